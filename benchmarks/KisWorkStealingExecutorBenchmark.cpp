@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisWorkStealingExecutorBenchmark.h"
+
+#include <atomic>
+
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "KisWorkStealingExecutor.h"
+#include "kis_image.h"
+#include "kis_paint_layer.h"
+#include "kis_paint_device.h"
+
+
+/**
+ * The depth of the fork-join tree, that is 2^(depth + 1) - 1 jobs
+ */
+static const int forkDepth = 14;
+
+/**
+ * A bit of useless work, roughly the size of a small merge job
+ */
+static const int jobWorkIterations = 2000;
+
+template<class Executor>
+struct ForkingJob : public QRunnable
+{
+    ForkingJob(Executor *executor, std::atomic<int> *counter, int depth)
+        : m_executor(executor),
+          m_counter(counter),
+          m_depth(depth)
+    {
+    }
+
+    void run() override {
+        if (m_depth > 0) {
+            m_executor->start(new ForkingJob(m_executor, m_counter, m_depth - 1));
+            m_executor->start(new ForkingJob(m_executor, m_counter, m_depth - 1));
+        }
+
+        volatile qreal value = 0;
+        for (int i = 0; i < jobWorkIterations; i++) {
+            value = value + qreal(i) * 0.5;
+        }
+
+        (*m_counter)++;
+    }
+
+private:
+    Executor *m_executor;
+    std::atomic<int> *m_counter;
+    int m_depth;
+};
+
+static void addThreadCountRows(bool addExecutorType)
+{
+    const int threadCounts[] = {4, 8, 16, 32, 64};
+
+    for (int threads : threadCounts) {
+        if (addExecutorType) {
+            QTest::newRow(QString("qthreadpool-%1").arg(threads).toLatin1()) << threads << false;
+            QTest::newRow(QString("work-stealing-%1").arg(threads).toLatin1()) << threads << true;
+        } else {
+            QTest::newRow(QString("threads-%1").arg(threads).toLatin1()) << threads;
+        }
+    }
+}
+
+void KisWorkStealingExecutorBenchmark::benchmarkForkJoin_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<bool>("useWorkStealing");
+
+    addThreadCountRows(true);
+}
+
+void KisWorkStealingExecutorBenchmark::benchmarkForkJoin()
+{
+    QFETCH(int, threads);
+    QFETCH(bool, useWorkStealing);
+
+    const int expectedJobs = (1 << (forkDepth + 1)) - 1;
+    std::atomic<int> counter(0);
+
+    if (useWorkStealing) {
+        KisWorkStealingExecutor executor(threads);
+
+        QBENCHMARK {
+            counter = 0;
+            executor.start(new ForkingJob<KisWorkStealingExecutor>(&executor, &counter, forkDepth));
+            executor.waitForDone();
+        }
+    } else {
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+
+        QBENCHMARK {
+            counter = 0;
+            pool.start(new ForkingJob<QThreadPool>(&pool, &counter, forkDepth));
+            pool.waitForDone();
+        }
+    }
+
+    QCOMPARE(int(counter), expectedJobs);
+}
+
+void KisWorkStealingExecutorBenchmark::benchmarkImageUpdates_data()
+{
+    QTest::addColumn<int>("threads");
+
+    addThreadCountRows(false);
+}
+
+void KisWorkStealingExecutorBenchmark::benchmarkImageUpdates()
+{
+    QFETCH(int, threads);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(0, 0, 4096, 4096);
+    const int numLayers = 8;
+    const int updateSize = 64;
+
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "benchmark");
+    image->setWorkingThreadsLimit(threads);
+
+    QVector<KisPaintLayerSP> layers;
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8 / 2, cs);
+        layer->paintDevice()->fill(imageRect, KoColor(QColor(i * 30, 255 - i * 30, 128), cs));
+        image->addNode(layer, image->root());
+        layers << layer;
+    }
+
+    image->refreshGraph();
+    image->waitForDone();
+
+    QBENCHMARK {
+        // many small non-intersecting updates, like a large brush stroke
+        for (int y = 0; y < imageRect.height(); y += updateSize) {
+            for (int x = 0; x < imageRect.width(); x += updateSize) {
+                layers[(x / updateSize + y / updateSize) % numLayers]->setDirty(QRect(x, y, updateSize, updateSize));
+            }
+        }
+
+        image->waitForDone();
+    }
+}
+
+QTEST_MAIN(KisWorkStealingExecutorBenchmark)
@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef KISWORKSTEALINGEXECUTORBENCHMARK_H
+#define KISWORKSTEALINGEXECUTORBENCHMARK_H
+
+#include <QtTest>
+
+/**
+ * Measures how the job dispatching scales with the number of
+ * threads, from 4 to 64. The executor is compared against
+ * QThreadPool on a fork-join tree of tiny jobs, and the whole
+ * update pipeline of the image is measured with many small
+ * updates of a layer stack.
+ */
+class KisWorkStealingExecutorBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchmarkForkJoin_data();
+    void benchmarkForkJoin();
+
+    void benchmarkImageUpdates_data();
+    void benchmarkImageUpdates();
+};
+
+#endif // KISWORKSTEALINGEXECUTORBENCHMARK_H
@@ -65,36 +65,51 @@ void KisBContrastBenchmark::cleanupTestCase()
 }
 
 
-void KisBContrastBenchmark::benchmarkFilter()
+void KisBContrastBenchmark::benchmarkFilterImpl(KisPaintDeviceSP device)
 {
-    KisFilterSP filter = KisFilterRegistry::instance()->value("brightnesscontrast");
+    /**
+     * The brightness/contrast filter has been merged into the
+     * per-channel one, so apply the same contrast curve to all the
+     * color channels. The curves are: all colors, red, green, blue,
+     * alpha and lightness.
+     */
+    KisFilterSP filter = KisFilterRegistry::instance()->value("perchannel");
     KisFilterConfigurationSP  kfc = filter->defaultConfiguration();
 
-    // Get the predefined configuration from a file
-    QFile file(QString(FILES_DATA_DIR) + QDir::separator() + filter->id() + ".cfg");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        file.open(QIODevice::WriteOnly | QIODevice::Text);
-        QTextStream out(&file);
-        out.setCodec("UTF-8");
-        out << kfc->toXML();
-    } else {
-        QString s;
-        QTextStream in(&file);
-        in.setCodec("UTF-8");
-        s = in.readAll();
-        kfc->fromXML(s);
-    }
+    const QString identity = "0,0;1,1;";
+    const QString contrast = "0,0;0.25,0.15;0.75,0.85;1,1;";
+
+    kfc->fromXML(QString("<!DOCTYPE params><params version=\"1\">"
+                         "<param name=\"nTransfers\">6</param>"
+                         "<param name=\"curve0\">%1</param>"
+                         "<param name=\"curve1\">%2</param>"
+                         "<param name=\"curve2\">%2</param>"
+                         "<param name=\"curve3\">%2</param>"
+                         "<param name=\"curve4\">%1</param>"
+                         "<param name=\"curve5\">%1</param>"
+                         "</params>").arg(identity).arg(contrast));
 
     QSize size = KritaUtils::optimalPatchSize();
     QVector<QRect> rects = KritaUtils::splitRectIntoPatches(QRect(0, 0, GMP_IMAGE_WIDTH,GMP_IMAGE_HEIGHT), size);
 
     QBENCHMARK{
         Q_FOREACH (const QRect &rc, rects) {
-            filter->process(m_device, rc, kfc);
+            filter->process(device, rc, kfc);
         }
     }
 }
 
+void KisBContrastBenchmark::benchmarkFilter()
+{
+    benchmarkFilterImpl(m_device);
+}
+
+void KisBContrastBenchmark::benchmarkFilter16()
+{
+    KisPaintDeviceSP device = new KisPaintDevice(*m_device);
+    delete device->convertTo(KoColorSpaceRegistry::instance()->rgb16());
 
+    benchmarkFilterImpl(device);
+}
 
 QTEST_MAIN(KisBContrastBenchmark)
@@ -36,11 +36,15 @@ private:
     KisPaintDeviceSP m_device;        
     
     
+private:
+    void benchmarkFilterImpl(KisPaintDeviceSP device);
+
 private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
     
     void benchmarkFilter();
+    void benchmarkFilter16();
     
 };
 
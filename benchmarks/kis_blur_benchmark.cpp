@@ -36,6 +36,8 @@
 
 #include "kis_selection.h"
 #include <kis_iterator_ng.h>
+#include <kis_gaussian_kernel.h>
+#include <QBitArray>
 
 void KisBlurBenchmark::initTestCase()
 {
@@ -87,6 +89,26 @@ void KisBlurBenchmark::benchmarkFilter()
     }
 }
 
+void KisBlurBenchmark::benchmarkGaussian_data()
+{
+    QTest::addColumn<qreal>("radius");
+
+    QTest::newRow("r5") << 5.0;
+    QTest::newRow("r20") << 20.0;
+    QTest::newRow("r80") << 80.0;
+    QTest::newRow("r300") << 300.0;
+}
+
+void KisBlurBenchmark::benchmarkGaussian()
+{
+    QFETCH(qreal, radius);
 
+    const QRect rc(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+
+    QBENCHMARK{
+        KisGaussianKernel::applyGaussian(dev, rc, radius, radius, QBitArray(), 0);
+    }
+}
 
 QTEST_MAIN(KisBlurBenchmark)
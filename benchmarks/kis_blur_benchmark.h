@@ -39,6 +39,9 @@ private Q_SLOTS:
     void cleanupTestCase();
     
     void benchmarkFilter();
+
+    void benchmarkGaussian_data();
+    void benchmarkGaussian();
     
 };
 
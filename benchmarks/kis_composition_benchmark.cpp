@@ -45,8 +45,12 @@
 #include <KoColorSpaceRegistry.h>
 
 #include <KoColorSpaceTraits.h>
+#include <KoChannelInfo.h>
 #include <KoCompositeOpAlphaDarken.h>
 #include <KoCompositeOpOver.h>
+#include <KoCompositeOpCopy2.h>
+#include <KoCompositeOpGeneric.h>
+#include <KoCompositeOpFunctions.h>
 #include "KoOptimizedCompositeOpFactory.h"
 
 // for posix_memalign()
@@ -148,6 +152,46 @@ struct RandomGenerator<float>
     boost::mt11213b m_rnd;
 };
 
+template <>
+struct RandomGenerator<quint16>
+{
+    RandomGenerator(int seed)
+        : m_smallint(0,65535),
+          m_rnd(seed)
+    {
+    }
+
+    quint16 operator() () {
+        return m_smallint(m_rnd);
+    }
+
+    quint16 unit() {
+        return KoColorSpaceMathsTraits<quint16>::unitValue;
+    }
+
+    boost::uniform_smallint<int> m_smallint;
+    boost::mt11213b m_rnd;
+};
+
+#ifdef HAVE_OPENEXR
+template <>
+struct RandomGenerator<half> : RandomGenerator<float>
+{
+    RandomGenerator(int seed)
+        : RandomGenerator<float>(seed)
+    {
+    }
+
+    half operator() () {
+        return half(RandomGenerator<float>::operator()());
+    }
+
+    half unit() {
+        return KoColorSpaceMathsTraits<half>::unitValue;
+    }
+};
+#endif
+
 template <>
 struct RandomGenerator<double> : RandomGenerator<float>
 {
@@ -222,7 +266,8 @@ QVector<Tile> generateTiles(int size,
                             const int dstAlignmentShift,
                             AlphaRange srcAlphaRange,
                             AlphaRange dstAlphaRange,
-                            const quint32 pixelSize)
+                            const quint32 pixelSize,
+                            bool halfFloat = false)
 {
     QVector<Tile> tiles(size);
 
@@ -255,6 +300,12 @@ QVector<Tile> generateTiles(int size,
 
         if (pixelSize == 4) {
             generateDataLine<quint8>(1, numPixels, tiles[i].src, tiles[i].dst, tiles[i].mask, srcAlphaRange, dstAlphaRange);
+        } else if (pixelSize == 8 && !halfFloat) {
+            generateDataLine<quint16>(1, numPixels, tiles[i].src, tiles[i].dst, tiles[i].mask, srcAlphaRange, dstAlphaRange);
+#ifdef HAVE_OPENEXR
+        } else if (pixelSize == 8 && halfFloat) {
+            generateDataLine<half>(1, numPixels, tiles[i].src, tiles[i].dst, tiles[i].mask, srcAlphaRange, dstAlphaRange);
+#endif
         } else if (pixelSize == 16) {
             generateDataLine<float>(1, numPixels, tiles[i].src, tiles[i].dst, tiles[i].mask, srcAlphaRange, dstAlphaRange);
         } else {
@@ -281,6 +332,13 @@ inline bool fuzzyCompare(channel_type a, channel_type b, channel_type prec) {
     return qAbs(a - b) <= prec;
 }
 
+#ifdef HAVE_OPENEXR
+template <>
+inline bool fuzzyCompare(half a, half b, half prec) {
+    return qAbs(float(a) - float(b)) <= float(prec);
+}
+#endif
+
 template <typename channel_type>
 inline bool comparePixels(channel_type *p1, channel_type *p2, channel_type prec) {
     return (p1[3] == p2[3] && p1[3] == 0) ||
@@ -322,12 +380,22 @@ bool compareTwoOpsPixels(QVector<Tile> &tiles, channel_type prec) {
     return true;
 }
 
-bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp *op2)
+bool isHalfFloat(const KoColorSpace *cs)
+{
+    return cs->channels().first()->channelValueType() == KoChannelInfo::FLOAT16;
+}
+
+const int compareAlignment = 16;
+
+/**
+ * Applies \p op1 to the first tile and \p op2 to the second one. The
+ * tiles should be released with freeTiles() afterwards.
+ */
+QVector<Tile> compositeTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp *op2, const QBitArray &channelFlags)
 {
     Q_ASSERT(op1->colorSpace()->pixelSize() == op2->colorSpace()->pixelSize());
-    const quint32 pixelSize = op1->colorSpace()->pixelSize();
-    const int alignment = 16;
-    QVector<Tile> tiles = generateTiles(2, alignment, alignment, ALPHA_RANDOM, ALPHA_RANDOM, op1->colorSpace()->pixelSize());
+    const bool halfFloat = isHalfFloat(op1->colorSpace());
+    QVector<Tile> tiles = generateTiles(2, compareAlignment, compareAlignment, ALPHA_RANDOM, ALPHA_RANDOM, op1->colorSpace()->pixelSize(), halfFloat);
 
     KoCompositeOp::ParameterInfo params;
     params.dstRowStride  = 4 * rowStride;
@@ -338,7 +406,7 @@ bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp
     // This is a hack as in the old version we get a rounding of opacity to this value
     params.opacity       = float(Arithmetic::scale<quint8>(0.5*1.0f))/255.0;
     params.flow          = 0.3*1.0f;
-    params.channelFlags  = QBitArray();
+    params.channelFlags  = channelFlags;
 
     params.dstRowStart   = tiles[0].dst;
     params.srcRowStart   = tiles[0].src;
@@ -350,10 +418,27 @@ bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp
     params.maskRowStart  = haveMask ? tiles[1].mask : 0;
     op2->composite(params);
 
+    return tiles;
+}
+
+bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp *op2, const QBitArray &channelFlags = QBitArray())
+{
+    const quint32 pixelSize = op1->colorSpace()->pixelSize();
+    const bool halfFloat = isHalfFloat(op1->colorSpace());
+    QVector<Tile> tiles = compositeTwoOps(haveMask, op1, op2, channelFlags);
+
     bool compareResult = true;
     if (pixelSize == 4) {
         compareResult = compareTwoOpsPixels<quint8>(tiles, 10);
     }
+    else if (pixelSize == 8 && !halfFloat) {
+        compareResult = compareTwoOpsPixels<quint16>(tiles, 64);
+    }
+#ifdef HAVE_OPENEXR
+    else if (pixelSize == 8 && halfFloat) {
+        compareResult = compareTwoOpsPixels<half>(tiles, half(2e-3f));
+    }
+#endif
     else if (pixelSize == 16) {
         compareResult = compareTwoOpsPixels<float>(tiles, 2e-7);
     }
@@ -361,11 +446,110 @@ bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp
         qFatal("Pixel size %i is not implemented", pixelSize);
     }
 
-    freeTiles(tiles, alignment, alignment);
+    freeTiles(tiles, compareAlignment, compareAlignment);
 
     return compareResult;
 }
 
+/**
+ * Checks the bounds documented in GenericSCCompositor32. Unlike
+ * comparePixels(), the colors of fully transparent pixels are
+ * compared too, when the alpha is locked.
+ */
+bool compareGenericSCPixels(QVector<Tile> &tiles, bool alphaLocked)
+{
+    const quint8 *dst1 = tiles[0].dst;
+    const quint8 *dst2 = tiles[1].dst;
+
+    for (int i = 0; i < numPixels; i++) {
+        const int alpha = dst2[alpha_pos];
+        bool isOk = qAbs(dst1[alpha_pos] - alpha) <= 1;
+
+        for (int ch = 0; ch < alpha_pos; ch++) {
+            const int diff = qAbs(dst1[ch] - dst2[ch]);
+
+            if (alphaLocked) {
+                isOk &= alpha ? diff <= 2 : diff == 0;
+            } else {
+                isOk &= diff * alpha <= 3 * 255;
+            }
+        }
+
+        if (!isOk) {
+            dbgKrita << "Wrong result:" << i;
+            dbgKrita << "Act: " << dst1[0] << dst1[1] << dst1[2] << dst1[3];
+            dbgKrita << "Exp: " << dst2[0] << dst2[1] << dst2[2] << dst2[3];
+
+            const quint8 *s = tiles[0].src + 4 * i;
+            dbgKrita << "Src: " << s[0] << s[1] << s[2] << s[3];
+            dbgKrita << "Msk: " << tiles[0].mask[i];
+
+            return false;
+        }
+
+        dst1 += 4;
+        dst2 += 4;
+    }
+
+    return true;
+}
+
+template<quint8 compositeFunc(quint8, quint8)>
+bool compareGenericSCOps(const QString &id, bool haveMask, const QBitArray &channelFlags)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QScopedPointer<KoCompositeOp> opAct(
+        KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, id, id, KoCompositeOp::categoryMix()));
+    QScopedPointer<KoCompositeOp> opExp(
+        new KoCompositeOpGenericSC<KoBgrU8Traits, compositeFunc>(cs, id, id, KoCompositeOp::categoryMix()));
+
+    if (!opAct) {
+        dbgKrita << "No optimized version of op" << id;
+        return false;
+    }
+
+    const bool alphaLocked = !channelFlags.isEmpty() && !channelFlags.testBit(alpha_pos);
+
+    QVector<Tile> tiles = compositeTwoOps(haveMask, opAct.data(), opExp.data(), channelFlags);
+    const bool result = compareGenericSCPixels(tiles, alphaLocked);
+    freeTiles(tiles, compareAlignment, compareAlignment);
+
+    if (!result) {
+        dbgKrita << "Failed op:" << id;
+    }
+
+    return result;
+}
+
+bool compareAllGenericSCOps(bool haveMask, const QBitArray &channelFlags = QBitArray())
+{
+    bool result = true;
+
+    result &= compareGenericSCOps<&cfMultiply<quint8> >(COMPOSITE_MULT, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfScreen<quint8> >(COMPOSITE_SCREEN, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfOverlay<quint8> >(COMPOSITE_OVERLAY, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfHardLight<quint8> >(COMPOSITE_HARD_LIGHT, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfSoftLight<quint8> >(COMPOSITE_SOFT_LIGHT_PHOTOSHOP, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfSoftLightSvg<quint8> >(COMPOSITE_SOFT_LIGHT_SVG, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfColorDodge<quint8> >(COMPOSITE_DODGE, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfColorBurn<quint8> >(COMPOSITE_BURN, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfAddition<quint8> >(COMPOSITE_ADD, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfAddition<quint8> >(COMPOSITE_LINEAR_DODGE, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfSubtract<quint8> >(COMPOSITE_SUBTRACT, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfInverseSubtract<quint8> >(COMPOSITE_INVERSE_SUBTRACT, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfLinearBurn<quint8> >(COMPOSITE_LINEAR_BURN, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfLinearLight<quint8> >(COMPOSITE_LINEAR_LIGHT, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfDarkenOnly<quint8> >(COMPOSITE_DARKEN, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfLightenOnly<quint8> >(COMPOSITE_LIGHTEN, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfDifference<quint8> >(COMPOSITE_DIFF, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfExclusion<quint8> >(COMPOSITE_EXCLUSION, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfGrainMerge<quint8> >(COMPOSITE_GRAIN_MERGE, haveMask, channelFlags);
+    result &= compareGenericSCOps<&cfGrainExtract<quint8> >(COMPOSITE_GRAIN_EXTRACT, haveMask, channelFlags);
+
+    return result;
+}
+
 QString getTestName(bool haveMask,
                     const int srcAlignmentShift,
                     const int dstAlignmentShift,
@@ -407,7 +591,7 @@ void benchmarkCompositeOp(const KoCompositeOp *op,
     QString testName = getTestName(haveMask, srcAlignmentShift, dstAlignmentShift, srcAlphaRange, dstAlphaRange);
 
     QVector<Tile> tiles =
-        generateTiles(numTiles, srcAlignmentShift, dstAlignmentShift, srcAlphaRange, dstAlphaRange, op->colorSpace()->pixelSize());
+        generateTiles(numTiles, srcAlignmentShift, dstAlignmentShift, srcAlphaRange, dstAlphaRange, op->colorSpace()->pixelSize(), isHalfFloat(op->colorSpace()));
 
     const int tileOffset = 4 * (processRect.y() * rowStride + processRect.x());
 
@@ -710,6 +894,147 @@ void KisCompositionBenchmark::compareRgbF32OverOps()
     delete opAct;
 }
 
+void KisCompositionBenchmark::compareRgbU16AlphaDarkenOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createAlphaDarkenOpU64(cs);
+    KoCompositeOp *opExp = new KoCompositeOpAlphaDarken<KoBgrU16Traits>(cs);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+}
+
+void KisCompositionBenchmark::compareRgbU16OverOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createOverOpU64(cs);
+    KoCompositeOp *opExp = new KoCompositeOpOver<KoBgrU16Traits>(cs);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+}
+
+void KisCompositionBenchmark::compareRgbU16CopyOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createCopyOpU64(cs);
+    KoCompositeOp *opExp = new KoCompositeOpCopy2<KoBgrU16Traits>(cs);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+}
+
+void KisCompositionBenchmark::compareRgbF16AlphaDarkenOps()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createAlphaDarkenOpF64(cs);
+    KoCompositeOp *opExp = new KoCompositeOpAlphaDarken<KoRgbF16Traits>(cs);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+#else
+    QSKIP("Half-float colorspaces need OpenEXR");
+#endif
+}
+
+void KisCompositionBenchmark::compareRgbF16OverOps()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createOverOpF64(cs);
+    KoCompositeOp *opExp = new KoCompositeOpOver<KoRgbF16Traits>(cs);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+#else
+    QSKIP("Half-float colorspaces need OpenEXR");
+#endif
+}
+
+void KisCompositionBenchmark::compareRgbF16CopyOps()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createCopyOpF64(cs);
+    KoCompositeOp *opExp = new KoCompositeOpCopy2<KoRgbF16Traits>(cs);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+#else
+    QSKIP("Half-float colorspaces need OpenEXR");
+#endif
+}
+
+void KisCompositionBenchmark::compareRgbU16OverOpsAlphaLocked()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createOverOpU64(cs);
+    KoCompositeOp *opExp = new KoCompositeOpOver<KoBgrU16Traits>(cs);
+
+    QBitArray channelFlags(4, true);
+    channelFlags.clearBit(3);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp, channelFlags));
+
+    delete opExp;
+    delete opAct;
+}
+
+void KisCompositionBenchmark::compareGenericSCOps()
+{
+#ifndef HAVE_VC
+    QSKIP("Generic ops are not vectorized without Vc");
+#endif
+    QVERIFY(compareAllGenericSCOps(true));
+}
+
+void KisCompositionBenchmark::compareGenericSCOpsNoMask()
+{
+#ifndef HAVE_VC
+    QSKIP("Generic ops are not vectorized without Vc");
+#endif
+    QVERIFY(compareAllGenericSCOps(false));
+}
+
+void KisCompositionBenchmark::compareGenericSCOpsAlphaLocked()
+{
+#ifndef HAVE_VC
+    QSKIP("Generic ops are not vectorized without Vc");
+#endif
+    QBitArray channelFlags(4, true);
+    channelFlags.clearBit(3);
+
+    QVERIFY(compareAllGenericSCOps(true, channelFlags));
+}
+
+void KisCompositionBenchmark::compareGenericSCOpsChannelFlags()
+{
+#ifndef HAVE_VC
+    QSKIP("Generic ops are not vectorized without Vc");
+#endif
+    QBitArray channelFlags(4, true);
+    channelFlags.clearBit(1);
+
+    QVERIFY(compareAllGenericSCOps(true, channelFlags));
+
+    channelFlags.clearBit(3);
+
+    QVERIFY(compareAllGenericSCOps(true, channelFlags));
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenLegacy()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -742,6 +1067,44 @@ void KisCompositionBenchmark::testRgb8CompositeOverOptimized()
     delete op;
 }
 
+void KisCompositionBenchmark::testRgb8CompositeMultiplyLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoBgrU8Traits, &cfMultiply<quint8> >(cs, COMPOSITE_MULT, "Multiply", KoCompositeOp::categoryArithmetic());
+    benchmarkCompositeOp(op, "Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb8CompositeMultiplyOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, COMPOSITE_MULT, "Multiply", KoCompositeOp::categoryArithmetic());
+    if (!op) {
+        QSKIP("Generic ops are not vectorized without Vc");
+    }
+    benchmarkCompositeOp(op, "Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb8CompositeOverlayLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoBgrU8Traits, &cfOverlay<quint8> >(cs, COMPOSITE_OVERLAY, "Overlay", KoCompositeOp::categoryMix());
+    benchmarkCompositeOp(op, "Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb8CompositeOverlayOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, COMPOSITE_OVERLAY, "Overlay", KoCompositeOp::categoryMix());
+    if (!op) {
+        QSKIP("Generic ops are not vectorized without Vc");
+    }
+    benchmarkCompositeOp(op, "Optimized");
+    delete op;
+}
+
 void KisCompositionBenchmark::testRgbF32CompositeAlphaDarkenLegacy()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
@@ -774,6 +1137,62 @@ void KisCompositionBenchmark::testRgbF32CompositeOverOptimized()
     delete op;
 }
 
+void KisCompositionBenchmark::testRgbU16CompositeAlphaDarkenLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = new KoCompositeOpAlphaDarken<KoBgrU16Traits>(cs);
+    benchmarkCompositeOp(op, "RGBU16 Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbU16CompositeAlphaDarkenOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createAlphaDarkenOpU64(cs);
+    benchmarkCompositeOp(op, "RGBU16 Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbU16CompositeOverLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = new KoCompositeOpOver<KoBgrU16Traits>(cs);
+    benchmarkCompositeOp(op, "RGBU16 Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbU16CompositeOverOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createOverOpU64(cs);
+    benchmarkCompositeOp(op, "RGBU16 Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbF16CompositeOverLegacy()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *op = new KoCompositeOpOver<KoRgbF16Traits>(cs);
+    benchmarkCompositeOp(op, "RGBF16 Legacy");
+    delete op;
+#else
+    QSKIP("Half-float colorspaces need OpenEXR");
+#endif
+}
+
+void KisCompositionBenchmark::testRgbF16CompositeOverOptimized()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createOverOpF64(cs);
+    benchmarkCompositeOp(op, "RGBF16 Optimized");
+    delete op;
+#else
+    QSKIP("Half-float colorspaces need OpenEXR");
+#endif
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenReal_Aligned()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -45,6 +45,17 @@ private Q_SLOTS:
     void compareOverOps();
     void compareOverOpsNoMask();
     void compareRgbF32OverOps();
+    void compareRgbU16AlphaDarkenOps();
+    void compareRgbU16OverOps();
+    void compareRgbU16CopyOps();
+    void compareRgbF16AlphaDarkenOps();
+    void compareRgbF16OverOps();
+    void compareRgbF16CopyOps();
+    void compareRgbU16OverOpsAlphaLocked();
+    void compareGenericSCOps();
+    void compareGenericSCOpsNoMask();
+    void compareGenericSCOpsAlphaLocked();
+    void compareGenericSCOpsChannelFlags();
 
     void testRgb8CompositeAlphaDarkenLegacy();
     void testRgb8CompositeAlphaDarkenOptimized();
@@ -52,12 +63,27 @@ private Q_SLOTS:
     void testRgb8CompositeOverLegacy();
     void testRgb8CompositeOverOptimized();
 
+    void testRgb8CompositeMultiplyLegacy();
+    void testRgb8CompositeMultiplyOptimized();
+
+    void testRgb8CompositeOverlayLegacy();
+    void testRgb8CompositeOverlayOptimized();
+
     void testRgbF32CompositeAlphaDarkenLegacy();
     void testRgbF32CompositeAlphaDarkenOptimized();
 
     void testRgbF32CompositeOverLegacy();
     void testRgbF32CompositeOverOptimized();
 
+    void testRgbU16CompositeAlphaDarkenLegacy();
+    void testRgbU16CompositeAlphaDarkenOptimized();
+
+    void testRgbU16CompositeOverLegacy();
+    void testRgbU16CompositeOverOptimized();
+
+    void testRgbF16CompositeOverLegacy();
+    void testRgbF16CompositeOverOptimized();
+
     void testRgb8CompositeAlphaDarkenReal_Aligned();
     void testRgb8CompositeOverReal_Aligned();
 
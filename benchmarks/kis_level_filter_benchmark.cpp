@@ -64,7 +64,7 @@ void KisLevelFilterBenchmark::cleanupTestCase()
 {
 }
 
-void KisLevelFilterBenchmark::benchmarkFilter()
+void KisLevelFilterBenchmark::benchmarkFilterImpl(KisPaintDeviceSP device)
 {
     KisFilterSP filter = KisFilterRegistry::instance()->value("levels");
     //KisFilterConfigurationSP  kfc = filter->defaultConfiguration(m_device);
@@ -96,11 +96,22 @@ void KisLevelFilterBenchmark::benchmarkFilter()
 
     QBENCHMARK{
         Q_FOREACH (const QRect &rc, rects) {
-            filter->process(m_device, rc, kfc);
+            filter->process(device, rc, kfc);
         }
     }
 }
 
+void KisLevelFilterBenchmark::benchmarkFilter()
+{
+    benchmarkFilterImpl(m_device);
+}
 
+void KisLevelFilterBenchmark::benchmarkFilter16()
+{
+    KisPaintDeviceSP device = new KisPaintDevice(*m_device);
+    delete device->convertTo(KoColorSpaceRegistry::instance()->rgb16());
+
+    benchmarkFilterImpl(device);
+}
 
 QTEST_MAIN(KisLevelFilterBenchmark)
@@ -35,11 +35,15 @@ private:
     KisPaintDeviceSP m_device;
     KoColor m_color;
 
+private:
+    void benchmarkFilterImpl(KisPaintDeviceSP device);
+
 private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
 
     void benchmarkFilter();
+    void benchmarkFilter16();
 };
 
 #endif // KIS_LEVEL_FILTER_BENCHMARK_H
@@ -30,6 +30,12 @@ private Q_SLOTS:
     void benchmarkSIMD_FadedBrush();
     void benchmarkSquare();
 
+    void benchmarkSIMD_Rect();
+    void benchmarkSIMD_GaussCircle();
+    void benchmarkSIMD_GaussRect();
+    void benchmarkSIMD_CurveCircle();
+    void benchmarkSIMD_CurveRect();
+
 };
 
 #endif
@@ -0,0 +1,270 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_data_allocator_benchmark.h"
+
+#include <QTest>
+#include <QtConcurrent>
+
+#include <boost/pool/singleton_pool.hpp>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "kis_debug.h"
+#include "tiles3/kis_tile_data_slab_allocator.h"
+
+// RGBA
+#define CHUNK_SIZE (4 * 64 * 64)
+#define NUM_CHUNKS 10000
+
+
+struct AllocatorAdapter
+{
+    virtual ~AllocatorAdapter() {}
+    virtual quint8* allocate() = 0;
+    virtual void free(quint8 *ptr) = 0;
+    virtual void release() = 0;
+};
+
+struct MallocAdapter : public AllocatorAdapter
+{
+    quint8* allocate() override {
+        return (quint8*) malloc(CHUNK_SIZE);
+    }
+
+    void free(quint8 *ptr) override {
+        ::free(ptr);
+    }
+
+    void release() override {
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+    }
+};
+
+struct BenchmarkPoolTag {};
+typedef boost::singleton_pool<BenchmarkPoolTag, CHUNK_SIZE, boost::default_user_allocator_new_delete, boost::details::pool::default_mutex, 256, 4096> BenchmarkBoostPool;
+
+struct BoostPoolAdapter : public AllocatorAdapter
+{
+    ~BoostPoolAdapter() override {
+        BenchmarkBoostPool::purge_memory();
+    }
+
+    quint8* allocate() override {
+        return (quint8*) BenchmarkBoostPool::malloc();
+    }
+
+    void free(quint8 *ptr) override {
+        BenchmarkBoostPool::free(ptr);
+    }
+
+    void release() override {
+        /**
+         * The pool could only be purged as a whole, that is what
+         * KisTileData::releaseInternalPools() used to do after
+         * migrating all the tiles
+         */
+    }
+};
+
+struct SlabAdapter : public AllocatorAdapter
+{
+    SlabAdapter() : allocator(CHUNK_SIZE) {}
+
+    quint8* allocate() override {
+        return allocator.allocate();
+    }
+
+    void free(quint8 *ptr) override {
+        allocator.free(ptr);
+    }
+
+    void release() override {
+        allocator.releaseFreeSlabs();
+    }
+
+    KisTileDataSlabAllocator allocator;
+};
+
+enum AllocatorType {
+    Malloc,
+    BoostPool,
+    Slab
+};
+
+AllocatorAdapter* createAdapter(int type)
+{
+    switch (type) {
+    case Malloc:
+        return new MallocAdapter();
+    case BoostPool:
+        return new BoostPoolAdapter();
+    default:
+        return new SlabAdapter();
+    }
+}
+
+void addAllocatorsData()
+{
+    QTest::addColumn<int>("allocatorType");
+
+    QTest::newRow("malloc") << int(Malloc);
+    QTest::newRow("boost-pool") << int(BoostPool);
+    QTest::newRow("slab") << int(Slab);
+}
+
+/**
+ * Allocates the chunks in a pattern similar to a painting thread:
+ * chunks are allocated in bursts and some of them are freed
+ */
+void allocationCycle(AllocatorAdapter *adapter, int numChunks)
+{
+    QVector<quint8*> chunks(numChunks);
+
+    for (int i = 0; i < numChunks; i++) {
+        chunks[i] = adapter->allocate();
+        chunks[i][0] = i & 0xff;
+    }
+
+    for (int i = 0; i < numChunks; i += 2) {
+        adapter->free(chunks[i]);
+    }
+
+    for (int i = 0; i < numChunks; i += 2) {
+        chunks[i] = adapter->allocate();
+    }
+
+    for (int i = 0; i < numChunks; i++) {
+        adapter->free(chunks[i]);
+    }
+}
+
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) return -1;
+
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) return -1;
+
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+void KisTileDataAllocatorBenchmark::benchmarkSingleThreaded_data()
+{
+    addAllocatorsData();
+}
+
+void KisTileDataAllocatorBenchmark::benchmarkSingleThreaded()
+{
+    QFETCH(int, allocatorType);
+    QScopedPointer<AllocatorAdapter> adapter(createAdapter(allocatorType));
+
+    QBENCHMARK {
+        allocationCycle(adapter.data(), NUM_CHUNKS);
+    }
+}
+
+void KisTileDataAllocatorBenchmark::benchmarkMultiThreaded_data()
+{
+    addAllocatorsData();
+}
+
+void KisTileDataAllocatorBenchmark::benchmarkMultiThreaded()
+{
+    QFETCH(int, allocatorType);
+    QScopedPointer<AllocatorAdapter> adapter(createAdapter(allocatorType));
+
+    const int numThreads = qMax(2, QThread::idealThreadCount());
+    QVector<AllocatorAdapter*> jobs(numThreads, adapter.data());
+
+    QBENCHMARK {
+        QtConcurrent::blockingMap(jobs, [] (AllocatorAdapter *adapter) {
+            allocationCycle(adapter, NUM_CHUNKS / 4);
+        });
+    }
+}
+
+void KisTileDataAllocatorBenchmark::testFragmentation_data()
+{
+    addAllocatorsData();
+}
+
+void KisTileDataAllocatorBenchmark::testFragmentation()
+{
+    QFETCH(int, allocatorType);
+
+    if (residentMemory() < 0) {
+        QSKIP("Resident memory size is not available on this platform");
+    }
+
+    QScopedPointer<AllocatorAdapter> adapter(createAdapter(allocatorType));
+
+    const qint64 initialMemory = residentMemory();
+
+    QVector<quint8*> chunks(NUM_CHUNKS);
+    for (int i = 0; i < NUM_CHUNKS; i++) {
+        chunks[i] = adapter->allocate();
+        memset(chunks[i], i & 0xff, CHUNK_SIZE);
+    }
+
+    const qint64 peakMemory = residentMemory() - initialMemory;
+
+    /**
+     * Keep every 64th chunk alive, that is what usually
+     * happens when a big layer is removed from the image
+     */
+    int numLiveChunks = 0;
+    for (int i = 0; i < NUM_CHUNKS; i++) {
+        if (i % 64) {
+            adapter->free(chunks[i]);
+        } else {
+            numLiveChunks++;
+        }
+    }
+
+    adapter->release();
+
+    const qint64 retainedMemory = residentMemory() - initialMemory;
+    const qint64 liveMemory = qint64(numLiveChunks) * CHUNK_SIZE;
+
+    qDebug() << "Peak RSS growth (MiB):" << peakMemory / (1 << 20)
+             << "retained (MiB):" << retainedMemory / (1 << 20)
+             << "live data (MiB):" << liveMemory / (1 << 20)
+             << "overhead:" << qreal(retainedMemory) / liveMemory;
+
+    for (int i = 0; i < NUM_CHUNKS; i += 64) {
+        adapter->free(chunks[i]);
+    }
+
+    adapter->release();
+}
+
+QTEST_MAIN(KisTileDataAllocatorBenchmark)
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_hash_table_benchmark.h"
+
+#include <QTest>
+#include <QtConcurrent>
+#include <QElapsedTimer>
+
+#include "kis_debug.h"
+
+#include "tiles3/kis_tile.h"
+#include "tiles3/kis_tile_hash_table.h"
+#include "tiles3/kis_tile_data_store.h"
+
+#define NUM_COLUMNS 64
+#define NUM_ROWS 64
+#define LOOKUPS_PER_THREAD 200000
+
+
+void KisTileHashTableBenchmark::benchmarkGetTile_data()
+{
+    QTest::addColumn<int>("numThreads");
+    QTest::addColumn<bool>("useGlobalLock");
+
+    for (int numThreads = 1; numThreads <= 64; numThreads *= 2) {
+        /**
+         * The "rwlock" rows serialize the lookups with a global
+         * read-write lock, like the table used to do
+         */
+        QTest::newRow(QString("lockfree-%1").arg(numThreads).toLatin1()) << numThreads << false;
+        QTest::newRow(QString("rwlock-%1").arg(numThreads).toLatin1()) << numThreads << true;
+    }
+}
+
+void KisTileHashTableBenchmark::benchmarkGetTile()
+{
+    QFETCH(int, numThreads);
+    QFETCH(bool, useGlobalLock);
+
+    quint8 defaultPixel = 0;
+    KisTileHashTable ht(0);
+    ht.setDefaultTileData(KisTileDataStore::instance()->createDefaultTileData(4, &defaultPixel));
+
+    for (int row = 0; row < NUM_ROWS; row++) {
+        for (int col = 0; col < NUM_COLUMNS; col++) {
+            bool newTile = false;
+            ht.getTileLazy(col, row, newTile);
+        }
+    }
+
+    QReadWriteLock globalLock;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+
+    QVector<int> seeds;
+    for (int i = 0; i < numThreads; i++) {
+        seeds << i;
+    }
+
+    auto lookupJob = [&] (int seed) {
+        for (int i = 0; i < LOOKUPS_PER_THREAD; i++) {
+            const int index = (i * 7 + seed * 131) % (NUM_COLUMNS * NUM_ROWS);
+
+            if (useGlobalLock) {
+                QReadLocker locker(&globalLock);
+                ht.getExistingTile(index % NUM_COLUMNS, index / NUM_COLUMNS);
+            } else {
+                ht.getExistingTile(index % NUM_COLUMNS, index / NUM_COLUMNS);
+            }
+        }
+    };
+
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    int numRuns = 0;
+
+    QBENCHMARK {
+        timer.start();
+
+        QList<QFuture<void>> futures;
+        Q_FOREACH (int seed, seeds) {
+            futures << QtConcurrent::run(&pool, lookupJob, seed);
+        }
+
+        Q_FOREACH (QFuture<void> future, futures) {
+            future.waitForFinished();
+        }
+
+        elapsed += timer.nsecsElapsed();
+        numRuns++;
+    }
+
+    const qreal secondsPerRun = qreal(elapsed) / numRuns / 1e9;
+    qDebug() << "Threads:" << numThreads
+             << "lookups per second per thread:"
+             << qRound64(LOOKUPS_PER_THREAD / secondsPerRun);
+}
+
+QTEST_MAIN(KisTileHashTableBenchmark)
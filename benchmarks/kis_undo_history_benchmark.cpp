@@ -0,0 +1,144 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_undo_history_benchmark.h"
+
+#include <QTest>
+
+#include "kis_debug.h"
+#include "kis_image_config.h"
+
+#include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "tiles3/kis_memento_item.h"
+
+#define IMAGE_SIZE 2048
+#define NUM_STROKES 50
+#define STROKE_WIDTH 8
+
+
+namespace {
+
+/**
+ * Every stroke is a thin horizontal line crossing the whole image,
+ * so it touches a row of tiles, but changes only a few pixels in
+ * each of them
+ */
+QVector<KisMementoSP> paintStrokes(KisTiledDataManager &dm)
+{
+    QVector<KisMementoSP> mementos;
+
+    for (int i = 0; i < NUM_STROKES; i++) {
+        const quint8 pixel[4] = {quint8(i), quint8(2 * i), quint8(3 * i), 255};
+        const int y = (i * 3 * STROKE_WIDTH) % (4 * KisTileData::HEIGHT);
+
+        mementos << dm.getMemento();
+        dm.clear(QRect(0, y, IMAGE_SIZE, STROKE_WIDTH), pixel);
+        dm.commit();
+    }
+
+    return mementos;
+}
+
+void setDeltaCompression(bool value)
+{
+    KisImageConfig config;
+    config.setEnableUndoDeltaCompression(value);
+}
+
+}
+
+void KisUndoHistoryBenchmark::initHistoryData()
+{
+    QTest::addColumn<bool>("useDeltas");
+
+    QTest::newRow("copies") << false;
+    QTest::newRow("deltas") << true;
+}
+
+void KisUndoHistoryBenchmark::benchmarkHistoryMemory_data()
+{
+    initHistoryData();
+}
+
+void KisUndoHistoryBenchmark::benchmarkHistoryMemory()
+{
+    QFETCH(bool, useDeltas);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+
+    setDeltaCompression(useDeltas);
+    store->testingRereadConfig();
+
+    const qint64 tileSize = KisTileData::WIDTH * KisTileData::HEIGHT * 4;
+    const qint64 tilesBefore = store->numTiles();
+    const qint64 deltasBefore = KisMementoItem::totalDeltaMemorySize();
+
+    quint8 defaultPixel[4] = {0, 0, 0, 0};
+    KisTiledDataManager dm(4, defaultPixel);
+
+    QVector<KisMementoSP> mementos;
+
+    QBENCHMARK_ONCE {
+        mementos = paintStrokes(dm);
+        store->m_mementoCompressor.testingWaitForIdle();
+    }
+
+    const qint64 tileDataMemory = (store->numTiles() - tilesBefore) * tileSize;
+    const qint64 deltaMemory = KisMementoItem::totalDeltaMemorySize() - deltasBefore;
+
+    qDebug() << "History of" << NUM_STROKES << "strokes:"
+             << "tile data" << tileDataMemory / 1024 << "KiB"
+             << "deltas" << deltaMemory / 1024 << "KiB"
+             << "total" << (tileDataMemory + deltaMemory) / 1024 << "KiB";
+}
+
+void KisUndoHistoryBenchmark::benchmarkUndoRedo_data()
+{
+    initHistoryData();
+}
+
+void KisUndoHistoryBenchmark::benchmarkUndoRedo()
+{
+    QFETCH(bool, useDeltas);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+
+    setDeltaCompression(useDeltas);
+    store->testingRereadConfig();
+
+    quint8 defaultPixel[4] = {0, 0, 0, 0};
+    KisTiledDataManager dm(4, defaultPixel);
+
+    QVector<KisMementoSP> mementos = paintStrokes(dm);
+    store->m_mementoCompressor.testingWaitForIdle();
+
+    QBENCHMARK_ONCE {
+        for (int i = mementos.size() - 1; i >= 0; i--) {
+            dm.rollback(mementos[i]);
+        }
+
+        for (int i = 0; i < mementos.size(); i++) {
+            dm.rollforward(mementos[i]);
+        }
+    }
+
+    store->m_mementoCompressor.testingWaitForIdle();
+}
+
+QTEST_MAIN(KisUndoHistoryBenchmark)
@@ -4,6 +4,8 @@
 #  FFTW3_FOUND - system has fftw3
 #  FFTW3_INCLUDE_DIRS - the fftw3 include directories
 #  FFTW3_LIBRARIES - the libraries needed to use fftw3
+#  FFTW3F_FOUND - system has the single precision fftw3f library, which is
+#                 then also added to FFTW3_LIBRARIES
 # Redistribution and use is allowed according to the terms of the BSD license.
 # For details see the accompanying COPYING-CMAKE-SCRIPTS file.
 #
@@ -22,12 +24,23 @@ find_library(FFTW3_LIBRARY
     HINTS ${FFTW3_PKGCONF_LIBRARY_DIRS} ${FFTW3_PKGCONF_LIBDIR}
 )
 
+find_library(FFTW3F_LIBRARY
+    NAMES fftw3f
+    HINTS ${FFTW3_PKGCONF_LIBRARY_DIRS} ${FFTW3_PKGCONF_LIBDIR}
+)
+
 set(FFTW3_PROCESS_LIBS FFTW3_LIBRARY)
 set(FFTW3_PROCESS_INCLUDES FFTW3_INCLUDE_DIR)
 libfind_process(FFTW3)
 
 if(FFTW3_FOUND)
     message(STATUS "FFTW Found Version: " ${FFTW_VERSION})
+
+    if(FFTW3F_LIBRARY)
+        set(FFTW3F_FOUND true)
+        set(FFTW3_LIBRARIES ${FFTW3_LIBRARIES} ${FFTW3F_LIBRARY})
+        message(STATUS "Found single precision FFTW: " ${FFTW3F_LIBRARY})
+    endif()
 endif()
 
 else()
@@ -44,6 +57,11 @@ find_library(
     NAMES libfftw3 libfftw3-3 libfftw3f-3 libfftw3l-3
     DOC "Libraries to link against for FFT Support")
 
+find_library(
+    FFTW3F_LIBRARY
+    NAMES libfftw3f libfftw3f-3
+    DOC "Single precision library to link against for FFT Support")
+
 if (FFTW3_LIBRARY)
     set(FFTW3_LIBRARY_DIR ${FFTW3_LIBRARY})
 endif()
@@ -53,6 +71,11 @@ set (FFTW3_LIBRARIES ${FFTW3_LIBRARY})
 if(FFTW3_INCLUDE_DIR AND FFTW3_LIBRARY_DIR)
  set (FFTW3_FOUND true)
  message(STATUS "Correctly found FFTW3")
+
+ if (FFTW3F_LIBRARY AND NOT FFTW3F_LIBRARY STREQUAL FFTW3_LIBRARY)
+  set (FFTW3F_FOUND true)
+  set (FFTW3_LIBRARIES ${FFTW3_LIBRARIES} ${FFTW3F_LIBRARY})
+ endif()
 else()
   message(STATUS "Could not find FFTW3")
 endif()
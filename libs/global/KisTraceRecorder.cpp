@@ -0,0 +1,315 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisTraceRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+#include "kis_debug.h"
+
+Q_GLOBAL_STATIC(KisTraceRecorder, s_instance)
+
+std::atomic<bool> KisTraceRecorder::s_enabled(false);
+
+namespace {
+
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    qint64 startTime;
+    qint64 endTime;
+    int threadId;
+};
+
+/**
+ * A single-producer ring buffer. It is owned by one thread at a time,
+ * the readers detect overwritten events by checking the write index
+ * after copying.
+ */
+struct ThreadBuffer
+{
+    TraceEvent events[KisTraceRecorder::eventsPerThread];
+    std::atomic<quint64> writeIndex {0};
+    int threadId = -1;
+};
+
+void writeEscaped(QByteArray &out, const char *str)
+{
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            out.append('\\');
+        }
+        out.append(*str);
+    }
+}
+
+}
+
+struct KisTraceRecorder::Private
+{
+    struct BufferHandle {
+        BufferHandle(Private *_d, ThreadBuffer *_buffer) : d(_d), buffer(_buffer) {}
+        ~BufferHandle() { d->releaseBuffer(buffer); }
+
+        Private *d;
+        ThreadBuffer *buffer;
+    };
+
+    QMutex lock;
+    QVector<ThreadBuffer*> buffers;
+    QVector<ThreadBuffer*> freeBuffers;
+    QVector<QString> threadNames;
+    QThreadStorage<BufferHandle*> currentBuffer;
+    std::atomic<qint64> clearTime {0};
+
+    ~Private() {
+        qDeleteAll(buffers);
+    }
+
+    ThreadBuffer* acquireBuffer();
+    void releaseBuffer(ThreadBuffer *buffer);
+};
+
+ThreadBuffer* KisTraceRecorder::Private::acquireBuffer()
+{
+    QMutexLocker l(&lock);
+
+    ThreadBuffer *buffer = 0;
+
+    if (!freeBuffers.isEmpty()) {
+        buffer = freeBuffers.takeLast();
+    } else {
+        buffer = new ThreadBuffer();
+        buffers.append(buffer);
+    }
+
+    QThread *thread = QThread::currentThread();
+    QString threadName = thread->objectName();
+
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        threadName = "GUI thread";
+    } else if (threadName.isEmpty()) {
+        threadName = QString("Thread %1").arg(threadNames.size());
+    }
+
+    buffer->threadId = threadNames.size();
+    threadNames.append(threadName);
+
+    return buffer;
+}
+
+void KisTraceRecorder::Private::releaseBuffer(ThreadBuffer *buffer)
+{
+    QMutexLocker l(&lock);
+    freeBuffers.append(buffer);
+}
+
+KisTraceRecorder::KisTraceRecorder()
+    : m_d(new Private)
+{
+}
+
+KisTraceRecorder::~KisTraceRecorder()
+{
+}
+
+KisTraceRecorder* KisTraceRecorder::instance()
+{
+    return s_instance.isDestroyed() ? 0 : s_instance();
+}
+
+void KisTraceRecorder::setEnabled(bool value)
+{
+    s_enabled.store(value);
+}
+
+qint64 KisTraceRecorder::timestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void KisTraceRecorder::addEvent(const char *name, const char *category, qint64 startTime, qint64 endTime)
+{
+    if (!m_d->currentBuffer.hasLocalData()) {
+        m_d->currentBuffer.setLocalData(new Private::BufferHandle(m_d.data(), m_d->acquireBuffer()));
+    }
+
+    ThreadBuffer *buffer = m_d->currentBuffer.localData()->buffer;
+
+    const quint64 index = buffer->writeIndex.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer->events[index % eventsPerThread];
+
+    event.name = name;
+    event.category = category;
+    event.startTime = startTime;
+    event.endTime = endTime;
+    event.threadId = buffer->threadId;
+
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void KisTraceRecorder::clear()
+{
+    /**
+     * The buffers may be written at the moment, so we don't touch
+     * them, just filter out the older events on export
+     */
+    m_d->clearTime.store(timestamp());
+}
+
+QByteArray KisTraceRecorder::chromeTrace() const
+{
+    QVector<TraceEvent> events;
+    QVector<QString> threadNames;
+
+    {
+        QMutexLocker l(&m_d->lock);
+        threadNames = m_d->threadNames;
+
+        Q_FOREACH (ThreadBuffer *buffer, m_d->buffers) {
+            const quint64 end = buffer->writeIndex.load(std::memory_order_acquire);
+            const quint64 begin = end > quint64(eventsPerThread) ? end - eventsPerThread : 0;
+
+            QVector<TraceEvent> bufferEvents;
+            bufferEvents.reserve(int(end - begin));
+
+            for (quint64 i = begin; i < end; i++) {
+                bufferEvents.append(buffer->events[i % eventsPerThread]);
+            }
+
+            // skip the events that were overwritten while we were copying
+            /**
+             * The writer fills the slot of the event newEnd before
+             * publishing it, so that slot may be torn as well
+             */
+            const quint64 newEnd = buffer->writeIndex.load(std::memory_order_acquire);
+            const quint64 validBegin = newEnd + 1 > quint64(eventsPerThread) ? newEnd + 1 - eventsPerThread : 0;
+            const int numOverwritten = int(std::min(end, std::max(validBegin, begin)) - begin);
+
+            events += bufferEvents.mid(numOverwritten);
+        }
+    }
+
+    const qint64 clearTime = m_d->clearTime.load();
+    auto it = std::remove_if(events.begin(), events.end(),
+                             [clearTime] (const TraceEvent &ev) {
+                                 return ev.startTime < clearTime;
+                             });
+    events.erase(it, events.end());
+
+    std::sort(events.begin(), events.end(),
+              [] (const TraceEvent &lhs, const TraceEvent &rhs) {
+                  return lhs.startTime < rhs.startTime;
+              });
+
+    const qint64 baseTime = !events.isEmpty() ? events.first().startTime : 0;
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    QByteArray out;
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    bool first = true;
+
+    for (int i = 0; i < threadNames.size(); i++) {
+        if (!first) out.append(",\n");
+        first = false;
+
+        out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":");
+        out.append(pid);
+        out.append(",\"tid\":");
+        out.append(QByteArray::number(i));
+        out.append(",\"args\":{\"name\":\"");
+        writeEscaped(out, threadNames[i].toUtf8().constData());
+        out.append("\"}}");
+    }
+
+    Q_FOREACH (const TraceEvent &ev, events) {
+        if (!first) out.append(",\n");
+        first = false;
+
+        out.append("{\"name\":\"");
+        writeEscaped(out, ev.name);
+        out.append("\",\"cat\":\"");
+        writeEscaped(out, ev.category);
+        out.append("\",\"ph\":\"X\",\"ts\":");
+        out.append(QByteArray::number(qreal(ev.startTime - baseTime) / 1000.0, 'f', 3));
+        out.append(",\"dur\":");
+        out.append(QByteArray::number(qreal(ev.endTime - ev.startTime) / 1000.0, 'f', 3));
+        out.append(",\"pid\":");
+        out.append(pid);
+        out.append(",\"tid\":");
+        out.append(QByteArray::number(ev.threadId));
+        out.append("}");
+    }
+
+    out.append("]}\n");
+
+    return out;
+}
+
+bool KisTraceRecorder::dumpChromeTrace(const QString &fileName) const
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        warnKrita << "Failed to open the trace file" << fileName;
+        return false;
+    }
+
+    const QByteArray data = chromeTrace();
+    if (file.write(data) != data.size()) {
+        warnKrita << "Failed to write the trace file" << fileName;
+        return false;
+    }
+
+    return true;
+}
+
+bool KisTraceRecorder::dumpToLogFolder()
+{
+    if (!QDir().mkpath("log")) {
+        warnKrita << "Failed to create the log folder for the trace";
+        return false;
+    }
+
+    const QString fileName =
+        QString("log/update_trace_%1.json")
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+
+    const bool result = dumpChromeTrace(fileName);
+    clear();
+
+    return result;
+}
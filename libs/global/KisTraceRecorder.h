@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_TRACE_RECORDER_H
+#define __KIS_TRACE_RECORDER_H
+
+#include <atomic>
+
+#include <QScopedPointer>
+#include <QtGlobal>
+
+#include "kritaglobal_export.h"
+
+class QByteArray;
+class QString;
+
+/**
+ * Records timing spans of the hot paths (scheduler jobs, walkers, canvas
+ * updates) for diagnosing latency problems. The spans are exported in the
+ * Chrome trace event format, so the result can be opened in
+ * chrome://tracing or Perfetto UI.
+ *
+ * Every thread writes into its own ring buffer, so recording takes no
+ * locks. When the buffer of a thread overflows, its oldest events are
+ * overwritten. When the recorder is disabled, the only cost of a span is
+ * a check of an atomic flag.
+ *
+ * The names and categories of the events must be string literals, the
+ * recorder stores the pointers only.
+ *
+ * Use KIS_TRACE_SCOPE() to record a span:
+ *
+ * \code
+ * void KisSomeClass::doWork()
+ * {
+ *     KIS_TRACE_SCOPE("do work", "category");
+ *     ...
+ * }
+ * \endcode
+ */
+class KRITAGLOBAL_EXPORT KisTraceRecorder
+{
+public:
+    /**
+     * The size of the ring buffer of every thread. The slot the thread
+     * writes next may be torn, so the trace contains at most
+     * eventsPerThread - 1 latest events of every thread.
+     */
+    static const int eventsPerThread = 8192;
+
+public:
+    KisTraceRecorder();
+    ~KisTraceRecorder();
+
+    static KisTraceRecorder* instance();
+
+    static inline bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void setEnabled(bool value);
+
+    /**
+     * Monotonic time in nanoseconds used for the events
+     */
+    static qint64 timestamp();
+
+    /**
+     * Records an event that happened in the current thread
+     */
+    void addEvent(const char *name, const char *category, qint64 startTime, qint64 endTime);
+
+    /**
+     * Forgets all the events recorded so far
+     */
+    void clear();
+
+    /**
+     * Returns the recorded events as Chrome trace JSON
+     */
+    QByteArray chromeTrace() const;
+
+    /**
+     * Writes chromeTrace() into \p fileName
+     */
+    bool dumpChromeTrace(const QString &fileName) const;
+
+    /**
+     * Writes the trace into a timestamped file in the 'log' folder of
+     * the working directory, next to the performance log, and forgets
+     * the written events
+     */
+    bool dumpToLogFolder();
+
+private:
+    static std::atomic<bool> s_enabled;
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+/**
+ * Records the lifetime of the object as a span, if the recorder is enabled
+ */
+class KisTraceScope
+{
+public:
+    inline KisTraceScope(const char *name, const char *category)
+        : m_name(name),
+          m_category(category),
+          m_startTime(KisTraceRecorder::isEnabled() ? KisTraceRecorder::timestamp() : -1)
+    {
+    }
+
+    inline ~KisTraceScope() {
+        if (m_startTime < 0) return;
+
+        KisTraceRecorder *recorder = KisTraceRecorder::instance();
+        if (recorder) {
+            recorder->addEvent(m_name, m_category, m_startTime, KisTraceRecorder::timestamp());
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(KisTraceScope)
+
+    const char *m_name;
+    const char *m_category;
+    const qint64 m_startTime;
+};
+
+#define KIS_TRACE_SCOPE(name, category) KisTraceScope kisTraceScope(name, category)
+
+#endif /* __KIS_TRACE_RECORDER_H */
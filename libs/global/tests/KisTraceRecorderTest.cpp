@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisTraceRecorderTest.h"
+
+#include <QTest>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include <KisTraceRecorder.h>
+
+
+namespace {
+
+struct TracingJob : public QRunnable
+{
+    void run() override {
+        for (int i = 0; i < numEvents(); i++) {
+            KIS_TRACE_SCOPE("job", "test");
+        }
+    }
+
+    static int numEvents() {
+        return 100;
+    }
+};
+
+QJsonArray parseEvents(const QString &name)
+{
+    const QJsonDocument doc =
+        QJsonDocument::fromJson(KisTraceRecorder::instance()->chromeTrace());
+
+    QJsonArray result;
+
+    Q_FOREACH (const QJsonValue &value, doc.object()["traceEvents"].toArray()) {
+        const QJsonObject event = value.toObject();
+        if (event["ph"].toString() == "X" && event["name"].toString() == name) {
+            result.append(event);
+        }
+    }
+
+    return result;
+}
+
+}
+
+void KisTraceRecorderTest::testDisabled()
+{
+    KisTraceRecorder::setEnabled(false);
+    KisTraceRecorder::instance()->clear();
+
+    {
+        KIS_TRACE_SCOPE("disabled", "test");
+    }
+
+    QVERIFY(parseEvents("disabled").isEmpty());
+}
+
+void KisTraceRecorderTest::testMultipleThreads()
+{
+    KisTraceRecorder::setEnabled(true);
+    KisTraceRecorder::instance()->clear();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+
+    const int numJobs = 8;
+
+    for (int i = 0; i < numJobs; i++) {
+        pool.start(new TracingJob());
+    }
+    pool.waitForDone();
+
+    KisTraceRecorder::setEnabled(false);
+
+    const QJsonArray events = parseEvents("job");
+    QCOMPARE(events.size(), numJobs * TracingJob::numEvents());
+
+    QSet<int> threads;
+    Q_FOREACH (const QJsonValue &value, events) {
+        const QJsonObject event = value.toObject();
+
+        QCOMPARE(event["cat"].toString(), QString("test"));
+        QVERIFY(event["ts"].toDouble() >= 0.0);
+        QVERIFY(event["dur"].toDouble() >= 0.0);
+
+        threads.insert(event["tid"].toInt());
+    }
+
+    QVERIFY(!threads.isEmpty());
+    QVERIFY(threads.size() <= pool.maxThreadCount());
+}
+
+void KisTraceRecorderTest::testOverflow()
+{
+    KisTraceRecorder::setEnabled(true);
+    KisTraceRecorder::instance()->clear();
+
+    for (int i = 0; i < KisTraceRecorder::eventsPerThread + 100; i++) {
+        KIS_TRACE_SCOPE("overflow", "test");
+    }
+
+    KisTraceRecorder::setEnabled(false);
+
+    /**
+     * The oldest slot of a full buffer is the one the writer fills
+     * next, so it is never exported
+     */
+    QCOMPARE(parseEvents("overflow").size(), int(KisTraceRecorder::eventsPerThread) - 1);
+}
+
+QTEST_MAIN(KisTraceRecorderTest)
@@ -0,0 +1,179 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisAdaptiveLodController.h"
+
+#include <atomic>
+
+
+namespace {
+/**
+ * Shorter strokes don't give a reliable estimation
+ */
+const qint64 minimumStrokeJobs = 8;
+
+/**
+ * The part of the target frame time the frame should fit into
+ * before the controller lowers the level of detail
+ */
+const qreal lowerThreshold = 0.75;
+
+inline qint64 normalizedTime(int levelOfDetail, qint64 nsecs)
+{
+    return nsecs << (2 * qBound(0, levelOfDetail, 15));
+}
+}
+
+struct KisAdaptiveLodController::Private
+{
+    std::atomic<qint64> strokeJobs {0};
+    std::atomic<qint64> strokeTime {0};
+    std::atomic<qint64> mergeJobs {0};
+    std::atomic<qint64> mergeTime {0};
+
+    // the level of the running adapting stroke, -1 if there is none
+    std::atomic<int> strokeLevelOfDetail {-1};
+
+    std::atomic<int> maximumLevelOfDetail {0};
+    std::atomic<int> levelOfDetail {0};
+    std::atomic<qint64> targetFrameTime {10000000}; // in nsecs
+
+    int fittingLevelOfDetail(qreal frameCost, qreal limit, int maxLod) const {
+        int lod = 0;
+
+        while (frameCost > limit && lod < maxLod) {
+            frameCost /= 4.0;
+            lod++;
+        }
+
+        return lod;
+    }
+};
+
+KisAdaptiveLodController::KisAdaptiveLodController()
+    : m_d(new Private)
+{
+}
+
+KisAdaptiveLodController::~KisAdaptiveLodController()
+{
+}
+
+void KisAdaptiveLodController::setTargetFrameTime(qreal value)
+{
+    m_d->targetFrameTime = qMax(qint64(1), qint64(value * 1000000.0));
+}
+
+qreal KisAdaptiveLodController::targetFrameTime() const
+{
+    return qreal(m_d->targetFrameTime) / 1000000.0;
+}
+
+void KisAdaptiveLodController::setMaximumLevelOfDetail(int value)
+{
+    value = qMax(0, value);
+
+    if (m_d->maximumLevelOfDetail.exchange(value) != value && !value) {
+        reset();
+    }
+}
+
+int KisAdaptiveLodController::maximumLevelOfDetail() const
+{
+    return m_d->maximumLevelOfDetail;
+}
+
+bool KisAdaptiveLodController::isEnabled() const
+{
+    return m_d->maximumLevelOfDetail.load(std::memory_order_relaxed) > 0;
+}
+
+void KisAdaptiveLodController::strokeStarted(int levelOfDetail)
+{
+    m_d->strokeLevelOfDetail = levelOfDetail;
+}
+
+void KisAdaptiveLodController::strokeFinished()
+{
+    m_d->strokeLevelOfDetail = -1;
+}
+
+void KisAdaptiveLodController::reportStrokeJob(int levelOfDetail, qint64 nsecs)
+{
+    m_d->strokeTime += normalizedTime(levelOfDetail, nsecs);
+    m_d->strokeJobs++;
+}
+
+void KisAdaptiveLodController::reportMergeJob(int levelOfDetail, qint64 nsecs)
+{
+    if (levelOfDetail != m_d->strokeLevelOfDetail.load(std::memory_order_relaxed)) return;
+
+    m_d->mergeTime += normalizedTime(levelOfDetail, nsecs);
+    m_d->mergeJobs++;
+}
+
+int KisAdaptiveLodController::levelOfDetail() const
+{
+    return qMin(m_d->levelOfDetail.load(), m_d->maximumLevelOfDetail.load());
+}
+
+int KisAdaptiveLodController::recalculateLevelOfDetail()
+{
+    const qint64 strokeJobs = m_d->strokeJobs.exchange(0);
+    const qint64 strokeTime = m_d->strokeTime.exchange(0);
+    const qint64 mergeJobs = m_d->mergeJobs.exchange(0);
+    const qint64 mergeTime = m_d->mergeTime.exchange(0);
+
+    const int maxLod = m_d->maximumLevelOfDetail;
+    const int currentLod = qMin(m_d->levelOfDetail.load(), maxLod);
+
+    if (strokeJobs < minimumStrokeJobs) {
+        m_d->levelOfDetail = currentLod;
+        return currentLod;
+    }
+
+    const qreal frameCost =
+        qreal(strokeTime) / strokeJobs +
+        (mergeJobs > 0 ? qreal(mergeTime) / mergeJobs : 0.0);
+
+    const qreal target = m_d->targetFrameTime;
+
+    const int raiseLod = m_d->fittingLevelOfDetail(frameCost, target, maxLod);
+    const int lowerLod = m_d->fittingLevelOfDetail(frameCost, lowerThreshold * target, maxLod);
+
+    int newLod = currentLod;
+
+    if (raiseLod > currentLod) {
+        newLod = raiseLod;
+    } else if (lowerLod < currentLod) {
+        newLod = lowerLod;
+    }
+
+    m_d->levelOfDetail = newLod;
+    return newLod;
+}
+
+void KisAdaptiveLodController::reset()
+{
+    m_d->strokeJobs = 0;
+    m_d->strokeTime = 0;
+    m_d->mergeJobs = 0;
+    m_d->mergeTime = 0;
+    m_d->levelOfDetail = 0;
+}
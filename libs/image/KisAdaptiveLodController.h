@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_ADAPTIVE_LOD_CONTROLLER_H
+#define __KIS_ADAPTIVE_LOD_CONTROLLER_H
+
+#include <QtGlobal>
+#include <QScopedPointer>
+#include "kritaimage_export.h"
+
+/**
+ * Selects the level of detail of the interactive strokes from the
+ * measured latency of the update jobs.
+ *
+ * The update job items report the time spent in the jobs of the strokes
+ * that adapt their level of detail (see
+ * KisStrokeStrategy::setAdaptsLevelOfDetail()) and in the merge jobs.
+ * Only the merges done while such a stroke is running and on the same
+ * level of detail are counted, the other ones (e.g. the updates of the
+ * Lod0 pair of the stroke) don't belong to its frames.
+ * Every sample is normalized to the cost of the same job on the full-size
+ * image by assuming that the cost is proportional to the number of pixels,
+ * that is it grows four times with each level of detail step down.
+ *
+ * When such a stroke ends, the strokes queue calls
+ * recalculateLevelOfDetail(). The controller estimates the cost of a frame
+ * as the sum of an average stroke job and an average merge job and picks
+ * the lowest level of detail that fits into the target frame time. The
+ * level is lowered only when the frame fits into 3/4 of the target to
+ * avoid flipping between two levels on every stroke, since each switch
+ * costs a regeneration of the level of detail caches.
+ *
+ * The controller is disabled while the maximum level of detail is zero.
+ *
+ * The reporting methods are thread-safe, recalculateLevelOfDetail() must
+ * be called under the strokes queue lock.
+ */
+class KRITAIMAGE_EXPORT KisAdaptiveLodController
+{
+public:
+    KisAdaptiveLodController();
+    ~KisAdaptiveLodController();
+
+    /**
+     * The time (in milliseconds) a frame of a stroke should take
+     */
+    void setTargetFrameTime(qreal value);
+    qreal targetFrameTime() const;
+
+    /**
+     * The highest level the controller may select. Zero disables
+     * the controller and drops the collected samples.
+     */
+    void setMaximumLevelOfDetail(int value);
+    int maximumLevelOfDetail() const;
+
+    bool isEnabled() const;
+
+    /**
+     * Called by the strokes queue when a stroke that adapts its level
+     * of detail starts working on \p levelOfDetail, and when it is
+     * finished
+     */
+    void strokeStarted(int levelOfDetail);
+    void strokeFinished();
+
+    void reportStrokeJob(int levelOfDetail, qint64 nsecs);
+
+    /**
+     * Ignored unless a stroke adapting its level of detail is running
+     * on \p levelOfDetail
+     */
+    void reportMergeJob(int levelOfDetail, qint64 nsecs);
+
+    /**
+     * The level selected by the last recalculateLevelOfDetail() call
+     */
+    int levelOfDetail() const;
+
+    /**
+     * Chooses a new level from the samples collected since the
+     * previous call and resets the samples. Keeps the current
+     * level if there are too few samples.
+     */
+    int recalculateLevelOfDetail();
+
+    void reset();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_ADAPTIVE_LOD_CONTROLLER_H */
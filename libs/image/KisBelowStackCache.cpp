@@ -0,0 +1,197 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisBelowStackCache.h"
+
+#include <atomic>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+
+#include <KoColorSpace.h>
+
+#include "kis_node.h"
+#include "kis_painter.h"
+#include "kis_paint_device.h"
+
+
+namespace {
+std::atomic<qint64> s_totalMemoryUsage(0);
+std::atomic<qint64> s_memoryLimit(256 * 1024 * 1024);
+
+qint64 regionArea(const QRegion &region)
+{
+    qint64 area = 0;
+
+    Q_FOREACH (const QRect &rc, region.rects()) {
+        area += qint64(rc.width()) * rc.height();
+    }
+
+    return area;
+}
+}
+
+struct KisBelowStackCache::Private
+{
+    mutable QMutex mutex;
+
+    KisNodeWSP keyNode;
+    KisPaintDeviceSP device;
+    QRegion validRegion;
+    int levelOfDetail = 0;
+    int graphSequenceNumber = -1;
+    qint64 memoryUsage = 0;
+
+    bool isCompatible(KisPaintDeviceSP dev, int lod, int seqNo) const {
+        return device &&
+            levelOfDetail == lod &&
+            graphSequenceNumber == seqNo &&
+            device->x() == dev->x() &&
+            device->y() == dev->y() &&
+            *device->colorSpace() == *dev->colorSpace();
+    }
+
+    void setMemoryUsage(qint64 value) {
+        s_totalMemoryUsage += value - memoryUsage;
+        memoryUsage = value;
+    }
+
+    void dropData() {
+        device = 0;
+        validRegion = QRegion();
+        setMemoryUsage(0);
+    }
+};
+
+KisBelowStackCache::KisBelowStackCache()
+    : m_d(new Private)
+{
+}
+
+KisBelowStackCache::~KisBelowStackCache()
+{
+    m_d->setMemoryUsage(0);
+}
+
+KisNodeSP KisBelowStackCache::keyNode() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->keyNode;
+}
+
+void KisBelowStackCache::setKeyNode(KisNodeSP node)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->dropData();
+    m_d->keyNode = node;
+}
+
+bool KisBelowStackCache::read(KisNodeSP keyNode, const QRect &rect, KisPaintDeviceSP dst,
+                              int levelOfDetail, int graphSequenceNumber)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (!keyNode || m_d->keyNode != keyNode.data() ||
+        !m_d->isCompatible(dst, levelOfDetail, graphSequenceNumber) ||
+        !(QRegion(rect) - m_d->validRegion).isEmpty()) {
+
+        return false;
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), m_d->device, dst, rect);
+    return true;
+}
+
+void KisBelowStackCache::write(KisNodeSP keyNode, const QRect &rect, KisPaintDeviceSP src,
+                               int levelOfDetail, int graphSequenceNumber)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (!keyNode || m_d->keyNode != keyNode.data() || rect.isEmpty()) return;
+
+    if (m_d->device && !m_d->isCompatible(src, levelOfDetail, graphSequenceNumber)) {
+        m_d->dropData();
+    }
+
+    const QRegion newRegion = m_d->validRegion | rect;
+    const qint64 newUsage = regionArea(newRegion) * src->pixelSize();
+
+    if (s_totalMemoryUsage - m_d->memoryUsage + newUsage > s_memoryLimit) return;
+
+    if (!m_d->device) {
+        m_d->device = new KisPaintDevice(src->colorSpace());
+        m_d->device->prepareClone(src);
+        m_d->levelOfDetail = levelOfDetail;
+        m_d->graphSequenceNumber = graphSequenceNumber;
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), src, m_d->device, rect);
+    m_d->validRegion = newRegion;
+    m_d->setMemoryUsage(newUsage);
+}
+
+void KisBelowStackCache::invalidate(const QRect &rect)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (!m_d->device || !m_d->validRegion.intersects(rect)) return;
+
+    m_d->validRegion -= rect;
+
+    if (m_d->validRegion.isEmpty()) {
+        m_d->dropData();
+    } else {
+        m_d->device->clear(rect);
+        m_d->setMemoryUsage(regionArea(m_d->validRegion) * m_d->device->pixelSize());
+    }
+}
+
+void KisBelowStackCache::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->dropData();
+    m_d->keyNode = KisNodeWSP();
+}
+
+qint64 KisBelowStackCache::memoryUsage() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->memoryUsage;
+}
+
+qint64 KisBelowStackCache::totalMemoryUsage()
+{
+    return s_totalMemoryUsage;
+}
+
+void KisBelowStackCache::setMemoryLimit(qint64 value)
+{
+    s_memoryLimit = value;
+}
+
+qint64 KisBelowStackCache::memoryLimit()
+{
+    return s_memoryLimit;
+}
+
+bool KisBelowStackCache::isEnabled()
+{
+    return s_memoryLimit > 0;
+}
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_BELOW_STACK_CACHE_H
+#define __KIS_BELOW_STACK_CACHE_H
+
+#include <QScopedPointer>
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+
+/**
+ * Keeps a pre-composited copy of the children of a group layer that lie
+ * below its "key" child, that is the child that has been updated most
+ * recently. While the user paints on the key layer, the merger copies the
+ * cached composite into the group's projection instead of compositing all
+ * the unchanged layers below it again.
+ *
+ * The cache tracks the valid area as a region. The merger invalidates the
+ * rects of all the updates which touch the layers below the key and fills
+ * the area back during the next merge that passes the key. The whole cache
+ * is dropped when the key changes, as well as when the graph, the level of
+ * detail or the color space of the group's projection changes.
+ *
+ * All the caches share a common memory limit, see setMemoryLimit(). The
+ * memory used by a cache is estimated by the area of its valid region.
+ *
+ * All the methods are thread-safe.
+ */
+class KRITAIMAGE_EXPORT KisBelowStackCache
+{
+public:
+    KisBelowStackCache();
+    ~KisBelowStackCache();
+
+    KisNodeSP keyNode() const;
+
+    /**
+     * Drops all the cached data and starts caching the composite
+     * below \p node
+     */
+    void setKeyNode(KisNodeSP node);
+
+    /**
+     * Copies the composite below \p keyNode into \p dst in \p rect.
+     * Returns false, without touching \p dst, if the cache doesn't
+     * cover the rect or has been generated for a different key, graph
+     * or level of detail.
+     */
+    bool read(KisNodeSP keyNode, const QRect &rect, KisPaintDeviceSP dst,
+              int levelOfDetail, int graphSequenceNumber);
+
+    /**
+     * Stores the composite below \p keyNode from \p src in \p rect. Does
+     * nothing if \p keyNode is not the current key or the memory limit
+     * doesn't allow caching more data.
+     */
+    void write(KisNodeSP keyNode, const QRect &rect, KisPaintDeviceSP src,
+               int levelOfDetail, int graphSequenceNumber);
+
+    /**
+     * Marks \p rect as changed below the key
+     */
+    void invalidate(const QRect &rect);
+
+    /**
+     * Drops all the cached data and resets the key
+     */
+    void clear();
+
+    qint64 memoryUsage() const;
+
+    /**
+     * The memory used by all the caches in the application
+     */
+    static qint64 totalMemoryUsage();
+
+    /**
+     * Sets the memory limit shared by all the caches. Zero
+     * disables caching.
+     */
+    static void setMemoryLimit(qint64 value);
+    static qint64 memoryLimit();
+
+    static bool isEnabled();
+
+private:
+    Q_DISABLE_COPY(KisBelowStackCache)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_BELOW_STACK_CACHE_H */
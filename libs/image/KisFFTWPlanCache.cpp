@@ -0,0 +1,360 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisFFTWPlanCache.h"
+
+#include <cstdlib>
+
+#include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <kis_debug.h>
+
+Q_GLOBAL_STATIC(KisFFTWPlanCache, s_instance)
+
+namespace {
+
+struct PlanKey
+{
+    PlanKey(int _width, int _height, KisFFTWPlanCache::Rigor _rigor)
+        : width(_width), height(_height), rigor(_rigor)
+    {
+    }
+
+    bool operator==(const PlanKey &rhs) const {
+        return width == rhs.width && height == rhs.height && rigor == rhs.rigor;
+    }
+
+    int width;
+    int height;
+    KisFFTWPlanCache::Rigor rigor;
+};
+
+inline uint qHash(const PlanKey &key, uint seed = 0)
+{
+    return ::qHash((quint64(key.width) << 32) | (quint64(key.height) << 1) | quint64(key.rigor), seed);
+}
+
+template <typename T>
+struct PlanPair
+{
+    typename KisFFTWTraits<T>::Plan forward;
+    typename KisFFTWTraits<T>::Plan backward;
+};
+
+unsigned plannerFlags(KisFFTWPlanCache::Rigor rigor)
+{
+    return rigor == KisFFTWPlanCache::Measure ? FFTW_MEASURE : FFTW_ESTIMATE;
+}
+
+/**
+ * FFTW_MEASURE overwrites the arrays while planning, so we plan on a
+ * scratch buffer of the same layout
+ */
+PlanPair<double> createPlanPair(int width, int height, unsigned flags, double)
+{
+    const size_t length = size_t(height) * (width / 2 + 1);
+    fftw_complex *scratch = KisFFTWTraits<double>::allocate(length);
+
+    PlanPair<double> pair;
+    pair.forward = fftw_plan_dft_r2c_2d(height, width, (double*)scratch, scratch, flags);
+    pair.backward = fftw_plan_dft_c2r_2d(height, width, scratch, (double*)scratch, flags);
+
+    KisFFTWTraits<double>::release(scratch);
+
+    return pair;
+}
+
+#ifdef HAVE_FFTW3F
+
+PlanPair<float> createPlanPair(int width, int height, unsigned flags, float)
+{
+    const size_t length = size_t(height) * (width / 2 + 1);
+    fftwf_complex *scratch = KisFFTWTraits<float>::allocate(length);
+
+    PlanPair<float> pair;
+    pair.forward = fftwf_plan_dft_r2c_2d(height, width, (float*)scratch, scratch, flags);
+    pair.backward = fftwf_plan_dft_c2r_2d(height, width, scratch, (float*)scratch, flags);
+
+    KisFFTWTraits<float>::release(scratch);
+
+    return pair;
+}
+
+#endif /* HAVE_FFTW3F */
+
+QString wisdomFileName(const QString &name)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/" + name;
+}
+
+QString wisdomFileName(double)
+{
+    return wisdomFileName("fftw_wisdom");
+}
+
+QByteArray exportWisdom(double)
+{
+    char *wisdom = fftw_export_wisdom_to_string();
+    const QByteArray result(wisdom);
+    free(wisdom);
+    return result;
+}
+
+#ifdef HAVE_FFTW3F
+
+QString wisdomFileName(float)
+{
+    return wisdomFileName("fftwf_wisdom");
+}
+
+QByteArray exportWisdom(float)
+{
+    char *wisdom = fftwf_export_wisdom_to_string();
+    const QByteArray result(wisdom);
+    free(wisdom);
+    return result;
+}
+
+#endif /* HAVE_FFTW3F */
+
+void saveWisdom(const QString &fileName, const QByteArray &wisdom)
+{
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (!QDir().mkpath(path)) {
+        warnKrita << "KisFFTWPlanCache: failed to create" << path << "to store the FFTW wisdom";
+        return;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(wisdom) != wisdom.size() ||
+        !file.commit()) {
+
+        warnKrita << "KisFFTWPlanCache: failed to save the FFTW wisdom to" << fileName;
+    }
+}
+
+}
+
+struct KisFFTWPlanCache::Private
+{
+    /**
+     * Protects the hashes of the plans. It is never held while
+     * planning, so the convolutions whose plans are already cached
+     * are not blocked by the measuring of another size.
+     */
+    QMutex cacheMutex;
+
+    /**
+     * Serializes all the calls to the FFTW planner, which is not
+     * thread-safe
+     */
+    QMutex plannerMutex;
+
+    QHash<PlanKey, PlanPair<double>> doublePlans;
+
+#ifdef HAVE_FFTW3F
+    QHash<PlanKey, PlanPair<float>> floatPlans;
+#endif
+
+    template <typename T>
+    void plans(QHash<PlanKey, PlanPair<T>> &cache,
+               int width, int height, Rigor rigor,
+               typename KisFFTWTraits<T>::Plan *forward,
+               typename KisFFTWTraits<T>::Plan *backward);
+};
+
+template <typename T>
+void KisFFTWPlanCache::Private::plans(QHash<PlanKey, PlanPair<T>> &cache,
+                                      int width, int height, Rigor rigor,
+                                      typename KisFFTWTraits<T>::Plan *forward,
+                                      typename KisFFTWTraits<T>::Plan *backward)
+{
+    const PlanKey key(width, height, rigor);
+
+    auto fetchCached = [&] () {
+        QMutexLocker l(&cacheMutex);
+
+        auto it = cache.constFind(key);
+        if (it == cache.constEnd()) return false;
+
+        *forward = it->forward;
+        *backward = it->backward;
+        return true;
+    };
+
+    if (fetchCached()) return;
+
+    QByteArray wisdom;
+
+    {
+        QMutexLocker planner(&plannerMutex);
+
+        /**
+         * Another thread could have planned the same size while we
+         * were waiting for the planner
+         */
+        if (fetchCached()) return;
+
+        const PlanPair<T> pair = createPlanPair(width, height, plannerFlags(rigor), T());
+
+        {
+            QMutexLocker l(&cacheMutex);
+            cache.insert(key, pair);
+        }
+
+        *forward = pair.forward;
+        *backward = pair.backward;
+
+        if (rigor != Measure) return;
+
+        wisdom = exportWisdom(T());
+    }
+
+    saveWisdom(wisdomFileName(T()), wisdom);
+}
+
+KisFFTWPlanCache::KisFFTWPlanCache()
+    : m_d(new Private)
+{
+    /**
+     * The wisdom is only a hint for the planner, so if the file is
+     * missing or was written by another version of FFTW, we just
+     * measure everything again
+     */
+    const QString doubleWisdom = wisdomFileName(double());
+    if (QFile::exists(doubleWisdom)) {
+        fftw_import_wisdom_from_filename(QFile::encodeName(doubleWisdom).constData());
+    }
+
+#ifdef HAVE_FFTW3F
+    const QString floatWisdom = wisdomFileName(float());
+    if (QFile::exists(floatWisdom)) {
+        fftwf_import_wisdom_from_filename(QFile::encodeName(floatWisdom).constData());
+    }
+#endif
+}
+
+KisFFTWPlanCache::~KisFFTWPlanCache()
+{
+    QMutexLocker planner(&m_d->plannerMutex);
+    QMutexLocker l(&m_d->cacheMutex);
+
+    Q_FOREACH (const PlanPair<double> &pair, m_d->doublePlans) {
+        fftw_destroy_plan(pair.forward);
+        fftw_destroy_plan(pair.backward);
+    }
+
+#ifdef HAVE_FFTW3F
+    Q_FOREACH (const PlanPair<float> &pair, m_d->floatPlans) {
+        fftwf_destroy_plan(pair.forward);
+        fftwf_destroy_plan(pair.backward);
+    }
+#endif
+}
+
+KisFFTWPlanCache *KisFFTWPlanCache::instance()
+{
+    return s_instance;
+}
+
+void KisFFTWPlanCache::plans(int width, int height, Rigor rigor,
+                             KisFFTWTraits<double>::Plan *forward,
+                             KisFFTWTraits<double>::Plan *backward)
+{
+    m_d->plans(m_d->doublePlans, width, height, rigor, forward, backward);
+}
+
+#ifdef HAVE_FFTW3F
+
+void KisFFTWPlanCache::plans(int width, int height, Rigor rigor,
+                             KisFFTWTraits<float>::Plan *forward,
+                             KisFFTWTraits<float>::Plan *backward)
+{
+    m_d->plans(m_d->floatPlans, width, height, rigor, forward, backward);
+}
+
+#endif /* HAVE_FFTW3F */
+
+void KisFFTWPlanCache::createPlans(int width, int height,
+                                   KisFFTWTraits<double>::Plan *forward,
+                                   KisFFTWTraits<double>::Plan *backward)
+{
+    QMutexLocker planner(&m_d->plannerMutex);
+
+    const PlanPair<double> pair = createPlanPair(width, height, FFTW_ESTIMATE, double());
+    *forward = pair.forward;
+    *backward = pair.backward;
+}
+
+void KisFFTWPlanCache::destroyPlans(KisFFTWTraits<double>::Plan forward,
+                                    KisFFTWTraits<double>::Plan backward)
+{
+    QMutexLocker planner(&m_d->plannerMutex);
+
+    fftw_destroy_plan(forward);
+    fftw_destroy_plan(backward);
+}
+
+#ifdef HAVE_FFTW3F
+
+void KisFFTWPlanCache::createPlans(int width, int height,
+                                   KisFFTWTraits<float>::Plan *forward,
+                                   KisFFTWTraits<float>::Plan *backward)
+{
+    QMutexLocker planner(&m_d->plannerMutex);
+
+    const PlanPair<float> pair = createPlanPair(width, height, FFTW_ESTIMATE, float());
+    *forward = pair.forward;
+    *backward = pair.backward;
+}
+
+void KisFFTWPlanCache::destroyPlans(KisFFTWTraits<float>::Plan forward,
+                                    KisFFTWTraits<float>::Plan backward)
+{
+    QMutexLocker planner(&m_d->plannerMutex);
+
+    fftwf_destroy_plan(forward);
+    fftwf_destroy_plan(backward);
+}
+
+#endif /* HAVE_FFTW3F */
+
+int KisFFTWPlanCache::optimalSize(int size)
+{
+    for (int candidate = qMax(1, size); ; candidate++) {
+        int rest = candidate;
+
+        for (int factor : {2, 3, 5, 7}) {
+            while (rest % factor == 0) {
+                rest /= factor;
+            }
+        }
+
+        if (rest == 1) {
+            return candidate;
+        }
+    }
+}
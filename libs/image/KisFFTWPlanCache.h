@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISFFTWPLANCACHE_H
+#define KISFFTWPLANCACHE_H
+
+#include <QScopedPointer>
+
+#include <fftw3.h>
+
+#include "config_convolution.h"
+#include "kritaimage_export.h"
+
+/**
+ * Maps the precision of the FFT onto the corresponding FFTW API, so
+ * that the convolution worker can be written once for both precisions
+ */
+template <typename T>
+struct KisFFTWTraits;
+
+template <>
+struct KisFFTWTraits<double>
+{
+    typedef fftw_complex Complex;
+    typedef fftw_plan Plan;
+
+    static inline Complex* allocate(size_t numElements) {
+        return (Complex*)fftw_malloc(sizeof(Complex) * numElements);
+    }
+
+    static inline void release(Complex *data) {
+        fftw_free(data);
+    }
+
+    static inline void executeForward(Plan plan, double *in, Complex *out) {
+        fftw_execute_dft_r2c(plan, in, out);
+    }
+
+    static inline void executeBackward(Plan plan, Complex *in, double *out) {
+        fftw_execute_dft_c2r(plan, in, out);
+    }
+};
+
+#ifdef HAVE_FFTW3F
+
+template <>
+struct KisFFTWTraits<float>
+{
+    typedef fftwf_complex Complex;
+    typedef fftwf_plan Plan;
+
+    static inline Complex* allocate(size_t numElements) {
+        return (Complex*)fftwf_malloc(sizeof(Complex) * numElements);
+    }
+
+    static inline void release(Complex *data) {
+        fftwf_free(data);
+    }
+
+    static inline void executeForward(Plan plan, float *in, Complex *out) {
+        fftwf_execute_dft_r2c(plan, in, out);
+    }
+
+    static inline void executeBackward(Plan plan, Complex *in, float *out) {
+        fftwf_execute_dft_c2r(plan, in, out);
+    }
+};
+
+#endif /* HAVE_FFTW3F */
+
+/**
+ * A process-wide cache of the in-place 2D real FFTW plans used by
+ * KisConvolutionWorkerFFT.
+ *
+ * Planning is the only part of FFTW that is not thread-safe, so all
+ * the planning is done here under one lock. The cached plans are
+ * fetched under a separate lock, so they are never blocked by the
+ * planning of a new size. The plans are kept for the lifetime of the
+ * application and shared between all the threads: the new-array
+ * execute functions of FFTW are reentrant as long as the arrays are
+ * allocated with fftw_malloc() and have the same layout as the
+ * planning ones.
+ *
+ * The plans created with FFTW_MEASURE are exported into a wisdom file
+ * in the application data location, so the measuring is paid only once
+ * per FFT size, not once per session.
+ *
+ * The cache is never purged, so only the plans for the fixed sizes of
+ * the tiles should be fetched with plans(). The sizes that depend on
+ * the size of the processed area should use createPlans() instead.
+ */
+class KRITAIMAGE_EXPORT KisFFTWPlanCache
+{
+public:
+    enum Rigor {
+        Estimate, ///< plan immediately, used for the tiles too big to measure
+        Measure   ///< measure the fastest plan, used for the fixed sizes of the tiles
+    };
+
+public:
+    KisFFTWPlanCache();
+    ~KisFFTWPlanCache();
+
+    static KisFFTWPlanCache* instance();
+
+    /**
+     * Fetches the forward and backward in-place plans for a
+     * \p width x \p height transform, creating them on the first
+     * request. The plans are owned by the cache and must not be
+     * destroyed by the caller.
+     */
+    void plans(int width, int height, Rigor rigor,
+               KisFFTWTraits<double>::Plan *forward,
+               KisFFTWTraits<double>::Plan *backward);
+
+#ifdef HAVE_FFTW3F
+    void plans(int width, int height, Rigor rigor,
+               KisFFTWTraits<float>::Plan *forward,
+               KisFFTWTraits<float>::Plan *backward);
+#endif
+
+    /**
+     * Creates the forward and backward in-place plans for a one-off
+     * \p width x \p height transform with FFTW_ESTIMATE. The plans are
+     * not cached and must be destroyed with destroyPlans().
+     */
+    void createPlans(int width, int height,
+                     KisFFTWTraits<double>::Plan *forward,
+                     KisFFTWTraits<double>::Plan *backward);
+
+    void destroyPlans(KisFFTWTraits<double>::Plan forward,
+                      KisFFTWTraits<double>::Plan backward);
+
+#ifdef HAVE_FFTW3F
+    void createPlans(int width, int height,
+                     KisFFTWTraits<float>::Plan *forward,
+                     KisFFTWTraits<float>::Plan *backward);
+
+    void destroyPlans(KisFFTWTraits<float>::Plan forward,
+                      KisFFTWTraits<float>::Plan backward);
+#endif
+
+    /**
+     * Rounds \p size up to the nearest value that has no prime factors
+     * other than 2, 3, 5 and 7, for which FFTW has fast codelets
+     */
+    static int optimalSize(int size);
+
+private:
+    Q_DISABLE_COPY(KisFFTWPlanCache)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISFFTWPLANCACHE_H
@@ -0,0 +1,294 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisIIRGaussianFilter.h"
+#include "KisIIRGaussianBlur.h"
+
+#include <QRect>
+#include <QBitArray>
+#include <QVector>
+#include <QScopedPointer>
+#include <QtMath>
+
+#include <cmath>
+#include <limits>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
+
+#include "kis_global.h"
+#include "kis_paint_device.h"
+#include "kis_iterator_ng.h"
+#include "kis_repeat_iterators_pixel.h"
+#include "kis_math_toolbox.h"
+
+
+namespace {
+
+/**
+ * The number of lines processed together. It is a multiple of any
+ * vector size, and the strip of floats still fits into the cache.
+ */
+const int stripWidth = 64;
+
+/**
+ * The conversion of the convolved channels into floats and back,
+ * the same way as KisConvolutionWorkerFFT does it
+ */
+struct ChannelsInfo {
+    ChannelsInfo(const KoColorSpace *cs, const QBitArray &channelFlags)
+        : alphaCachePos(-1),
+          alphaRealPos(-1)
+    {
+        const QList<KoChannelInfo*> channels = cs->channels();
+
+        for (int i = 0; i < channels.size(); i++) {
+            if (channelFlags.isEmpty() || channelFlags.testBit(i)) {
+                convChannelList << channels[i];
+            }
+        }
+
+        KisMathToolbox mathToolbox;
+
+        for (int i = 0; i < convChannelList.size(); i++) {
+            minClamp << mathToolbox.minChannelValue(convChannelList[i]);
+            maxClamp << mathToolbox.maxChannelValue(convChannelList[i]);
+
+            if (convChannelList[i]->channelType() == KoChannelInfo::ALPHA) {
+                alphaCachePos = i;
+                alphaRealPos = convChannelList[i]->pos();
+            }
+        }
+
+        toDoubleFuncPtr.resize(convChannelList.size());
+        fromDoubleFuncPtr.resize(convChannelList.size());
+
+        bool result = mathToolbox.getToDoubleChannelPtr(convChannelList, toDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleChannelPtr(convChannelList, fromDoubleFuncPtr);
+
+        KIS_ASSERT(result);
+    }
+
+    int numChannels() const {
+        return convChannelList.size();
+    }
+
+    QList<KoChannelInfo*> convChannelList;
+    QVector<qreal> minClamp;
+    QVector<qreal> maxClamp;
+    QVector<PtrToDouble> toDoubleFuncPtr;
+    QVector<PtrFromDouble> fromDoubleFuncPtr;
+
+    int alphaCachePos;
+    int alphaRealPos;
+};
+
+inline void readPixel(const quint8 *data, const ChannelsInfo &info,
+                      QVector<float*> &planes, int offset)
+{
+    // no alpha is a rare case, so just multiply by 1.0 in that case
+    const qreal alphaValue = info.alphaRealPos >= 0 ?
+        info.toDoubleFuncPtr[info.alphaCachePos](data, info.alphaRealPos) : 1.0;
+
+    for (int k = 0; k < info.numChannels(); k++) {
+        if (k != info.alphaCachePos) {
+            const quint32 channelPos = info.convChannelList[k]->pos();
+            planes[k][offset] = info.toDoubleFuncPtr[k](data, channelPos) * alphaValue;
+        } else {
+            planes[k][offset] = alphaValue;
+        }
+    }
+}
+
+inline void writePixel(quint8 *data, const ChannelsInfo &info,
+                       const QVector<float*> &planes, int offset)
+{
+    qreal alphaValueInv = 1.0;
+
+    if (info.alphaCachePos >= 0) {
+        const qreal alphaValue =
+            qBound(info.minClamp[info.alphaCachePos],
+                   qreal(planes[info.alphaCachePos][offset]),
+                   info.maxClamp[info.alphaCachePos]);
+
+        info.fromDoubleFuncPtr[info.alphaCachePos](data, info.alphaRealPos, alphaValue);
+
+        if (alphaValue <= std::numeric_limits<qreal>::epsilon()) {
+            for (int k = 0; k < info.numChannels(); k++) {
+                if (k == info.alphaCachePos) continue;
+                info.fromDoubleFuncPtr[k](data, info.convChannelList[k]->pos(), 0.0);
+            }
+            return;
+        }
+
+        alphaValueInv = 1.0 / alphaValue;
+    }
+
+    for (int k = 0; k < info.numChannels(); k++) {
+        if (k == info.alphaCachePos) continue;
+
+        const qreal value =
+            qBound(info.minClamp[k],
+                   planes[k][offset] * alphaValueInv,
+                   info.maxClamp[k]);
+
+        info.fromDoubleFuncPtr[k](data, info.convChannelList[k]->pos(), value);
+    }
+}
+
+}
+
+bool KisIIRGaussianBlur::isApplicable(qreal sigma)
+{
+    /**
+     * Below this value the coefficients of Young and van Vliet come
+     * from the nonlinear part of their fit, and the deviation from
+     * the real Gaussian becomes visible
+     */
+    return sigma >= 2.5;
+}
+
+int KisIIRGaussianBlur::borderSize(qreal sigma)
+{
+    /**
+     * The impulse response of the filter is below 0.01% of
+     * its peak after four sigmas
+     */
+    return qCeil(4.0 * sigma);
+}
+
+KisIIRGaussianCoefficients KisIIRGaussianBlur::coefficients(qreal sigma)
+{
+    const qreal q = sigma >= 2.5 ?
+        0.98711 * sigma - 0.96330 :
+        3.97156 - 4.14554 * std::sqrt(qMax(0.0, 1.0 - 0.26891 * sigma));
+
+    const qreal q2 = q * q;
+    const qreal q3 = q2 * q;
+
+    const qreal b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+    const qreal b1 = 2.44413 * q + 2.85619 * q2 + 1.26661 * q3;
+    const qreal b2 = -(1.4281 * q2 + 1.26661 * q3);
+    const qreal b3 = 0.422205 * q3;
+
+    KisIIRGaussianCoefficients coeffs;
+    coeffs.b1 = b1 / b0;
+    coeffs.b2 = b2 / b0;
+    coeffs.b3 = b3 / b0;
+
+    // B is calculated from the rounded values to keep the gain equal to 1.0
+    coeffs.B = 1.0f - (coeffs.b1 + coeffs.b2 + coeffs.b3);
+
+    return coeffs;
+}
+
+void KisIIRGaussianBlur::applyDirectional(KisPaintDeviceSP dst,
+                                          KisPaintDeviceSP src,
+                                          const QRect &rect,
+                                          qreal sigma,
+                                          Direction direction,
+                                          const QBitArray &channelFlags,
+                                          KoUpdater *progressUpdater)
+{
+    if (rect.isEmpty()) return;
+
+    const QRect dataRect = src->exactBounds();
+    if (dataRect.isEmpty()) return;
+
+    const ChannelsInfo info(src->colorSpace(), channelFlags);
+    if (!info.numChannels()) return;
+
+    static QScopedPointer<KisIIRGaussianFilterBase> filter(
+        createOptimizedClass<KisIIRGaussianFilterFactory>(0));
+
+    const KisIIRGaussianCoefficients coeffs = coefficients(sigma);
+    const int border = borderSize(sigma);
+
+    const bool isHorizontal = direction == Horizontal;
+
+    // the lines of the strip are the rows or columns of the image
+    const int lineLength = (isHorizontal ? rect.width() : rect.height()) + 2 * border;
+    const int numLines = isHorizontal ? rect.height() : rect.width();
+
+    QVector<float> buffer(info.numChannels() * stripWidth * lineLength);
+    QVector<float*> planes(info.numChannels());
+    for (int k = 0; k < info.numChannels(); k++) {
+        planes[k] = buffer.data() + k * stripWidth * lineLength;
+    }
+
+    for (int firstLine = 0; firstLine < numLines; firstLine += stripWidth) {
+        const int linesInStrip = qMin(stripWidth, numLines - firstLine);
+
+        // the unused lanes of the last strip are filtered along the rest
+        if (linesInStrip < stripWidth) {
+            buffer.fill(0.0f);
+        }
+
+        /**
+         * Each line of the strip (a row or a column of the image)
+         * becomes one float in every line of the buffer
+         */
+        const QRect readRect = isHorizontal ?
+            QRect(rect.x() - border, rect.y() + firstLine, lineLength, linesInStrip) :
+            QRect(rect.x() + firstLine, rect.y() - border, linesInStrip, lineLength);
+
+        KisRepeatHLineConstIteratorSP srcIt =
+            src->createRepeatHLineConstIterator(readRect.x(), readRect.y(), readRect.width(), dataRect);
+
+        for (int y = 0; y < readRect.height(); y++) {
+            for (int x = 0; x < readRect.width(); x++) {
+                const int offset = isHorizontal ?
+                    x * stripWidth + y :
+                    y * stripWidth + x;
+
+                readPixel(srcIt->oldRawData(), info, planes, offset);
+                srcIt->nextPixel();
+            }
+            srcIt->nextRow();
+        }
+
+        for (int k = 0; k < info.numChannels(); k++) {
+            filter->filter(planes[k], stripWidth, lineLength, coeffs);
+        }
+
+        const QRect writeRect = isHorizontal ?
+            QRect(rect.x(), rect.y() + firstLine, rect.width(), linesInStrip) :
+            QRect(rect.x() + firstLine, rect.y(), linesInStrip, rect.height());
+
+        KisHLineIteratorSP dstIt =
+            dst->createHLineIteratorNG(writeRect.x(), writeRect.y(), writeRect.width());
+
+        for (int y = 0; y < writeRect.height(); y++) {
+            for (int x = 0; x < writeRect.width(); x++) {
+                const int offset = isHorizontal ?
+                    (x + border) * stripWidth + y :
+                    (y + border) * stripWidth + x;
+
+                writePixel(dstIt->rawData(), info, planes, offset);
+                dstIt->nextPixel();
+            }
+            dstIt->nextRow();
+        }
+
+        if (progressUpdater) {
+            progressUpdater->setProgress(100 * (firstLine + linesInStrip) / numLines);
+            if (progressUpdater->interrupted()) break;
+        }
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISIIRGAUSSIANBLUR_H
+#define KISIIRGAUSSIANBLUR_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class QBitArray;
+class KoUpdater;
+
+/**
+ * Coefficients of the recursive Gaussian filter of Young and van Vliet.
+ * The feedback coefficients are already divided by b0.
+ */
+struct KisIIRGaussianCoefficients
+{
+    float B;
+    float b1;
+    float b2;
+    float b3;
+};
+
+/**
+ * A recursive approximation of the Gaussian blur by Young and
+ * van Vliet ("Recursive implementation of the Gaussian filter",
+ * Signal Processing 44, 1995).
+ *
+ * Every pixel costs the same six multiplications per direction
+ * whatever the radius is, so it is much faster than the convolution
+ * with an explicit kernel for big radii. For small sigmas the
+ * approximation becomes imprecise, so the callers should check
+ * isApplicable() and fall back to KisConvolutionPainter.
+ */
+class KRITAIMAGE_EXPORT KisIIRGaussianBlur
+{
+public:
+    enum Direction {
+        Horizontal,
+        Vertical
+    };
+
+    /**
+     * Blurs \p rect of \p src along \p direction and writes the result
+     * into the same rect of \p dst. \p dst may be the same device as
+     * \p src. The pixels outside the exact bounds of \p src are
+     * treated as repeated border pixels, the same way as
+     * BORDER_REPEAT of KisConvolutionPainter.
+     *
+     * Only the channels set in \p channelFlags are blurred and written
+     * into \p dst. An empty \p channelFlags means all the channels.
+     */
+    static void applyDirectional(KisPaintDeviceSP dst,
+                                 KisPaintDeviceSP src,
+                                 const QRect &rect,
+                                 qreal sigma,
+                                 Direction direction,
+                                 const QBitArray &channelFlags,
+                                 KoUpdater *progressUpdater);
+
+    /**
+     * \return true if the recursive filter approximates the Gaussian
+     * with \p sigma well enough to replace the convolution
+     */
+    static bool isApplicable(qreal sigma);
+
+    /**
+     * The number of pixels on each side of the blurred line the filter
+     * reads from the source, the same meaning as the half of the size
+     * of a convolution kernel
+     */
+    static int borderSize(qreal sigma);
+
+    static KisIIRGaussianCoefficients coefficients(qreal sigma);
+};
+
+#endif // KISIIRGAUSSIANBLUR_H
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisIIRGaussianFilter.h"
+#include "KisIIRGaussianBlur.h"
+
+#include <QtGlobal>
+
+template<Vc::Implementation _impl>
+class KisIIRGaussianFilter : public KisIIRGaussianFilterBase
+{
+public:
+    void filter(float *data, int stripWidth, int length,
+                const KisIIRGaussianCoefficients &coeffs) const override;
+};
+
+#if defined HAVE_VC
+
+template<Vc::Implementation _impl>
+void KisIIRGaussianFilter<_impl>::filter(float *data, int stripWidth, int length,
+                                         const KisIIRGaussianCoefficients &coeffs) const
+{
+    if (length <= 0) return;
+
+    const Vc::float_v vB(coeffs.B);
+    const Vc::float_v vB1(coeffs.b1);
+    const Vc::float_v vB2(coeffs.b2);
+    const Vc::float_v vB3(coeffs.b3);
+
+    for (int x = 0; x < stripWidth; x += int(Vc::float_v::size())) {
+        float *column = data + x;
+
+        /**
+         * The filter is initialized with the steady state of a constant
+         * signal equal to the first pixel. The caller pads the strip
+         * with the border pixels, so it matches the clamped border.
+         */
+        Vc::float_v w1(column, Vc::Unaligned);
+        Vc::float_v w2 = w1;
+        Vc::float_v w3 = w1;
+
+        // causal pass
+        float *ptr = column;
+        for (int i = 0; i < length; i++, ptr += stripWidth) {
+            const Vc::float_v value(ptr, Vc::Unaligned);
+            const Vc::float_v w = vB * value + vB1 * w1 + vB2 * w2 + vB3 * w3;
+            w.store(ptr, Vc::Unaligned);
+
+            w3 = w2;
+            w2 = w1;
+            w1 = w;
+        }
+
+        // anti-causal pass
+        ptr = column + (length - 1) * stripWidth;
+
+        Vc::float_v y1(ptr, Vc::Unaligned);
+        Vc::float_v y2 = y1;
+        Vc::float_v y3 = y1;
+
+        for (int i = length - 1; i >= 0; i--, ptr -= stripWidth) {
+            const Vc::float_v value(ptr, Vc::Unaligned);
+            const Vc::float_v y = vB * value + vB1 * y1 + vB2 * y2 + vB3 * y3;
+            y.store(ptr, Vc::Unaligned);
+
+            y3 = y2;
+            y2 = y1;
+            y1 = y;
+        }
+    }
+}
+
+#else /* HAVE_VC */
+
+template<Vc::Implementation _impl>
+void KisIIRGaussianFilter<_impl>::filter(float *data, int stripWidth, int length,
+                                         const KisIIRGaussianCoefficients &coeffs) const
+{
+    if (length <= 0) return;
+
+    for (int x = 0; x < stripWidth; x++) {
+        float *column = data + x;
+
+        float w1 = *column;
+        float w2 = w1;
+        float w3 = w1;
+
+        float *ptr = column;
+        for (int i = 0; i < length; i++, ptr += stripWidth) {
+            const float w = coeffs.B * *ptr + coeffs.b1 * w1 + coeffs.b2 * w2 + coeffs.b3 * w3;
+            *ptr = w;
+
+            w3 = w2;
+            w2 = w1;
+            w1 = w;
+        }
+
+        ptr = column + (length - 1) * stripWidth;
+
+        float y1 = *ptr;
+        float y2 = y1;
+        float y3 = y1;
+
+        for (int i = length - 1; i >= 0; i--, ptr -= stripWidth) {
+            const float y = coeffs.B * *ptr + coeffs.b1 * y1 + coeffs.b2 * y2 + coeffs.b3 * y3;
+            *ptr = y;
+
+            y3 = y2;
+            y2 = y1;
+            y1 = y;
+        }
+    }
+}
+
+#endif /* HAVE_VC */
+
+template<>
+KisIIRGaussianFilterBase*
+KisIIRGaussianFilterFactory::create<Vc::CurrentImplementation::current()>(int)
+{
+    return new KisIIRGaussianFilter<Vc::CurrentImplementation::current()>();
+}
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISIIRGAUSSIANFILTER_H
+#define KISIIRGAUSSIANFILTER_H
+
+#include <compositeops/KoVcMultiArchBuildSupport.h>
+
+struct KisIIRGaussianCoefficients;
+
+/**
+ * The inner loop of KisIIRGaussianBlur, compiled separately for every
+ * instruction set supported by Vc.
+ *
+ * The strip is stored as \p length lines of \p stripWidth floats. The
+ * filter runs along the lines, so all the floats of one line are
+ * processed in parallel in the vector registers.
+ */
+class KisIIRGaussianFilterBase
+{
+public:
+    virtual ~KisIIRGaussianFilterBase() {}
+
+    /**
+     * Runs the causal and the anti-causal passes of the filter
+     * over the strip in place. \p stripWidth must be a multiple
+     * of KisIIRGaussianFilterBase::maxVectorSize.
+     */
+    virtual void filter(float *data, int stripWidth, int length,
+                        const KisIIRGaussianCoefficients &coeffs) const = 0;
+
+    /**
+     * The largest vector size among the supported instruction sets
+     */
+    static const int maxVectorSize = 16;
+};
+
+struct KisIIRGaussianFilterFactory
+{
+    typedef int ParamType;
+    typedef KisIIRGaussianFilterBase* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType);
+};
+
+#endif // KISIIRGAUSSIANFILTER_H
@@ -0,0 +1,306 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisWorkStealingExecutor.h"
+
+#include <atomic>
+#include <deque>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+struct WorkerQueue
+{
+    QMutex lock;
+    std::deque<QRunnable*> jobs;
+};
+
+}
+
+struct KisWorkStealingExecutor::Private
+{
+    class Worker : public QThread
+    {
+    public:
+        Worker(Private *_owner, int _index)
+            : owner(_owner), index(_index)
+        {
+        }
+
+        void run() override {
+            owner->workerLoop(index);
+        }
+
+        Private * const owner;
+        const int index;
+    };
+
+    QVector<WorkerQueue*> queues;
+    QVector<Worker*> workers;
+
+    /**
+     * The number of jobs sitting in the queues. Workers do not go to
+     * sleep while it is non-zero.
+     */
+    std::atomic<int> numQueuedJobs {0};
+
+    /**
+     * The number of jobs that are either queued or running
+     */
+    std::atomic<int> numActiveJobs {0};
+
+    std::atomic<int> numSleepingWorkers {0};
+    std::atomic<unsigned int> nextQueue {0};
+
+    QMutex sleepLock;
+    QWaitCondition wakeUpCondition;
+    bool quitRequested = false;
+
+    QMutex doneLock;
+    QWaitCondition doneCondition;
+
+    int currentWorkerIndex() const;
+    void push(int queueIndex, QRunnable *runnable);
+    QRunnable* popLocal(int index);
+    QRunnable* steal(int index);
+    void runJob(QRunnable *runnable);
+    void workerLoop(int index);
+
+    void startWorkers(int numWorkers);
+    void stopWorkers();
+};
+
+int KisWorkStealingExecutor::Private::currentWorkerIndex() const
+{
+    Worker *worker = dynamic_cast<Worker*>(QThread::currentThread());
+    return worker && worker->owner == this ? worker->index : -1;
+}
+
+void KisWorkStealingExecutor::Private::push(int queueIndex, QRunnable *runnable)
+{
+    WorkerQueue *queue = queues[queueIndex];
+
+    {
+        QMutexLocker l(&queue->lock);
+        queue->jobs.push_back(runnable);
+        numQueuedJobs++;
+    }
+
+    /**
+     * The sleeping worker increments the counter before rechecking
+     * numQueuedJobs under sleepLock, so either it sees our job, or we
+     * see it sleeping.
+     */
+    if (numSleepingWorkers > 0) {
+        QMutexLocker l(&sleepLock);
+        wakeUpCondition.wakeOne();
+    }
+}
+
+QRunnable* KisWorkStealingExecutor::Private::popLocal(int index)
+{
+    WorkerQueue *queue = queues[index];
+    QMutexLocker l(&queue->lock);
+
+    if (queue->jobs.empty()) return 0;
+
+    QRunnable *runnable = queue->jobs.back();
+    queue->jobs.pop_back();
+    numQueuedJobs--;
+
+    return runnable;
+}
+
+QRunnable* KisWorkStealingExecutor::Private::steal(int index)
+{
+    const int numQueues = queues.size();
+
+    for (int i = 1; i < numQueues; i++) {
+        WorkerQueue *queue = queues[(index + i) % numQueues];
+
+        // don't wait for a busy queue, just try the next one
+        if (!queue->lock.tryLock()) continue;
+
+        QRunnable *runnable = 0;
+
+        if (!queue->jobs.empty()) {
+            runnable = queue->jobs.front();
+            queue->jobs.pop_front();
+            numQueuedJobs--;
+        }
+
+        queue->lock.unlock();
+
+        if (runnable) return runnable;
+    }
+
+    return 0;
+}
+
+void KisWorkStealingExecutor::Private::runJob(QRunnable *runnable)
+{
+    const bool autoDelete = runnable->autoDelete();
+
+    runnable->run();
+
+    if (autoDelete) {
+        delete runnable;
+    }
+
+    if (--numActiveJobs == 0) {
+        QMutexLocker l(&doneLock);
+        doneCondition.wakeAll();
+    }
+}
+
+void KisWorkStealingExecutor::Private::workerLoop(int index)
+{
+    while (1) {
+        QRunnable *runnable = popLocal(index);
+
+        if (!runnable) {
+            runnable = steal(index);
+        }
+
+        if (runnable) {
+            runJob(runnable);
+            continue;
+        }
+
+        QMutexLocker l(&sleepLock);
+
+        if (quitRequested) break;
+
+        numSleepingWorkers++;
+
+        /**
+         * Some of the queues might have been busy while we were
+         * stealing, so recheck the counter before going to sleep.
+         */
+        if (!numQueuedJobs) {
+            wakeUpCondition.wait(&sleepLock);
+        }
+
+        numSleepingWorkers--;
+    }
+}
+
+void KisWorkStealingExecutor::Private::startWorkers(int numWorkers)
+{
+    quitRequested = false;
+
+    for (int i = 0; i < numWorkers; i++) {
+        queues.append(new WorkerQueue());
+        workers.append(new Worker(this, i));
+    }
+
+    Q_FOREACH (Worker *worker, workers) {
+        worker->start();
+    }
+}
+
+void KisWorkStealingExecutor::Private::stopWorkers()
+{
+    {
+        QMutexLocker l(&sleepLock);
+        quitRequested = true;
+        wakeUpCondition.wakeAll();
+    }
+
+    Q_FOREACH (Worker *worker, workers) {
+        worker->wait();
+    }
+
+    qDeleteAll(workers);
+    workers.clear();
+
+    Q_FOREACH (WorkerQueue *queue, queues) {
+        KIS_SAFE_ASSERT_RECOVER_NOOP(queue->jobs.empty());
+    }
+
+    qDeleteAll(queues);
+    queues.clear();
+}
+
+
+KisWorkStealingExecutor::KisWorkStealingExecutor(int maxThreadCount)
+    : m_d(new Private)
+{
+    m_d->startWorkers(qMax(1, maxThreadCount));
+}
+
+KisWorkStealingExecutor::~KisWorkStealingExecutor()
+{
+    waitForDone();
+    m_d->stopWorkers();
+}
+
+void KisWorkStealingExecutor::start(QRunnable *runnable)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(runnable);
+
+    m_d->numActiveJobs++;
+
+    int queueIndex = m_d->currentWorkerIndex();
+    if (queueIndex < 0) {
+        queueIndex = m_d->nextQueue++ % m_d->queues.size();
+    }
+
+    m_d->push(queueIndex, runnable);
+}
+
+void KisWorkStealingExecutor::waitForDone()
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_d->currentWorkerIndex() < 0);
+
+    QMutexLocker l(&m_d->doneLock);
+
+    while (m_d->numActiveJobs > 0) {
+        m_d->doneCondition.wait(&m_d->doneLock);
+    }
+}
+
+void KisWorkStealingExecutor::setMaxThreadCount(int value)
+{
+    value = qMax(1, value);
+    if (value == m_d->workers.size()) return;
+
+    waitForDone();
+    m_d->stopWorkers();
+    m_d->startWorkers(value);
+}
+
+int KisWorkStealingExecutor::maxThreadCount() const
+{
+    return m_d->workers.size();
+}
+
+int KisWorkStealingExecutor::currentWorkerIndex() const
+{
+    return m_d->currentWorkerIndex();
+}
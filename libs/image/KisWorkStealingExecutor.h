@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __KIS_WORK_STEALING_EXECUTOR_H
+#define __KIS_WORK_STEALING_EXECUTOR_H
+
+#include <QScopedPointer>
+#include "kritaimage_export.h"
+
+class QRunnable;
+
+/**
+ * A thread pool with a fixed set of worker threads, each having its own
+ * queue of jobs. It is a drop-in replacement for QThreadPool in the
+ * updater context.
+ *
+ * When a job is started from inside a worker thread (e.g. when the
+ * scheduler assigns the next job right from the sigJobFinished() handler),
+ * it is pushed into the queue of this very worker, so no shared lock is
+ * taken. A worker takes the jobs from its own queue in LIFO order, and when
+ * its queue is empty, it steals the oldest jobs from the queues of other
+ * workers. The jobs started from outside the pool are distributed between
+ * the workers in a round-robin manner.
+ *
+ * The ownership of the runnables is the same as in QThreadPool: a runnable
+ * is deleted after completion only if its autoDelete() is true.
+ */
+class KRITAIMAGE_EXPORT KisWorkStealingExecutor
+{
+public:
+    KisWorkStealingExecutor(int maxThreadCount);
+    ~KisWorkStealingExecutor();
+
+    /**
+     * Queues \p runnable for execution in one of the worker threads
+     */
+    void start(QRunnable *runnable);
+
+    /**
+     * Blocks the caller until all the queued and running jobs are
+     * completed. Must not be called from a worker thread.
+     */
+    void waitForDone();
+
+    /**
+     * Changes the number of the worker threads. All the jobs queued
+     * before the call are completed first.
+     */
+    void setMaxThreadCount(int value);
+    int maxThreadCount() const;
+
+    /**
+     * Returns the index of the worker of this executor the caller is run
+     * in, or -1 if the caller is not a worker of this executor.
+     */
+    int currentWorkerIndex() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_WORK_STEALING_EXECUTOR_H */
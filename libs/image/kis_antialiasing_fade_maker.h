@@ -83,6 +83,16 @@ public:
         return false;
     }
 
+    /**
+     * The parameters of the fade, used by the vectorized
+     * row processors of the mask generators
+     */
+    qreal radius() const { return m_radius; }
+    quint8 fadeStartValue() const { return m_fadeStartValue; }
+    qreal antialiasingFadeStart() const { return m_antialiasingFadeStart; }
+    qreal antialiasingFadeCoeff() const { return m_antialiasingFadeCoeff; }
+    bool antialiasingEnabled() const { return m_enableAntialiasing; }
+
 private:
     qreal m_radius;
     quint8 m_fadeStartValue;
@@ -174,6 +184,14 @@ public:
         return false;
     }
 
+    qreal xLimit() const { return m_xLimit; }
+    qreal yLimit() const { return m_yLimit; }
+    qreal xFadeLimitStart() const { return m_xFadeLimitStart; }
+    qreal yFadeLimitStart() const { return m_yFadeLimitStart; }
+    qreal xFadeCoeff() const { return m_xFadeCoeff; }
+    qreal yFadeCoeff() const { return m_yFadeCoeff; }
+    bool antialiasingEnabled() const { return m_enableAntialiasing; }
+
 private:
     qreal m_xLimit;
     qreal m_yLimit;
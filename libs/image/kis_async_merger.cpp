@@ -29,6 +29,7 @@
 #include "kis_painter.h"
 #include "kis_layer.h"
 #include "kis_group_layer.h"
+#include "KisBelowStackCache.h"
 #include "kis_adjustment_layer.h"
 #include "generator/kis_generator_layer.h"
 #include "kis_external_layer_iface.h"
@@ -207,6 +208,13 @@ private:
 /*                     KisAsyncMerger                                */
 /*********************************************************************/
 
+KisAsyncMerger::KisAsyncMerger()
+    : m_cacheGraphSequenceNumber(-1),
+      m_cachedLeavesToSkip(0),
+      m_cacheNeedsWrite(false)
+{
+}
+
 void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
     KisMergeWalker::LeafStack &leafStack = walker.leafStack();
 
@@ -237,9 +245,20 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
         }
 
 
-        if(!m_currentProjection)
+        if(!m_currentProjection) {
             setupProjection(currentLeaf, applyRect, useTempProjections);
 
+            if (m_currentProjection) {
+                setupBelowStackCache(item, leafStack, walker.levelOfDetail());
+            }
+        }
+
+        if (m_cachedLeavesToSkip > 0) {
+            DEBUG_NODE_ACTION("Skipping", "N_BELOW_FILTHY", currentLeaf, applyRect);
+            m_cachedLeavesToSkip--;
+            continue;
+        }
+
         KisUpdateOriginalVisitor originalVisitor(applyRect,
                                                  m_currentProjection,
                                                  walker.cropRect());
@@ -271,6 +290,14 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
             /* nothing to do */
         }
 
+        if (m_cacheNeedsWrite && currentLeaf->node() == m_cacheKeyNode) {
+            m_cacheGroup->belowStackCache()->write(m_cacheKeyNode, m_cacheRect,
+                                                   m_currentProjection,
+                                                   walker.levelOfDetail(),
+                                                   m_cacheGraphSequenceNumber);
+            m_cacheNeedsWrite = false;
+        }
+
         compositeWithProjection(currentLeaf, applyRect);
 
         if(item.m_position & KisMergeWalker::N_TOPMOST) {
@@ -300,6 +327,13 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
 void KisAsyncMerger::resetProjection() {
     m_currentProjection = 0;
     m_finalProjection = 0;
+
+    m_cacheGroup = 0;
+    m_cacheKeyNode = 0;
+    m_cacheRect = QRect();
+    m_cacheGraphSequenceNumber = -1;
+    m_cachedLeavesToSkip = 0;
+    m_cacheNeedsWrite = false;
 }
 
 void KisAsyncMerger::setupProjection(KisProjectionLeafSP currentLeaf, const QRect& rect, bool useTempProjection) {
@@ -330,6 +364,111 @@ void KisAsyncMerger::setupProjection(KisProjectionLeafSP currentLeaf, const QRec
     }
 }
 
+void KisAsyncMerger::setupBelowStackCache(const KisBaseRectsWalker::JobItem &firstItem,
+                                          const KisBaseRectsWalker::LeafStack &leafStack,
+                                          int levelOfDetail)
+{
+    if (!KisBelowStackCache::isEnabled()) return;
+
+    KisGroupLayerSP group =
+        qobject_cast<KisGroupLayer*>(firstItem.m_leaf->parent()->node().data());
+    if (!group) return;
+
+    /**
+     * Collect the leaves of the level we are going to merge. They
+     * lie in the stack contiguously up to the topmost one.
+     */
+    QVector<const KisBaseRectsWalker::JobItem*> items;
+    items << &firstItem;
+
+    for (int i = leafStack.size() - 1;
+         !(items.last()->m_position & KisMergeWalker::N_TOPMOST); i--) {
+
+        if (i < 0) return;
+        items << &leafStack[i];
+    }
+
+    int firstChangedIndex = -1;
+    for (int i = 0; i < items.size(); i++) {
+        if (items[i]->m_position & KisMergeWalker::N_EXTRA) return;
+
+        if (firstChangedIndex < 0 &&
+            !(items[i]->m_position & KisMergeWalker::N_BELOW_FILTHY)) {
+
+            firstChangedIndex = i;
+        }
+    }
+
+    if (firstChangedIndex < 0) {
+        firstChangedIndex = items.size();
+    }
+
+    KisBelowStackCache *cache = group->belowStackCache();
+    KisNodeSP keyNode = cache->keyNode();
+
+    auto findKey = [&items] (KisNodeSP node) {
+        for (int i = 0; i < items.size(); i++) {
+            if (items[i]->m_leaf->node() == node) return i;
+        }
+        return -1;
+    };
+
+    int keyIndex = keyNode ? findKey(keyNode) : -1;
+
+    if (firstChangedIndex > 0 && firstChangedIndex < items.size() &&
+        firstChangedIndex != keyIndex) {
+
+        /**
+         * The user has switched to another layer, start caching
+         * the layers below it
+         */
+        keyIndex = firstChangedIndex;
+        keyNode = items[keyIndex]->m_leaf->node();
+        cache->setKeyNode(keyNode);
+
+    } else if (keyIndex < 0 || firstChangedIndex < keyIndex) {
+        /**
+         * The layers below the key have changed (or we cannot find out
+         * whether they have), so the cache must forget the area
+         */
+        const int lastChangedIndex = keyIndex < 0 ? items.size() : keyIndex;
+
+        QRect dirtyRect;
+        for (int i = firstChangedIndex; i < lastChangedIndex; i++) {
+            dirtyRect |= items[i]->m_applyRect;
+        }
+        cache->invalidate(dirtyRect);
+    }
+
+    if (keyIndex <= 0) return;
+
+    m_cacheGroup = group;
+    m_cacheKeyNode = keyNode;
+    m_cacheGraphSequenceNumber = group->graphSequenceNumber();
+
+    /**
+     * When all the layers below the key are unchanged we can fetch
+     * their composite from the cache. The key may need more pixels
+     * than it changes (e.g. a blur adjustment layer), so we should
+     * read the rect of the topmost leaf below it, which the walker has
+     * grown by the key's need rect. The rects of the lower leaves may
+     * be even bigger, but the key doesn't read that area.
+     */
+    m_cacheRect = items[keyIndex - 1]->m_applyRect;
+
+    if (firstChangedIndex >= keyIndex &&
+        cache->read(keyNode, m_cacheRect,
+                    m_currentProjection, levelOfDetail,
+                    m_cacheGraphSequenceNumber)) {
+
+        m_cachedLeavesToSkip = keyIndex;
+        m_cacheNeedsWrite = false;
+    } else {
+        m_cachedLeavesToSkip = 0;
+        m_cacheNeedsWrite = true;
+    }
+}
+
 void KisAsyncMerger::writeProjection(KisProjectionLeafSP topmostLeaf, bool useTempProjection, const QRect &rect) {
     Q_UNUSED(useTempProjection);
     Q_UNUSED(topmostLeaf);
@@ -21,6 +21,7 @@
 
 #include "kritaimage_export.h"
 #include "kis_types.h"
+#include "kis_base_rects_walker.h"
 
 class QRect;
 class KisBaseRectsWalker;
@@ -28,6 +29,8 @@ class KisBaseRectsWalker;
 class KRITAIMAGE_EXPORT KisAsyncMerger
 {
 public:
+    KisAsyncMerger();
+
     void startMerge(KisBaseRectsWalker &walker, bool notifyClones = true);
 
 private:
@@ -36,6 +39,9 @@ private:
     inline void writeProjection(KisProjectionLeafSP topmostLeaf, bool useTempProjection, const QRect &rect);
     inline bool compositeWithProjection(KisProjectionLeafSP leaf, const QRect &rect);
     inline void doNotifyClones(KisBaseRectsWalker &walker);
+    void setupBelowStackCache(const KisBaseRectsWalker::JobItem &firstItem,
+                              const KisBaseRectsWalker::LeafStack &leafStack,
+                              int levelOfDetail);
 
 private:
     /**
@@ -62,6 +68,17 @@ private:
      * setupProjection()
      */
     KisPaintDeviceSP m_cachedPaintDevice;
+
+    /**
+     * The state of the below-stack cache of the group being merged
+     * at the moment. See setupBelowStackCache()
+     */
+    KisGroupLayerSP m_cacheGroup;
+    KisNodeSP m_cacheKeyNode;
+    QRect m_cacheRect;
+    int m_cacheGraphSequenceNumber;
+    int m_cachedLeavesToSkip;
+    bool m_cacheNeedsWrite;
 };
 
 
@@ -25,6 +25,7 @@
 
 #include "kis_abstract_projection_plane.h"
 #include "kis_projection_leaf.h"
+#include "KisTraceRecorder.h"
 
 
 class KisBaseRectsWalker;
@@ -122,6 +123,8 @@ public:
     }
 
     void collectRects(KisNodeSP node, const QRect& requestedRect) {
+        KIS_TRACE_SCOPE("collect rects", "walkers");
+
         clear();
 
         KisProjectionLeafSP startLeaf = node->projectionLeaf();
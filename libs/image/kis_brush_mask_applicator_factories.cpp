@@ -20,6 +20,16 @@
 
 #include "kis_circle_mask_generator.h"
 #include "kis_circle_mask_generator_p.h"
+#include "kis_rect_mask_generator.h"
+#include "kis_rect_mask_generator_p.h"
+#include "kis_gauss_circle_mask_generator.h"
+#include "kis_gauss_circle_mask_generator_p.h"
+#include "kis_gauss_rect_mask_generator.h"
+#include "kis_gauss_rect_mask_generator_p.h"
+#include "kis_curve_circle_mask_generator.h"
+#include "kis_curve_circle_mask_generator_p.h"
+#include "kis_curve_rect_mask_generator.h"
+#include "kis_curve_rect_mask_generator_p.h"
 #include "kis_brush_mask_applicators.h"
 #include "kis_brush_mask_applicator_base.h"
 
@@ -42,6 +52,46 @@ MaskApplicatorFactory<KisCircleMaskGenerator, KisBrushMaskVectorApplicator>::cre
     return new KisBrushMaskVectorApplicator<KisCircleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
 }
 
+template<>
+template<>
+MaskApplicatorFactory<KisRectangleMaskGenerator, KisBrushMaskVectorApplicator>::ReturnType
+MaskApplicatorFactory<KisRectangleMaskGenerator, KisBrushMaskVectorApplicator>::create<Vc::CurrentImplementation::current()>(ParamType maskGenerator)
+{
+    return new KisBrushMaskVectorApplicator<KisRectangleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
+}
+
+template<>
+template<>
+MaskApplicatorFactory<KisGaussCircleMaskGenerator, KisBrushMaskVectorApplicator>::ReturnType
+MaskApplicatorFactory<KisGaussCircleMaskGenerator, KisBrushMaskVectorApplicator>::create<Vc::CurrentImplementation::current()>(ParamType maskGenerator)
+{
+    return new KisBrushMaskVectorApplicator<KisGaussCircleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
+}
+
+template<>
+template<>
+MaskApplicatorFactory<KisGaussRectangleMaskGenerator, KisBrushMaskVectorApplicator>::ReturnType
+MaskApplicatorFactory<KisGaussRectangleMaskGenerator, KisBrushMaskVectorApplicator>::create<Vc::CurrentImplementation::current()>(ParamType maskGenerator)
+{
+    return new KisBrushMaskVectorApplicator<KisGaussRectangleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
+}
+
+template<>
+template<>
+MaskApplicatorFactory<KisCurveCircleMaskGenerator, KisBrushMaskVectorApplicator>::ReturnType
+MaskApplicatorFactory<KisCurveCircleMaskGenerator, KisBrushMaskVectorApplicator>::create<Vc::CurrentImplementation::current()>(ParamType maskGenerator)
+{
+    return new KisBrushMaskVectorApplicator<KisCurveCircleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
+}
+
+template<>
+template<>
+MaskApplicatorFactory<KisCurveRectangleMaskGenerator, KisBrushMaskVectorApplicator>::ReturnType
+MaskApplicatorFactory<KisCurveRectangleMaskGenerator, KisBrushMaskVectorApplicator>::create<Vc::CurrentImplementation::current()>(ParamType maskGenerator)
+{
+    return new KisBrushMaskVectorApplicator<KisCurveRectangleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
+}
+
 #if defined HAVE_VC
 
 struct KisCircleMaskGenerator::FastRowProcessor
@@ -134,4 +184,475 @@ FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, i
     }
 }
 
+
+namespace {
+
+/**
+ * Vectorized erf() by Abramowitz and Stegun, formula 7.1.26. Its
+ * maximum absolute error is 1.5e-7, which is far below the precision
+ * of an 8-bit mask.
+ */
+inline Vc::float_v vErf(const Vc::float_v &x)
+{
+    const Vc::float_v vOne(Vc::One);
+    const Vc::float_v xa = Vc::abs(x);
+
+    const Vc::float_v t = vOne / (vOne + 0.3275911f * xa);
+
+    Vc::float_v y = ((((1.061405429f * t - 1.453152027f) * t + 1.421413741f) * t - 0.284496736f) * t + 0.254829592f) * t;
+    y = vOne - y * Vc::exp(-xa * xa);
+
+    y(x < Vc::float_v(Vc::Zero)) = -y;
+    return y;
+}
+
+/**
+ * Vectorized version of KisAntialiasingFadeMaker1D::needFade(). The lanes
+ * whose value is decided by the fade maker get it written into \p value
+ * (normalized to 0...1) and are returned as a mask.
+ */
+template <class FadeMaker>
+inline Vc::float_m vNeedFade1D(const FadeMaker &fadeMaker, const Vc::float_v &dist, Vc::float_v &value)
+{
+    const Vc::float_m outsideMask = dist > Vc::float_v(float(fadeMaker.radius()));
+    value(outsideMask) = Vc::float_v(Vc::One);
+
+    if (!fadeMaker.antialiasingEnabled()) {
+        return outsideMask;
+    }
+
+    const Vc::float_v vFadeStart(float(fadeMaker.antialiasingFadeStart()));
+    const Vc::float_v vFadeStartValue(float(fadeMaker.fadeStartValue()) / 255.0f);
+    const Vc::float_v vFadeCoeff(float(fadeMaker.antialiasingFadeCoeff()) / 255.0f);
+
+    const Vc::float_m fadeMask = !outsideMask && dist > vFadeStart;
+    value(fadeMask) = vFadeStartValue + (dist - vFadeStart) * vFadeCoeff;
+
+    return outsideMask | fadeMask;
+}
+
+/**
+ * Vectorized version of KisAntialiasingFadeMaker2D::needFade(). Returns
+ * the mask of the lanes lying outside the limits of the brush.
+ */
+template <class FadeMaker>
+inline Vc::float_m vOutsideLimits2D(const FadeMaker &fadeMaker, const Vc::float_v &xa, const Vc::float_v &ya)
+{
+    return (xa > Vc::float_v(float(fadeMaker.xLimit()))) |
+        (ya > Vc::float_v(float(fadeMaker.yLimit())));
+}
+
+/**
+ * Fades the normalized base \p value in the antialiasing border
+ * the same way KisAntialiasingFadeMaker2D::needFade() does.
+ */
+template <class FadeMaker>
+inline void vApplyFade2D(const FadeMaker &fadeMaker, const Vc::float_v &xa, const Vc::float_v &ya, Vc::float_v &value)
+{
+    if (!fadeMaker.antialiasingEnabled()) return;
+
+    const Vc::float_v vOne(Vc::One);
+    const Vc::float_v vXFadeStart(float(fadeMaker.xFadeLimitStart()));
+    const Vc::float_v vYFadeStart(float(fadeMaker.yFadeLimitStart()));
+
+    const Vc::float_m xFadeMask = xa > vXFadeStart;
+    value(xFadeMask) += (vOne - value) * (xa - vXFadeStart) * float(fadeMaker.xFadeCoeff());
+
+    const Vc::float_m yFadeMask = ya > vYFadeStart;
+    value(yFadeMask) += (vOne - value) * (ya - vYFadeStart) * float(fadeMaker.yFadeCoeff());
+}
+
+}
+
+struct KisRectangleMaskGenerator::FastRowProcessor
+{
+    FastRowProcessor(KisRectangleMaskGenerator *maskGenerator)
+        : d(maskGenerator->d.data()),
+          antialiasEdges(maskGenerator->antialiasEdges()) {}
+
+    template<Vc::Implementation _impl>
+    void process(float* buffer, int width, float y, float cosa, float sina,
+                 float centerX, float centerY);
+
+    KisRectangleMaskGenerator::Private *d;
+    bool antialiasEdges;
+};
+
+template<> void KisRectangleMaskGenerator::
+FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, int width, float y, float cosa, float sina,
+                                   float centerX, float centerY)
+{
+    float y_ = y - centerY;
+    float sinay_ = sina * y_;
+    float cosay_ = cosa * y_;
+
+    float* bufferPointer = buffer;
+
+    Vc::float_v currentIndices = Vc::float_v::IndexesFromZero();
+
+    Vc::float_v increment((float)Vc::float_v::size());
+    Vc::float_v vCenterX(centerX);
+
+    Vc::float_v vCosa(cosa);
+    Vc::float_v vSina(sina);
+    Vc::float_v vCosaY_(cosay_);
+    Vc::float_v vSinaY_(sinay_);
+
+    Vc::float_v vXCoeff(d->xcoeff);
+    Vc::float_v vYCoeff(d->ycoeff);
+
+    Vc::float_v vTransformedFadeX(d->transformedFadeX);
+    Vc::float_v vTransformedFadeY(d->transformedFadeY);
+
+    // we add +1.0 to ensure correct antialiasing on the border
+    Vc::float_v vAntialiasingOffset(antialiasEdges ? 1.0f : 0.0f);
+
+    Vc::float_v vOne(Vc::One);
+
+    for (int i=0; i < width; i+= Vc::float_v::size()){
+
+        Vc::float_v x_ = currentIndices - vCenterX;
+
+        Vc::float_v xr = Vc::abs(x_ * vCosa - vSinaY_);
+        Vc::float_v yr = Vc::abs(x_ * vSina + vCosaY_);
+
+        Vc::float_v nxr = xr * vXCoeff;
+        Vc::float_v nyr = yr * vYCoeff;
+
+        Vc::float_m outsideMask = (nxr > vOne) | (nyr > vOne);
+
+        if (!outsideMask.isFull()) {
+            xr += vAntialiasingOffset;
+            yr += vAntialiasingOffset;
+
+            Vc::float_v fxr = xr * vTransformedFadeX;
+            Vc::float_v fyr = yr * vTransformedFadeY;
+
+            Vc::float_m xFadeMask = (fxr > vOne) & ((fxr > fyr) | (fyr < vOne));
+            Vc::float_m yFadeMask = !xFadeMask & (fyr > vOne) & ((fyr > fxr) | (fxr < vOne));
+
+            Vc::float_v vFade(Vc::Zero);
+
+            // n * (normeFade - 1) / (normeFade - n), per axis
+            vFade(xFadeMask) = nxr * (fxr - vOne) / (fxr - nxr);
+            vFade(yFadeMask) = nyr * (fyr - vOne) / (fyr - nyr);
+
+            // Mask out the outer rectangle of the mask
+            vFade(outsideMask) = vOne;
+
+            vFade.store(bufferPointer, Vc::Aligned);
+        } else {
+            // Mask out everything outside the rectangle
+            vOne.store(bufferPointer, Vc::Aligned);
+        }
+
+        currentIndices = currentIndices + increment;
+
+        bufferPointer += Vc::float_v::size();
+    }
+}
+
+struct KisGaussCircleMaskGenerator::FastRowProcessor
+{
+    FastRowProcessor(KisGaussCircleMaskGenerator *maskGenerator)
+        : d(maskGenerator->d.data()) {}
+
+    template<Vc::Implementation _impl>
+    void process(float* buffer, int width, float y, float cosa, float sina,
+                 float centerX, float centerY);
+
+    KisGaussCircleMaskGenerator::Private *d;
+};
+
+template<> void KisGaussCircleMaskGenerator::
+FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, int width, float y, float cosa, float sina,
+                                   float centerX, float centerY)
+{
+    float y_ = y - centerY;
+    float sinay_ = sina * y_;
+    float cosay_ = cosa * y_;
+
+    float* bufferPointer = buffer;
+
+    Vc::float_v currentIndices = Vc::float_v::IndexesFromZero();
+
+    Vc::float_v increment((float)Vc::float_v::size());
+    Vc::float_v vCenterX(centerX);
+
+    Vc::float_v vCosa(cosa);
+    Vc::float_v vSina(sina);
+    Vc::float_v vCosaY_(cosay_);
+    Vc::float_v vSinaY_(sinay_);
+
+    Vc::float_v vYCoeff(d->ycoef);
+    Vc::float_v vDistfactor(d->distfactor);
+    Vc::float_v vCenter(d->center);
+    Vc::float_v vAlphafactor(d->alphafactor / 255.0);
+
+    Vc::float_v vOne(Vc::One);
+
+    for (int i=0; i < width; i+= Vc::float_v::size()){
+
+        Vc::float_v x_ = currentIndices - vCenterX;
+
+        Vc::float_v xr = x_ * vCosa - vSinaY_;
+        Vc::float_v yr = x_ * vSina + vCosaY_;
+
+        Vc::float_v dist = Vc::sqrt(pow2(xr) + pow2(yr * vYCoeff));
+
+        Vc::float_v vFade(vOne);
+        Vc::float_m excludedMask = vNeedFade1D(d->fadeMaker, dist, vFade);
+
+        if (!excludedMask.isFull()) {
+            Vc::float_v scaledDist = dist * vDistfactor;
+            vFade(!excludedMask) = vOne - vAlphafactor * (vErf(scaledDist + vCenter) - vErf(scaledDist - vCenter));
+        }
+
+        vFade.store(bufferPointer, Vc::Aligned);
+
+        currentIndices = currentIndices + increment;
+
+        bufferPointer += Vc::float_v::size();
+    }
+}
+
+struct KisGaussRectangleMaskGenerator::FastRowProcessor
+{
+    FastRowProcessor(KisGaussRectangleMaskGenerator *maskGenerator)
+        : d(maskGenerator->d.data()) {}
+
+    template<Vc::Implementation _impl>
+    void process(float* buffer, int width, float y, float cosa, float sina,
+                 float centerX, float centerY);
+
+    KisGaussRectangleMaskGenerator::Private *d;
+};
+
+template<> void KisGaussRectangleMaskGenerator::
+FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, int width, float y, float cosa, float sina,
+                                   float centerX, float centerY)
+{
+    float y_ = y - centerY;
+    float sinay_ = sina * y_;
+    float cosay_ = cosa * y_;
+
+    float* bufferPointer = buffer;
+
+    Vc::float_v currentIndices = Vc::float_v::IndexesFromZero();
+
+    Vc::float_v increment((float)Vc::float_v::size());
+    Vc::float_v vCenterX(centerX);
+
+    Vc::float_v vCosa(cosa);
+    Vc::float_v vSina(sina);
+    Vc::float_v vCosaY_(cosay_);
+    Vc::float_v vSinaY_(sinay_);
+
+    Vc::float_v vXFade(d->xfade);
+    Vc::float_v vYFade(d->yfade);
+    Vc::float_v vHalfWidth(d->halfWidth);
+    Vc::float_v vHalfHeight(d->halfHeight);
+    Vc::float_v vAlphafactor(d->alphafactor / 255.0);
+
+    Vc::float_v vOne(Vc::One);
+
+    for (int i=0; i < width; i+= Vc::float_v::size()){
+
+        Vc::float_v x_ = currentIndices - vCenterX;
+
+        Vc::float_v xr = x_ * vCosa - vSinaY_;
+        Vc::float_v yr = x_ * vSina + vCosaY_;
+
+        Vc::float_v xa = Vc::abs(xr);
+        Vc::float_v ya = Vc::abs(yr);
+
+        Vc::float_m outsideMask = vOutsideLimits2D(d->fadeMaker, xa, ya);
+
+        if (!outsideMask.isFull()) {
+            Vc::float_v vFade = vOne - vAlphafactor *
+                (vErf((vHalfWidth + xa) * vXFade) + vErf((vHalfWidth - xa) * vXFade)) *
+                (vErf((vHalfHeight + ya) * vYFade) + vErf((vHalfHeight - ya) * vYFade));
+
+            vApplyFade2D(d->fadeMaker, xa, ya, vFade);
+
+            vFade(outsideMask) = vOne;
+            vFade.store(bufferPointer, Vc::Aligned);
+        } else {
+            vOne.store(bufferPointer, Vc::Aligned);
+        }
+
+        currentIndices = currentIndices + increment;
+
+        bufferPointer += Vc::float_v::size();
+    }
+}
+
+struct KisCurveCircleMaskGenerator::FastRowProcessor
+{
+    FastRowProcessor(KisCurveCircleMaskGenerator *maskGenerator)
+        : d(maskGenerator->d.data()) {}
+
+    template<Vc::Implementation _impl>
+    void process(float* buffer, int width, float y, float cosa, float sina,
+                 float centerX, float centerY);
+
+    KisCurveCircleMaskGenerator::Private *d;
+};
+
+template<> void KisCurveCircleMaskGenerator::
+FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, int width, float y, float cosa, float sina,
+                                   float centerX, float centerY)
+{
+    float y_ = y - centerY;
+    float sinay_ = sina * y_;
+    float cosay_ = cosa * y_;
+
+    float* bufferPointer = buffer;
+
+    Vc::float_v currentIndices = Vc::float_v::IndexesFromZero();
+
+    Vc::float_v increment((float)Vc::float_v::size());
+    Vc::float_v vCenterX(centerX);
+
+    Vc::float_v vCosa(cosa);
+    Vc::float_v vSina(sina);
+    Vc::float_v vCosaY_(cosay_);
+    Vc::float_v vSinaY_(sinay_);
+
+    Vc::float_v vXCoeff(d->xcoef);
+    Vc::float_v vYCoeff(d->ycoef);
+    Vc::float_v vCurveResolution(d->curveResolution);
+
+    Vc::float_v vOne(Vc::One);
+
+    const qreal *curveData = d->curveData.constData();
+    const int maxIndex = d->curveData.size() - 2;
+
+    for (int i=0; i < width; i+= Vc::float_v::size()){
+
+        Vc::float_v x_ = currentIndices - vCenterX;
+
+        Vc::float_v xr = x_ * vCosa - vSinaY_;
+        Vc::float_v yr = x_ * vSina + vCosaY_;
+
+        Vc::float_v dist = pow2(xr * vXCoeff) + pow2(yr * vYCoeff);
+
+        Vc::float_v vFade(vOne);
+        Vc::float_m excludedMask = vNeedFade1D(d->fadeMaker, dist, vFade);
+
+        if (!excludedMask.isFull()) {
+            Vc::float_v distance = dist * vCurveResolution;
+
+            /**
+             * The curve is a lookup table, so there is no way
+             * to avoid the per-lane gather here
+             */
+            for (int j = 0; j < int(Vc::float_v::size()); j++) {
+                if (excludedMask[j]) continue;
+
+                const float laneDistance = distance[j];
+                const int index = qBound(0, int(laneDistance), maxIndex);
+                const float fraction = laneDistance - index;
+
+                const float alpha = float((1.0f - fraction) * curveData[index] + fraction * curveData[index + 1]);
+                vFade[j] = 1.0f - alpha;
+            }
+        }
+
+        vFade.store(bufferPointer, Vc::Aligned);
+
+        currentIndices = currentIndices + increment;
+
+        bufferPointer += Vc::float_v::size();
+    }
+}
+
+struct KisCurveRectangleMaskGenerator::FastRowProcessor
+{
+    FastRowProcessor(KisCurveRectangleMaskGenerator *maskGenerator)
+        : d(maskGenerator->d) {}
+
+    template<Vc::Implementation _impl>
+    void process(float* buffer, int width, float y, float cosa, float sina,
+                 float centerX, float centerY);
+
+    KisCurveRectangleMaskGenerator::Private *d;
+};
+
+template<> void KisCurveRectangleMaskGenerator::
+FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, int width, float y, float cosa, float sina,
+                                   float centerX, float centerY)
+{
+    float y_ = y - centerY;
+    float sinay_ = sina * y_;
+    float cosay_ = cosa * y_;
+
+    float* bufferPointer = buffer;
+
+    Vc::float_v currentIndices = Vc::float_v::IndexesFromZero();
+
+    Vc::float_v increment((float)Vc::float_v::size());
+    Vc::float_v vCenterX(centerX);
+
+    Vc::float_v vCosa(cosa);
+    Vc::float_v vSina(sina);
+    Vc::float_v vCosaY_(cosay_);
+    Vc::float_v vSinaY_(sinay_);
+
+    Vc::float_v vXCoeff(d->xcoeff * d->curveResolution);
+    Vc::float_v vYCoeff(d->ycoeff * d->curveResolution);
+
+    Vc::float_v vOne(Vc::One);
+
+    const qreal *curveData = d->curveData.constData();
+    const int curveResolution = d->curveResolution;
+    const int maxIndex = d->curveData.size() - 1;
+
+    for (int i=0; i < width; i+= Vc::float_v::size()){
+
+        Vc::float_v x_ = currentIndices - vCenterX;
+
+        Vc::float_v xr = x_ * vCosa - vSinaY_;
+        Vc::float_v yr = x_ * vSina + vCosaY_;
+
+        Vc::float_v xa = Vc::abs(xr);
+        Vc::float_v ya = Vc::abs(yr);
+
+        Vc::float_m outsideMask = vOutsideLimits2D(d->fadeMaker, xa, ya);
+
+        if (!outsideMask.isFull()) {
+            Vc::float_v sPos = xa * vXCoeff;
+            Vc::float_v tPos = ya * vYCoeff;
+
+            Vc::float_v vFade(vOne);
+
+            // the curve lookup is a per-lane gather
+            for (int j = 0; j < int(Vc::float_v::size()); j++) {
+                if (outsideMask[j]) continue;
+
+                const int sIndex = qBound(0, qRound(sPos[j]), maxIndex);
+                const int tIndex = qBound(0, qRound(tPos[j]), maxIndex);
+                const int sIndexInverted = qBound(0, curveResolution - sIndex, maxIndex);
+                const int tIndexInverted = qBound(0, curveResolution - tIndex, maxIndex);
+
+                const qreal blend = curveData[sIndex] * (1.0 - curveData[sIndexInverted]) *
+                    curveData[tIndex] * (1.0 - curveData[tIndexInverted]);
+
+                vFade[j] = float(1.0 - blend);
+            }
+
+            vApplyFade2D(d->fadeMaker, xa, ya, vFade);
+
+            vFade(outsideMask) = vOne;
+            vFade.store(bufferPointer, Vc::Aligned);
+        } else {
+            vOne.store(bufferPointer, Vc::Aligned);
+        }
+
+        currentIndices = currentIndices + increment;
+
+        bufferPointer += Vc::float_v::size();
+    }
+}
+
 #endif /* defined HAVE_VC */
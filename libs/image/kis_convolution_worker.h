@@ -25,7 +25,9 @@
 #include "kis_iterator_ng.h"
 #include "kis_repeat_iterators_pixel.h"
 #include "kis_painter.h"
+#include "kis_paint_device.h"
 #include <QBitArray>
+#include <QVector>
 
 struct StandardIteratorFactory {
     typedef KisHLineIteratorSP HLineIterator;
@@ -26,6 +26,7 @@
 
 #include "kis_convolution_worker.h"
 #include "kis_math_toolbox.h"
+#include "KisFFTWPlanCache.h"
 
 #include <QMutex>
 #include <QVector>
@@ -35,16 +36,6 @@
 
 #include <fftw3.h>
 
-template<class _IteratorFactory_> class KisConvolutionWorkerFFT;
-class KisConvolutionWorkerFFTLock
-{
-private:
-    static QMutex fftwMutex;
-    template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
-};
-
-QMutex KisConvolutionWorkerFFTLock::fftwMutex;
-
 
 template<class _IteratorFactory_>
 class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
@@ -52,8 +43,7 @@ class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
 public:
     KisConvolutionWorkerFFT(KisPainter *painter, KoUpdater *progress)
         : KisConvolutionWorker<_IteratorFactory_>(painter, progress),
-          m_currentProgress(0),
-          m_kernelFFT(0)
+          m_currentProgress(0)
     {
     }
 
@@ -79,92 +69,17 @@ public:
         addToProgress(0);
         if (isInterrupted()) return;
 
-        const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
-        const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
-
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
-
-        /**
-         * FIXME: check whether this "optimization" is needed to
-         * be uncommented. My tests showed about 30% better performance
-         * when the line is commented out (DK).
-         */
-        //optimumDimensions(m_fftWidth, m_fftHeight);
-
-        m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
-        m_extraMem = (m_fftWidth % 2) ? 1 : 2;
-
-        // create and fill kernel
-        m_kernelFFT = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
-        memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
-        fftFillKernelMatrix(kernel, m_kernelFFT);
-
         // find out which channels need convolving
         QList<KoChannelInfo*> convChannelList = this->convolvableChannelList(src);
 
-        m_channelFFT.resize(convChannelList.count());
-        for (auto i = m_channelFFT.begin(); i != m_channelFFT.end(); ++i) {
-            *i = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
-        }
-
-        const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
-        const double fftScale = 1.0 / (m_fftHeight * m_fftWidth) / kernelFactor;
-
-        FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
-        int cacheRowStride = m_fftWidth + m_extraMem;
-
-        fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
-                                  m_fftWidth,
-                                  m_fftHeight),
-                            cacheRowStride,
-                            info, dataRect);
-
-        addToProgress(10);
-        if (isInterrupted()) return;
-
-        // calculate number off fft operations required for progress reporting
-        const float progressPerFFT = (100 - 30) / (double)(convChannelList.count() * 2 + 1);
-
-        // perform FFT
-        fftw_plan fftwPlanForward, fftwPlanBackward;
-
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftwPlanForward = fftw_plan_dft_r2c_2d(m_fftHeight, m_fftWidth, (double*)m_kernelFFT, m_kernelFFT, FFTW_ESTIMATE);
-        fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
-
-        fftw_execute(fftwPlanForward);
-        addToProgress(progressPerFFT);
-        if (isInterrupted()) return;
-
-        for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k)
-        {
-            fftw_execute_dft_r2c(fftwPlanForward, (double*)(*k), *k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-
-            fftMultiply(*k, m_kernelFFT);
-
-            fftw_execute_dft_c2r(fftwPlanBackward, *k, (double*)*k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
+#ifdef HAVE_FFTW3F
+        if (canUseSinglePrecision(convChannelList)) {
+            executeImpl<float>(kernel, src, srcPos, dstPos, areaSize, dataRect, convChannelList);
+            return;
         }
+#endif
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftw_destroy_plan(fftwPlanForward);
-        fftw_destroy_plan(fftwPlanBackward);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
-
-
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
-                            info, dataRect);
-
-        addToProgress(20);
-        cleanUp();
+        executeImpl<double>(kernel, src, srcPos, dstPos, areaSize, dataRect, convChannelList);
     }
 
     struct FFTInfo {
@@ -218,11 +133,47 @@ public:
         int alphaRealPos;
     };
 
+    /**
+     * The layout of one FFT frame. All the tiles of one execute() call
+     * share the same frame, so they can share the plans and the
+     * transformed kernel as well.
+     */
+    struct FFTGeometry {
+        FFTGeometry(int _fftWidth, int _fftHeight, int _halfKernelWidth, int _halfKernelHeight)
+            : fftWidth(_fftWidth),
+              fftHeight(_fftHeight),
+              halfKernelWidth(_halfKernelWidth),
+              halfKernelHeight(_halfKernelHeight),
+              cacheRowStride(2 * (_fftWidth / 2 + 1)),
+              fftLength(_fftHeight * (_fftWidth / 2 + 1))
+        {
+        }
+
+        /**
+         * The size of the tile whose convolution is fully
+         * defined by the data inside the frame
+         */
+        QSize tileSize() const {
+            return QSize(fftWidth - 2 * halfKernelWidth,
+                         fftHeight - 2 * halfKernelHeight);
+        }
+
+        int fftWidth;
+        int fftHeight;
+        int halfKernelWidth;
+        int halfKernelHeight;
+
+        int cacheRowStride; ///< in real numbers, the rows are padded for the in-place transform
+        int fftLength; ///< in complex numbers
+    };
+
+    template <typename T>
     void fillCacheFromDevice(KisPaintDeviceSP src,
                              const QRect &rect,
                              const int cacheRowStride,
                              const FFTInfo &info,
-                             const QRect &dataRect) {
+                             const QRect &dataRect,
+                             const QVector<typename KisFFTWTraits<T>::Complex*> &channelFFT) {
 
         typename _IteratorFactory_::HLineConstIterator hitSrc =
             _IteratorFactory_::createHLineConstIterator(src,
@@ -230,22 +181,22 @@ public:
                                                         dataRect);
 
         const int channelCount = info.numChannels();
-        QVector<double*> channelPtr(channelCount);
+        QVector<T*> channelPtr(channelCount);
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channelFFT.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
-            *i = (double*)*iFFt;
+            *i = (T*)*iFFt;
         }
 
         // prepare cache, reused in all loops
-        QVector<double*> cacheRowStart(channelCount);
+        QVector<T*> cacheRowStart(channelCount);
         const auto cacheRowStartBegin = cacheRowStart.begin();
 
         for (int y = 0; y < rect.height(); ++y) {
             // cache current channelPtr in cacheRowStart
-            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(double*));
+            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(T*));
 
             for (int x = 0; x < rect.width(); ++x) {
                 const quint8 *data = hitSrc->oldRawData();
@@ -287,11 +238,11 @@ public:
         }
     }
 
-    template <bool additionalMultiplierActive>
+    template <bool additionalMultiplierActive, typename T>
     inline qreal writeOneChannelFromCache(quint8* dstPtr,
                                           const quint32 channel,
                                           const FFTInfo &info,
-                                          double* channelValuePtr,
+                                          T* channelValuePtr,
                                           const qreal additionalMultiplier = 0.0) {
         qreal channelPixelValue;
 
@@ -308,12 +259,14 @@ public:
         return channelPixelValue;
     }
 
+    template <typename T>
     void writeResultToDevice(const QRect &rect,
                              const int cacheRowStride,
                              const int halfKernelWidth,
                              const int halfKernelHeight,
                              const FFTInfo &info,
-                             const QRect &dataRect) {
+                             const QRect &dataRect,
+                             const QVector<typename KisFFTWTraits<T>::Complex*> &channelFFT) {
 
         typename _IteratorFactory_::HLineIterator hitDst =
             _IteratorFactory_::createHLineIterator(this->m_painter->device(),
@@ -323,22 +276,22 @@ public:
         int initialOffset = cacheRowStride * halfKernelHeight + halfKernelWidth;
 
         const int channelCount = info.numChannels();
-        QVector<double*> channelPtr(channelCount);
+        QVector<T*> channelPtr(channelCount);
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channelFFT.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
-            *i = (double*)*iFFt + initialOffset;
+            *i = (T*)*iFFt + initialOffset;
         }
 
         // prepare cache, reused in all loops
-        QVector<double*> cacheRowStart(channelCount);
+        QVector<T*> cacheRowStart(channelCount);
         const auto cacheRowStartBegin = cacheRowStart.begin();
 
         for (int y = 0; y < rect.height(); ++y) {
             // cache current channelPtr in cacheRowStart
-            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(double*));
+            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(T*));
 
             for (int x = 0; x < rect.width(); ++x) {
                 quint8 *dstPtr = hitDst->rawData();
@@ -400,42 +353,239 @@ public:
     }
 
 private:
-    void fftFillKernelMatrix(const KisConvolutionKernelSP kernel, fftw_complex *m_kernelFFT)
+    /**
+     * The minimal size of the FFT frame of a tile. The frame is
+     * also made at least four times bigger than the kernel, so that
+     * the overlapping borders of the tiles do not dominate the cost.
+     */
+    static const int minimalTileFFTSize = 512;
+
+    /**
+     * The tiles bigger than that are planned with FFTW_ESTIMATE,
+     * because measuring them would take longer than the filter itself.
+     */
+    static const int maxMeasuredFFTArea = 2048 * 2048;
+
+#ifdef HAVE_FFTW3F
+    /**
+     * The rounding error of the single precision transform is well
+     * below the quantization step of 8-bit channels, so they are
+     * convolved in floats. Deeper channels keep double precision.
+     */
+    static bool canUseSinglePrecision(const QList<KoChannelInfo*> &convChannelList)
+    {
+        Q_FOREACH (KoChannelInfo *channel, convChannelList) {
+            if (channel->channelValueType() != KoChannelInfo::UINT8 &&
+                channel->channelValueType() != KoChannelInfo::INT8) {
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+#endif
+
+    template <typename T>
+    void executeImpl(const KisConvolutionKernelSP kernel, const KisPaintDeviceSP src,
+                     const QPoint &srcPos, const QPoint &dstPos, const QSize &areaSize,
+                     const QRect& dataRect, const QList<KoChannelInfo*> &convChannelList)
+    {
+        typedef KisFFTWTraits<T> Traits;
+        typedef typename Traits::Complex Complex;
+
+        const int halfKernelWidth = (kernel->width() - 1) / 2;
+        const int halfKernelHeight = (kernel->height() - 1) / 2;
+
+        const int tileFFTWidth = KisFFTWPlanCache::optimalSize(qMax(int(minimalTileFFTSize), 4 * int(kernel->width())));
+        const int tileFFTHeight = KisFFTWPlanCache::optimalSize(qMax(int(minimalTileFFTSize), 4 * int(kernel->height())));
+
+        const bool needsSplit =
+            areaSize.width() + 2 * halfKernelWidth > tileFFTWidth ||
+            areaSize.height() + 2 * halfKernelHeight > tileFFTHeight;
+
+        int fftWidth = 0;
+        int fftHeight = 0;
+
+        typename Traits::Plan fftwPlanForward;
+        typename Traits::Plan fftwPlanBackward;
+
+        /**
+         * Only the plans for the tile sizes are cached, they depend on
+         * the size of the kernel only. The area that fits into a single
+         * frame gets one-off plans of its own size, caching them would
+         * keep a plan for every size of the update rect ever filtered.
+         */
+        if (needsSplit) {
+            fftWidth = tileFFTWidth;
+            fftHeight = tileFFTHeight;
+
+            const KisFFTWPlanCache::Rigor rigor =
+                fftWidth * fftHeight <= maxMeasuredFFTArea ?
+                KisFFTWPlanCache::Measure : KisFFTWPlanCache::Estimate;
+
+            KisFFTWPlanCache::instance()->plans(fftWidth, fftHeight, rigor, &fftwPlanForward, &fftwPlanBackward);
+        } else {
+            fftWidth = KisFFTWPlanCache::optimalSize(areaSize.width() + 2 * halfKernelWidth);
+            fftHeight = KisFFTWPlanCache::optimalSize(areaSize.height() + 2 * halfKernelHeight);
+
+            KisFFTWPlanCache::instance()->createPlans(fftWidth, fftHeight, &fftwPlanForward, &fftwPlanBackward);
+        }
+
+        const FFTGeometry geometry(fftWidth, fftHeight, halfKernelWidth, halfKernelHeight);
+
+        QVector<QRect> tiles;
+        const QRect dstRect(dstPos, areaSize);
+        const QSize tileSize = geometry.tileSize();
+
+        for (int y = dstRect.y(); y <= dstRect.bottom(); y += tileSize.height()) {
+            for (int x = dstRect.x(); x <= dstRect.right(); x += tileSize.width()) {
+                tiles << (QRect(QPoint(x, y), tileSize) & dstRect);
+            }
+        }
+
+        // create and fill kernel
+        Complex *kernelFFT = Traits::allocate(geometry.fftLength);
+        memset(kernelFFT, 0, sizeof(Complex) * geometry.fftLength);
+        fftFillKernelMatrix(kernel, (T*)kernelFFT, geometry);
+        Traits::executeForward(fftwPlanForward, (T*)kernelFFT, kernelFFT);
+
+        const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
+        const double fftScale = 1.0 / (fftHeight * fftWidth) / kernelFactor;
+
+        const FFTInfo info(fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
+        const QPoint srcOffset = srcPos - dstPos;
+
+        auto releaseResources = [&] () {
+            Traits::release(kernelFFT);
+
+            if (!needsSplit) {
+                KisFFTWPlanCache::instance()->destroyPlans(fftwPlanForward, fftwPlanBackward);
+            }
+        };
+
+        addToProgress(10);
+        if (isInterrupted()) {
+            releaseResources();
+            return;
+        }
+
+        /**
+         * The tiles are convolved one by one, they only bound the
+         * size of the frames. The filter stroke splits big areas into
+         * bands processed by separate jobs, so the worker doesn't
+         * spawn any threads itself.
+         */
+        const float progressPerTile = (100 - 30) / float(tiles.size());
+
+        Q_FOREACH (const QRect &tileRect, tiles) {
+            processTile<T>(tileRect, srcOffset, src, dataRect, info, geometry,
+                           kernelFFT, fftwPlanForward, fftwPlanBackward);
+
+            addToProgress(progressPerTile);
+            if (isInterrupted()) {
+                releaseResources();
+                return;
+            }
+        }
+
+        releaseResources();
+        addToProgress(20);
+    }
+
+    template <typename T>
+    void processTile(const QRect &dstTileRect,
+                     const QPoint &srcOffset,
+                     const KisPaintDeviceSP src,
+                     const QRect &dataRect,
+                     const FFTInfo &info,
+                     const FFTGeometry &geometry,
+                     const typename KisFFTWTraits<T>::Complex *kernelFFT,
+                     typename KisFFTWTraits<T>::Plan fftwPlanForward,
+                     typename KisFFTWTraits<T>::Plan fftwPlanBackward)
+    {
+        typedef KisFFTWTraits<T> Traits;
+        typedef typename Traits::Complex Complex;
+
+        const QRect srcFrameRect(dstTileRect.topLeft() + srcOffset -
+                                 QPoint(geometry.halfKernelWidth, geometry.halfKernelHeight),
+                                 dstTileRect.size() +
+                                 QSize(2 * geometry.halfKernelWidth, 2 * geometry.halfKernelHeight));
+
+        /**
+         * The tiles on the border of the area do not fill the whole
+         * frame, the rest of it must be zeroed to not wrap around
+         */
+        const bool partialFrame =
+            srcFrameRect.width() < geometry.fftWidth ||
+            srcFrameRect.height() < geometry.fftHeight;
+
+        QVector<Complex*> channelFFT(info.numChannels());
+        for (auto i = channelFFT.begin(); i != channelFFT.end(); ++i) {
+            *i = Traits::allocate(geometry.fftLength);
+
+            if (partialFrame) {
+                memset(*i, 0, sizeof(Complex) * geometry.fftLength);
+            }
+        }
+
+        fillCacheFromDevice<T>(src, srcFrameRect, geometry.cacheRowStride, info, dataRect, channelFFT);
+
+        for (auto k = channelFFT.begin(); k != channelFFT.end(); ++k) {
+            Traits::executeForward(fftwPlanForward, (T*)(*k), *k);
+            fftMultiply<T>(*k, kernelFFT, geometry.fftLength);
+            Traits::executeBackward(fftwPlanBackward, *k, (T*)(*k));
+        }
+
+        writeResultToDevice<T>(dstTileRect, geometry.cacheRowStride,
+                               geometry.halfKernelWidth, geometry.halfKernelHeight,
+                               info, dataRect, channelFFT);
+
+        Q_FOREACH (Complex *channel, channelFFT) {
+            Traits::release(channel);
+        }
+    }
+
+    template <typename T>
+    void fftFillKernelMatrix(const KisConvolutionKernelSP kernel, T *kernelData, const FFTGeometry &geometry)
     {
         // find central item
         QPoint offset((kernel->width() - 1) / 2, (kernel->height() - 1) / 2);
 
-        qint32 xShift = m_fftWidth - offset.x();
-        qint32 yShift = m_fftHeight - offset.y();
+        qint32 xShift = geometry.fftWidth - offset.x();
+        qint32 yShift = geometry.fftHeight - offset.y();
 
-        quint32 absXpos, absYpos;
+        qint32 absXpos, absYpos;
 
         for (quint32 y = 0; y < kernel->height(); y++)
         {
             absYpos = y + yShift;
-            if (absYpos >= m_fftHeight)
-                absYpos -= m_fftHeight;
+            if (absYpos >= geometry.fftHeight)
+                absYpos -= geometry.fftHeight;
 
             for (quint32 x = 0; x < kernel->width(); x++)
             {
                 absXpos = x + xShift;
-                if (absXpos >= m_fftWidth)
-                    absXpos -= m_fftWidth;
+                if (absXpos >= geometry.fftWidth)
+                    absXpos -= geometry.fftWidth;
 
-                ((double*)m_kernelFFT)[(m_fftWidth + m_extraMem) * absYpos + absXpos] = kernel->data()->coeff(y, x);
+                kernelData[geometry.cacheRowStride * absYpos + absXpos] = kernel->data()->coeff(y, x);
             }
         }
     }
 
-    void fftMultiply(fftw_complex* channel, fftw_complex* kernel)
+    template <typename T>
+    static void fftMultiply(typename KisFFTWTraits<T>::Complex* channel,
+                            const typename KisFFTWTraits<T>::Complex* kernel,
+                            const int fftLength)
     {
         // perform complex multiplication
-        fftw_complex *channelPtr = channel;
-        fftw_complex *kernelPtr = kernel;
+        typename KisFFTWTraits<T>::Complex *channelPtr = channel;
+        const typename KisFFTWTraits<T>::Complex *kernelPtr = kernel;
 
-        fftw_complex tmp;
+        T tmp[2];
 
-        for (quint32 pixelPos = 0; pixelPos < m_fftLength; ++pixelPos)
+        for (int pixelPos = 0; pixelPos < fftLength; ++pixelPos)
         {
             tmp[0] = ((*channelPtr)[0] * (*kernelPtr)[0]) - ((*channelPtr)[1] * (*kernelPtr)[1]);
             tmp[1] = ((*channelPtr)[0] * (*kernelPtr)[1]) + ((*channelPtr)[1] * (*kernelPtr)[0]);
@@ -448,47 +598,27 @@ private:
         }
     }
 
-    void optimumDimensions(quint32& w, quint32& h)
+    template <typename T>
+    void fftLogMatrix(T* channel, const FFTGeometry &geometry, const QString &f)
     {
-        // FFTW is most efficient when array size is a factor of 2, 3, 5 or 7
-        quint32 optW = w, optH = h;
+        static QMutex logMutex;
+        QMutexLocker l(&logMutex);
 
-        while ((optW % 2 != 0) || (optW % 3 != 0) || (optW % 5 != 0) || (optW % 7 != 0))
-            ++optW;
-
-        while ((optH % 2 != 0) || (optH % 3 != 0) || (optH % 5 != 0) || (optH % 7 != 0))
-            ++optH;
-
-        quint32 optAreaW = optW * h;
-        quint32 optAreaH = optH * w;
-
-        if (optAreaW < optAreaH) {
-            w = optW;
-        }
-        else {
-            h = optH;
-        }
-    }
-
-    void fftLogMatrix(double* channel, const QString &f)
-    {
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
         QString filename(QDir::homePath() + "/log_" + f + ".txt");
         dbgKrita << "Log File Name: " << filename;
         QFile file (filename);
         if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
         {
             dbgKrita << "Failed";
-            KisConvolutionWorkerFFTLock::fftwMutex.unlock();
             return;
         }
 
         QTextStream in(&file);
-        for (quint32 y = 0; y < m_fftHeight; y++)
+        for (int y = 0; y < geometry.fftHeight; y++)
         {
-            for (quint32 x = 0; x < m_fftWidth; x++)
+            for (int x = 0; x < geometry.fftWidth; x++)
             {
-                QString num = QString::number(channel[y * m_fftWidth + x]);
+                QString num = QString::number(channel[y * geometry.cacheRowStride + x]);
                 while (num.length() < 15)
                     num += " ";
 
@@ -496,7 +626,6 @@ private:
             }
             in << "\n";
         }
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
     }
 
     void addToProgress(float amount)
@@ -510,32 +639,11 @@ private:
 
     bool isInterrupted()
     {
-        if (this->m_progress && this->m_progress->interrupted()) {
-            cleanUp();
-            return true;
-        }
-
-        return false;
+        return this->m_progress && this->m_progress->interrupted();
     }
 
-    void cleanUp()
-    {
-        // free kernel fft data
-        if (m_kernelFFT) {
-            fftw_free(m_kernelFFT);
-        }
-
-        Q_FOREACH (fftw_complex *channel, m_channelFFT) {
-            fftw_free(channel);
-        }
-        m_channelFFT.clear();
-    }
 private:
-    quint32 m_fftWidth, m_fftHeight, m_fftLength, m_extraMem;
     float m_currentProgress;
-
-    fftw_complex* m_kernelFFT;
-    QVector<fftw_complex*> m_channelFFT;
 };
 
 #endif
@@ -31,8 +31,7 @@ public:
         : KisConvolutionWorker<_IteratorFactory_>(painter, progress)
         ,  m_alphaCachePos(-1)
         ,  m_alphaRealPos(-1)
-        ,  m_pixelPtrCache(0)
-        ,  m_pixelPtrCacheCopy(0)
+        ,  m_kernelData(0)
         ,  m_minClamp(0)
         ,  m_maxClamp(0)
         ,  m_absoluteOffset(0)
@@ -40,6 +39,7 @@ public:
     }
 
     ~KisConvolutionWorkerSpatial() override {
+        cleanUp();
     }
 
     inline void loadPixelToCache(qreal **cache, const quint8 *data, int index) {
@@ -66,7 +66,7 @@ public:
         m_khalfHeight = (m_kh - 1) / 2;
         m_cacheSize = m_kw * m_kh;
         m_pixelSize = src->colorSpace()->pixelSize();
-        quint32 channelCount = src->colorSpace()->channelCount();
+        m_channelCount = src->colorSpace()->channelCount();
 
         m_kernelData = new qreal[m_cacheSize];
         qreal *kernelDataPtr = m_kernelData;
@@ -108,21 +108,6 @@ public:
         if (hasProgressUpdater)
             this->m_progress->setProgress(0);
 
-        // Iterate over all pixels in our rect, create a cache of pixels around the current pixel and convolve them.
-        m_pixelPtrCache = new qreal*[m_cacheSize];
-        m_pixelPtrCacheCopy = new qreal*[m_cacheSize];
-        for (quint32 c = 0; c < m_cacheSize; ++c) {
-            m_pixelPtrCache[c] = new qreal[channelCount];
-            m_pixelPtrCacheCopy[c] = new qreal[channelCount];
-        }
-
-        // decide caching strategy
-        enum TraversingDirection { Horizontal, Vertical };
-        TraversingDirection traversingDirection = Vertical;
-        if (m_kw > m_kh) {
-            traversingDirection = Horizontal;
-        }
-
         KisMathToolbox mathToolbox;
         m_toDoubleFuncPtr = QVector<PtrToDouble>(m_convolveChannelsNo);
         if (!mathToolbox.getToDoubleChannelPtr(m_convChannelList, m_toDoubleFuncPtr))
@@ -142,6 +127,37 @@ public:
             m_absoluteOffset[i] = (m_maxClamp[i] - m_minClamp[i]) * kernel->offset();
         }
 
+        processArea(src, QRect(srcPos, areaSize), dstPos, dataRect, hasProgressUpdater);
+    }
+
+    /**
+     * Convolves \p srcRect of \p src and writes the result at \p dstPos
+     * of the painter's device. Every call has its own pixel cache.
+     *
+     * @return false if the operation was cancelled
+     */
+    bool processArea(const KisPaintDeviceSP src, const QRect &srcRect, QPoint dstPos, const QRect &dataRect, bool reportProgress) {
+        const QPoint srcPos = srcRect.topLeft();
+        const QSize areaSize = srcRect.size();
+
+        // Iterate over all pixels in our rect, create a cache of pixels around the current pixel and convolve them.
+        QVector<qreal> cacheData(2 * m_cacheSize * m_channelCount);
+        QVector<qreal*> pixelPtrCache(m_cacheSize);
+        QVector<qreal*> pixelPtrCacheCopy(m_cacheSize);
+        for (quint32 c = 0; c < m_cacheSize; ++c) {
+            pixelPtrCache[c] = cacheData.data() + c * m_channelCount;
+            pixelPtrCacheCopy[c] = cacheData.data() + (m_cacheSize + c) * m_channelCount;
+        }
+        qreal **cache = pixelPtrCache.data();
+        qreal **cacheCopy = pixelPtrCacheCopy.data();
+
+        // decide caching strategy
+        enum TraversingDirection { Horizontal, Vertical };
+        TraversingDirection traversingDirection = Vertical;
+        if (m_kw > m_kh) {
+            traversingDirection = Horizontal;
+        }
+
         qint32 row = srcPos.y();
         qint32 col = srcPos.x();
 
@@ -152,7 +168,7 @@ public:
         for (quint32 krow = 0; krow < m_kh; ++krow) {
             do {
                 const quint8* data = hitInitSrc->oldRawData();
-                loadPixelToCache(m_pixelPtrCacheCopy, data, i);
+                loadPixelToCache(cacheCopy, data, i);
                 ++i;
             } while (hitInitSrc->nextPixel());
             hitInitSrc->nextRow();
@@ -160,7 +176,7 @@ public:
 
 
         if (traversingDirection == Horizontal) {
-            if(hasProgressUpdater) {
+            if(reportProgress) {
                 this->m_progress->setRange(0, areaSize.height());
             }
             typename _IteratorFactory_::HLineIterator hitDst = _IteratorFactory_::createHLineIterator(this->m_painter->device(), dstPos.x(), dstPos.y(), areaSize.width(), dataRect);
@@ -170,19 +186,19 @@ public:
             for (int prow = 0; prow < areaSize.height(); ++prow) {
                 // reload cache from copy
                 for (quint32 i = 0; i < m_cacheSize; ++i)
-                    memcpy(m_pixelPtrCache[i], m_pixelPtrCacheCopy[i], channelCount * sizeof(qreal));
+                    memcpy(cache[i], cacheCopy[i], m_channelCount * sizeof(qreal));
 
                 typename _IteratorFactory_::VLineConstIterator kitSrc = _IteratorFactory_::createVLineConstIterator(src, col + m_khalfWidth, row - m_khalfHeight, m_kh, dataRect);
                 for (int pcol = 0; pcol < areaSize.width(); ++pcol) {
                     // write original channel values
                     memcpy(hitDst->rawData(), hitSrc->oldRawData(), m_pixelSize);
-                    convolveCache(hitDst->rawData());
+                    convolveCache(hitDst->rawData(), cache);
 
                     ++col;
                     kitSrc->nextColumn();
                     hitDst->nextPixel();
                     hitSrc->nextPixel();
-                    moveKernelRight(kitSrc, m_pixelPtrCache);
+                    moveKernelRight(kitSrc, cache);
                 }
 
                 row++;
@@ -191,20 +207,19 @@ public:
                 hitSrc->nextRow();
                 col = srcPos.x();
 
-                moveKernelDown(khitSrc, m_pixelPtrCacheCopy);
+                moveKernelDown(khitSrc, cacheCopy);
 
-                if (hasProgressUpdater) {
+                if (reportProgress) {
                     this->m_progress->setValue(prow);
 
                     if (this->m_progress->interrupted()) {
-                        cleanUp();
-                        return;
+                        return false;
                     }
                 }
 
             }
         } else if (traversingDirection == Vertical) {
-            if(hasProgressUpdater) {
+            if(reportProgress) {
                 this->m_progress->setRange(0, areaSize.width());
             }
             typename _IteratorFactory_::VLineIterator vitDst = _IteratorFactory_::createVLineIterator(this->m_painter->device(), dstPos.x(), dstPos.y(), areaSize.height(), dataRect);
@@ -214,19 +229,19 @@ public:
             for (int pcol = 0; pcol < areaSize.width(); pcol++) {
                 // reload cache from copy
                 for (quint32 i = 0; i < m_cacheSize; ++i)
-                    memcpy(m_pixelPtrCache[i], m_pixelPtrCacheCopy[i], channelCount * sizeof(qreal));
+                    memcpy(cache[i], cacheCopy[i], m_channelCount * sizeof(qreal));
 
                 typename _IteratorFactory_::HLineConstIterator khitSrc = _IteratorFactory_::createHLineConstIterator(src, col - m_khalfWidth, row + m_khalfHeight, m_kw, dataRect);
                 for (int prow = 0; prow < areaSize.height(); prow++) {
                     // write original channel values
                     memcpy(vitDst->rawData(), vitSrc->oldRawData(), m_pixelSize);
-                    convolveCache(vitDst->rawData());
+                    convolveCache(vitDst->rawData(), cache);
 
                     ++row;
                     khitSrc->nextRow();
                     vitDst->nextPixel();
                     vitSrc->nextPixel();
-                    moveKernelDown(khitSrc, m_pixelPtrCache);
+                    moveKernelDown(khitSrc, cache);
                 }
 
                 ++col;
@@ -235,19 +250,19 @@ public:
                 vitSrc->nextColumn();
                 row = srcPos.y();
 
-                moveKernelRight(kitSrc, m_pixelPtrCacheCopy);
+                moveKernelRight(kitSrc, cacheCopy);
 
-                if (hasProgressUpdater) {
+                if (reportProgress) {
                     this->m_progress->setValue(pcol);
 
                     if (this->m_progress->interrupted()) {
-                        cleanUp();
-                        return;
+                        return false;
                     }
                 }
             }
         }
-        cleanUp();
+
+        return true;
     }
 
     inline void limitValue(qreal *value, qreal lowBound, qreal highBound) {
@@ -260,11 +275,11 @@ public:
     }
 
     template <bool additionalMultiplierActive>
-    inline qreal convolveOneChannelFromCache(quint8* dstPtr, quint32 channel, qreal additionalMultiplier = 0.0) {
+    inline qreal convolveOneChannelFromCache(quint8* dstPtr, qreal **pixelPtrCache, quint32 channel, qreal additionalMultiplier = 0.0) {
         qreal interimConvoResult = 0;
 
         for (quint32 pIndex = 0; pIndex < m_cacheSize; ++pIndex) {
-            qreal cacheValue = m_pixelPtrCache[pIndex][channel];
+            qreal cacheValue = pixelPtrCache[pIndex][channel];
             interimConvoResult += m_kernelData[m_cacheSize - pIndex - 1] * cacheValue;
         }
 
@@ -283,9 +298,9 @@ public:
         return channelPixelValue;
     }
 
-    inline void convolveCache(quint8* dstPtr) {
+    inline void convolveCache(quint8* dstPtr, qreal **pixelPtrCache) {
         if (m_alphaCachePos >= 0) {
-            qreal alphaValue = convolveOneChannelFromCache<false>(dstPtr, m_alphaCachePos);
+            qreal alphaValue = convolveOneChannelFromCache<false>(dstPtr, pixelPtrCache, m_alphaCachePos);
 
             // TODO: we need a special case for applying LoG filter,
             // when the alpha i suniform and therefore should not be
@@ -297,7 +312,7 @@ public:
 
                 for (quint32 k = 0; k < m_convolveChannelsNo; ++k) {
                     if (k == (quint32)m_alphaCachePos) continue;
-                    convolveOneChannelFromCache<true>(dstPtr, k, alphaValueInv);
+                    convolveOneChannelFromCache<true>(dstPtr, pixelPtrCache, k, alphaValueInv);
                 }
             } else {
                 for (quint32 k = 0; k < m_convolveChannelsNo; ++k) {
@@ -310,7 +325,7 @@ public:
             }
         } else {
             for (quint32 k = 0; k < m_convolveChannelsNo; ++k) {
-                convolveOneChannelFromCache<false>(dstPtr, k);
+                convolveOneChannelFromCache<false>(dstPtr, pixelPtrCache, k);
             }
         }
     }
@@ -349,18 +364,15 @@ public:
     }
 
     void cleanUp() {
-        for (quint32 c = 0; c < m_cacheSize; ++c) {
-            delete[] m_pixelPtrCache[c];
-            delete[] m_pixelPtrCacheCopy[c];
-        }
-
         delete[] m_kernelData;
-        delete[] m_pixelPtrCache;
-        delete[] m_pixelPtrCacheCopy;
-
         delete[] m_minClamp;
         delete[] m_maxClamp;
         delete[] m_absoluteOffset;
+
+        m_kernelData = 0;
+        m_minClamp = 0;
+        m_maxClamp = 0;
+        m_absoluteOffset = 0;
     }
 
 private:
@@ -368,12 +380,12 @@ private:
     quint32 m_khalfWidth, m_khalfHeight;
     quint32 m_convolveChannelsNo;
     quint32 m_cacheSize, m_pixelSize;
+    quint32 m_channelCount;
 
     int m_alphaCachePos;
     int m_alphaRealPos;
 
     qreal *m_kernelData;
-    qreal** m_pixelPtrCache, ** m_pixelPtrCacheCopy;
     qreal* m_minClamp, *m_maxClamp, *m_absoluteOffset;
 
     qreal m_kernelFactor;
@@ -30,38 +30,13 @@
 
 #include "kis_base_mask_generator.h"
 #include "kis_curve_circle_mask_generator.h"
+#include "kis_curve_circle_mask_generator_p.h"
+#include "kis_brush_mask_applicator_factories.h"
+#include "kis_brush_mask_applicator_base.h"
 #include "kis_cubic_curve.h"
 #include "kis_antialiasing_fade_maker.h"
 
 
-struct Q_DECL_HIDDEN KisCurveCircleMaskGenerator::Private
-{
-    Private(bool enableAntialiasing)
-        : fadeMaker(*this, enableAntialiasing)
-    {
-    }
-
-    Private(const Private &rhs)
-        : xcoef(rhs.xcoef),
-        ycoef(rhs.ycoef),
-        curveResolution(rhs.curveResolution),
-        curveData(rhs.curveData),
-        curvePoints(rhs.curvePoints),
-        dirty(true),
-        fadeMaker(rhs.fadeMaker,*this)
-    {
-    }
-
-    qreal xcoef, ycoef;
-    qreal curveResolution;
-    QVector<qreal> curveData;
-    QList<QPointF> curvePoints;
-    bool dirty;
-
-    KisAntialiasingFadeMaker1D<Private> fadeMaker;
-    inline quint8 value(qreal dist) const;
-};
-
 KisCurveCircleMaskGenerator::KisCurveCircleMaskGenerator(qreal diameter, qreal ratio, qreal fh, qreal fv, int spikes, const KisCubicCurve &curve, bool antialiasEdges)
     : KisMaskGenerator(diameter, ratio, fh, fv, spikes, antialiasEdges, CIRCLE, SoftId), d(new Private(antialiasEdges))
 {
@@ -73,12 +48,15 @@ KisCurveCircleMaskGenerator::KisCurveCircleMaskGenerator(qreal diameter, qreal r
     d->dirty = false;
 
     setScale(1.0, 1.0);
+
+    d->applicator.reset(createOptimizedClass<MaskApplicatorFactory<KisCurveCircleMaskGenerator, KisBrushMaskVectorApplicator> >(this));
 }
 
 KisCurveCircleMaskGenerator::KisCurveCircleMaskGenerator(const KisCurveCircleMaskGenerator &rhs)
     : KisMaskGenerator(rhs),
       d(new Private(*rhs.d))
 {
+    d->applicator.reset(createOptimizedClass<MaskApplicatorFactory<KisCurveCircleMaskGenerator, KisBrushMaskVectorApplicator> >(this));
 }
 
 KisCurveCircleMaskGenerator::~KisCurveCircleMaskGenerator()
@@ -90,6 +68,16 @@ KisMaskGenerator* KisCurveCircleMaskGenerator::clone() const
     return new KisCurveCircleMaskGenerator(*this);
 }
 
+bool KisCurveCircleMaskGenerator::shouldVectorize() const
+{
+    return !shouldSupersample() && spikes() == 2;
+}
+
+KisBrushMaskApplicatorBase* KisCurveCircleMaskGenerator::applicator()
+{
+    return d->applicator.data();
+}
+
 void KisCurveCircleMaskGenerator::setScale(qreal scaleX, qreal scaleY)
 {
     KisMaskGenerator::setScale(scaleX, scaleY);
@@ -38,7 +38,8 @@ class QPointF;
  */
 class KRITAIMAGE_EXPORT KisCurveCircleMaskGenerator : public KisMaskGenerator
 {
-
+public:
+    struct FastRowProcessor;
 public:
 
     KisCurveCircleMaskGenerator(qreal radius, qreal ratio, qreal fh, qreal fv, int spikes,const KisCubicCurve& curve, bool antialiasEdges);
@@ -52,6 +53,10 @@ public:
 
     bool shouldSupersample() const override;
 
+    bool shouldVectorize() const override;
+
+    KisBrushMaskApplicatorBase* applicator() override;
+
     void toXML(QDomDocument& , QDomElement&) const override;
     void setSoftness(qreal softness) override;
 
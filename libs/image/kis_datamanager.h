@@ -56,6 +56,7 @@ public:
      */
 KisDataManager(quint32 pixelSize, const quint8 *defPixel) : ACTUAL_DATAMGR(pixelSize, defPixel) {}
     KisDataManager(const KisDataManager& dm) : ACTUAL_DATAMGR(dm) { }
+    KisDataManager(const KisDataManager& dm, SnapshotPolicy policy) : ACTUAL_DATAMGR(dm, policy) { }
 
     ~KisDataManager() override {
     }
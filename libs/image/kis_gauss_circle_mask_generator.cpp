@@ -30,6 +30,9 @@
 
 #include "kis_base_mask_generator.h"
 #include "kis_gauss_circle_mask_generator.h"
+#include "kis_gauss_circle_mask_generator_p.h"
+#include "kis_brush_mask_applicator_factories.h"
+#include "kis_brush_mask_applicator_base.h"
 #include "kis_antialiasing_fade_maker.h"
 
 #define M_SQRT_2 1.41421356237309504880
@@ -41,31 +44,6 @@
 #endif
 
 
-struct Q_DECL_HIDDEN KisGaussCircleMaskGenerator::Private
-{
-    Private(bool enableAntialiasing)
-        : fadeMaker(*this, enableAntialiasing)
-    {
-    }
-
-    Private(const Private &rhs)
-        : ycoef(rhs.ycoef),
-        fade(rhs.fade),
-        center(rhs.center),
-        distfactor(rhs.distfactor),
-        alphafactor(rhs.alphafactor),
-        fadeMaker(rhs.fadeMaker, *this)
-    {
-    }
-
-    qreal ycoef;
-    qreal fade;
-    qreal center, distfactor, alphafactor;
-    KisAntialiasingFadeMaker1D<Private> fadeMaker;
-
-    inline quint8 value(qreal dist) const;
-};
-
 KisGaussCircleMaskGenerator::KisGaussCircleMaskGenerator(qreal diameter, qreal ratio, qreal fh, qreal fv, int spikes, bool antialiasEdges)
     : KisMaskGenerator(diameter, ratio, fh, fv, spikes, antialiasEdges, CIRCLE, GaussId),
       d(new Private(antialiasEdges))
@@ -76,12 +54,15 @@ KisGaussCircleMaskGenerator::KisGaussCircleMaskGenerator(qreal diameter, qreal r
     else if (d->fade == 1.0) d->fade = 1.0 - 1e-6; // would become undefined for fade == 0 or 1
     d->center = (2.5 * (6761.0*d->fade-10000.0))/(M_SQRT_2*6761.0*d->fade);
     d->alphafactor = 255.0 / (2.0 * erf(d->center));
+
+    d->applicator.reset(createOptimizedClass<MaskApplicatorFactory<KisGaussCircleMaskGenerator, KisBrushMaskVectorApplicator> >(this));
 }
 
 KisGaussCircleMaskGenerator::KisGaussCircleMaskGenerator(const KisGaussCircleMaskGenerator &rhs)
     : KisMaskGenerator(rhs),
       d(new Private(*rhs.d))
 {
+    d->applicator.reset(createOptimizedClass<MaskApplicatorFactory<KisGaussCircleMaskGenerator, KisBrushMaskVectorApplicator> >(this));
 }
 
 KisMaskGenerator* KisGaussCircleMaskGenerator::clone() const
@@ -89,6 +70,16 @@ KisMaskGenerator* KisGaussCircleMaskGenerator::clone() const
     return new KisGaussCircleMaskGenerator(*this);
 }
 
+bool KisGaussCircleMaskGenerator::shouldVectorize() const
+{
+    return !isEmpty() && spikes() == 2;
+}
+
+KisBrushMaskApplicatorBase* KisGaussCircleMaskGenerator::applicator()
+{
+    return d->applicator.data();
+}
+
 void KisGaussCircleMaskGenerator::setScale(qreal scaleX, qreal scaleY)
 {
     KisMaskGenerator::setScale(scaleX, scaleY);
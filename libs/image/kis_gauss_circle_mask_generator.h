@@ -29,7 +29,8 @@
  */
 class KRITAIMAGE_EXPORT KisGaussCircleMaskGenerator : public KisMaskGenerator
 {
-
+public:
+    struct FastRowProcessor;
 public:
 
     KisGaussCircleMaskGenerator(qreal diameter, qreal ratio, qreal fh, qreal fv, int spikes, bool antialiasEdges);
@@ -41,6 +42,10 @@ public:
 
     void setScale(qreal scaleX, qreal scaleY) override;
 
+    bool shouldVectorize() const override;
+
+    KisBrushMaskApplicatorBase* applicator() override;
+
 private:
 
     qreal norme(qreal a, qreal b) const {
@@ -21,6 +21,7 @@
 #include "kis_global.h"
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
+#include "KisIIRGaussianBlur.h"
 #include <QRect>
 
 
@@ -99,51 +100,83 @@ KisGaussianKernel::createVerticalKernel(qreal radius)
     return KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
 }
 
+namespace {
+
+/**
+ * Blurs the rect in one direction, using the recursive filter when
+ * the radius is big enough for it and the convolution otherwise
+ */
+void applyGaussianDirectional(KisPaintDeviceSP dst, KisPaintDeviceSP src,
+                              const QRect &rect, qreal radius,
+                              KisIIRGaussianBlur::Direction direction,
+                              const QBitArray &channelFlags,
+                              KoUpdater *progressUpdater)
+{
+    const qreal sigma = KisGaussianKernel::sigmaFromRadius(radius);
+
+    if (KisIIRGaussianBlur::isApplicable(sigma)) {
+        KisIIRGaussianBlur::applyDirectional(dst, src, rect, sigma, direction,
+                                             channelFlags, progressUpdater);
+    } else {
+        KisConvolutionKernelSP kernel =
+            direction == KisIIRGaussianBlur::Horizontal ?
+            KisGaussianKernel::createHorizontalKernel(radius) :
+            KisGaussianKernel::createVerticalKernel(radius);
+
+        KisConvolutionPainter painter(dst);
+        painter.setChannelFlags(channelFlags);
+        painter.setProgress(progressUpdater);
+        painter.applyMatrix(kernel, src, rect.topLeft(), rect.topLeft(), rect.size(), BORDER_REPEAT);
+    }
+}
+
+/**
+ * The number of rows above and below the rect the vertical
+ * pass will read from the result of the horizontal one
+ */
+int verticalBorderSize(qreal yRadius)
+{
+    const qreal sigma = KisGaussianKernel::sigmaFromRadius(yRadius);
+
+    if (KisIIRGaussianBlur::isApplicable(sigma)) {
+        return KisIIRGaussianBlur::borderSize(sigma);
+    } else {
+        KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(yRadius);
+        return ceil(qreal(kernelVertical->height()) / 2.0);
+    }
+}
+
+}
+
 void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
                                       const QRect& rect,
                                       qreal xRadius, qreal yRadius,
                                       const QBitArray &channelFlags,
                                       KoUpdater *progressUpdater)
 {
-    QPoint srcTopLeft = rect.topLeft();
-
     if (xRadius > 0.0 && yRadius > 0.0) {
         KisPaintDeviceSP interm = new KisPaintDevice(device->colorSpace());
 
-        KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(xRadius);
-        KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(yRadius);
-
-        qreal verticalCenter = qreal(kernelVertical->height()) / 2.0;
-
-        KisConvolutionPainter horizPainter(interm);
-        horizPainter.setChannelFlags(channelFlags);
-        horizPainter.setProgress(progressUpdater);
-        horizPainter.applyMatrix(kernelHoriz, device,
-                                 srcTopLeft - QPoint(0, ceil(verticalCenter)),
-                                 srcTopLeft - QPoint(0, ceil(verticalCenter)),
-                                 rect.size() + QSize(0, 2 * ceil(verticalCenter)), BORDER_REPEAT);
+        const int verticalBorder = verticalBorderSize(yRadius);
 
+        applyGaussianDirectional(interm, device,
+                                 rect.adjusted(0, -verticalBorder, 0, verticalBorder),
+                                 xRadius, KisIIRGaussianBlur::Horizontal,
+                                 channelFlags, progressUpdater);
 
-        KisConvolutionPainter verticalPainter(device);
-        verticalPainter.setChannelFlags(channelFlags);
-        verticalPainter.setProgress(progressUpdater);
-        verticalPainter.applyMatrix(kernelVertical, interm, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+        applyGaussianDirectional(device, interm, rect,
+                                 yRadius, KisIIRGaussianBlur::Vertical,
+                                 channelFlags, progressUpdater);
 
     } else if (xRadius > 0.0) {
-        KisConvolutionPainter painter(device);
-        painter.setChannelFlags(channelFlags);
-        painter.setProgress(progressUpdater);
-
-        KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(xRadius);
-        painter.applyMatrix(kernelHoriz, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+        applyGaussianDirectional(device, device, rect,
+                                 xRadius, KisIIRGaussianBlur::Horizontal,
+                                 channelFlags, progressUpdater);
 
     } else if (yRadius > 0.0) {
-        KisConvolutionPainter painter(device);
-        painter.setChannelFlags(channelFlags);
-        painter.setProgress(progressUpdater);
-
-        KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(yRadius);
-        painter.applyMatrix(kernelVertical, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+        applyGaussianDirectional(device, device, rect,
+                                 yRadius, KisIIRGaussianBlur::Vertical,
+                                 channelFlags, progressUpdater);
     }
 }
 
@@ -23,6 +23,7 @@
 #include "kis_types.h"
 
 class KoColorSpace;
+class KisBelowStackCache;
 
 /**
  * A KisLayer that bundles child layers into a single layer.
@@ -107,6 +108,12 @@ public:
 
     bool projectionIsValid() const;
 
+    /**
+     * The cached composite of the children lying below the most
+     * recently updated child, used by KisAsyncMerger
+     */
+    KisBelowStackCache* belowStackCache() const;
+
 protected:
     KisLayer* onlyMeaningfulChild() const;
     KisPaintDeviceSP tryObligeChild() const;
@@ -1657,6 +1657,17 @@ void KisImage::setDesiredLevelOfDetail(int lod)
     m_d->scheduler.setDesiredLevelOfDetail(lod);
 }
 
+void KisImage::setAdaptiveLevelOfDetailLimit(int lod)
+{
+    if (m_d->blockLevelOfDetail) {
+        qWarning() << "WARNING: KisImage::setAdaptiveLevelOfDetailLimit()"
+                   << "was called while LoD functionality was being blocked!";
+        return;
+    }
+
+    m_d->scheduler.setAdaptiveLevelOfDetailLimit(lod);
+}
+
 int KisImage::currentLevelOfDetail() const
 {
     if (m_d->blockLevelOfDetail) {
@@ -1671,6 +1682,7 @@ void KisImage::setLevelOfDetailBlocked(bool value)
     KisImageBarrierLockerRaw l(this);
 
     if (value && !m_d->blockLevelOfDetail) {
+        m_d->scheduler.setAdaptiveLevelOfDetailLimit(0);
         m_d->scheduler.setDesiredLevelOfDetail(0);
     }
 
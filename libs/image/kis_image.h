@@ -645,6 +645,15 @@ public:
      */
     void setDesiredLevelOfDetail(int lod);
 
+    /**
+     * Allows the strokes to use levels of detail higher than the
+     * desired one, up to \p lod, when they cannot keep up with the
+     * target frame rate. Zero disables the adaptive level of detail.
+     *
+     * \see KisAdaptiveLodController
+     */
+    void setAdaptiveLevelOfDetailLimit(int lod);
+
     /**
      * Relative position of the mirror axis center
      *     0,0 - topleft corner of the image
@@ -86,6 +86,28 @@ void KisImageConfig::setEnablePerfLog(bool value)
     m_config.writeEntry("enablePerfLog", value);
 }
 
+bool KisImageConfig::enableUpdateTracing(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("enableUpdateTracing", false) : false;
+}
+
+void KisImageConfig::setEnableUpdateTracing(bool value)
+{
+    m_config.writeEntry("enableUpdateTracing", value);
+}
+
+bool KisImageConfig::enableAdaptiveLevelOfDetail(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("enableAdaptiveLevelOfDetail", false) : false;
+}
+
+void KisImageConfig::setEnableAdaptiveLevelOfDetail(bool value)
+{
+    m_config.writeEntry("enableAdaptiveLevelOfDetail", value);
+}
+
 qreal KisImageConfig::transformMaskOffBoundsReadArea() const
 {
     return m_config.readEntry("transformMaskOffBoundsReadArea", 0.5);
@@ -111,6 +133,17 @@ void KisImageConfig::setUpdatePatchWidth(int value)
     m_config.writeEntry("updatePatchWidth", value);
 }
 
+int KisImageConfig::belowStackCacheMemoryLimit(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("belowStackCacheMemoryLimit", 256) : 256; // in MiB
+}
+
+void KisImageConfig::setBelowStackCacheMemoryLimit(int value)
+{
+    m_config.writeEntry("belowStackCacheMemoryLimit", value);
+}
+
 qreal KisImageConfig::maxCollectAlpha() const
 {
     return m_config.readEntry("maxCollectAlpha", 2.5);
@@ -170,6 +203,76 @@ void KisImageConfig::setSwapWindowSize(int value)
     m_config.writeEntry("swapWindowSize", value);
 }
 
+QString KisImageConfig::swapCompression(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("swapCompression", "LZ4") : "LZ4";
+}
+
+void KisImageConfig::setSwapCompression(const QString &value)
+{
+    m_config.writeEntry("swapCompression", value);
+}
+
+QString KisImageConfig::tilesSaveCompression(bool requestDefault) const
+{
+    /**
+     * Older versions of Krita can read LZF-compressed tiles only,
+     * so keep it the default for the saved files
+     */
+    return !requestDefault ?
+        m_config.readEntry("tilesSaveCompression", "LZF") : "LZF";
+}
+
+void KisImageConfig::setTilesSaveCompression(const QString &value)
+{
+    m_config.writeEntry("tilesSaveCompression", value);
+}
+
+bool KisImageConfig::enableTilesDeduplication(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("enableTilesDeduplication", false) : false;
+}
+
+void KisImageConfig::setEnableTilesDeduplication(bool value)
+{
+    m_config.writeEntry("enableTilesDeduplication", value);
+}
+
+bool KisImageConfig::enableSwapPrefetching(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("enableSwapPrefetching", true) : true;
+}
+
+void KisImageConfig::setEnableSwapPrefetching(bool value)
+{
+    m_config.writeEntry("enableSwapPrefetching", value);
+}
+
+bool KisImageConfig::enableUndoDeltaCompression(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("enableUndoDeltaCompression", true) : true;
+}
+
+void KisImageConfig::setEnableUndoDeltaCompression(bool value)
+{
+    m_config.writeEntry("enableUndoDeltaCompression", value);
+}
+
+QString KisImageConfig::undoCompression(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("undoCompression", "LZ4") : "LZ4";
+}
+
+void KisImageConfig::setUndoCompression(const QString &value)
+{
+    m_config.writeEntry("undoCompression", value);
+}
+
 int KisImageConfig::tilesHardLimit() const
 {
     qreal hp = qreal(memoryHardLimitPercent()) / 100.0;
@@ -36,6 +36,19 @@ public:
     bool enablePerfLog(bool requestDefault = false) const;
     void setEnablePerfLog(bool value);
 
+    /**
+     * Record the timings of the update jobs with KisTraceRecorder
+     */
+    bool enableUpdateTracing(bool requestDefault = false) const;
+    void setEnableUpdateTracing(bool value);
+
+    /**
+     * Let the strokes raise the level of detail above the one
+     * requested by the zoom when they miss the fps limit
+     */
+    bool enableAdaptiveLevelOfDetail(bool requestDefault = false) const;
+    void setEnableAdaptiveLevelOfDetail(bool value);
+
     qreal transformMaskOffBoundsReadArea() const;
 
     int updatePatchHeight() const;
@@ -43,6 +56,14 @@ public:
     int updatePatchWidth() const;
     void setUpdatePatchWidth(int value);
 
+    /**
+     * The memory (in MiB) shared by the caches of the layers lying
+     * below the active one, see KisBelowStackCache. Zero disables
+     * the caching.
+     */
+    int belowStackCacheMemoryLimit(bool requestDefault = false) const;
+    void setBelowStackCacheMemoryLimit(int value);
+
     qreal maxCollectAlpha() const;
     qreal maxMergeAlpha() const;
     qreal maxMergeCollectAlpha() const;
@@ -58,6 +79,42 @@ public:
     int swapWindowSize() const;
     void setSwapWindowSize(int value);
 
+    /**
+     * Names of the compression backends used for swapping tiles out
+     * and for saving tiles into .kra files.
+     *
+     * \see KisCompressionRegistry
+     */
+    QString swapCompression(bool requestDefault = false) const;
+    void setSwapCompression(const QString &value);
+
+    QString tilesSaveCompression(bool requestDefault = false) const;
+    void setTilesSaveCompression(const QString &value);
+
+    /**
+     * Share the data between the tiles with identical
+     * contents, e.g. in duplicated layers or undo history
+     */
+    bool enableTilesDeduplication(bool requestDefault = false) const;
+    void setEnableTilesDeduplication(bool value);
+
+    /**
+     * Load the swapped out tiles, that are likely to be accessed
+     * soon, in a background thread
+     */
+    bool enableSwapPrefetching(bool requestDefault = false) const;
+    void setEnableSwapPrefetching(bool value);
+
+    /**
+     * Store the old revisions of the tiles in the undo history as
+     * compressed differences against the previous revisions
+     */
+    bool enableUndoDeltaCompression(bool requestDefault = false) const;
+    void setEnableUndoDeltaCompression(bool value);
+
+    QString undoCompression(bool requestDefault = false) const;
+    void setUndoCompression(const QString &value);
+
     int tilesHardLimit() const; // MiB
     int tilesSoftLimit() const; // MiB
     int poolLimit() const; // MiB
@@ -23,6 +23,8 @@
 
 #include "kis_image.h"
 #include "kis_image_config.h"
+#include "kis_group_layer.h"
+#include "KisBelowStackCache.h"
 #include "kis_signal_compressor.h"
 
 #include "tiles3/kis_tile_data_store.h"
@@ -95,7 +97,8 @@ qint64 calculateNodeMemoryHiBoundStep(KisNodeSP node,
                                       QSet<KisPaintDevice*> &devices,
                                       qint64 &layersSize,
                                       qint64 &projectionsSize,
-                                      qint64 &lodSize)
+                                      qint64 &lodSize,
+                                      qint64 &cacheSize)
 {
     qint64 memBound = 0;
 
@@ -108,10 +111,18 @@ qint64 calculateNodeMemoryHiBoundStep(KisNodeSP node,
     addDevice(node->original(), originalIsProjection, devices, memBound, layersSize, projectionsSize, lodSize);
     addDevice(node->projection(), true, devices, memBound, layersSize, projectionsSize, lodSize);
 
+    KisGroupLayer *group = qobject_cast<KisGroupLayer*>(node.data());
+    if (group) {
+        const qint64 groupCacheSize = group->belowStackCache()->memoryUsage();
+        memBound += groupCacheSize;
+        cacheSize += groupCacheSize;
+    }
+
     node = node->firstChild();
     while (node) {
         memBound += calculateNodeMemoryHiBoundStep(node, devices,
-                                                   layersSize, projectionsSize, lodSize);
+                                                   layersSize, projectionsSize,
+                                                   lodSize, cacheSize);
         node = node->nextSibling();
     }
 
@@ -121,18 +132,21 @@ qint64 calculateNodeMemoryHiBoundStep(KisNodeSP node,
 qint64 calculateNodeMemoryHiBound(KisNodeSP node,
                                   qint64 &layersSize,
                                   qint64 &projectionsSize,
-                                  qint64 &lodSize)
+                                  qint64 &lodSize,
+                                  qint64 &cacheSize)
 {
     layersSize = 0;
     projectionsSize = 0;
     lodSize = 0;
+    cacheSize = 0;
 
     QSet<KisPaintDevice*> devices;
     return calculateNodeMemoryHiBoundStep(node,
                                           devices,
                                           layersSize,
                                           projectionsSize,
-                                          lodSize);
+                                          lodSize,
+                                          cacheSize);
 }
 
 
@@ -148,7 +162,8 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
             calculateNodeMemoryHiBound(image->root(),
                                        stats.layersSize,
                                        stats.projectionsSize,
-                                       stats.lodSize);
+                                       stats.lodSize,
+                                       stats.belowStackCacheSize);
     }
     stats.totalMemorySize = tileStats.totalMemorySize;
     stats.realMemorySize = tileStats.realMemorySize;
@@ -156,6 +171,7 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.poolSize = tileStats.poolSize;
 
     stats.swapSize = tileStats.swapSize;
+    stats.deduplicatedSize = tileStats.deduplicatedSize;
 
     KisImageConfig cfg;
 
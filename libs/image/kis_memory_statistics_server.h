@@ -38,6 +38,7 @@ public:
               layersSize(0),
               projectionsSize(0),
               lodSize(0),
+              belowStackCacheSize(0),
 
               totalMemorySize(0),
               realMemorySize(0),
@@ -45,6 +46,7 @@ public:
               poolSize(0),
 
               swapSize(0),
+              deduplicatedSize(0),
 
               totalMemoryLimit(0),
               tilesHardLimit(0),
@@ -57,6 +59,7 @@ public:
         qint64 layersSize;
         qint64 projectionsSize;
         qint64 lodSize;
+        qint64 belowStackCacheSize;
 
         qint64 totalMemorySize;
         qint64 realMemorySize;
@@ -64,6 +67,7 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+        qint64 deduplicatedSize;
 
         qint64 totalMemoryLimit;
         qint64 tilesHardLimit;
@@ -67,6 +67,7 @@
 #include "kis_transform_worker.h"
 #include "kis_filter_strategy.h"
 #include "krita_utils.h"
+#include "kis_algebra_2d.h"
 
 
 struct KisPaintDeviceSPStaticRegistrar {
@@ -1057,6 +1058,14 @@ void KisPaintDevice::makeCloneFromRough(KisPaintDeviceSP src, const QRect &minim
     fastBitBltRough(src, optimizedRect);
 }
 
+KisPaintDeviceSP KisPaintDevice::createSnapshot() const
+{
+    KisPaintDeviceSP snapshot = new KisPaintDevice(colorSpace());
+    snapshot->m_d->currentNonLodData()->prepareSnapshot(m_d->currentNonLodData());
+    snapshot->setDefaultBounds(m_d->defaultBounds);
+    return snapshot;
+}
+
 void KisPaintDevice::setDirty()
 {
     m_d->cache()->invalidate();
@@ -1229,6 +1238,57 @@ private:
     const quint8 *m_defaultPixel;
 };
 
+/**
+ * Uses the occupancy index of the data manager to let the exact
+ * bounds calculation skip the areas without tiles. Such areas
+ * contain default pixels only, which are always considered empty
+ * by both the compare operations above. It makes calculating
+ * bounds of huge sparse devices much faster.
+ */
+struct TileOccupancy {
+    TileOccupancy(const KisPaintDevice *device)
+        : m_dataManager(device->dataManager()),
+          m_offsetX(device->x()),
+          m_offsetY(device->y()),
+          m_enabled(!device->defaultBounds()->wrapAroundMode())
+    {
+    }
+
+    inline bool rowIsEmpty(int y) const {
+        return m_enabled && !m_dataManager->tileRowExistsAt(y - m_offsetY);
+    }
+
+    inline bool columnIsEmpty(int x) const {
+        return m_enabled && !m_dataManager->tileColumnExistsAt(x - m_offsetX);
+    }
+
+    inline bool tileIsEmpty(int x, int y) const {
+        return m_enabled && !m_dataManager->tileExistsAt(x - m_offsetX, y - m_offsetY);
+    }
+
+    inline int tileLeft(int x) const {
+        return KisAlgebra2D::divideFloor(x - m_offsetX, KisTileData::WIDTH) * KisTileData::WIDTH + m_offsetX;
+    }
+
+    inline int tileRight(int x) const {
+        return tileLeft(x) + KisTileData::WIDTH - 1;
+    }
+
+    inline int tileTop(int y) const {
+        return KisAlgebra2D::divideFloor(y - m_offsetY, KisTileData::HEIGHT) * KisTileData::HEIGHT + m_offsetY;
+    }
+
+    inline int tileBottom(int y) const {
+        return tileTop(y) + KisTileData::HEIGHT - 1;
+    }
+
+private:
+    KisDataManagerSP m_dataManager;
+    int m_offsetX;
+    int m_offsetY;
+    bool m_enabled;
+};
+
 template <class ComparePixelOp>
 QRect calculateExactBoundsImpl(const KisPaintDevice *device, const QRect &startRect, const QRect &endRect, ComparePixelOp compareOp)
 {
@@ -1263,11 +1323,25 @@ QRect calculateExactBoundsImpl(const KisPaintDevice *device, const QRect &startR
     //      and third cases, at the cost of making the code a bit more complex
 
     KisRandomConstAccessorSP accessor = device->createRandomConstAccessorNG(x, y);
+    const TileOccupancy tiles(device);
 
     bool found = false;
     {
         for (qint32 y2 = y; y2 <= endDirS; ++y2) {
-            for (qint32 x2 = x; x2 < x + w || found; ++ x2) {
+            if (tiles.rowIsEmpty(y2)) {
+                y2 = tiles.tileBottom(y2);
+                continue;
+            }
+
+            for (qint32 x2 = x, nextTileX = x; x2 < x + w || found; ++ x2) {
+                if (x2 == nextTileX) {
+                    nextTileX = tiles.tileRight(x2) + 1;
+                    if (tiles.tileIsEmpty(x2, y2)) {
+                        x2 = nextTileX - 1;
+                        continue;
+                    }
+                }
+
                 accessor->moveTo(x2, y2);
                 if (!compareOp.isPixelEmpty(accessor->rawDataConst())) {
                     boundTop = y2;
@@ -1291,7 +1365,20 @@ QRect calculateExactBoundsImpl(const KisPaintDevice *device, const QRect &startR
     found = false;
 
     for (qint32 y2 = y + h - 1; y2 >= endDirN ; --y2) {
-        for (qint32 x2 = x + w - 1; x2 >= x || found; --x2) {
+        if (tiles.rowIsEmpty(y2)) {
+            y2 = tiles.tileTop(y2);
+            continue;
+        }
+
+        for (qint32 x2 = x + w - 1, nextTileX = x2; x2 >= x || found; --x2) {
+            if (x2 == nextTileX) {
+                nextTileX = tiles.tileLeft(x2) - 1;
+                if (tiles.tileIsEmpty(x2, y2)) {
+                    x2 = nextTileX + 1;
+                    continue;
+                }
+            }
+
             accessor->moveTo(x2, y2);
             if (!compareOp.isPixelEmpty(accessor->rawDataConst())) {
                 boundBottom = y2;
@@ -1305,7 +1392,20 @@ QRect calculateExactBoundsImpl(const KisPaintDevice *device, const QRect &startR
 
     {
         for (qint32 x2 = x; x2 <= endDirE ; ++x2) {
-            for (qint32 y2 = y; y2 < y + h || found; ++y2) {
+            if (tiles.columnIsEmpty(x2)) {
+                x2 = tiles.tileRight(x2);
+                continue;
+            }
+
+            for (qint32 y2 = y, nextTileY = y; y2 < y + h || found; ++y2) {
+                if (y2 == nextTileY) {
+                    nextTileY = tiles.tileBottom(y2) + 1;
+                    if (tiles.tileIsEmpty(x2, y2)) {
+                        y2 = nextTileY - 1;
+                        continue;
+                    }
+                }
+
                 accessor->moveTo(x2, y2);
                 if (!compareOp.isPixelEmpty(accessor->rawDataConst())) {
                     boundLeft = x2;
@@ -1323,7 +1423,20 @@ QRect calculateExactBoundsImpl(const KisPaintDevice *device, const QRect &startR
     {
 
         for (qint32 x2 = x + w - 1; x2 >= endDirW; --x2) {
-            for (qint32 y2 = y + h - 1; y2 >= y || found; --y2) {
+            if (tiles.columnIsEmpty(x2)) {
+                x2 = tiles.tileLeft(x2);
+                continue;
+            }
+
+            for (qint32 y2 = y + h - 1, nextTileY = y2; y2 >= y || found; --y2) {
+                if (y2 == nextTileY) {
+                    nextTileY = tiles.tileTop(y2) - 1;
+                    if (tiles.tileIsEmpty(x2, y2)) {
+                        y2 = nextTileY + 1;
+                        continue;
+                    }
+                }
+
                 accessor->moveTo(x2, y2);
                 if (!compareOp.isPixelEmpty(accessor->rawDataConst())) {
                     boundRight = x2;
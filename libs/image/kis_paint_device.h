@@ -347,6 +347,25 @@ public:
      */
     void makeCloneFromRough(KisPaintDeviceSP src, const QRect &minimalRect);
 
+    /**
+     * Creates a read-only snapshot of the current frame of the device
+     * for reading in a background thread (saving, histograms, color
+     * sampling and so on).
+     *
+     * The snapshot contains the last committed revision of the pixels,
+     * that is, if a stroke is being painted on the device right now,
+     * it will show the state before the stroke. The pixel data is
+     * shared with the undo history, so creating a snapshot is cheap
+     * and doesn't need to wait for the stroke to finish.
+     *
+     * If the device doesn't have a named transaction in progress, the
+     * snapshot is equivalent to a copy-on-write clone of the device.
+     * Such a snapshot may catch a part of a write that is running
+     * concurrently (e.g. on a projection), which is fine for the
+     * statistics, but not for saving.
+     */
+    KisPaintDeviceSP createSnapshot() const;
+
 
 protected:
     friend class KisPaintDeviceTest;
@@ -222,6 +222,20 @@ public:
         m_cache.invalidate();
     }
 
+    /**
+     * Makes this data object share the last committed revision of
+     * the pixels of \p srcData. See KisPaintDevice::createSnapshot().
+     */
+    void prepareSnapshot(const KisPaintDeviceData *srcData) {
+        m_x = srcData->x();
+        m_y = srcData->y();
+        m_dataManager = new KisDataManager(*srcData->dataManager(),
+                                           KisDataManager::FrozenRevision);
+        m_levelOfDetail = srcData->levelOfDetail();
+        m_colorSpace = srcData->colorSpace();
+        m_cache.invalidate();
+    }
+
     ALWAYS_INLINE KisDataManagerSP dataManager() const {
         return m_dataManager;
     }
@@ -30,7 +30,8 @@
  */
 class KRITAIMAGE_EXPORT KisRectangleMaskGenerator : public KisMaskGenerator
 {
-
+public:
+    struct FastRowProcessor;
 public:
 
     KisRectangleMaskGenerator(qreal radius, qreal ratio, qreal fh, qreal fv, int spikes, bool antialiasEdges);
@@ -44,6 +45,10 @@ public:
     void setScale(qreal scaleX, qreal scaleY) override;
     void setSoftness(qreal softness) override;
 
+    bool shouldVectorize() const override;
+
+    KisBrushMaskApplicatorBase* applicator() override;
+
 private:
     struct Private;
     const QScopedPointer<Private> d;
@@ -24,6 +24,7 @@
 #include <KoColorSpace.h>
 #include "kis_convolution_painter.h"
 #include "kis_convolution_kernel.h"
+#include "KisIIRGaussianBlur.h"
 #include "kis_pixel_selection.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
@@ -473,14 +474,53 @@ KUndo2MagicString KisFeatherSelectionFilter::name()
     return kundo2_i18n("Feather Selection");
 }
 
+namespace {
+
+/**
+ * The kernel of the feather filter is a Gaussian with sigma equal to
+ * the radius, truncated at one sigma. The standard deviation of such a
+ * kernel is 0.54 of the radius, which is the sigma of the recursive
+ * filter that gives the same look.
+ */
+qreal featherRecursiveSigma(qint32 radius)
+{
+    return 0.54 * radius;
+}
+
+}
+
 QRect KisFeatherSelectionFilter::changeRect(const QRect& rect)
 {
-    return rect.adjusted(-m_radius, -m_radius,
-                         m_radius, m_radius);
+    const qreal sigma = featherRecursiveSigma(m_radius);
+
+    const int border = KisIIRGaussianBlur::isApplicable(sigma) ?
+        qMax(m_radius, KisIIRGaussianBlur::borderSize(sigma)) : m_radius;
+
+    return rect.adjusted(-border, -border,
+                         border, border);
 }
 
 void KisFeatherSelectionFilter::process(KisPixelSelectionSP pixelSelection, const QRect& rect)
 {
+    const qreal sigma = featherRecursiveSigma(m_radius);
+
+    if (KisIIRGaussianBlur::isApplicable(sigma)) {
+        const QBitArray channelFlags = pixelSelection->colorSpace()->channelFlags(false, true);
+        const int border = KisIIRGaussianBlur::borderSize(sigma);
+
+        KisPaintDeviceSP interm = new KisPaintDevice(pixelSelection->colorSpace());
+
+        KisIIRGaussianBlur::applyDirectional(interm, pixelSelection,
+                                             rect.adjusted(0, -border, 0, border),
+                                             sigma, KisIIRGaussianBlur::Horizontal,
+                                             channelFlags, 0);
+
+        KisIIRGaussianBlur::applyDirectional(pixelSelection, interm, rect,
+                                             sigma, KisIIRGaussianBlur::Vertical,
+                                             channelFlags, 0);
+        return;
+    }
+
     // compute horizontal kernel
     const uint kernelSize = m_radius * 2 + 1;
     Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussianMatrix(1, kernelSize);
@@ -119,6 +119,8 @@ KisStrokeJob* KisStroke::popOneJob()
     if(job) {
         m_strokeInitialized = true;
         m_strokeSuspended = false;
+
+        job->setAdaptsLevelOfDetail(job->isOwnJob() && adaptsLevelOfDetail());
     }
 
     return job;
@@ -267,6 +269,12 @@ bool KisStroke::canForgetAboutMe() const
     return m_strokeStrategy->canForgetAboutMe();
 }
 
+bool KisStroke::adaptsLevelOfDetail() const
+{
+    return (m_type == LEGACY || m_type == LODN) &&
+        m_strokeStrategy->adaptsLevelOfDetail();
+}
+
 qreal KisStroke::balancingRatioOverride() const
 {
     return m_strokeStrategy->balancingRatioOverride();
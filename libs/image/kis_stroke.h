@@ -69,6 +69,14 @@ public:
     bool supportsWrapAroundMode() const;
     int worksOnLevelOfDetail() const;
     bool canForgetAboutMe() const;
+
+    /**
+     * Returns true if the timings of the stroke's own jobs should be
+     * used for selecting the level of detail of the next strokes. Only
+     * the stroke the user actually sees is measured, that is the LodN
+     * buddy or the legacy stroke, but never its Lod0 counterpart.
+     */
+    bool adaptsLevelOfDetail() const;
     qreal balancingRatioOverride() const;
 
     KisStrokeJobData::Sequentiality nextJobSequentiality() const;
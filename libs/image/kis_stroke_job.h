@@ -32,7 +32,8 @@ public:
         : m_dabStrategy(strategy),
           m_dabData(data),
           m_levelOfDetail(levelOfDetail),
-          m_isOwnJob(isOwnJob)
+          m_isOwnJob(isOwnJob),
+          m_adaptsLevelOfDetail(false)
     {
     }
 
@@ -67,6 +68,17 @@ public:
         return m_levelOfDetail;
     }
 
+    /**
+     * The timing of the job is reported to KisAdaptiveLodController
+     */
+    bool adaptsLevelOfDetail() const {
+        return m_adaptsLevelOfDetail;
+    }
+
+    void setAdaptsLevelOfDetail(bool value) {
+        m_adaptsLevelOfDetail = value;
+    }
+
     bool isCancellable() const {
         return m_isOwnJob;
     }
@@ -98,6 +110,7 @@ private:
 
     int m_levelOfDetail;
     bool m_isOwnJob;
+    bool m_adaptsLevelOfDetail;
 };
 
 #endif /* __KIS_STROKE_JOB_H */
@@ -29,6 +29,7 @@ KisStrokeStrategy::KisStrokeStrategy(QString id, const KUndo2MagicString &name)
       m_requestsOtherStrokesToEnd(true),
       m_canForgetAboutMe(false),
       m_needsExplicitCancel(false),
+      m_adaptsLevelOfDetail(false),
       m_balancingRatioOverride(-1.0),
       m_id(id),
       m_name(name),
@@ -43,6 +44,7 @@ KisStrokeStrategy::KisStrokeStrategy(const KisStrokeStrategy &rhs)
       m_requestsOtherStrokesToEnd(rhs.m_requestsOtherStrokesToEnd),
       m_canForgetAboutMe(rhs.m_canForgetAboutMe),
       m_needsExplicitCancel(rhs.m_needsExplicitCancel),
+      m_adaptsLevelOfDetail(rhs.m_adaptsLevelOfDetail),
       m_balancingRatioOverride(rhs.m_balancingRatioOverride),
       m_id(rhs.m_id),
       m_name(rhs.m_name),
@@ -215,6 +217,16 @@ void KisStrokeStrategy::setNeedsExplicitCancel(bool value)
     m_needsExplicitCancel = value;
 }
 
+bool KisStrokeStrategy::adaptsLevelOfDetail() const
+{
+    return m_adaptsLevelOfDetail;
+}
+
+void KisStrokeStrategy::setAdaptsLevelOfDetail(bool value)
+{
+    m_adaptsLevelOfDetail = value;
+}
+
 qreal KisStrokeStrategy::balancingRatioOverride() const
 {
     return m_balancingRatioOverride;
@@ -104,6 +104,15 @@ public:
 
     bool needsExplicitCancel() const;
 
+    /**
+     * Returns true if the strokes queue should select the level of
+     * detail of the following strokes from the measured latency of
+     * this stroke's jobs, see KisAdaptiveLodController.
+     *
+     * Default is 'false'.
+     */
+    bool adaptsLevelOfDetail() const;
+
     /**
      * \see setBalancingRatioOverride() for details
      */
@@ -168,6 +177,7 @@ protected:
     void setRequestsOtherStrokesToEnd(bool value);
     void setCanForgetAboutMe(bool value);
     void setNeedsExplicitCancel(bool value);
+    void setAdaptsLevelOfDetail(bool value);
 
     /**
      * Set override for the desired scheduler balancing ratio:
@@ -197,6 +207,7 @@ private:
     bool m_requestsOtherStrokesToEnd;
     bool m_canForgetAboutMe;
     bool m_needsExplicitCancel;
+    bool m_adaptsLevelOfDetail;
     qreal m_balancingRatioOverride;
 
     QString m_id;
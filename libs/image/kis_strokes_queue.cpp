@@ -27,6 +27,7 @@
 #include "kis_stroke_strategy.h"
 #include "kis_undo_stores.h"
 #include "kis_post_execution_undo_adapter.h"
+#include "KisAdaptiveLodController.h"
 
 typedef QQueue<KisStrokeSP> StrokesQueue;
 typedef QQueue<KisStrokeSP>::iterator StrokesQueueIterator;
@@ -81,6 +82,8 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
           lodNNeedsSynchronization(true),
           desiredLevelOfDetail(0),
           nextDesiredLevelOfDetail(0),
+          requestedLevelOfDetail(0),
+          adaptiveLodController(0),
           lodNStrokesFacade(_q),
           lodNPostExecutionUndoAdapter(&lodNUndoStore, &lodNStrokesFacade) {}
 
@@ -95,6 +98,8 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
     bool lodNNeedsSynchronization;
     int desiredLevelOfDetail;
     int nextDesiredLevelOfDetail;
+    int requestedLevelOfDetail;
+    KisAdaptiveLodController *adaptiveLodController;
     QMutex mutex;
     KisLodSyncStrokeStrategyFactory lod0ToNStrokeStrategyFactory;
     KisSuspendResumeStrategyFactory suspendUpdatesStrokeStrategyFactory;
@@ -111,7 +116,10 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
     StrokesQueueIterator findNewLodNPos(KisStrokeSP lodN);
     bool shouldWrapInSuspendUpdatesStroke() const;
 
+    void loadStroke(KisStrokeSP stroke);
     void switchDesiredLevelOfDetail(bool forced);
+    int adaptiveLevelOfDetail() const;
+    void updateNextDesiredLevelOfDetail();
     bool hasUnfinishedStrokes() const;
     void tryClearUndoOnStrokeCompletion(KisStrokeSP finishingStroke);
 };
@@ -614,6 +622,39 @@ void KisStrokesQueue::Private::switchDesiredLevelOfDetail(bool forced)
     }
 }
 
+void KisStrokesQueue::Private::loadStroke(KisStrokeSP stroke)
+{
+    needsExclusiveAccess = stroke->isExclusive();
+    wrapAroundModeSupported = stroke->supportsWrapAroundMode();
+    balancingRatioOverride = stroke->balancingRatioOverride();
+    currentStrokeLoaded = true;
+
+    if (stroke->adaptsLevelOfDetail() && adaptiveLodController) {
+        adaptiveLodController->strokeStarted(stroke->worksOnLevelOfDetail());
+    }
+}
+
+int KisStrokesQueue::Private::adaptiveLevelOfDetail() const
+{
+    /**
+     * The level requested by the canvas is derived from the zoom, so
+     * using it costs nothing visually. The adaptive level may only
+     * raise it further when the strokes are too slow.
+     */
+    return adaptiveLodController ?
+        qMax(requestedLevelOfDetail, adaptiveLodController->levelOfDetail()) :
+        requestedLevelOfDetail;
+}
+
+void KisStrokesQueue::Private::updateNextDesiredLevelOfDetail()
+{
+    const int lod = adaptiveLevelOfDetail();
+    if (lod == nextDesiredLevelOfDetail) return;
+
+    nextDesiredLevelOfDetail = lod;
+    switchDesiredLevelOfDetail(false);
+}
+
 void KisStrokesQueue::explicitRegenerateLevelOfDetail()
 {
     QMutexLocker locker(&m_d->mutex);
@@ -624,10 +665,23 @@ void KisStrokesQueue::setDesiredLevelOfDetail(int lod)
 {
     QMutexLocker locker(&m_d->mutex);
 
-    if (lod == m_d->nextDesiredLevelOfDetail) return;
+    m_d->requestedLevelOfDetail = lod;
+    m_d->updateNextDesiredLevelOfDetail();
+}
 
-    m_d->nextDesiredLevelOfDetail = lod;
-    m_d->switchDesiredLevelOfDetail(false);
+void KisStrokesQueue::setAdaptiveLevelOfDetailLimit(int lod)
+{
+    QMutexLocker locker(&m_d->mutex);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_d->adaptiveLodController);
+
+    m_d->adaptiveLodController->setMaximumLevelOfDetail(lod);
+    m_d->updateNextDesiredLevelOfDetail();
+}
+
+void KisStrokesQueue::setAdaptiveLodController(KisAdaptiveLodController *controller)
+{
+    QMutexLocker locker(&m_d->mutex);
+    m_d->adaptiveLodController = controller;
 }
 
 void KisStrokesQueue::notifyUFOChangedImage()
@@ -737,10 +791,7 @@ bool KisStrokesQueue::checkStrokeState(bool hasStrokeJobsRunning,
          * stroke might end up in loaded, but uninitialized state.
          */
         if (!m_d->currentStrokeLoaded) {
-            m_d->needsExclusiveAccess = stroke->isExclusive();
-            m_d->wrapAroundModeSupported = stroke->supportsWrapAroundMode();
-            m_d->balancingRatioOverride = stroke->balancingRatioOverride();
-            m_d->currentStrokeLoaded = true;
+            m_d->loadStroke(stroke);
         }
 
         result = true;
@@ -751,10 +802,7 @@ bool KisStrokesQueue::checkStrokeState(bool hasStrokeJobsRunning,
          * arrive here unloaded.
          */
         if (!m_d->currentStrokeLoaded) {
-            m_d->needsExclusiveAccess = stroke->isExclusive();
-            m_d->wrapAroundModeSupported = stroke->supportsWrapAroundMode();
-            m_d->balancingRatioOverride = stroke->balancingRatioOverride();
-            m_d->currentStrokeLoaded = true;
+            m_d->loadStroke(stroke);
         }
 
         result = true;
@@ -768,6 +816,23 @@ bool KisStrokesQueue::checkStrokeState(bool hasStrokeJobsRunning,
         m_d->balancingRatioOverride = -1.0;
         m_d->currentStrokeLoaded = false;
 
+        if (stroke->adaptsLevelOfDetail() && m_d->adaptiveLodController) {
+            m_d->adaptiveLodController->strokeFinished();
+        }
+
+        if (stroke->adaptsLevelOfDetail() &&
+            m_d->adaptiveLodController &&
+            m_d->adaptiveLodController->isEnabled()) {
+
+            /**
+             * The level is switched only when there are no LodN
+             * strokes in the queue, that is after the Lod0 part of
+             * the pair is also finished
+             */
+            m_d->adaptiveLodController->recalculateLevelOfDetail();
+            m_d->nextDesiredLevelOfDetail = m_d->adaptiveLevelOfDetail();
+        }
+
         m_d->switchDesiredLevelOfDetail(false);
 
         if(!m_d->strokesQueue.isEmpty()) {
@@ -35,6 +35,7 @@ class KisStroke;
 class KisStrokeStrategy;
 class KisStrokeJobData;
 class KisPostExecutionUndoAdapter;
+class KisAdaptiveLodController;
 
 
 class KRITAIMAGE_EXPORT KisStrokesQueue : public KisStrokesQueueMutatedJobInterface
@@ -66,6 +67,23 @@ public:
     qreal balancingRatioOverride() const;
 
     void setDesiredLevelOfDetail(int lod);
+
+    /**
+     * Lets the queue raise the level of detail of the strokes above
+     * the desired one up to \p lod, when the measured latency of the
+     * strokes doesn't fit into the target frame time. Zero disables
+     * the adaptive selection.
+     *
+     * \see KisAdaptiveLodController
+     */
+    void setAdaptiveLevelOfDetailLimit(int lod);
+
+    /**
+     * Set up by the scheduler, the controller is owned by the
+     * updater context
+     */
+    void setAdaptiveLodController(KisAdaptiveLodController *controller);
+
     void explicitRegenerateLevelOfDetail();
     void setLod0ToNStrokeStrategyFactory(const KisLodSyncStrokeStrategyFactory &factory);
     void setSuspendUpdatesStrokeStrategyFactory(const KisSuspendResumeStrategyFactory &factory);
@@ -22,6 +22,7 @@
 #include <kundo2magicstring.h>
 #include "krita_utils.h"
 #include "kis_layer_utils.h"
+#include "KisTraceRecorder.h"
 
 
 struct KisSyncLodCacheStrokeStrategy::Private
@@ -92,6 +93,8 @@ KisSyncLodCacheStrokeStrategy::~KisSyncLodCacheStrokeStrategy()
 
 void KisSyncLodCacheStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 {
+    KIS_TRACE_SCOPE("sync lod cache", "lod");
+
     Private::InitData *initData = dynamic_cast<Private::InitData*>(data);
     Private::ProcessData *processData = dynamic_cast<Private::ProcessData*>(data);
     Private::AdditionalProcessNode *additionalProcessNode = dynamic_cast<Private::AdditionalProcessNode*>(data);
@@ -113,6 +116,8 @@ void KisSyncLodCacheStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 
 void KisSyncLodCacheStrokeStrategy::finishStrokeCallback()
 {
+    KIS_TRACE_SCOPE("upload lod cache", "lod");
+
     auto it = m_d->dataObjects.begin();
     auto end = m_d->dataObjects.end();
 
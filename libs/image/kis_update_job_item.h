@@ -23,11 +23,14 @@
 
 #include <QRunnable>
 #include <QReadWriteLock>
+#include <QElapsedTimer>
 
 #include "kis_stroke_job.h"
 #include "kis_spontaneous_job.h"
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
+#include "KisTraceRecorder.h"
+#include "KisAdaptiveLodController.h"
 
 
 class KisUpdateJobItem :  public QObject, public QRunnable
@@ -43,10 +46,14 @@ public:
     };
 
 public:
-    KisUpdateJobItem(QReadWriteLock *exclusiveJobLock)
+    KisUpdateJobItem(QReadWriteLock *exclusiveJobLock,
+                     KisAdaptiveLodController *adaptiveLodController = 0)
         : m_exclusiveJobLock(exclusiveJobLock),
+          m_adaptiveLodController(adaptiveLodController),
           m_atomicType(Type::EMPTY),
-          m_runnableJob(0)
+          m_runnableJob(0),
+          m_strokeAdaptsLevelOfDetail(false),
+          m_strokeLevelOfDetail(0)
     {
         setAutoDelete(false);
         KIS_SAFE_ASSERT_RECOVER_NOOP(m_atomicType.is_lock_free());
@@ -81,13 +88,37 @@ public:
                 m_exclusiveJobLock->lockForRead();
             }
 
+            const bool measureLatency =
+                m_adaptiveLodController && m_adaptiveLodController->isEnabled();
+
+            QElapsedTimer latencyTimer;
+            if (measureLatency) {
+                latencyTimer.start();
+            }
+
             if(m_atomicType == Type::MERGE) {
+                KIS_TRACE_SCOPE("merge job", "scheduler");
                 runMergeJob();
+
+                if (measureLatency) {
+                    m_adaptiveLodController->reportMergeJob(m_walker->levelOfDetail(),
+                                                            latencyTimer.nsecsElapsed());
+                }
             } else {
                 KIS_ASSERT(m_atomicType == Type::STROKE ||
                            m_atomicType == Type::SPONTANEOUS);
 
+                KIS_TRACE_SCOPE(m_atomicType == Type::STROKE ? "stroke job" : "spontaneous job",
+                                "scheduler");
                 m_runnableJob->run();
+
+                if (measureLatency &&
+                    m_atomicType == Type::STROKE &&
+                    m_strokeAdaptsLevelOfDetail) {
+
+                    m_adaptiveLodController->reportStrokeJob(m_strokeLevelOfDetail,
+                                                             latencyTimer.nsecsElapsed());
+                }
             }
 
             setDone();
@@ -141,6 +172,8 @@ public:
 
         m_runnableJob = strokeJob;
         m_strokeJobSequentiality = strokeJob->sequentiality();
+        m_strokeAdaptsLevelOfDetail = strokeJob->adaptsLevelOfDetail();
+        m_strokeLevelOfDetail = strokeJob->levelOfDetail();
 
         m_exclusive = strokeJob->isExclusive();
         m_walker = 0;
@@ -227,6 +260,11 @@ private:
      */
     QReadWriteLock *m_exclusiveJobLock;
 
+    /**
+     * Receives the timings of the jobs, owned by the context
+     */
+    KisAdaptiveLodController *m_adaptiveLodController;
+
     bool m_exclusive;
 
     std::atomic<Type> m_atomicType;
@@ -238,6 +276,8 @@ private:
      * The job is owned by the context and deleted after completion
      */
     KisRunnable *m_runnableJob;
+    bool m_strokeAdaptsLevelOfDetail;
+    int m_strokeLevelOfDetail;
 
     /**
      * Merge jobs part
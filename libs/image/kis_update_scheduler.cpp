@@ -29,6 +29,8 @@
 
 #include "kis_queues_progress_updater.h"
 #include "KisUpdateSchedulerConfigNotifier.h"
+#include "KisBelowStackCache.h"
+#include "KisTraceRecorder.h"
 
 #include <QReadWriteLock>
 #include "kis_lazy_wait_condition.h"
@@ -52,7 +54,9 @@ struct Q_DECL_HIDDEN KisUpdateScheduler::Private {
         : q(_q)
         , updaterContext(KisImageConfig().maxNumberOfThreads(), q)
         , projectionUpdateListener(p)
-    {}
+    {
+        strokesQueue.setAdaptiveLodController(updaterContext.adaptiveLodController());
+    }
 
     KisUpdateScheduler *q;
 
@@ -65,6 +69,7 @@ struct Q_DECL_HIDDEN KisUpdateScheduler::Private {
     KisQueuesProgressUpdater *progressUpdater = 0;
 
     QAtomicInt updatesLockCounter;
+    QAtomicInt spareThreadRequests;
     QReadWriteLock updatesStartLock;
     KisLazyWaitCondition updatesFinishedCondition;
 
@@ -268,6 +273,14 @@ void KisUpdateScheduler::setDesiredLevelOfDetail(int lod)
     processQueues();
 }
 
+void KisUpdateScheduler::setAdaptiveLevelOfDetailLimit(int lod)
+{
+    m_d->strokesQueue.setAdaptiveLevelOfDetailLimit(lod);
+
+    // \see a comment in setDesiredLevelOfDetail()
+    processQueues();
+}
+
 void KisUpdateScheduler::explicitRegenerateLevelOfDetail()
 {
     m_d->strokesQueue.explicitRegenerateLevelOfDetail();
@@ -321,6 +334,9 @@ void KisUpdateScheduler::updateSettings()
 
     KisImageConfig config;
     m_d->defaultBalancingRatio = config.schedulerBalancingRatio();
+    KisBelowStackCache::setMemoryLimit(qint64(config.belowStackCacheMemoryLimit()) * 1024 * 1024);
+    KisTraceRecorder::setEnabled(config.enableUpdateTracing());
+    m_d->updaterContext.adaptiveLodController()->setTargetFrameTime(1000.0 / qMax(1, config.fpsLimit()));
 
     setThreadsLimit(config.maxNumberOfThreads());
 }
@@ -480,7 +496,22 @@ void KisUpdateScheduler::doSomeUsefulWork()
 
 void KisUpdateScheduler::spareThreadAppeared()
 {
-    processQueues();
+    /**
+     * Several jobs may finish at the same time. Instead of making all
+     * their threads wait for the context lock, only the first of them
+     * processes the queues, and the others just ask it to make one more
+     * pass. The rest of the threads can take the next job right away.
+     */
+    if (m_d->spareThreadRequests.fetchAndAddOrdered(1) > 0) return;
+
+    forever {
+        processQueues();
+
+        if (m_d->spareThreadRequests.testAndSetOrdered(1, 0)) break;
+
+        // all the requests that came during the pass are served by the next one
+        m_d->spareThreadRequests.storeRelease(1);
+    }
 }
 
 KisTestableUpdateScheduler::KisTestableUpdateScheduler(KisProjectionUpdateListener *projectionUpdateListener,
@@ -156,6 +156,11 @@ public:
      */
     void setDesiredLevelOfDetail(int lod);
 
+    /**
+     * \see KisStrokesQueue::setAdaptiveLevelOfDetailLimit()
+     */
+    void setAdaptiveLevelOfDetailLimit(int lod);
+
     /**
      * Explicitly start regeneration of LoD planes of all the devices
      * in the image. This call should be performed when the user is idle,
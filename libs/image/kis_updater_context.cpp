@@ -19,22 +19,29 @@
 #include "kis_updater_context.h"
 
 #include <QThread>
-#include <QThreadPool>
 
 #include "kis_update_job_item.h"
 #include "kis_stroke_job.h"
 
 const int KisUpdaterContext::useIdealThreadCountTag = -1;
 
-KisUpdaterContext::KisUpdaterContext(qint32 threadCount, QObject *parent)
-    : QObject(parent)
+namespace {
+qint32 effectiveThreadCount(qint32 threadCount)
 {
     if(threadCount <= 0) {
         threadCount = QThread::idealThreadCount();
         threadCount = threadCount > 0 ? threadCount : 1;
     }
 
-    setThreadsLimit(threadCount);
+    return threadCount;
+}
+}
+
+KisUpdaterContext::KisUpdaterContext(qint32 threadCount, QObject *parent)
+    : QObject(parent),
+      m_threadPool(effectiveThreadCount(threadCount))
+{
+    setThreadsLimit(effectiveThreadCount(threadCount));
 }
 
 KisUpdaterContext::~KisUpdaterContext()
@@ -278,7 +285,7 @@ void KisUpdaterContext::setThreadsLimit(int value)
     m_jobs.resize(value);
 
     for(qint32 i = 0; i < m_jobs.size(); i++) {
-        m_jobs[i] = new KisUpdateJobItem(&m_exclusiveJobLock);
+        m_jobs[i] = new KisUpdateJobItem(&m_exclusiveJobLock, &m_adaptiveLodController);
         connect(m_jobs[i], SIGNAL(sigContinueUpdate(const QRect&)),
                 SIGNAL(sigContinueUpdate(const QRect&)),
                 Qt::DirectConnection);
@@ -297,6 +304,11 @@ int KisUpdaterContext::threadsLimit() const
     return m_jobs.size();
 }
 
+KisAdaptiveLodController* KisUpdaterContext::adaptiveLodController()
+{
+    return &m_adaptiveLodController;
+}
+
 KisTestableUpdaterContext::KisTestableUpdaterContext(qint32 threadCount)
     : KisUpdaterContext(threadCount)
 {
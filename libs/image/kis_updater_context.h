@@ -22,13 +22,14 @@
 #include <QObject>
 #include <QMutex>
 #include <QReadWriteLock>
-#include <QThreadPool>
 
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
 #include "kis_lock_free_lod_counter.h"
 
 #include "KisUpdaterContextSnapshotEx.h"
+#include "KisWorkStealingExecutor.h"
+#include "KisAdaptiveLodController.h"
 
 class KisUpdateJobItem;
 class KisSpontaneousJob;
@@ -138,6 +139,13 @@ public:
      */
     int threadsLimit() const;
 
+    /**
+     * The controller receiving the timings of the jobs executed
+     * by the context. The pointer is valid during the whole
+     * lifetime of the context.
+     */
+    KisAdaptiveLodController* adaptiveLodController();
+
 
 Q_SIGNALS:
     void sigContinueUpdate(const QRect& rc);
@@ -162,8 +170,9 @@ protected:
     QReadWriteLock m_exclusiveJobLock;
 
     QMutex m_lock;
+    KisAdaptiveLodController m_adaptiveLodController;
     QVector<KisUpdateJobItem*> m_jobs;
-    QThreadPool m_threadPool;
+    KisWorkStealingExecutor m_threadPool;
     KisLockFreeLodCounter m_lodCounter;
 };
 
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisAdaptiveLodControllerTest.h"
+
+#include "KisAdaptiveLodController.h"
+
+namespace {
+const qint64 msec = 1000000; // in nsecs
+
+void reportFrames(KisAdaptiveLodController &controller, int levelOfDetail,
+                  qint64 strokeTime, qint64 mergeTime, int numFrames = 10)
+{
+    controller.strokeStarted(levelOfDetail);
+
+    for (int i = 0; i < numFrames; i++) {
+        controller.reportStrokeJob(levelOfDetail, strokeTime);
+        controller.reportMergeJob(levelOfDetail, mergeTime);
+    }
+
+    controller.strokeFinished();
+}
+}
+
+void KisAdaptiveLodControllerTest::testDisabled()
+{
+    KisAdaptiveLodController controller;
+
+    QVERIFY(!controller.isEnabled());
+    QCOMPARE(controller.levelOfDetail(), 0);
+
+    reportFrames(controller, 0, 100 * msec, 100 * msec);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 0);
+}
+
+void KisAdaptiveLodControllerTest::testRaise()
+{
+    KisAdaptiveLodController controller;
+    controller.setTargetFrameTime(10.0);
+    controller.setMaximumLevelOfDetail(3);
+
+    QVERIFY(controller.isEnabled());
+
+    // 40 ms per frame on Lod0 fits into 10 ms only on Lod1
+    reportFrames(controller, 0, 30 * msec, 10 * msec);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 1);
+    QCOMPARE(controller.levelOfDetail(), 1);
+
+    // 160 ms per frame needs Lod2
+    reportFrames(controller, 0, 150 * msec, 10 * msec);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 2);
+}
+
+void KisAdaptiveLodControllerTest::testNormalization()
+{
+    KisAdaptiveLodController controller;
+    controller.setTargetFrameTime(10.0);
+    controller.setMaximumLevelOfDetail(3);
+
+    // 10 ms on Lod1 means 40 ms on Lod0, which still fits on Lod1
+    reportFrames(controller, 1, 7 * msec, 3 * msec);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 1);
+
+    // 4 ms on Lod2 means 64 ms on Lod0, which needs Lod2
+    reportFrames(controller, 2, 3 * msec, 1 * msec);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 2);
+}
+
+void KisAdaptiveLodControllerTest::testHysteresis()
+{
+    KisAdaptiveLodController controller;
+    controller.setTargetFrameTime(10.0);
+    controller.setMaximumLevelOfDetail(3);
+
+    reportFrames(controller, 0, 30 * msec, 10 * msec);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 1);
+
+    // 9 ms fits into the target on Lod0, but not into its 3/4
+    reportFrames(controller, 1, 2 * msec, qint64(0.25 * msec));
+    QCOMPARE(controller.recalculateLevelOfDetail(), 1);
+
+    // 5 ms fits into 3/4 of the target
+    reportFrames(controller, 1, 1 * msec, qint64(0.25 * msec));
+    QCOMPARE(controller.recalculateLevelOfDetail(), 0);
+}
+
+void KisAdaptiveLodControllerTest::testTooFewSamples()
+{
+    KisAdaptiveLodController controller;
+    controller.setTargetFrameTime(10.0);
+    controller.setMaximumLevelOfDetail(3);
+
+    reportFrames(controller, 0, 100 * msec, 100 * msec, 2);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 0);
+
+    // the samples are dropped on every recalculation
+    reportFrames(controller, 0, 100 * msec, 100 * msec, 6);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 0);
+}
+
+void KisAdaptiveLodControllerTest::testMaximumLevel()
+{
+    KisAdaptiveLodController controller;
+    controller.setTargetFrameTime(10.0);
+    controller.setMaximumLevelOfDetail(2);
+
+    reportFrames(controller, 0, 1000 * msec, 1000 * msec);
+    QCOMPARE(controller.recalculateLevelOfDetail(), 2);
+
+    controller.setMaximumLevelOfDetail(1);
+    QCOMPARE(controller.levelOfDetail(), 1);
+
+    controller.setMaximumLevelOfDetail(0);
+    QVERIFY(!controller.isEnabled());
+    QCOMPARE(controller.levelOfDetail(), 0);
+
+    controller.setMaximumLevelOfDetail(2);
+    QCOMPARE(controller.levelOfDetail(), 0);
+}
+
+void KisAdaptiveLodControllerTest::testForeignMerges()
+{
+    KisAdaptiveLodController controller;
+    controller.setTargetFrameTime(10.0);
+    controller.setMaximumLevelOfDetail(3);
+
+    // the merges outside the stroke are not counted
+    controller.reportMergeJob(0, 1000 * msec);
+
+    controller.strokeStarted(1);
+
+    for (int i = 0; i < 10; i++) {
+        controller.reportStrokeJob(1, 2 * msec);
+        controller.reportMergeJob(1, 2 * msec);
+
+        // the merges of another level, e.g. of the Lod0 pair
+        controller.reportMergeJob(0, 1000 * msec);
+    }
+
+    controller.strokeFinished();
+    controller.reportMergeJob(1, 1000 * msec);
+
+    // 4 ms on Lod1 means 16 ms on Lod0, which needs Lod1
+    QCOMPARE(controller.recalculateLevelOfDetail(), 1);
+}
+
+QTEST_MAIN(KisAdaptiveLodControllerTest)
@@ -0,0 +1,286 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisBelowStackCacheTest.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "KisBelowStackCache.h"
+#include "kis_async_merger.h"
+#include "kis_full_refresh_walker.h"
+#include "kis_group_layer.h"
+#include "kis_image.h"
+#include "kis_merge_walker.h"
+#include "kis_paint_device.h"
+#include "kis_paint_layer.h"
+#include "kis_adjustment_layer.h"
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_filter_registry.h"
+
+#include "../../sdk/tests/testutil.h"
+
+
+namespace {
+
+struct CacheLimitSaver
+{
+    CacheLimitSaver(qint64 value)
+        : m_oldValue(KisBelowStackCache::memoryLimit())
+    {
+        KisBelowStackCache::setMemoryLimit(value);
+    }
+
+    ~CacheLimitSaver() {
+        KisBelowStackCache::setMemoryLimit(m_oldValue);
+    }
+
+private:
+    qint64 m_oldValue;
+};
+
+void mergeNode(KisImageSP image, KisNodeSP node, const QRect &rect)
+{
+    KisMergeWalker walker(image->bounds());
+    walker.collectRects(node, rect);
+
+    KisAsyncMerger merger;
+    merger.startMerge(walker);
+}
+
+void fullRefresh(KisImageSP image)
+{
+    KisFullRefreshWalker walker(image->bounds());
+    walker.collectRects(image->rootLayer(), image->bounds());
+
+    KisAsyncMerger merger;
+    merger.startMerge(walker);
+}
+
+QImage referenceProjection(KisImageSP image)
+{
+    CacheLimitSaver disableCache(0);
+    fullRefresh(image);
+    return image->rootLayer()->projection()->convertToQImage(0);
+}
+
+/*
+  +-----------+
+  |root       |
+  | paint 3   |
+  | paint 2   |
+  | paint 1   |
+  +-----------+
+*/
+
+KisImageSP createImage(KisPaintLayerSP *layers)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, 300, 300, cs, "below stack cache test");
+
+    layers[0] = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8);
+    layers[1] = new KisPaintLayer(image, "paint2", 128);
+    layers[2] = new KisPaintLayer(image, "paint3", OPACITY_OPAQUE_U8);
+
+    layers[0]->paintDevice()->fill(QRect(0, 0, 300, 300), KoColor(Qt::white, cs));
+    layers[1]->paintDevice()->fill(QRect(50, 50, 200, 200), KoColor(Qt::red, cs));
+    layers[2]->paintDevice()->fill(QRect(100, 100, 50, 50), KoColor(Qt::blue, cs));
+
+    for (int i = 0; i < 3; i++) {
+        image->addNode(layers[i], image->rootLayer());
+    }
+
+    fullRefresh(image);
+
+    return image;
+}
+
+}
+
+void KisBelowStackCacheTest::testReadWrite()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(0, 0, 100, 100);
+    const qint64 rectSize = rect.width() * rect.height() * cs->pixelSize();
+
+    CacheLimitSaver limit(KisBelowStackCache::totalMemoryUsage() + rectSize);
+
+    KisImageSP image = new KisImage(0, 300, 300, cs, "below stack cache test");
+    KisNodeSP keyNode = new KisPaintLayer(image, "key", OPACITY_OPAQUE_U8);
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    src->fill(rect, KoColor(Qt::red, cs));
+
+    KisBelowStackCache cache;
+    cache.setKeyNode(keyNode);
+    cache.write(keyNode, rect, src, 0, 1);
+    QCOMPARE(cache.memoryUsage(), rectSize);
+
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    QVERIFY(cache.read(keyNode, rect, dst, 0, 1));
+    QCOMPARE(dst->exactBounds(), rect);
+
+    QVERIFY(!cache.read(keyNode, rect, dst, 0, 2));
+    QVERIFY(!cache.read(keyNode, rect, dst, 1, 1));
+    QVERIFY(!cache.read(keyNode, rect.adjusted(0, 0, 1, 1), dst, 0, 1));
+
+    // the limit doesn't allow caching more data
+    cache.write(keyNode, rect.translated(100, 0), src, 0, 1);
+    QCOMPARE(cache.memoryUsage(), rectSize);
+
+    cache.invalidate(QRect(0, 0, 50, 100));
+    QCOMPARE(cache.memoryUsage(), rectSize / 2);
+    QVERIFY(!cache.read(keyNode, rect, dst, 0, 1));
+    QVERIFY(cache.read(keyNode, QRect(50, 0, 50, 100), dst, 0, 1));
+
+    cache.clear();
+    QCOMPARE(cache.memoryUsage(), qint64(0));
+    QVERIFY(!cache.keyNode());
+}
+
+void KisBelowStackCacheTest::testMergeUsesCache()
+{
+    CacheLimitSaver limit(64 * 1024 * 1024);
+
+    KisPaintLayerSP layers[3];
+    KisImageSP image = createImage(layers);
+    KisPaintDeviceSP projection = image->rootLayer()->projection();
+    KisBelowStackCache *cache = image->rootLayer()->belowStackCache();
+
+    mergeNode(image, layers[2], image->bounds());
+    QCOMPARE(cache->keyNode(), KisNodeSP(layers[2]));
+    QVERIFY(cache->memoryUsage() > 0);
+
+    QColor oldColor;
+    projection->pixel(60, 60, &oldColor);
+
+    /**
+     * Change the layer below the key without notifying anyone. The next
+     * update of the key must take its composite from the cache.
+     */
+    const KoColorSpace *cs = image->colorSpace();
+    layers[1]->paintDevice()->fill(QRect(50, 50, 200, 200), KoColor(Qt::green, cs));
+    layers[2]->paintDevice()->fill(QRect(200, 200, 50, 50), KoColor(Qt::blue, cs));
+
+    mergeNode(image, layers[2], image->bounds());
+
+    QColor newColor;
+    projection->pixel(60, 60, &newColor);
+    QCOMPARE(newColor, oldColor);
+
+    projection->pixel(220, 220, &newColor);
+    QCOMPARE(newColor, QColor(Qt::blue));
+
+    /**
+     * A proper update of the layer makes it the new key
+     */
+    mergeNode(image, layers[1], image->bounds());
+    QCOMPARE(cache->keyNode(), KisNodeSP(layers[1]));
+
+    const QImage result = projection->convertToQImage(0);
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt, referenceProjection(image), result));
+}
+
+void KisBelowStackCacheTest::testInvalidationBelowKey()
+{
+    CacheLimitSaver limit(64 * 1024 * 1024);
+
+    KisPaintLayerSP layers[3];
+    KisImageSP image = createImage(layers);
+    KisPaintDeviceSP projection = image->rootLayer()->projection();
+    KisBelowStackCache *cache = image->rootLayer()->belowStackCache();
+
+    mergeNode(image, layers[2], image->bounds());
+    QCOMPARE(cache->keyNode(), KisNodeSP(layers[2]));
+
+    /**
+     * The bottommost layer cannot become a key, so the cache should
+     * just be updated in the changed area
+     */
+    const KoColorSpace *cs = image->colorSpace();
+    const QRect changeRect(20, 20, 60, 60);
+    layers[0]->paintDevice()->fill(changeRect, KoColor(Qt::black, cs));
+    mergeNode(image, layers[0], changeRect);
+    QCOMPARE(cache->keyNode(), KisNodeSP(layers[2]));
+
+    layers[2]->paintDevice()->fill(QRect(200, 200, 50, 50), KoColor(Qt::blue, cs));
+    mergeNode(image, layers[2], image->bounds());
+
+    const QImage result = projection->convertToQImage(0);
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt, referenceProjection(image), result));
+}
+
+void KisBelowStackCacheTest::testFilterLayerAsKey()
+{
+    CacheLimitSaver limit(64 * 1024 * 1024);
+
+    /*
+      +-----------+
+      |root       |
+      | blur      |
+      | paint 2   |
+      | paint 1   |
+      +-----------+
+    */
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, 300, 300, cs, "below stack cache test");
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    QVERIFY(filter);
+    KisFilterConfigurationSP configuration = filter->defaultConfiguration();
+
+    KisPaintLayerSP paint1 = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8);
+    KisPaintLayerSP paint2 = new KisPaintLayer(image, "paint2", OPACITY_OPAQUE_U8);
+    KisLayerSP blur = new KisAdjustmentLayer(image, "blur", configuration, 0);
+
+    paint1->paintDevice()->fill(QRect(0, 0, 300, 300), KoColor(Qt::white, cs));
+    paint2->paintDevice()->fill(QRect(50, 50, 200, 200), KoColor(Qt::red, cs));
+
+    image->addNode(paint1, image->rootLayer());
+    image->addNode(paint2, image->rootLayer());
+    image->addNode(blur, image->rootLayer());
+
+    fullRefresh(image);
+
+    KisBelowStackCache *cache = image->rootLayer()->belowStackCache();
+
+    mergeNode(image, blur, image->bounds());
+    QCOMPARE(cache->keyNode(), KisNodeSP(blur));
+
+    /**
+     * The blur reads the pixels around the updated rect, they
+     * should be fetched from the cache as well
+     */
+    mergeNode(image, blur, QRect(40, 40, 20, 20));
+    mergeNode(image, blur, QRect(140, 240, 20, 20));
+
+    const QImage result = image->rootLayer()->projection()->convertToQImage(0);
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt, referenceProjection(image), result));
+}
+
+QTEST_MAIN(KisBelowStackCacheTest)
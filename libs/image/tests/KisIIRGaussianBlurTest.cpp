@@ -0,0 +1,188 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisIIRGaussianBlurTest.h"
+
+#include <QTest>
+#include <QBitArray>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_convolution_painter.h"
+#include "kis_convolution_kernel.h"
+#include "kis_gaussian_kernel.h"
+#include "KisIIRGaussianBlur.h"
+
+
+namespace {
+
+KisPaintDeviceSP createNoiseDevice(const QRect &rc)
+{
+    QImage noise(rc.size(), QImage::Format_ARGB32);
+
+    qsrand(17);
+    quint32 *pixel = reinterpret_cast<quint32*>(noise.bits());
+    for (int i = 0; i < rc.width() * rc.height(); i++) {
+        *pixel++ = qRgba(qrand() % 256, qrand() % 256, qrand() % 256, 128 + qrand() % 128);
+    }
+
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    dev->convertFromQImage(noise, 0, rc.x(), rc.y());
+    return dev;
+}
+
+bool compareDevices(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rc, int tolerance)
+{
+    const QImage image1 = dev1->convertToQImage(0, rc);
+    const QImage image2 = dev2->convertToQImage(0, rc);
+
+    for (int y = 0; y < rc.height(); y++) {
+        for (int x = 0; x < rc.width(); x++) {
+            const QRgb pixel1 = image1.pixel(x, y);
+            const QRgb pixel2 = image2.pixel(x, y);
+
+            if (qAbs(qRed(pixel1) - qRed(pixel2)) > tolerance ||
+                qAbs(qGreen(pixel1) - qGreen(pixel2)) > tolerance ||
+                qAbs(qBlue(pixel1) - qBlue(pixel2)) > tolerance ||
+                qAbs(qAlpha(pixel1) - qAlpha(pixel2)) > tolerance) {
+
+                qDebug() << "Failed at" << x << y << hex << pixel1 << pixel2;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
+
+void KisIIRGaussianBlurTest::testCoefficients()
+{
+    for (qreal sigma = 2.5; sigma < 100.0; sigma *= 1.5) {
+        const KisIIRGaussianCoefficients coeffs = KisIIRGaussianBlur::coefficients(sigma);
+
+        // the filter must keep the flat areas unchanged
+        QVERIFY(qAbs(coeffs.B + coeffs.b1 + coeffs.b2 + coeffs.b3 - 1.0f) < 1e-6);
+        QVERIFY(coeffs.B > 0.0f);
+    }
+
+    QVERIFY(!KisIIRGaussianBlur::isApplicable(1.0));
+    QVERIFY(KisIIRGaussianBlur::isApplicable(2.5));
+}
+
+void KisIIRGaussianBlurTest::testCompareWithConvolution_data()
+{
+    QTest::addColumn<qreal>("radius");
+    QTest::addColumn<bool>("horizontal");
+
+    QTest::newRow("r10, horizontal") << 10.0 << true;
+    QTest::newRow("r10, vertical") << 10.0 << false;
+    QTest::newRow("r30, horizontal") << 30.0 << true;
+    QTest::newRow("r30, vertical") << 30.0 << false;
+    QTest::newRow("r100, horizontal") << 100.0 << true;
+    QTest::newRow("r100, vertical") << 100.0 << false;
+}
+
+void KisIIRGaussianBlurTest::testCompareWithConvolution()
+{
+    QFETCH(qreal, radius);
+    QFETCH(bool, horizontal);
+
+    const QRect imageRect(10, 20, 300, 200);
+    const QRect applyRect(40, 40, 200, 150);
+    KisPaintDeviceSP dev = createNoiseDevice(imageRect);
+
+    const qreal sigma = KisGaussianKernel::sigmaFromRadius(radius);
+    QVERIFY(KisIIRGaussianBlur::isApplicable(sigma));
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(dev->colorSpace());
+    KisConvolutionPainter painter(refDev, KisConvolutionPainter::SPATIAL);
+    painter.applyMatrix(horizontal ?
+                        KisGaussianKernel::createHorizontalKernel(radius) :
+                        KisGaussianKernel::createVerticalKernel(radius),
+                        dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(),
+                        BORDER_REPEAT);
+
+    KisPaintDeviceSP iirDev = new KisPaintDevice(dev->colorSpace());
+    KisIIRGaussianBlur::applyDirectional(iirDev, dev, applyRect, sigma,
+                                         horizontal ?
+                                         KisIIRGaussianBlur::Horizontal :
+                                         KisIIRGaussianBlur::Vertical,
+                                         QBitArray(), 0);
+
+    QCOMPARE(iirDev->exactBounds(), applyRect);
+    QVERIFY(compareDevices(refDev, iirDev, applyRect, 3));
+}
+
+void KisIIRGaussianBlurTest::testInPlace()
+{
+    const QRect imageRect(0, 0, 200, 150);
+    const qreal sigma = 12.0;
+
+    KisPaintDeviceSP dev = createNoiseDevice(imageRect);
+    KisPaintDeviceSP refDev = new KisPaintDevice(dev->colorSpace());
+
+    KisIIRGaussianBlur::applyDirectional(refDev, dev, imageRect, sigma,
+                                         KisIIRGaussianBlur::Vertical,
+                                         QBitArray(), 0);
+
+    KisIIRGaussianBlur::applyDirectional(dev, dev, imageRect, sigma,
+                                         KisIIRGaussianBlur::Vertical,
+                                         QBitArray(), 0);
+
+    QVERIFY(compareDevices(refDev, dev, imageRect, 0));
+}
+
+void KisIIRGaussianBlurTest::testChannelFlags()
+{
+    const QRect imageRect(0, 0, 100, 100);
+    const qreal sigma = 5.0;
+
+    KisPaintDeviceSP dev = createNoiseDevice(imageRect);
+    KisPaintDeviceSP origDev = new KisPaintDevice(*dev);
+
+    // blur the alpha channel only
+    const QBitArray channelFlags = dev->colorSpace()->channelFlags(false, true);
+
+    KisIIRGaussianBlur::applyDirectional(dev, dev, imageRect, sigma,
+                                         KisIIRGaussianBlur::Horizontal,
+                                         channelFlags, 0);
+
+    const QImage result = dev->convertToQImage(0, imageRect);
+    const QImage orig = origDev->convertToQImage(0, imageRect);
+
+    bool alphaChanged = false;
+
+    for (int y = 0; y < imageRect.height(); y++) {
+        for (int x = 0; x < imageRect.width(); x++) {
+            QCOMPARE(qRed(result.pixel(x, y)), qRed(orig.pixel(x, y)));
+            QCOMPARE(qGreen(result.pixel(x, y)), qGreen(orig.pixel(x, y)));
+            QCOMPARE(qBlue(result.pixel(x, y)), qBlue(orig.pixel(x, y)));
+
+            alphaChanged |= qAlpha(result.pixel(x, y)) != qAlpha(orig.pixel(x, y));
+        }
+    }
+
+    QVERIFY(alphaChanged);
+}
+
+QTEST_MAIN(KisIIRGaussianBlurTest)
@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "KisWorkStealingExecutorTest.h"
+
+#include <atomic>
+
+#include <QRunnable>
+#include <QSemaphore>
+
+#include "KisWorkStealingExecutor.h"
+
+
+struct CountingJob : public QRunnable
+{
+    CountingJob(std::atomic<int> *counter)
+        : m_counter(counter)
+    {
+    }
+
+    void run() override {
+        (*m_counter)++;
+    }
+
+private:
+    std::atomic<int> *m_counter;
+};
+
+/**
+ * Spawns two children until the requested depth is reached,
+ * that is creates (2^(depth + 1) - 1) jobs in total
+ */
+struct ForkingJob : public QRunnable
+{
+    ForkingJob(KisWorkStealingExecutor *executor, std::atomic<int> *counter,
+               std::atomic<int> *wrongThreadCounter, int depth)
+        : m_executor(executor),
+          m_counter(counter),
+          m_wrongThreadCounter(wrongThreadCounter),
+          m_depth(depth)
+    {
+    }
+
+    void run() override {
+        (*m_counter)++;
+
+        if (m_executor->currentWorkerIndex() < 0) {
+            (*m_wrongThreadCounter)++;
+        }
+
+        if (m_depth > 0) {
+            m_executor->start(new ForkingJob(m_executor, m_counter, m_wrongThreadCounter, m_depth - 1));
+            m_executor->start(new ForkingJob(m_executor, m_counter, m_wrongThreadCounter, m_depth - 1));
+        }
+    }
+
+private:
+    KisWorkStealingExecutor *m_executor;
+    std::atomic<int> *m_counter;
+    std::atomic<int> *m_wrongThreadCounter;
+    int m_depth;
+};
+
+void KisWorkStealingExecutorTest::testExternalJobs()
+{
+    KisWorkStealingExecutor executor(4);
+    QCOMPARE(executor.maxThreadCount(), 4);
+    QCOMPARE(executor.currentWorkerIndex(), -1);
+
+    std::atomic<int> counter(0);
+
+    for (int i = 0; i < 1000; i++) {
+        executor.start(new CountingJob(&counter));
+    }
+
+    executor.waitForDone();
+    QCOMPARE(int(counter), 1000);
+}
+
+void KisWorkStealingExecutorTest::testNestedJobs()
+{
+    KisWorkStealingExecutor executor(4);
+
+    std::atomic<int> counter(0);
+    std::atomic<int> wrongThreadCounter(0);
+
+    executor.start(new ForkingJob(&executor, &counter, &wrongThreadCounter, 10));
+    executor.waitForDone();
+
+    QCOMPARE(int(counter), 2047);
+    QCOMPARE(int(wrongThreadCounter), 0);
+}
+
+void KisWorkStealingExecutorTest::testStealing()
+{
+    const int numThreads = 4;
+    KisWorkStealingExecutor executor(numThreads);
+
+    /**
+     * The first job blocks its worker and queues the rest of the jobs
+     * into the worker's own queue. They can be completed only if the
+     * other workers steal them.
+     */
+    struct BlockingJob : public QRunnable
+    {
+        BlockingJob(KisWorkStealingExecutor *executor, QSemaphore *semaphore)
+            : m_executor(executor), m_semaphore(semaphore)
+        {
+        }
+
+        void run() override {
+            for (int i = 0; i < numThreads - 1; i++) {
+                m_executor->start(new ReleasingJob(m_semaphore));
+            }
+            m_semaphore->acquire(numThreads - 1);
+        }
+
+        struct ReleasingJob : public QRunnable
+        {
+            ReleasingJob(QSemaphore *semaphore) : m_semaphore(semaphore) {}
+            void run() override {
+                m_semaphore->release();
+            }
+            QSemaphore *m_semaphore;
+        };
+
+        KisWorkStealingExecutor *m_executor;
+        QSemaphore *m_semaphore;
+    };
+
+    QSemaphore semaphore;
+    executor.start(new BlockingJob(&executor, &semaphore));
+
+    executor.waitForDone();
+    QCOMPARE(semaphore.available(), 0);
+}
+
+void KisWorkStealingExecutorTest::testChangeThreadCount()
+{
+    KisWorkStealingExecutor executor(2);
+
+    std::atomic<int> counter(0);
+
+    for (int i = 0; i < 100; i++) {
+        executor.start(new CountingJob(&counter));
+    }
+
+    executor.setMaxThreadCount(8);
+    QCOMPARE(int(counter), 100);
+    QCOMPARE(executor.maxThreadCount(), 8);
+
+    std::atomic<int> wrongThreadCounter(0);
+    executor.start(new ForkingJob(&executor, &counter, &wrongThreadCounter, 6));
+    executor.waitForDone();
+
+    QCOMPARE(int(counter), 100 + 127);
+    QCOMPARE(int(wrongThreadCounter), 0);
+}
+
+QTEST_MAIN(KisWorkStealingExecutorTest)
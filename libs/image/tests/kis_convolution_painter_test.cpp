@@ -31,8 +31,10 @@
 #include "kis_paint_device.h"
 #include "kis_convolution_painter.h"
 #include "kis_convolution_kernel.h"
+#include "kis_transaction.h"
 #include <kis_gaussian_kernel.h>
 #include <kis_mask_generator.h>
+#include <brushengine/kis_random_source.h>
 #include "testutil.h"
 
 KisPaintDeviceSP initAsymTestDevice(QRect &imageRect, int &pixelSize, QByteArray &initialData)
@@ -56,6 +58,23 @@ KisPaintDeviceSP initAsymTestDevice(QRect &imageRect, int &pixelSize, QByteArray
     return dev;
 }
 
+/**
+ * Fills \p rect of \p dev with semi-transparent noise. The noise is
+ * seeded, so that the failures could be reproduced.
+ */
+void fillWithNoise(KisPaintDeviceSP dev, const QRect &rect, int seed)
+{
+    KisRandomSource source(seed);
+
+    QImage noise(rect.size(), QImage::Format_ARGB32);
+    quint32 *pixel = reinterpret_cast<quint32*>(noise.bits());
+    for (int i = 0; i < rect.width() * rect.height(); i++) {
+        *pixel++ = qRgba(source.generate(0, 255), source.generate(0, 255),
+                         source.generate(0, 255), source.generate(128, 255));
+    }
+    dev->convertFromQImage(noise, 0, rect.x(), rect.y());
+}
+
 Eigen::Matrix<qreal, 3, 3> initSymmFilter(qreal &offset, qreal &factor)
 {
     Eigen::Matrix<qreal, 3, 3> filter;
@@ -437,4 +456,181 @@ void KisConvolutionPainterTest::testGaussianDetailsFFTW()
     testGaussianDetails(true);
 }
 
+void KisConvolutionPainterTest::testTiledFFTW_data()
+{
+    QTest::addColumn<QString>("colorSpace");
+    QTest::addColumn<int>("diameter");
+
+    QTest::newRow("rgb8, small") << "rgb8" << 11;
+    QTest::newRow("rgb8, large") << "rgb8" << 41;
+    QTest::newRow("rgb16, small") << "rgb16" << 11;
+    QTest::newRow("rgb16, large") << "rgb16" << 41;
+}
+
+/**
+ * The area is bigger than one FFT frame, so the FFTW worker
+ * splits it into tiles. The result should not depend on it.
+ */
+void KisConvolutionPainterTest::testTiledFFTW()
+{
+    QFETCH(QString, colorSpace);
+    QFETCH(int, diameter);
+
+    const KoColorSpace *cs =
+        colorSpace == "rgb8" ?
+        KoColorSpaceRegistry::instance()->rgb8() :
+        KoColorSpaceRegistry::instance()->rgb16();
+
+    const QRect imageRect(0, 0, 1300, 900);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    fillWithNoise(dev, imageRect, 1);
+
+    QScopedPointer<KisCircleMaskGenerator> kas(new KisCircleMaskGenerator(diameter, 1.0, 5, 5, 2, false));
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMaskGenerator(kas.data());
+
+    KisPaintDeviceSP spatialDst = new KisPaintDevice(cs);
+    KisConvolutionPainter spatialPainter(spatialDst, KisConvolutionPainter::SPATIAL);
+    spatialPainter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(),
+                               imageRect.size(), BORDER_REPEAT);
+
+    KisPaintDeviceSP fftwDst = new KisPaintDevice(cs);
+    KisConvolutionPainter fftwPainter(fftwDst, KisConvolutionPainter::FFTW);
+    fftwPainter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(),
+                            imageRect.size(), BORDER_REPEAT);
+
+    const QImage spatialImage = spatialDst->convertToQImage(0, imageRect);
+    const QImage fftwImage = fftwDst->convertToQImage(0, imageRect);
+
+    for (int y = 0; y < imageRect.height(); y++) {
+        for (int x = 0; x < imageRect.width(); x++) {
+            const QRgb expected = spatialImage.pixel(x, y);
+            const QRgb result = fftwImage.pixel(x, y);
+
+            if (qAbs(qRed(expected) - qRed(result)) > 1 ||
+                qAbs(qGreen(expected) - qGreen(result)) > 1 ||
+                qAbs(qBlue(expected) - qBlue(result)) > 1 ||
+                qAbs(qAlpha(expected) - qAlpha(result)) > 1) {
+
+                qDebug() << "Failed at" << x << y << "expected:" << hex << expected << "result:" << result;
+                QFAIL("FFTW result differs from the spatial one");
+            }
+        }
+    }
+}
+
+void KisConvolutionPainterTest::testBandedSpatial_data()
+{
+    QTest::addColumn<int>("kernelWidth");
+    QTest::addColumn<int>("kernelHeight");
+    QTest::addColumn<int>("borderOp");
+
+    QTest::newRow("horizontal, repeat") << 7 << 3 << int(BORDER_REPEAT);
+    QTest::newRow("vertical, repeat") << 3 << 7 << int(BORDER_REPEAT);
+    QTest::newRow("square, repeat") << 5 << 5 << int(BORDER_REPEAT);
+    QTest::newRow("horizontal, ignore") << 7 << 3 << int(BORDER_IGNORE);
+    QTest::newRow("vertical, ignore") << 3 << 7 << int(BORDER_IGNORE);
+}
+
+/**
+ * The filter stroke splits big areas into bands filtered by separate
+ * jobs. The result of the spatial worker should be exactly the same
+ * as the one of the whole area.
+ */
+void KisConvolutionPainterTest::testBandedSpatial()
+{
+    QFETCH(int, kernelWidth);
+    QFETCH(int, kernelHeight);
+    QFETCH(int, borderOp);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(-10, -37, 700, 500);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    fillWithNoise(dev, imageRect, 2);
+
+    // an asymmetric sharpening-like kernel
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(kernelHeight, kernelWidth);
+    for (int r = 0; r < kernelHeight; r++) {
+        for (int c = 0; c < kernelWidth; c++) {
+            matrix(r, c) = 0.25 * ((r + 2 * c) % 3 - 1);
+        }
+    }
+    matrix(kernelHeight / 2, kernelWidth / 2) += 1.0;
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0.0, 1.0);
+
+    KisPaintDeviceSP wholeDst = new KisPaintDevice(cs);
+    KisConvolutionPainter wholePainter(wholeDst, KisConvolutionPainter::SPATIAL);
+    wholePainter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(),
+                              imageRect.size(), KisConvolutionBorderOp(borderOp));
+
+    KisPaintDeviceSP stripsDst = new KisPaintDevice(cs);
+    KisConvolutionPainter stripsPainter(stripsDst, KisConvolutionPainter::SPATIAL);
+    for (int y = imageRect.top(); y <= imageRect.bottom(); y += 64) {
+        const QRect strip = QRect(imageRect.x(), y, imageRect.width(), 64) & imageRect;
+        stripsPainter.applyMatrix(kernel, dev, strip.topLeft(), strip.topLeft(),
+                                  strip.size(), KisConvolutionBorderOp(borderOp));
+    }
+
+    QByteArray wholeData(imageRect.width() * imageRect.height() * cs->pixelSize(), 0);
+    QByteArray stripsData(wholeData.size(), 0);
+
+    wholeDst->readBytes((quint8*)wholeData.data(), imageRect);
+    stripsDst->readBytes((quint8*)stripsData.data(), imageRect);
+
+    QVERIFY(wholeData == stripsData);
+}
+
+void KisConvolutionPainterTest::testInPlace_data()
+{
+    QTest::addColumn<int>("engine");
+    QTest::addColumn<int>("diameter");
+
+    QTest::newRow("spatial") << int(KisConvolutionPainter::SPATIAL) << 5;
+    QTest::newRow("fftw") << int(KisConvolutionPainter::FFTW) << 41;
+}
+
+/**
+ * The convolution filters apply the matrix in place, that is the
+ * source and the destination are the same device. The filter stroke
+ * keeps a transaction open on the device, so the workers read the
+ * old pixels instead of the ones they have already written.
+ */
+void KisConvolutionPainterTest::testInPlace()
+{
+    QFETCH(int, engine);
+    QFETCH(int, diameter);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(-10, -37, 1300, 900);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillWithNoise(dev, imageRect, 3);
+
+    QScopedPointer<KisCircleMaskGenerator> kas(new KisCircleMaskGenerator(diameter, 1.0, 5, 5, 2, false));
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMaskGenerator(kas.data());
+
+    KisPaintDeviceSP copyDst = new KisPaintDevice(cs);
+    KisConvolutionPainter copyPainter(copyDst, KisConvolutionPainter::TestingEnginePreference(engine));
+    copyPainter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(),
+                            imageRect.size(), BORDER_REPEAT);
+
+    // the same as KisConvolutionFilter::processImpl() does
+    KisTransaction transaction(dev);
+    KisConvolutionPainter inPlacePainter(dev, KisConvolutionPainter::TestingEnginePreference(engine));
+    inPlacePainter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(),
+                               imageRect.size(), BORDER_REPEAT);
+    transaction.end();
+
+    QByteArray inPlaceData(imageRect.width() * imageRect.height() * cs->pixelSize(), 0);
+    QByteArray copyData(inPlaceData.size(), 0);
+
+    dev->readBytes((quint8*)inPlaceData.data(), imageRect);
+    copyDst->readBytes((quint8*)copyData.data(), imageRect);
+
+    QVERIFY(inPlaceData == copyData);
+}
+
 QTEST_MAIN(KisConvolutionPainterTest)
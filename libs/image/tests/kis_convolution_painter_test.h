@@ -56,6 +56,15 @@ private Q_SLOTS:
 
     void testGaussianDetailsSpatial();
     void testGaussianDetailsFFTW();
+
+    void testTiledFFTW_data();
+    void testTiledFFTW();
+
+    void testBandedSpatial_data();
+    void testBandedSpatial();
+
+    void testInPlace_data();
+    void testInPlace();
 };
 
 #endif
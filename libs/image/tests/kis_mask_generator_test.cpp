@@ -181,5 +181,87 @@ void KisMaskGeneratorTest::testCopyCtorGaussRect()
     testCopyCtor(&gen);
 }
 
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include "kis_fixed_paint_device.h"
+#include "kis_brush_mask_applicator_base.h"
+
+/**
+ * Checks that the applicator of the generator (vectorized, when
+ * available) produces the same mask as the scalar valueAt()
+ */
+void testApplicator(KisMaskGenerator *gen)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+    dev->setRect(QRect(0, 0, 60, 45));
+    dev->initialize(255);
+
+    const qreal centerX = 29.5;
+    const qreal centerY = 22.5;
+
+    MaskProcessingData data(dev, cs,
+                            0.0, 1.0,
+                            centerX, centerY, 0);
+
+    KisBrushMaskApplicatorBase *applicator = gen->applicator();
+    applicator->initializeData(&data);
+    applicator->process(dev->bounds());
+
+    const quint8 *pixel = dev->data();
+
+    for (int y = 0; y < dev->bounds().height(); y++) {
+        for (int x = 0; x < dev->bounds().width(); x++) {
+            const int expected = 255 - gen->valueAt(x - centerX, y - centerY);
+            const int actual = cs->opacityU8(pixel);
+
+            if (qAbs(expected - actual) > 2) {
+                qDebug() << "Failed at" << x << y << "expected:" << expected << "actual:" << actual;
+                QFAIL("The applicator doesn't match the generator");
+            }
+
+            pixel += cs->pixelSize();
+        }
+    }
+}
+
+void KisMaskGeneratorTest::testApplicatorRect()
+{
+    KisRectangleMaskGenerator gen(40, 0.7, 0.5, 0.6, 2, true);
+    testApplicator(&gen);
+}
+
+void KisMaskGeneratorTest::testApplicatorGaussCircle()
+{
+    KisGaussCircleMaskGenerator gen(40, 0.7, 0.5, 0.6, 2, true);
+    testApplicator(&gen);
+}
+
+void KisMaskGeneratorTest::testApplicatorGaussRect()
+{
+    KisGaussRectangleMaskGenerator gen(40, 0.7, 0.5, 0.6, 2, true);
+    testApplicator(&gen);
+}
+
+void KisMaskGeneratorTest::testApplicatorCurveCircle()
+{
+    KisCurveCircleMaskGenerator gen(40, 0.7,
+                                    0.5, 0.6,
+                                    2,
+                                    KisCubicCurve(), // linear
+                                    true);
+    testApplicator(&gen);
+}
+
+void KisMaskGeneratorTest::testApplicatorCurveRect()
+{
+    KisCurveRectangleMaskGenerator gen(40, 0.7,
+                                       0.5, 0.6,
+                                       2,
+                                       KisCubicCurve(), // linear
+                                       true);
+    testApplicator(&gen);
+}
+
 
 QTEST_MAIN(KisMaskGeneratorTest)
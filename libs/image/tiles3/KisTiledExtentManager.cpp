@@ -23,9 +23,32 @@
 #include "kis_tile_data_interface.h"
 #include "kis_assert.h"
 #include "kis_global.h"
+#include "kis_algebra_2d.h"
 
 namespace {
 
+/**
+ * The blocks of the occupancy index are 8x8 tiles, so that
+ * the bitmap of a block fits into one quint64
+ */
+const int BLOCK_SIZE = 8;
+
+inline quint64 packIndex(int x, int y)
+{
+    return (quint64(quint32(y)) << 32) | quint64(quint32(x));
+}
+
+inline int blockIndex(int tileIndex)
+{
+    return KisAlgebra2D::divideFloor(tileIndex, BLOCK_SIZE);
+}
+
+inline quint64 bitInBlock(int col, int row, int blockCol, int blockRow)
+{
+    return quint64(1) << ((row - blockRow * BLOCK_SIZE) * BLOCK_SIZE +
+                          (col - blockCol * BLOCK_SIZE));
+}
+
 inline bool addTileToMap(int index, QMap<int, int> *map)
 {
     bool needsUpdateExtent = false;
@@ -79,6 +102,7 @@ void KisTiledExtentManager::notifyTileAdded(int col, int row)
 
     needsUpdateExtent |= addTileToMap(col, &m_colMap);
     needsUpdateExtent |= addTileToMap(row, &m_rowMap);
+    addTileToIndex(col, row);
 
     if (needsUpdateExtent) {
         updateExtent();
@@ -93,6 +117,7 @@ void KisTiledExtentManager::notifyTileRemoved(int col, int row)
 
     needsUpdateExtent |= removeTileFromMap(col, &m_colMap);
     needsUpdateExtent |= removeTileFromMap(row, &m_rowMap);
+    removeTileFromIndex(col, row);
 
     if (needsUpdateExtent) {
         updateExtent();
@@ -105,10 +130,13 @@ void KisTiledExtentManager::replaceTileStats(const QVector<QPoint> &indexes)
 
     m_colMap.clear();
     m_rowMap.clear();
+    m_blocks.clear();
+    m_superBlocks.clear();
 
     Q_FOREACH (const QPoint &index, indexes) {
         addTileToMap(index.x(), &m_colMap);
         addTileToMap(index.y(), &m_rowMap);
+        addTileToIndex(index.x(), index.y());
     }
 
     updateExtent();
@@ -120,8 +148,9 @@ void KisTiledExtentManager::clear()
 
     m_colMap.clear();
     m_rowMap.clear();
+    m_blocks.clear();
+    m_superBlocks.clear();
     m_currentExtent = QRect(qint32_MAX, qint32_MAX, 0, 0);
-
 }
 
 QRect KisTiledExtentManager::extent() const
@@ -130,6 +159,154 @@ QRect KisTiledExtentManager::extent() const
     return m_currentExtent;
 }
 
+bool KisTiledExtentManager::hasTile(int col, int row) const
+{
+    const int blockCol = blockIndex(col);
+    const int blockRow = blockIndex(row);
+
+    QMutexLocker l(&m_mutex);
+
+    auto it = m_blocks.constFind(packIndex(blockCol, blockRow));
+    return it != m_blocks.constEnd() &&
+        (*it & bitInBlock(col, row, blockCol, blockRow));
+}
+
+bool KisTiledExtentManager::rowHasTiles(int row) const
+{
+    QMutexLocker l(&m_mutex);
+    return m_rowMap.contains(row);
+}
+
+bool KisTiledExtentManager::colHasTiles(int col) const
+{
+    QMutexLocker l(&m_mutex);
+    return m_colMap.contains(col);
+}
+
+QVector<QPoint> KisTiledExtentManager::tilesInRect(const QRect &tileRect) const
+{
+    QVector<QPoint> result;
+
+    QMutexLocker l(&m_mutex);
+    tilesInRectImpl(tileRect, &result);
+
+    return result;
+}
+
+QVector<QPoint> KisTiledExtentManager::tiles() const
+{
+    QVector<QPoint> result;
+
+    QMutexLocker l(&m_mutex);
+
+    if (!m_colMap.isEmpty()) {
+        const QRect allTiles(QPoint(m_colMap.firstKey(), m_rowMap.firstKey()),
+                             QPoint(m_colMap.lastKey(), m_rowMap.lastKey()));
+        tilesInRectImpl(allTiles, &result);
+    }
+
+    return result;
+}
+
+void KisTiledExtentManager::tilesInRectImpl(const QRect &tileRect, QVector<QPoint> *result) const
+{
+    if (m_colMap.isEmpty()) return;
+
+    /**
+     * Don't let huge query rects make us iterate through
+     * the empty superblocks outside the extent
+     */
+    const QRect rc = tileRect &
+        QRect(QPoint(m_colMap.firstKey(), m_rowMap.firstKey()),
+              QPoint(m_colMap.lastKey(), m_rowMap.lastKey()));
+
+    if (rc.isEmpty()) return;
+
+    const int firstBlockCol = blockIndex(rc.left());
+    const int lastBlockCol = blockIndex(rc.right());
+    const int firstBlockRow = blockIndex(rc.top());
+    const int lastBlockRow = blockIndex(rc.bottom());
+
+    const int firstSuperCol = blockIndex(firstBlockCol);
+    const int lastSuperCol = blockIndex(lastBlockCol);
+    const int firstSuperRow = blockIndex(firstBlockRow);
+    const int lastSuperRow = blockIndex(lastBlockRow);
+
+    for (int superRow = firstSuperRow; superRow <= lastSuperRow; superRow++) {
+        for (int superCol = firstSuperCol; superCol <= lastSuperCol; superCol++) {
+            if (!m_superBlocks.contains(packIndex(superCol, superRow))) continue;
+
+            const int blockRowStart = qMax(firstBlockRow, superRow * BLOCK_SIZE);
+            const int blockRowEnd = qMin(lastBlockRow, superRow * BLOCK_SIZE + BLOCK_SIZE - 1);
+            const int blockColStart = qMax(firstBlockCol, superCol * BLOCK_SIZE);
+            const int blockColEnd = qMin(lastBlockCol, superCol * BLOCK_SIZE + BLOCK_SIZE - 1);
+
+            for (int blockRow = blockRowStart; blockRow <= blockRowEnd; blockRow++) {
+                for (int blockCol = blockColStart; blockCol <= blockColEnd; blockCol++) {
+                    auto it = m_blocks.constFind(packIndex(blockCol, blockRow));
+                    if (it == m_blocks.constEnd()) continue;
+
+                    quint64 bits = *it;
+
+                    for (int i = 0; bits; i++, bits >>= 1) {
+                        if (!(bits & 1)) continue;
+
+                        const QPoint index(blockCol * BLOCK_SIZE + i % BLOCK_SIZE,
+                                           blockRow * BLOCK_SIZE + i / BLOCK_SIZE);
+
+                        if (rc.contains(index)) {
+                            result->append(index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void KisTiledExtentManager::addTileToIndex(int col, int row)
+{
+    const int blockCol = blockIndex(col);
+    const int blockRow = blockIndex(row);
+    const quint64 bit = bitInBlock(col, row, blockCol, blockRow);
+
+    quint64 &bits = m_blocks[packIndex(blockCol, blockRow)];
+    KIS_ASSERT_RECOVER_NOOP(!(bits & bit));
+
+    if (!bits) {
+        m_superBlocks[packIndex(blockIndex(blockCol), blockIndex(blockRow))]++;
+    }
+
+    bits |= bit;
+}
+
+void KisTiledExtentManager::removeTileFromIndex(int col, int row)
+{
+    const int blockCol = blockIndex(col);
+    const int blockRow = blockIndex(row);
+    const quint64 bit = bitInBlock(col, row, blockCol, blockRow);
+
+    auto it = m_blocks.find(packIndex(blockCol, blockRow));
+
+    if (it == m_blocks.end() || !(*it & bit)) {
+        KIS_ASSERT_RECOVER_NOOP(0 && "sanity check failed: the tile is not present in the index!");
+        return;
+    }
+
+    *it &= ~bit;
+
+    if (!*it) {
+        m_blocks.erase(it);
+
+        auto superIt = m_superBlocks.find(packIndex(blockIndex(blockCol), blockIndex(blockRow)));
+        KIS_ASSERT_RECOVER_RETURN(superIt != m_superBlocks.end());
+
+        if (--(*superIt) <= 0) {
+            m_superBlocks.erase(superIt);
+        }
+    }
+}
+
 void KisTiledExtentManager::updateExtent()
 {
     KIS_ASSERT_RECOVER_RETURN(m_colMap.isEmpty() == m_rowMap.isEmpty());
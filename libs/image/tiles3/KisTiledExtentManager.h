@@ -21,10 +21,23 @@
 
 #include <QMutex>
 #include <QMap>
+#include <QHash>
 #include <QRect>
+#include <QVector>
 #include "kritaimage_export.h"
 
 
+/**
+ * Keeps track of the tiles present in the data manager.
+ *
+ * Apart from the row and column counters used for calculating the
+ * extent, the manager keeps a two-level occupancy pyramid of the
+ * tiles: a 64-bit bitmap of 8x8 tiles per block and the count of
+ * non-empty blocks per superblock of 8x8 blocks. It lets us answer "which tiles exist inside rect R"
+ * without walking the whole hash table, which is important for huge
+ * sparse devices. The tiles that are not present are guaranteed to
+ * contain default pixels only.
+ */
 class KRITAIMAGE_EXPORT KisTiledExtentManager
 {
 public:
@@ -38,14 +51,58 @@ public:
 
     QRect extent() const;
 
+    /**
+     * \return true if the tile at (\p col, \p row) exists
+     */
+    bool hasTile(int col, int row) const;
+
+    /**
+     * \return true if there is at least one tile in the row \p row
+     */
+    bool rowHasTiles(int row) const;
+
+    /**
+     * \return true if there is at least one tile in the column \p col
+     */
+    bool colHasTiles(int col) const;
+
+    /**
+     * Returns the indexes of the existing tiles that lie inside \p tileRect.
+     * The rect is measured in tiles, not in pixels. The cost of the call
+     * is proportional to the number of the found tiles and the number
+     * of the superblocks intersecting \p tileRect.
+     */
+    QVector<QPoint> tilesInRect(const QRect &tileRect) const;
+
+    /**
+     * Returns the indexes of all the existing tiles
+     */
+    QVector<QPoint> tiles() const;
+
 private:
     void updateExtent();
 
+    void addTileToIndex(int col, int row);
+    void removeTileFromIndex(int col, int row);
+    void tilesInRectImpl(const QRect &tileRect, QVector<QPoint> *result) const;
+
 private:
     mutable QMutex m_mutex;
     QMap<int, int> m_colMap;
     QMap<int, int> m_rowMap;
     QRect m_currentExtent;
+
+    /**
+     * Level 0 of the occupancy pyramid: block index -> bitmap of the
+     * existing tiles inside the block
+     */
+    QHash<quint64, quint64> m_blocks;
+
+    /**
+     * Level 1 of the occupancy pyramid: superblock index -> number of
+     * non-empty blocks inside the superblock
+     */
+    QHash<quint64, int> m_superBlocks;
 };
 
 #endif // KISTILEDEXTENTMANAGER_H
@@ -62,6 +62,8 @@ KisHLineIterator2::KisHLineIterator2(KisDataManager *dataManager, qint32 x, qint
     for (quint32 i = 0; i < m_tilesCacheSize; i++){
         fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
     }
+    prefetchNextRow();
+
     m_index = 0;
     switchToTile(m_leftInLeftmostTile);
 }
@@ -219,6 +221,14 @@ void KisHLineIterator2::preallocateTiles()
         unlockTile(m_tilesCache[i].oldtile);
         fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
     }
+    prefetchNextRow();
+}
+
+void KisHLineIterator2::prefetchNextRow()
+{
+    for (quint32 i = 0; i < m_tilesCacheSize; ++i) {
+        m_dataManager->prefetchTile(m_leftCol + i, m_row + 1);
+    }
 }
 
 qint32 KisHLineIterator2::x() const
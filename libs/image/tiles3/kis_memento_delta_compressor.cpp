@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_memento_delta_compressor.h"
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QScopedPointer>
+
+#include "kis_memento_item.h"
+#include "swap/kis_abstract_compression.h"
+#include "swap/kis_compression_registry.h"
+#include "kis_image_config.h"
+
+
+struct Q_DECL_HIDDEN KisMementoDeltaCompressor::Private
+{
+    QMutex lock;
+    QWaitCondition workCondition;
+    QWaitCondition idleCondition;
+    QQueue<KisMementoItemSP> queue;
+
+    bool isBusy = false;
+    bool shouldExit = false;
+    bool enabled = true;
+
+    /**
+     * The compression object is used by the compression thread only,
+     * but it is recreated when the config is reread
+     */
+    QScopedPointer<KisAbstractCompression> compression;
+    quint8 compressionId = KisCompressionRegistry::RAW_DATA_ID;
+
+    void loadConfig();
+};
+
+void KisMementoDeltaCompressor::Private::loadConfig()
+{
+    KisImageConfig config(true);
+    enabled = config.enableUndoDeltaCompression();
+
+    const QString name =
+        KisCompressionRegistry::compressionForUsage(KisCompressionRegistry::UndoUsage);
+
+    compression.reset(KisCompressionRegistry::create(name));
+    compressionId = KisCompressionRegistry::idForName(name);
+}
+
+KisMementoDeltaCompressor::KisMementoDeltaCompressor()
+    : QThread(),
+      m_d(new Private())
+{
+    m_d->loadConfig();
+}
+
+KisMementoDeltaCompressor::~KisMementoDeltaCompressor()
+{
+    clearQueue();
+    delete m_d;
+}
+
+void KisMementoDeltaCompressor::compressLater(KisMementoItem *item)
+{
+    QMutexLocker locker(&m_d->lock);
+
+    if (!m_d->enabled || m_d->shouldExit) return;
+
+    m_d->queue.enqueue(KisMementoItemSP(item));
+    m_d->workCondition.wakeOne();
+}
+
+void KisMementoDeltaCompressor::terminateCompressor()
+{
+    {
+        QMutexLocker locker(&m_d->lock);
+        m_d->shouldExit = true;
+        m_d->workCondition.wakeAll();
+    }
+
+    wait();
+    clearQueue();
+
+    QMutexLocker locker(&m_d->lock);
+    m_d->shouldExit = false;
+}
+
+void KisMementoDeltaCompressor::testingRereadConfig()
+{
+    testingWaitForIdle();
+
+    QMutexLocker locker(&m_d->lock);
+    m_d->loadConfig();
+}
+
+void KisMementoDeltaCompressor::testingWaitForIdle()
+{
+    QMutexLocker locker(&m_d->lock);
+
+    while (!m_d->queue.isEmpty() || m_d->isBusy) {
+        m_d->idleCondition.wait(&m_d->lock);
+    }
+}
+
+void KisMementoDeltaCompressor::clearQueue()
+{
+    QQueue<KisMementoItemSP> queue;
+
+    {
+        QMutexLocker locker(&m_d->lock);
+        queue.swap(m_d->queue);
+    }
+
+    /**
+     * The items (and the whole history chains) may be freed
+     * here, so the queue is destroyed without any locks held
+     */
+}
+
+void KisMementoDeltaCompressor::run()
+{
+    QMutexLocker locker(&m_d->lock);
+
+    while (1) {
+        while (m_d->queue.isEmpty() && !m_d->shouldExit) {
+            m_d->workCondition.wait(&m_d->lock);
+        }
+
+        if (m_d->shouldExit) break;
+
+        KisMementoItemSP item = m_d->queue.dequeue();
+        m_d->isBusy = true;
+
+        locker.unlock();
+
+        if (m_d->compression) {
+            item->compressDelta(m_d->compression.data(), m_d->compressionId);
+        }
+        item = 0;
+
+        locker.relock();
+
+        m_d->isBusy = false;
+        if (m_d->queue.isEmpty()) {
+            m_d->idleCondition.wakeAll();
+        }
+    }
+
+    m_d->isBusy = false;
+    m_d->idleCondition.wakeAll();
+}
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_MEMENTO_DELTA_COMPRESSOR_H
+#define __KIS_MEMENTO_DELTA_COMPRESSOR_H
+
+#include <QThread>
+
+#include "kritaimage_export.h"
+
+class KisMementoItem;
+
+/**
+ * A thread that compresses the superseded revisions of the tiles
+ * stored in the undo history. The memento manager queues the items
+ * on every commit, the compression is done lazily, so the painting
+ * thread never waits for it.
+ *
+ * \see KisMementoItem::compressDelta()
+ */
+class KRITAIMAGE_EXPORT KisMementoDeltaCompressor : public QThread
+{
+    Q_OBJECT
+
+public:
+    KisMementoDeltaCompressor();
+    ~KisMementoDeltaCompressor() override;
+
+    /**
+     * Queues the item for compression. The queue keeps
+     * a reference to the item until it is processed.
+     */
+    void compressLater(KisMementoItem *item);
+
+    void terminateCompressor();
+
+    void testingRereadConfig();
+
+    /**
+     * Blocks until all the queued items are processed
+     */
+    void testingWaitForIdle();
+
+private:
+    void run() override;
+
+    void clearQueue();
+
+private:
+    struct Private;
+    Private * const m_d;
+};
+
+#endif /* __KIS_MEMENTO_DELTA_COMPRESSOR_H */
@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_memento_item.h"
+
+#include <QAtomicInteger>
+#include <QScopedArrayPointer>
+#include <QScopedPointer>
+
+#include "swap/kis_abstract_compression.h"
+#include "swap/kis_compression_registry.h"
+#include "kis_assert.h"
+
+
+const int KisMementoItem::MAX_DELTA_DEPTH = 8;
+
+namespace {
+QAtomicInteger<qint64> s_totalDeltaMemorySize;
+}
+
+struct KisMementoItem::DeltaData
+{
+    QByteArray data;
+    quint8 compressionId;
+    qint32 pixelSize;
+
+    /**
+     * The number of compressed revisions in the chain
+     * including this one
+     */
+    int depth;
+};
+
+void KisMementoItem::setSuperseded(bool value)
+{
+    QMutexLocker locker(&m_deltaLock);
+    m_superseded = value;
+}
+
+bool KisMementoItem::isDeltaCompressed()
+{
+    QMutexLocker locker(&m_deltaLock);
+    return m_delta != 0;
+}
+
+qint32 KisMementoItem::pixelSize() const
+{
+    return m_delta ? m_delta->pixelSize : m_tileData->pixelSize();
+}
+
+void KisMementoItem::reconstructData(quint8 *dst, qint32 dataSize)
+{
+    // PRECONDITION: m_deltaLock is locked
+
+    if (!m_delta) {
+        m_tileData->blockSwapping();
+        memcpy(dst, m_tileData->data(), dataSize);
+        m_tileData->unblockSwapping();
+        return;
+    }
+
+    {
+        QMutexLocker parentLocker(&m_parent->m_deltaLock);
+        m_parent->reconstructData(dst, dataSize);
+    }
+
+    QScopedPointer<KisAbstractCompression> compression(
+        KisCompressionRegistry::create(
+            KisCompressionRegistry::nameForId(m_delta->compressionId)));
+    KIS_ASSERT_RECOVER_RETURN(compression);
+
+    QScopedArrayPointer<quint8> delta(new quint8[dataSize]);
+    const qint32 bytesWritten =
+        compression->decompress((const quint8*)m_delta->data.constData(),
+                                m_delta->data.size(), delta.data(), dataSize);
+    KIS_ASSERT_RECOVER_RETURN(bytesWritten == dataSize);
+
+    for (qint32 i = 0; i < dataSize; i++) {
+        dst[i] ^= delta[i];
+    }
+}
+
+bool KisMementoItem::compressDelta(KisAbstractCompression *compression, quint8 compressionId)
+{
+    QMutexLocker locker(&m_deltaLock);
+
+    if (!m_superseded || m_delta || !m_committedFlag ||
+        !m_tileData || m_type != CHANGED || !m_parent) {
+
+        return false;
+    }
+
+    /**
+     * If the tile data is still used by a tile or by another
+     * device, compressing it will not free any memory
+     */
+    if (m_tileData->numUsers() > 1) return false;
+
+    const qint32 pixelSize = m_tileData->pixelSize();
+    const qint32 dataSize = KisTileData::WIDTH * KisTileData::HEIGHT * pixelSize;
+
+    QScopedArrayPointer<quint8> delta(new quint8[dataSize]);
+    int depth = 1;
+
+    {
+        QMutexLocker parentLocker(&m_parent->m_deltaLock);
+
+        if (m_parent->m_delta) {
+            depth = m_parent->m_delta->depth + 1;
+        }
+
+        if (depth > MAX_DELTA_DEPTH ||
+            m_parent->pixelSize() != pixelSize) {
+
+            return false;
+        }
+
+        m_parent->reconstructData(delta.data(), dataSize);
+    }
+
+    m_tileData->blockSwapping();
+    const quint8 *data = m_tileData->data();
+    for (qint32 i = 0; i < dataSize; i++) {
+        delta[i] ^= data[i];
+    }
+    m_tileData->unblockSwapping();
+
+    QByteArray compressedDelta(compression->outputBufferSize(dataSize), Qt::Uninitialized);
+    const qint32 compressedSize =
+        compression->compress(delta.data(), dataSize,
+                              (quint8*)compressedDelta.data(),
+                              compressedDelta.size());
+
+    /**
+     * The revisions that differ too much are not worth
+     * the time spent on the reconstruction
+     */
+    if (compressedSize <= 0 || compressedSize > dataSize / 2) {
+        return false;
+    }
+
+    compressedDelta.resize(compressedSize);
+
+    m_delta = new DeltaData();
+    m_delta->data = compressedDelta;
+    m_delta->compressionId = compressionId;
+    m_delta->pixelSize = pixelSize;
+    m_delta->depth = depth;
+
+    s_totalDeltaMemorySize.fetchAndAddRelaxed(compressedSize);
+
+    releaseTileData();
+    m_tileData = 0;
+
+    return true;
+}
+
+void KisMementoItem::decompressDelta()
+{
+    QMutexLocker locker(&m_deltaLock);
+
+    if (!m_delta) return;
+
+    const qint32 pixelSize = m_delta->pixelSize;
+    const qint32 dataSize = KisTileData::WIDTH * KisTileData::HEIGHT * pixelSize;
+
+    const QByteArray defaultPixel(pixelSize, 0);
+    KisTileData *td = KisTileDataStore::instance()->
+        createDefaultTileData(pixelSize, (const quint8*)defaultPixel.constData());
+
+    td->blockSwapping();
+    reconstructData(td->data(), dataSize);
+    td->unblockSwapping();
+
+    /**
+     * The item is committed, so take the tile data the
+     * same way commit() does
+     */
+    td->acquire();
+    td->setMementoed(true);
+    m_tileData = td;
+
+    releaseDelta();
+}
+
+void KisMementoItem::rebaseParent(KisMementoItemSP parent)
+{
+    if (m_parent == parent) return;
+
+    decompressDelta();
+
+    QMutexLocker locker(&m_deltaLock);
+    m_parent = parent;
+}
+
+qint64 KisMementoItem::totalDeltaMemorySize()
+{
+    return s_totalDeltaMemorySize.load();
+}
+
+void KisMementoItem::releaseDelta()
+{
+    if (m_delta) {
+        s_totalDeltaMemorySize.fetchAndAddRelaxed(-m_delta->data.size());
+    }
+
+    delete m_delta;
+    m_delta = 0;
+}
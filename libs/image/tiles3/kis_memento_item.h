@@ -19,15 +19,18 @@
 #ifndef KIS_MEMENTO_ITEM_H_
 #define KIS_MEMENTO_ITEM_H_
 
+#include <QMutex>
+
 #include <kis_shared.h>
 #include <kis_shared_ptr.h>
 #include "kis_tile.h"
 
+class KisAbstractCompression;
 
 class KisMementoItem;
 typedef KisSharedPtr<KisMementoItem> KisMementoItemSP;
 
-class KisMementoItem : public KisShared
+class KRITAIMAGE_EXPORT KisMementoItem : public KisShared
 {
 public:
     enum enumType {
@@ -37,7 +40,8 @@ public:
 
 public:
     KisMementoItem()
-            : m_tileData(0), m_committedFlag(false) {
+            : m_tileData(0), m_committedFlag(false),
+              m_superseded(false), m_delta(0) {
     }
 
     KisMementoItem(const KisMementoItem& rhs)
@@ -47,8 +51,15 @@ public:
             m_type(rhs.m_type),
             m_col(rhs.m_col),
             m_row(rhs.m_row),
-            m_next(0),
-            m_parent(0) {
+            m_parent(0),
+            m_superseded(false),
+            m_delta(0) {
+        /**
+         * Only the head revisions are copied, they
+         * are never stored as deltas
+         */
+        Q_ASSERT(!rhs.m_delta);
+
         if (m_tileData) {
             if (m_committedFlag)
                 m_tileData->acquire();
@@ -76,6 +87,8 @@ public:
         m_type = DELETED;
         m_parent = 0;
         m_committedFlag = true; /* yes, we've committed it */
+        m_superseded = false;
+        m_delta = 0;
     }
 
     /**
@@ -84,6 +97,8 @@ public:
      */
     KisMementoItem(const KisMementoItem &rhs, KisMementoManager *mm) {
         Q_UNUSED(mm);
+        Q_ASSERT(!rhs.m_delta);
+
         m_tileData = rhs.m_tileData;
         /* Setting counter: m_refCount++ */
         m_tileData->ref();
@@ -92,10 +107,13 @@ public:
         m_type = CHANGED;
         m_parent = 0;
         m_committedFlag = false;
+        m_superseded = false;
+        m_delta = 0;
     }
 
     ~KisMementoItem() {
         releaseTileData();
+        releaseDelta();
     }
 
     void notifyDead() {
@@ -144,10 +162,45 @@ public:
     }
 
     inline KisTileSP tile(KisMementoManager *mm) {
+        decompressDelta();
+
         Q_ASSERT(m_tileData);
         return KisTileSP(new KisTile(m_col, m_row, m_tileData, mm));
     }
 
+    /**
+     * Delta compression of the undo history.
+     *
+     * When a newer revision of the tile is committed, the older one
+     * is marked as superseded and queued for compression. The
+     * compression thread replaces its tile data with a compressed
+     * XOR-difference against the parent revision (the one preceding
+     * it in history) by calling compressDelta(). The data is restored
+     * transparently by tile() when the revision is needed for undo
+     * or redo.
+     *
+     * Since the difference is computed against the parent, and the
+     * parent is owned by the item anyway, the base of the delta can
+     * never disappear. Every MAX_DELTA_DEPTH'th revision is kept
+     * uncompressed to limit the cost of the reconstruction.
+     */
+    void setSuperseded(bool value);
+    bool compressDelta(KisAbstractCompression *compression, quint8 compressionId);
+    void decompressDelta();
+    bool isDeltaCompressed();
+
+    /**
+     * Changes the parent of a committed item. The data of the item
+     * is restored before that if it depends on the old parent.
+     */
+    void rebaseParent(KisMementoItemSP parent);
+
+    /**
+     * The total size of the compressed deltas of all the
+     * items in all the documents. Used for statistics.
+     */
+    static qint64 totalDeltaMemorySize();
+
     inline enumType type() {
         return m_type;
     }
@@ -159,13 +212,9 @@ public:
         return m_parent;
     }
 
+    static const int MAX_DELTA_DEPTH;
+
     // Stuff for Kis..HashTable
-    inline void setNext(KisMementoItemSP next) {
-        m_next = next;
-    }
-    inline KisMementoItemSP next() const {
-        return m_next;
-    }
     inline qint32 col() const {
         return m_col;
     }
@@ -180,8 +229,7 @@ public:
         QString s = QString("------\n"
                    "Memento item:\t\t0x%1 (0x%2)\n"
                    "   status:\t(%3,%4) %5%6\n"
-                   "   parent:\t0x%7 (0x%8)\n"
-                   "   next:\t0x%9 (0x%10)\n")
+                   "   parent:\t0x%7 (0x%8)\n")
                 .arg((quintptr)this)
                 .arg((quintptr)m_tileData)
                 .arg(m_col)
@@ -189,9 +237,7 @@ public:
                 .arg((m_type == CHANGED) ? 'W' : 'D')
                 .arg(m_committedFlag ? 'C' : '-')
                 .arg((quintptr)m_parent.data())
-                .arg(m_parent ? (quintptr)m_parent->m_tileData : 0)
-                .arg((quintptr)m_next.data())
-                .arg(m_next ? (quintptr)m_next->m_tileData : 0);
+                .arg(m_parent ? (quintptr)m_parent->m_tileData : 0);
         dbgKrita << s;
     }
 
@@ -216,9 +262,24 @@ protected:
     qint32 m_col;
     qint32 m_row;
 
-    KisMementoItemSP m_next;
     KisMementoItemSP m_parent;
+
 private:
+    struct DeltaData;
+
+    void releaseDelta();
+    qint32 pixelSize() const;
+    void reconstructData(quint8 *dst, qint32 dataSize);
+
+private:
+    /**
+     * Guards m_tileData, m_delta and m_superseded of the committed
+     * items against the compression thread. When both an item and
+     * its parent are locked, the child is always locked first.
+     */
+    QMutex m_deltaLock;
+    bool m_superseded;
+    DeltaData *m_delta;
 };
 
 
@@ -195,6 +195,13 @@ void KisMementoManager::commit()
         mi->commit();
         revisionList.append(mi);
 
+        /**
+         * The previous revision is not needed until undo,
+         * so it can be compressed now
+         */
+        parentMI->setSuperseded(true);
+        KisTileDataStore::instance()->compressMementoItemLater(parentMI.data());
+
         m_headsHashTable.deleteTile(mi->col(), mi->row());
 
         iter.moveCurrentToHashTable(&m_headsHashTable);
@@ -230,6 +237,28 @@ KisTileSP KisMementoManager::getCommitedTile(qint32 col, qint32 row, bool &exist
     return mi->tile(0);
 }
 
+QVector<QPoint> KisMementoManager::changedTilesInTransaction()
+{
+    QVector<QPoint> result;
+    if(!namedTransactionInProgress()) return result;
+
+    KisMementoItemSP mi;
+    KisMementoItemHashTableIteratorConst iter(&m_index);
+
+    while ((mi = iter.tile())) {
+        result.append(QPoint(mi->col(), mi->row()));
+        iter.next();
+    }
+
+    return result;
+}
+
+bool KisMementoManager::tileChangedInTransaction(qint32 col, qint32 row)
+{
+    return namedTransactionInProgress() &&
+        m_index.getExistingTile(col, row);
+}
+
 KisMementoSP KisMementoManager::getMemento()
 {
     /**
@@ -273,6 +302,8 @@ void KisMementoManager::rollback(KisTileHashTable *ht)
         mi=*iter;
         parentMI = mi->parent();
 
+        parentMI->setSuperseded(false);
+
         if (mi->type() == KisMementoItem::CHANGED)
             ht->deleteTile(mi->col(), mi->row());
         if (parentMI->type() == KisMementoItem::CHANGED)
@@ -380,7 +411,7 @@ void KisMementoManager::resetRevisionHistory(KisMementoItemList list)
         while (parentMI->parent()) {
             parentMI = parentMI->parent();
         }
-        mi->setParent(parentMI);
+        mi->rebaseParent(parentMI);
     }
 }
 
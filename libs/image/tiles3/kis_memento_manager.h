@@ -20,6 +20,8 @@
 #define KIS_MEMENTO_MANAGER_
 
 #include <QList>
+#include <QVector>
+#include <QPoint>
 
 #include "kis_memento_item.h"
 #include "kis_tile_hash_table.h"
@@ -94,6 +96,19 @@ public:
      */
     KisTileSP getCommitedTile(qint32 col, qint32 row, bool &existingTile);
 
+    /**
+     * Returns the positions of the tiles changed (or deleted) since
+     * the beginning of the current named transaction. Returns an
+     * empty list if no named transaction is in progress.
+     */
+    QVector<QPoint> changedTilesInTransaction();
+
+    /**
+     * Checks whether the tile has been changed (or deleted) in
+     * the current named transaction
+     */
+    bool tileChangedInTransaction(qint32 col, qint32 row);
+
     KisMementoSP getMemento();
 
     bool hasCurrentMemento() {
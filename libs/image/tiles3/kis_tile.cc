@@ -193,6 +193,12 @@ void KisTile::lockForWrite()
 
             DEBUG_COWING(tileData);
 
+            /**
+             * The registration must stay inside the COW mutex: the
+             * frozen-revision snapshots rely on seeing the new data
+             * only together with the tile registered in the memento
+             * manager, see refTileData()
+             */
             if (m_mementoManager)
                 m_mementoManager->registerTileChange(this);
         }
@@ -208,14 +214,45 @@ void KisTile::unlock() const
     DEBUG_LOG_ACTION("unlock");
 }
 
+void KisTile::prefetch() const
+{
+    /**
+     * m_tileData can be changed by COW only while the tile is
+     * locked, so holding the barrier lock is enough to keep the
+     * tile data alive until the prefetcher takes its reference
+     */
+    QMutexLocker locker(&m_swapBarrierLock);
+
+    if (!m_lockCounter) {
+        m_tileData->prefetch();
+    }
+}
+
+KisTileData* KisTile::refTileData()
+{
+    QMutexLocker locker(&m_COWMutex);
+
+    KisTileData *td = m_tileData;
+    td->ref();
+    return td;
+}
+
+void KisTile::setSwapPriority(KisTileData::SwapPriority priority, quint32 hintsPass) const
+{
+    QMutexLocker locker(&m_swapBarrierLock);
+
+    if (!m_lockCounter) {
+        m_tileData->mergeSwapPriority(priority, hintsPass);
+    }
+}
+
 
 #include <stdio.h>
 void KisTile::debugPrintInfo()
 {
     dbgTiles << "------\n"
                 "Tile:\t\t\t" << this
-                << "\n   data:\t" << m_tileData
-                << "\n   next:\t" <<  m_nextTile.data();
+                << "\n   data:\t" << m_tileData;
 
 }
 
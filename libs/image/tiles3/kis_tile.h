@@ -75,6 +75,21 @@ public:
     void lockForWrite();
     void unlock() const;
 
+    /**
+     * Starts loading the tile data in the background, if it has
+     * been swapped out. Call it for the tiles that are going to be
+     * locked soon. Doesn't block on the swap file.
+     */
+    void prefetch() const;
+
+    /**
+     * Passes the swap priority hint to the tile data. The hint is
+     * dropped if the tile is locked at the moment.
+     *
+     * \see KisTileData::mergeSwapPriority()
+     */
+    void setSwapPriority(KisTileData::SwapPriority priority, quint32 hintsPass) const;
+
     /* this allows us work directly on tile's data */
     inline quint8 *data() const {
         return m_tileData->data();
@@ -96,14 +111,6 @@ public:
 //                     KisTileData::WIDTH, KisTileData::HEIGHT);
     }
 
-    inline KisTileSP next() const {
-        return m_nextTile;
-    }
-
-    void setNext(KisTileSP next) {
-        m_nextTile = next;
-    }
-
     inline qint32 pixelSize() const {
         /* don't lock here as pixelSize is constant */
         return m_tileData->pixelSize();
@@ -113,6 +120,14 @@ public:
         return m_tileData;
     }
 
+    /**
+     * Returns the current tile data with an additional reference
+     * taken on it. Unlike tileData(), it is safe to call while some
+     * other thread is doing copy-on-write on the tile. The caller
+     * must call deref() on the returned object when done.
+     */
+    KisTileData* refTileData();
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
@@ -135,10 +150,6 @@ private:
      */
     QRect m_extent;
 
-    /**
-     * For KisTiledDataManager's hash table
-     */
-    KisTileSP m_nextTile;
 
 #ifdef DEAD_TILES_SANITY_CHECK
     QAtomicPointer<KisMementoManager> m_mementoManager;
@@ -22,15 +22,54 @@
 
 #include <kis_debug.h>
 
-#include <boost/pool/singleton_pool.hpp>
 #include "kis_tile_data_store_iterators.h"
+#include "kis_tile_data_slab_allocator.h"
 
-// BPP == bytes per pixel
-#define TILE_SIZE_4BPP (4 * __TILE_DATA_WIDTH * __TILE_DATA_HEIGHT)
-#define TILE_SIZE_8BPP (8 * __TILE_DATA_WIDTH * __TILE_DATA_HEIGHT)
+/**
+ * The pixel sizes of the color spaces we have, that is up to
+ * 32-bit floating point RGBA, are served by the slab allocators.
+ * The rest goes directly to malloc().
+ */
+struct KisTileDataAllocators
+{
+    KisTileDataAllocators()
+    {
+        for (int i = 0; i < NUM_ALLOCATORS; i++) {
+            allocators[i] = new KisTileDataSlabAllocator((1 << i) * __TILE_DATA_WIDTH * __TILE_DATA_HEIGHT);
+        }
+    }
+
+    static KisTileDataAllocators* instance()
+    {
+        /**
+         * The tile data objects may be destroyed by other static
+         * objects on exit, so the allocators are never deleted
+         */
+        static KisTileDataAllocators *s_instance = new KisTileDataAllocators();
+        return s_instance;
+    }
 
-typedef boost::singleton_pool<KisTileData, TILE_SIZE_4BPP, boost::default_user_allocator_new_delete, boost::details::pool::default_mutex, 256, 4096> BoostPool4BPP;
-typedef boost::singleton_pool<KisTileData, TILE_SIZE_8BPP, boost::default_user_allocator_new_delete, boost::details::pool::default_mutex, 128, 2048> BoostPool8BPP;
+    inline KisTileDataSlabAllocator* allocatorForPixelSize(qint32 pixelSize) const
+    {
+        switch (pixelSize) {
+        case 1:
+            return allocators[0];
+        case 2:
+            return allocators[1];
+        case 4:
+            return allocators[2];
+        case 8:
+            return allocators[3];
+        case 16:
+            return allocators[4];
+        default:
+            return 0;
+        }
+    }
+
+    static const int NUM_ALLOCATORS = 5;
+    KisTileDataSlabAllocator *allocators[NUM_ALLOCATORS];
+};
 
 const qint32 KisTileData::WIDTH = __TILE_DATA_WIDTH;
 const qint32 KisTileData::HEIGHT = __TILE_DATA_HEIGHT;
@@ -40,9 +79,16 @@ KisTileData::KisTileData(qint32 pixelSize, const quint8 *defPixel, KisTileDataSt
     : m_state(NORMAL),
       m_mementoFlag(0),
       m_age(0),
+      m_swapPriority(NormalPriority),
       m_usersCount(0),
       m_refCount(0),
       m_pixelSize(pixelSize),
+      m_solidPixel(0),
+      m_solidityChecked(false),
+      m_deduplicationSource(0),
+      m_isDeduplicationSource(false),
+      m_contentHash(0),
+      m_contentHashValid(false),
       m_store(store)
 {
     m_store->checkFreeMemory();
@@ -67,9 +113,16 @@ KisTileData::KisTileData(const KisTileData& rhs, bool checkFreeMemory)
     : m_state(NORMAL),
       m_mementoFlag(0),
       m_age(0),
+      m_swapPriority(NormalPriority),
       m_usersCount(0),
       m_refCount(0),
       m_pixelSize(rhs.m_pixelSize),
+      m_solidPixel(0),
+      m_solidityChecked(false),
+      m_deduplicationSource(0),
+      m_isDeduplicationSource(false),
+      m_contentHash(0),
+      m_contentHashValid(false),
       m_store(rhs.m_store)
 {
     if(checkFreeMemory) {
@@ -84,6 +137,7 @@ KisTileData::KisTileData(const KisTileData& rhs, bool checkFreeMemory)
 KisTileData::~KisTileData()
 {
     releaseMemory();
+    delete[] m_solidPixel;
 }
 
 void KisTileData::fillWithPixel(const quint8 *defPixel)
@@ -116,34 +170,85 @@ void KisTileData::allocateMemory()
     m_data = allocateData(m_pixelSize);
 }
 
-quint8* KisTileData::allocateData(const qint32 pixelSize)
+bool KisTileData::tryCompactSolidData()
 {
-    quint8 *ptr = 0;
-
-    switch(pixelSize) {
-    case 4:
-        ptr = (quint8*)BoostPool4BPP::malloc();
-        break;
-    case 8:
-        ptr = (quint8*)BoostPool8BPP::malloc();
-        break;
-    default:
-        ptr = (quint8*) malloc(pixelSize * WIDTH * HEIGHT);
+    Q_ASSERT(m_data);
+
+    if (m_solidityChecked.load(std::memory_order_relaxed)) return false;
+    m_solidityChecked.store(true, std::memory_order_relaxed);
+
+    /**
+     * All the pixels are equal iff every byte is equal
+     * to the byte lying one pixel further
+     */
+    const qint32 dataSize = m_pixelSize * WIDTH * HEIGHT;
+    if (memcmp(m_data, m_data + m_pixelSize, dataSize - m_pixelSize)) {
+        return false;
     }
 
-    return ptr;
+    m_solidPixel = new quint8[m_pixelSize];
+    memcpy(m_solidPixel, m_data, m_pixelSize);
+
+    releaseMemory();
+
+    return true;
+}
+
+void KisTileData::expandSolidData()
+{
+    Q_ASSERT(m_solidPixel);
+
+    allocateMemory();
+    fillWithPixel(m_solidPixel);
+
+    delete[] m_solidPixel;
+    m_solidPixel = 0;
+}
+
+void KisTileData::deduplicateWith(KisTileData *source)
+{
+    Q_ASSERT(m_data);
+    Q_ASSERT(!m_deduplicationSource);
+    Q_ASSERT(source->m_isDeduplicationSource);
+
+    source->ref();
+    m_deduplicationSource = source;
+
+    releaseMemory();
+}
+
+KisTileData* KisTileData::expandDeduplicatedData()
+{
+    Q_ASSERT(m_deduplicationSource);
+    Q_ASSERT(m_deduplicationSource->data());
+
+    allocateMemory();
+    memcpy(m_data, m_deduplicationSource->data(), m_pixelSize * WIDTH * HEIGHT);
+
+    KisTileData *source = m_deduplicationSource;
+    m_deduplicationSource = 0;
+
+    return source;
+}
+
+quint8* KisTileData::allocateData(const qint32 pixelSize)
+{
+    KisTileDataSlabAllocator *allocator =
+        KisTileDataAllocators::instance()->allocatorForPixelSize(pixelSize);
+
+    return allocator ?
+        allocator->allocate() :
+        (quint8*) malloc(pixelSize * WIDTH * HEIGHT);
 }
 
 void KisTileData::freeData(quint8* ptr, const qint32 pixelSize)
 {
-    switch(pixelSize) {
-    case 4:
-        BoostPool4BPP::free(ptr);
-        break;
-    case 8:
-        BoostPool8BPP::free(ptr);
-        break;
-    default:
+    KisTileDataSlabAllocator *allocator =
+        KisTileDataAllocators::instance()->allocatorForPixelSize(pixelSize);
+
+    if (allocator) {
+        allocator->free(ptr);
+    } else {
         free(ptr);
     }
 }
@@ -157,6 +262,7 @@ void KisTileData::freeData(quint8* ptr, const qint32 pixelSize)
 void KisTileData::releaseInternalPools()
 {
     const int maxMigratedTiles = 100;
+    KisTileDataAllocators *allocators = KisTileDataAllocators::instance();
 
     if (KisTileDataStore::instance()->numTilesInMemory() < maxMigratedTiles) {
 
@@ -176,9 +282,7 @@ void KisTileData::releaseInternalPools()
             }
 
             // check if the tile data has actually been pooled
-            if (item->m_pixelSize != 4 &&
-                item->m_pixelSize != 8) {
-
+            if (!allocators->allocatorForPixelSize(item->m_pixelSize)) {
                 continue;
             }
 
@@ -198,9 +302,18 @@ void KisTileData::releaseInternalPools()
         }
 
         if (!failedToLock) {
-            // purge the pools memory
-            BoostPool4BPP::purge_memory();
-            BoostPool8BPP::purge_memory();
+            /**
+             * Move the few remaining tiles out of their slabs, so
+             * that the slabs could be returned to the system
+             */
+            Q_FOREACH (KisTileData *item, dataObjects) {
+                freeData(item->m_data, item->m_pixelSize);
+                item->m_data = 0;
+            }
+
+            for (int i = 0; i < KisTileDataAllocators::NUM_ALLOCATORS; i++) {
+                allocators->allocators[i]->releaseFreeSlabs();
+            }
 
             auto it = dataObjects.begin();
             auto chunkIt = memoryChunks.constBegin();
@@ -224,19 +337,27 @@ void KisTileData::releaseInternalPools()
 
         KisTileDataStore::instance()->endIteration(iter);
 
-#ifdef DEBUG_POOL_RELEASE
-        dbgKrita << "After purging unused memory:";
-
-        char command[256];
-        sprintf(command, "cat /proc/%d/status | grep -i vm", (int)getpid());
-        printf("--- %s ---\n", command);
-        (void)system(command);
-#endif /* DEBUG_POOL_RELEASE */
-
     } else {
-        dbgKrita << "DEBUG: releasing of the pooled memory has been cancelled:"
+        dbgKrita << "DEBUG: migration of the pooled tiles has been cancelled:"
                  << "there are still"
                  << KisTileDataStore::instance()->numTilesInMemory()
                  << "tiles in memory";
     }
+
+    /**
+     * The slabs which have no tiles in use can be
+     * released without any migration
+     */
+    for (int i = 0; i < KisTileDataAllocators::NUM_ALLOCATORS; i++) {
+        allocators->allocators[i]->releaseFreeSlabs();
+    }
+
+#ifdef DEBUG_POOL_RELEASE
+    dbgKrita << "After purging unused memory:";
+
+    char command[256];
+    sprintf(command, "cat /proc/%d/status | grep -i vm", (int)getpid());
+    printf("--- %s ---\n", command);
+    (void)system(command);
+#endif /* DEBUG_POOL_RELEASE */
 }
@@ -95,12 +95,21 @@ inline void KisTileData::blockSwapping() {
         m_store->ensureTileDataLoaded(this);
     }
     resetAge();
+    m_solidityChecked.store(false, std::memory_order_relaxed);
+    m_contentHashValid.store(false, std::memory_order_relaxed);
 }
 
 inline void KisTileData::unblockSwapping() {
     m_swapLock.unlock();
 }
 
+inline void KisTileData::prefetch() {
+    // the check is racy, but the prefetching is only a hint
+    if(!m_data) {
+        m_store->prefetchTileData(this);
+    }
+}
+
 inline KisChunk KisTileData::swapChunk() const {
     return m_swapChunk;
 }
@@ -129,6 +138,40 @@ inline void KisTileData::markOld() {
     m_age++;
 }
 
+inline KisTileData::SwapPriority KisTileData::swapPriority() const {
+    return SwapPriority(m_swapPriority.load(std::memory_order_relaxed) & 0x3);
+}
+inline void KisTileData::mergeSwapPriority(SwapPriority value, quint32 hintsPass) {
+    const quint32 newValue = (hintsPass << 2) | quint32(value);
+    quint32 oldValue = m_swapPriority.load(std::memory_order_relaxed);
+
+    Q_FOREVER {
+        /**
+         * The passes are compared in a wrap-around safe way
+         */
+        const qint32 passDelta = qint32((newValue & ~0x3U) - (oldValue & ~0x3U));
+
+        if (passDelta < 0 ||
+            (!passDelta && (oldValue & 0x3U) >= quint32(value))) {
+
+            break;
+        }
+
+        if (m_swapPriority.compare_exchange_weak(oldValue, newValue,
+                                                 std::memory_order_relaxed)) {
+            break;
+        }
+    }
+}
+
+inline bool KisTileData::isSolid() const {
+    return m_solidPixel;
+}
+
+inline bool KisTileData::isDeduplicated() const {
+    return m_deduplicationSource;
+}
+
 inline qint32 KisTileData::numUsers() const {
     return m_usersCount;
 }
@@ -21,6 +21,8 @@
 #include <QReadWriteLock>
 #include <QAtomicInt>
 
+#include <atomic>
+
 #include "kis_lockless_stack.h"
 #include "swap/kis_chunk_allocator.h"
 
@@ -61,6 +63,18 @@ public:
         SWAPPED
     };
 
+    /**
+     * A hint for the swapper telling how much the user needs
+     * the tile data at the moment. The low priority tiles are
+     * swapped out first, the high priority ones are swapped out
+     * only when nothing else could be freed.
+     */
+    enum SwapPriority {
+        LowPriority = 0,
+        NormalPriority,
+        HighPriority
+    };
+
     /**
      * Information about data stored
      */
@@ -106,6 +120,12 @@ public:
     inline void blockSwapping();
     inline void unblockSwapping();
 
+    /**
+     * Asks the store to load the data in the background if it is
+     * not present in memory at the moment. Doesn't block.
+     */
+    inline void prefetch();
+
     /**
      * The position of the tile data in a swap file
      */
@@ -125,6 +145,16 @@ public:
     inline void resetAge();
     inline void markOld();
 
+    /**
+     * The priority hint set by the GUI. The tile data may be shared
+     * by several devices via COW, so the hints of the same pass
+     * (\see KisTileDataStore::beginSwapPriorityHints()) are merged
+     * and the highest priority wins. A hint of a newer pass replaces
+     * the older ones, the hints of the older passes are ignored.
+     */
+    inline SwapPriority swapPriority() const;
+    inline void mergeSwapPriority(SwapPriority value, quint32 hintsPass);
+
     /**
      * Returns number of tiles (or memento items),
      * referencing the tile data.
@@ -157,10 +187,65 @@ public:
      */
     void allocateMemory();
 
+    /**
+     * Used for memory saving purposes only.
+     * If all the pixels of the tile data are equal, the data is
+     * released and replaced with a single pixel. The data is
+     * expanded back by expandSolidData() when the tile data is
+     * accessed the next time (\see KisTileDataStore::ensureTileDataLoaded)
+     *
+     * The check is performed only once per access to the tile
+     * data, the repeated calls just return false.
+     *
+     * LOCKING: m_swapLock should be held by the caller in write mode
+     *
+     * \return true if the data has been compacted
+     */
+    bool tryCompactSolidData();
+
+    /**
+     * Restores the data compacted by tryCompactSolidData()
+     *
+     * LOCKING: m_swapLock should be held by the caller in write mode
+     */
+    void expandSolidData();
+
+    /**
+     * Returns true if the data is compacted into a single pixel
+     */
+    inline bool isSolid() const;
+
+    /**
+     * Used for memory saving purposes only.
+     * Releases the data and makes the tile data share the contents
+     * of \a source, which is guaranteed to be identical and is never
+     * written to. The data is expanded back by
+     * expandDeduplicatedData() on the next access.
+     *
+     * LOCKING: m_swapLock should be held by the caller in write mode
+     */
+    void deduplicateWith(KisTileData *source);
+
+    /**
+     * Restores the data shared by deduplicateWith(). The data of the
+     * source must be loaded into memory by the caller.
+     *
+     * LOCKING: m_swapLock should be held by the caller in write mode
+     *
+     * \return the source the data has been copied from. The caller
+     *         must deref() it after releasing all the store locks
+     */
+    KisTileData* expandDeduplicatedData();
+
+    /**
+     * Returns true if the data is shared with an identical tile data
+     */
+    inline bool isDeduplicated() const;
+
     /**
      * Releases internal pools, which keep blobs where the tiles are
      * stored.  The point is that we don't allocate the tiles from
-     * glibc directly, but use pools (implemented via boost) to
+     * glibc directly, but use pools (\see KisTileDataSlabAllocator) to
      * allocate bigger chunks. This method should be called when one
      * knows that we have just free'd quite a lot of memory and we
      * won't need it anymore. E.g. when a document has been closed.
@@ -186,6 +271,8 @@ private:
     friend class KisTile;
     friend class KisTileDataStore;
 
+    friend class KisTileDataSwapper;
+
     friend class KisTileDataStoreIterator;
     friend class KisTileDataStoreReverseIterator;
     friend class KisTileDataStoreClockIterator;
@@ -229,6 +316,13 @@ private:
     //FIXME: make memory aligned
     int m_age;
 
+    /**
+     * The swap priority hint, see SwapPriority. The lower two bits
+     * keep the priority itself, the rest keep the pass of hints it
+     * was set in.
+     */
+    std::atomic<quint32> m_swapPriority;
+
 
     /**
      * The primitive for controlling swapping of the tile.
@@ -263,6 +357,39 @@ private:
     qint32 m_pixelSize;
     //qint32 m_timeStamp;
 
+    /**
+     * The only pixel of the tile data compacted by
+     * tryCompactSolidData(). Null for usual tile data.
+     */
+    quint8 *m_solidPixel;
+
+    /**
+     * Set when the data has already been checked for
+     * uniformity and reset on every access to the data
+     * (\see blockSwapping()). It is reset under the shared
+     * swap lock, so it must be atomic.
+     */
+    std::atomic<bool> m_solidityChecked;
+
+    /**
+     * The identical tile data this tile data shares
+     * the contents with. Null for usual tile data.
+     */
+    KisTileData *m_deduplicationSource;
+
+    /**
+     * Set for the shared copies created by the store
+     * for deduplicated tile data objects
+     */
+    bool m_isDeduplicationSource;
+
+    /**
+     * The hash of the contents of the data. It is
+     * invalidated on every access to the data.
+     */
+    uint m_contentHash;
+    std::atomic<bool> m_contentHashValid;
+
     KisTileDataStore *m_store;
 public:
     static const qint32 WIDTH;
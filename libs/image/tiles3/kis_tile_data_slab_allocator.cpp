@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_data_slab_allocator.h"
+
+#include <QThread>
+#include <QHash>
+#include <QSet>
+
+#include "kis_debug.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+/**
+ * The size of a huge page on x86_64
+ */
+const quint64 KisTileDataSlabAllocator::SLAB_SIZE = 2ULL << 20;
+
+const int KisTileDataSlabAllocator::NUM_SHARDS = 16;
+const int KisTileDataSlabAllocator::BATCH_SIZE = 16;
+const int KisTileDataSlabAllocator::MAX_SHARD_SIZE = 4 * BATCH_SIZE;
+
+
+inline quint8* slabForChunk(const void *ptr)
+{
+    return reinterpret_cast<quint8*>(
+        reinterpret_cast<quintptr>(ptr) &
+        ~quintptr(KisTileDataSlabAllocator::SLAB_SIZE - 1));
+}
+
+KisTileDataSlabAllocator::KisTileDataSlabAllocator(int chunkSize)
+    : m_chunkSize(chunkSize),
+      m_chunksPerSlab(SLAB_SIZE / chunkSize),
+      m_shards(new Shard[NUM_SHARDS]),
+      m_slabTop(0),
+      m_slabEnd(0)
+{
+    Q_ASSERT(quint64(chunkSize) <= SLAB_SIZE);
+    Q_ASSERT(SLAB_SIZE % chunkSize == 0);
+    Q_ASSERT(quint64(chunkSize) >= sizeof(FreeChunk));
+}
+
+KisTileDataSlabAllocator::~KisTileDataSlabAllocator()
+{
+    /**
+     * The tile data objects may still be alive if the store is
+     * destroyed after us, so return only the slabs we know to be
+     * unused. The rest goes away with the process.
+     */
+    releaseFreeSlabs();
+    delete[] m_shards;
+}
+
+KisTileDataSlabAllocator::Shard& KisTileDataSlabAllocator::currentShard()
+{
+    const quintptr threadId = quintptr(QThread::currentThreadId());
+    return m_shards[qHash(threadId) % NUM_SHARDS];
+}
+
+quint8* KisTileDataSlabAllocator::allocate()
+{
+    Shard &shard = currentShard();
+
+    {
+        QMutexLocker locker(&shard.lock);
+        FreeChunk *chunk = shard.chunks.pop();
+        if (chunk) {
+            return reinterpret_cast<quint8*>(chunk);
+        }
+    }
+
+    FreeList batch = fetchBatch();
+    FreeChunk *chunk = batch.pop();
+
+    if (batch.size) {
+        QMutexLocker locker(&shard.lock);
+        shard.chunks.append(batch);
+    }
+
+    return reinterpret_cast<quint8*>(chunk);
+}
+
+void KisTileDataSlabAllocator::free(quint8 *ptr)
+{
+    Shard &shard = currentShard();
+    FreeList overflow;
+
+    {
+        QMutexLocker locker(&shard.lock);
+        shard.chunks.push(reinterpret_cast<FreeChunk*>(ptr));
+
+        if (shard.chunks.size > MAX_SHARD_SIZE) {
+            overflow.append(shard.chunks);
+        }
+    }
+
+    if (overflow.size) {
+        QMutexLocker locker(&m_globalLock);
+        m_globalChunks.append(overflow);
+    }
+}
+
+KisTileDataSlabAllocator::FreeList KisTileDataSlabAllocator::fetchBatch()
+{
+    QMutexLocker locker(&m_globalLock);
+    FreeList batch;
+
+    while (batch.size < BATCH_SIZE) {
+        FreeChunk *chunk = m_globalChunks.pop();
+        if (!chunk) break;
+        batch.push(chunk);
+    }
+
+    if (!batch.size) {
+        if (m_slabTop == m_slabEnd) {
+            m_slabTop = allocateSlab();
+            m_slabEnd = m_slabTop ? m_slabTop + SLAB_SIZE : 0;
+        }
+
+        while (batch.size < BATCH_SIZE && m_slabTop != m_slabEnd) {
+            batch.push(reinterpret_cast<FreeChunk*>(m_slabTop));
+            m_slabTop += m_chunkSize;
+        }
+    }
+
+    return batch;
+}
+
+quint8* KisTileDataSlabAllocator::allocateSlab()
+{
+    quint8 *slab = mapSlab();
+
+    if (slab) {
+        m_slabs.append(slab);
+    } else {
+        warnKrita << "KisTileDataSlabAllocator: failed to allocate a slab of" << SLAB_SIZE << "bytes";
+    }
+
+    return slab;
+}
+
+quint64 KisTileDataSlabAllocator::releaseFreeSlabs()
+{
+    QMutexLocker locker(&m_globalLock);
+
+    for (int i = 0; i < NUM_SHARDS; i++) {
+        QMutexLocker shardLocker(&m_shards[i].lock);
+        m_globalChunks.append(m_shards[i].chunks);
+    }
+
+    QHash<quint8*, int> numFreeChunks;
+
+    for (FreeChunk *chunk = m_globalChunks.head; chunk; chunk = chunk->next) {
+        numFreeChunks[slabForChunk(chunk)]++;
+    }
+
+    if (m_slabTop != m_slabEnd) {
+        numFreeChunks[slabForChunk(m_slabTop)] += (m_slabEnd - m_slabTop) / m_chunkSize;
+    }
+
+    QSet<quint8*> freeSlabs;
+
+    for (auto it = numFreeChunks.constBegin(); it != numFreeChunks.constEnd(); ++it) {
+        if (it.value() == m_chunksPerSlab) {
+            freeSlabs.insert(it.key());
+        }
+    }
+
+    if (freeSlabs.isEmpty()) return 0;
+
+    FreeList usedSlabsChunks;
+    while (FreeChunk *chunk = m_globalChunks.pop()) {
+        if (!freeSlabs.contains(slabForChunk(chunk))) {
+            usedSlabsChunks.push(chunk);
+        }
+    }
+    m_globalChunks.append(usedSlabsChunks);
+
+    if (m_slabTop != m_slabEnd &&
+        freeSlabs.contains(slabForChunk(m_slabTop))) {
+
+        m_slabTop = m_slabEnd = 0;
+    }
+
+    Q_FOREACH (quint8 *slab, freeSlabs) {
+        m_slabs.removeOne(slab);
+        unmapSlab(slab);
+    }
+
+    return freeSlabs.size() * SLAB_SIZE;
+}
+
+quint64 KisTileDataSlabAllocator::allocatedMemory() const
+{
+    QMutexLocker locker(&m_globalLock);
+    return m_slabs.size() * SLAB_SIZE;
+}
+
+quint8* KisTileDataSlabAllocator::mapSlab()
+{
+#ifdef Q_OS_LINUX
+    /**
+     * mmap() guarantees only the page alignment, so map twice as
+     * much and cut off the unaligned head and the tail
+     */
+    const size_t mappingSize = 2 * SLAB_SIZE;
+
+    void *mapping = mmap(0, mappingSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (mapping == MAP_FAILED) return 0;
+
+    quint8 *begin = static_cast<quint8*>(mapping);
+    quint8 *slab = slabForChunk(begin + SLAB_SIZE - 1);
+
+    const size_t headSize = slab - begin;
+    const size_t tailSize = mappingSize - headSize - SLAB_SIZE;
+
+    if (headSize) {
+        munmap(begin, headSize);
+    }
+
+    if (tailSize) {
+        munmap(slab + SLAB_SIZE, tailSize);
+    }
+
+#ifdef MADV_HUGEPAGE
+    madvise(slab, SLAB_SIZE, MADV_HUGEPAGE);
+#endif
+
+    return slab;
+#else
+    return static_cast<quint8*>(qMallocAligned(SLAB_SIZE, SLAB_SIZE));
+#endif
+}
+
+void KisTileDataSlabAllocator::unmapSlab(quint8 *slab)
+{
+#ifdef Q_OS_LINUX
+    munmap(slab, SLAB_SIZE);
+#else
+    qFreeAligned(slab);
+#endif
+}
@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_TILE_DATA_SLAB_ALLOCATOR_H
+#define __KIS_TILE_DATA_SLAB_ALLOCATOR_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QVector>
+
+#include "kritaimage_export.h"
+
+
+/**
+ * An allocator for the fixed-size memory blocks keeping the pixels
+ * of tile data objects.
+ *
+ * The memory is requested from the system in big slabs of SLAB_SIZE
+ * bytes, which are aligned by their size. On Linux the slabs are
+ * mapped directly and marked as candidates for transparent huge
+ * pages, so a single slab occupies a single TLB entry.
+ *
+ * The free chunks are kept in intrusive lists split into several
+ * shards. Every thread works with its own shard, so the painting
+ * threads almost never contend on the same mutex. The shards
+ * exchange the chunks with a global list in batches.
+ *
+ * A fresh slab is carved into chunks lazily, by the threads that
+ * request the chunks. Linux places the pages on the NUMA node of
+ * the thread that touches them first, so a tile data usually gets
+ * its memory on the node of the thread that has created it.
+ *
+ * The memory is returned to the system in the whole slabs only
+ * (\see releaseFreeSlabs())
+ */
+class KRITAIMAGE_EXPORT KisTileDataSlabAllocator
+{
+public:
+    static const quint64 SLAB_SIZE;
+
+    KisTileDataSlabAllocator(int chunkSize);
+    ~KisTileDataSlabAllocator();
+
+    quint8* allocate();
+    void free(quint8 *ptr);
+
+    /**
+     * Returns all the slabs, which have no chunks in use, back to
+     * the system. It is safe to call it at any moment of time, but
+     * it stops all the allocations while running.
+     *
+     * \return the number of bytes released
+     */
+    quint64 releaseFreeSlabs();
+
+    /**
+     * The number of bytes requested from the system
+     */
+    quint64 allocatedMemory() const;
+
+    inline int chunkSize() const {
+        return m_chunkSize;
+    }
+
+private:
+    struct FreeChunk {
+        FreeChunk *next;
+    };
+
+    struct FreeList {
+        FreeList() : head(0), tail(0), size(0) {}
+
+        inline void push(FreeChunk *chunk) {
+            chunk->next = head;
+            head = chunk;
+            if (!tail) tail = chunk;
+            size++;
+        }
+
+        inline FreeChunk* pop() {
+            FreeChunk *chunk = head;
+            if (chunk) {
+                head = chunk->next;
+                if (!head) tail = 0;
+                size--;
+            }
+            return chunk;
+        }
+
+        inline void append(FreeList &other) {
+            if (!other.head) return;
+
+            if (tail) {
+                tail->next = other.head;
+            } else {
+                head = other.head;
+            }
+            tail = other.tail;
+            size += other.size;
+
+            other.head = other.tail = 0;
+            other.size = 0;
+        }
+
+        FreeChunk *head;
+        FreeChunk *tail;
+        int size;
+    };
+
+    struct Shard {
+        QMutex lock;
+        FreeList chunks;
+    };
+
+private:
+    Shard& currentShard();
+    FreeList fetchBatch();
+    quint8* allocateSlab();
+
+    static quint8* mapSlab();
+    static void unmapSlab(quint8 *slab);
+
+private:
+    static const int NUM_SHARDS;
+    static const int BATCH_SIZE;
+    static const int MAX_SHARD_SIZE;
+
+    const int m_chunkSize;
+    const int m_chunksPerSlab;
+
+    Shard *m_shards;
+
+    mutable QMutex m_globalLock;
+    FreeList m_globalChunks;
+
+    /**
+     * The part of the latest slab, which has never been given out
+     */
+    quint8 *m_slabTop;
+    quint8 *m_slabEnd;
+
+    QVector<quint8*> m_slabs;
+};
+
+#endif /* __KIS_TILE_DATA_SLAB_ALLOCATOR_H */
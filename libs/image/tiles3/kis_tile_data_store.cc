@@ -20,9 +20,11 @@
 #include "config-memory-leak-tracker.h"
 
 #include <QGlobalStatic>
+#include <QHash>
 
 #include "kis_tile_data_store.h"
 #include "kis_tile_data.h"
+#include "kis_memento_item.h"
 #include "kis_debug.h"
 
 #include "kis_tile_data_store_iterators.h"
@@ -69,16 +71,25 @@ qint64 __preclone_miss_age = 0;
 KisTileDataStore::KisTileDataStore()
     : m_pooler(this),
       m_swapper(this),
+      m_prefetcher(this),
       m_numTiles(0),
-      m_memoryMetric(0)
+      m_numSolidTiles(0),
+      m_numDeduplicatedTiles(0),
+      m_memoryMetric(0),
+      m_deduplicatedMemoryMetric(0),
+      m_swapPriorityHintsPass(0)
 {
     m_clockIterator = m_tileDataList.end();
     m_pooler.start();
     m_swapper.start();
+    m_prefetcher.start();
+    m_mementoCompressor.start();
 }
 
 KisTileDataStore::~KisTileDataStore()
 {
+    m_mementoCompressor.terminateCompressor();
+    m_prefetcher.terminatePrefetcher();
     m_pooler.terminatePooler();
     m_swapper.terminateSwapper();
 
@@ -109,13 +120,24 @@ KisTileDataStore::MemoryStatistics KisTileDataStore::memoryStatistics()
     const qint64 metricCoeff = KisTileData::WIDTH * KisTileData::HEIGHT;
 
     stats.realMemorySize = m_pooler.lastRealMemoryMetric() * metricCoeff;
-    stats.historicalMemorySize = m_pooler.lastHistoricalMemoryMetric() * metricCoeff;
     stats.poolSize = m_pooler.lastPoolMemoryMetric() * metricCoeff;
 
-    stats.totalMemorySize = memoryMetric() * metricCoeff + stats.poolSize;
+    /**
+     * The delta-compressed revisions don't own any tile data,
+     * so their memory is not covered by the metrics
+     */
+    const qint64 deltaMemorySize = KisMementoItem::totalDeltaMemorySize();
+
+    stats.historicalMemorySize =
+        m_pooler.lastHistoricalMemoryMetric() * metricCoeff + deltaMemorySize;
+
+    stats.totalMemorySize =
+        memoryMetric() * metricCoeff + stats.poolSize + deltaMemorySize;
 
     stats.swapSize = m_swappedStore.totalMemoryMetric() * metricCoeff;
 
+    stats.deduplicatedSize = m_deduplicatedMemoryMetric * metricCoeff;
+
     return stats;
 }
 
@@ -184,10 +206,21 @@ void KisTileDataStore::freeTileData(KisTileData *td)
 
     DEBUG_FREE_ACTION(td);
 
+    KisTileData *releasedSource = 0;
+
     m_listLock.lock();
     td->m_swapLock.lockForWrite();
 
-    if(!td->data()) {
+    if(td->isSolid()) {
+        m_numSolidTiles--;
+    }
+    else if(td->m_deduplicationSource) {
+        releasedSource = td->m_deduplicationSource;
+        td->m_deduplicationSource = 0;
+        m_numDeduplicatedTiles--;
+        m_deduplicatedMemoryMetric -= td->pixelSize();
+    }
+    else if(!td->data()) {
         m_swappedStore.forgetTileData(td);
     }
     else {
@@ -198,6 +231,14 @@ void KisTileDataStore::freeTileData(KisTileData *td)
     m_listLock.unlock();
 
     delete td;
+
+    /**
+     * Dereferencing may free the source,
+     * so do it without any locks held
+     */
+    if (releasedSource) {
+        releasedSource->deref();
+    }
 }
 
 void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
@@ -208,8 +249,25 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
     td->m_swapLock.lockForRead();
 
     while(!td->data()) {
+        /**
+         * The source of a deduplicated tile data must be loaded
+         * before taking m_listLock, because loading it may need
+         * m_listLock itself. We hold the swap lock of the td, so
+         * the source cannot be changed or freed while we ref it.
+         */
+        KisTileData *source = td->m_deduplicationSource;
+        if (source) {
+            source->ref();
+        }
+
         td->m_swapLock.unlock();
 
+        if (source) {
+            source->blockSwapping();
+        }
+
+        KisTileData *releasedSource = 0;
+
         /**
          * The order of this heavy locking is very important.
          * Change it only in case, you really know what you are doing.
@@ -227,12 +285,24 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
          * while checking this, because holding m_listLock is
          * enough. Nothing can happen to the tile while we hold
          * m_listLock.
+         *
+         * The td might also have been loaded and deduplicated again
+         * with another source. In such a case we just try once more.
          */
 
-        if(!td->data()) {
+        if(!td->data() && td->m_deduplicationSource == source) {
             td->m_swapLock.lockForWrite();
 
-            m_swappedStore.swapInTileData(td);
+            if (td->isSolid()) {
+                td->expandSolidData();
+                m_numSolidTiles--;
+            } else if (source) {
+                releasedSource = td->expandDeduplicatedData();
+                m_numDeduplicatedTiles--;
+                m_deduplicatedMemoryMetric -= td->pixelSize();
+            } else {
+                m_swappedStore.swapInTileData(td);
+            }
             registerTileDataImp(td);
 
             td->m_swapLock.unlock();
@@ -240,6 +310,19 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
 
         m_listLock.unlock();
 
+        if (source) {
+            source->unblockSwapping();
+
+            /**
+             * Dereferencing may free the source,
+             * so do it without any locks held
+             */
+            if (releasedSource) {
+                releasedSource->deref();
+            }
+            source->deref();
+        }
+
         /**
          * <-- In theory, livelock is possible here...
          */
@@ -271,6 +354,184 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     return result;
 }
 
+bool KisTileDataStore::tryCompactSolidTileData(KisTileData *td)
+{
+    /**
+     * This function is called with m_listLock acquired
+     */
+
+    bool result = false;
+    if(!td->m_swapLock.tryLockForWrite()) return result;
+
+    if(td->data()) {
+        if (td->tryCompactSolidData()) {
+            unregisterTileDataImp(td);
+            m_numSolidTiles++;
+            result = true;
+        }
+    }
+    td->m_swapLock.unlock();
+
+    return result;
+}
+
+bool KisTileDataStore::tryRefTileData(KisTileData *td)
+{
+    /**
+     * This function is called with m_listLock acquired, so the
+     * object cannot be deleted yet, but its last reference might
+     * have already been released. Such tile data is skipped.
+     */
+
+    int refCount;
+    do {
+        refCount = td->m_refCount.loadAcquire();
+        if(!refCount) return false;
+    } while(!td->m_refCount.testAndSetOrdered(refCount, refCount + 1));
+
+    return true;
+}
+
+bool KisTileDataStore::tryHashTileData(KisTileData *td)
+{
+    /**
+     * This function is called without m_listLock, the caller
+     * owns a reference to the tile data
+     */
+
+    bool result = false;
+    if(!td->m_swapLock.tryLockForWrite()) return result;
+
+    if(td->data() && !td->m_contentHashValid.load(std::memory_order_relaxed)) {
+        td->m_contentHash =
+            qHashBits(td->data(),
+                      td->pixelSize() * KisTileData::WIDTH * KisTileData::HEIGHT,
+                      td->pixelSize());
+        td->m_contentHashValid.store(true, std::memory_order_relaxed);
+        result = true;
+    }
+    td->m_swapLock.unlock();
+
+    return result;
+}
+
+qint64 KisTileDataStore::tryDeduplicateTileData(const QVector<KisTileData*> &candidates)
+{
+    /**
+     * This function is called without m_listLock, the caller owns
+     * a reference to every candidate. The contents are compared
+     * before taking m_listLock, so that the allocations were not
+     * blocked. Any access to the data resets its content hash
+     * flag, so the flag tells whether the result of the comparison
+     * is still valid when the list lock is finally taken.
+     */
+
+    QVector<KisTileData*> orderedCandidates;
+
+    // the existing shared copy is preferred as a reference
+    Q_FOREACH (KisTileData *td, candidates) {
+        if(td->m_isDeduplicationSource) {
+            orderedCandidates.prepend(td);
+        } else {
+            orderedCandidates.append(td);
+        }
+    }
+
+    KisTileData *reference = 0;
+    QVector<KisTileData*> duplicates;
+
+    Q_FOREACH (KisTileData *td, orderedCandidates) {
+        if(!td->m_swapLock.tryLockForWrite()) continue;
+
+        if(td->data() && td->m_contentHashValid.load(std::memory_order_relaxed)) {
+            if(!reference) {
+                // stays locked till the end of the comparison
+                reference = td;
+                continue;
+            }
+
+            const qint32 tileDataSize =
+                reference->pixelSize() * KisTileData::WIDTH * KisTileData::HEIGHT;
+
+            if(!td->m_isDeduplicationSource &&
+               td->pixelSize() == reference->pixelSize() &&
+               !memcmp(td->data(), reference->data(), tileDataSize)) {
+
+                duplicates.append(td);
+            }
+        }
+        td->m_swapLock.unlock();
+    }
+
+    if(!reference) return 0;
+    reference->m_swapLock.unlock();
+
+    if(duplicates.isEmpty()) return 0;
+
+    qint64 freedMetric = 0;
+
+    QMutexLocker lock(&m_listLock);
+
+    if(!reference->m_swapLock.tryLockForWrite()) return 0;
+
+    if(!reference->data() ||
+       !reference->m_contentHashValid.load(std::memory_order_relaxed)) {
+
+        reference->m_swapLock.unlock();
+        return 0;
+    }
+
+    QVector<KisTileData*> lockedItems;
+
+    Q_FOREACH (KisTileData *td, duplicates) {
+        if(!td->m_swapLock.tryLockForWrite()) continue;
+
+        if(!td->data() || !td->m_contentHashValid.load(std::memory_order_relaxed)) {
+            td->m_swapLock.unlock();
+            continue;
+        }
+
+        lockedItems.append(td);
+    }
+
+    if(!lockedItems.isEmpty()) {
+        KisTileData *source = reference;
+        QVector<KisTileData*> deduplicatedItems = lockedItems;
+
+        if(!reference->m_isDeduplicationSource) {
+            /**
+             * Nobody writes into the shared copy, so the
+             * duplicates may be expanded from it at any time
+             */
+            source = new KisTileData(*reference, false);
+            source->m_isDeduplicationSource = true;
+            source->m_contentHash = reference->m_contentHash;
+            source->m_contentHashValid.store(true, std::memory_order_relaxed);
+            registerTileDataImp(source);
+
+            freedMetric -= source->pixelSize();
+
+            deduplicatedItems.prepend(reference);
+        }
+
+        Q_FOREACH (KisTileData *td, deduplicatedItems) {
+            unregisterTileDataImp(td);
+            td->deduplicateWith(source);
+
+            m_numDeduplicatedTiles++;
+            m_deduplicatedMemoryMetric += td->pixelSize();
+            freedMetric += td->pixelSize();
+        }
+    }
+
+    Q_FOREACH (KisTileData *td, lockedItems) {
+        td->m_swapLock.unlock();
+    }
+    reference->m_swapLock.unlock();
+
+    return freedMetric;
+}
+
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 {
     m_listLock.lock();
@@ -349,6 +610,8 @@ void KisTileDataStore::debugClear()
 void KisTileDataStore::testingRereadConfig() {
     m_pooler.testingRereadConfig();
     m_swapper.testingRereadConfig();
+    m_prefetcher.testingRereadConfig();
+    m_mementoCompressor.testingRereadConfig();
     kickPooler();
 }
 
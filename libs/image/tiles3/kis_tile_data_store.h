@@ -21,10 +21,13 @@
 #include "kritaimage_export.h"
 
 #include <QReadWriteLock>
+#include <QVector>
 #include "kis_tile_data_interface.h"
 
 #include "kis_tile_data_pooler.h"
 #include "swap/kis_tile_data_swapper.h"
+#include "swap/kis_tile_data_prefetcher.h"
+#include "kis_memento_delta_compressor.h"
 #include "swap/kis_swapped_data_store.h"
 
 class KisTileDataStoreIterator;
@@ -51,6 +54,12 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+
+        /**
+         * The amount of memory saved by sharing
+         * identical tile data objects
+         */
+        qint64 deduplicatedSize;
     };
 
     MemoryStatistics memoryStatistics();
@@ -60,7 +69,17 @@ public:
      * or in a swap file
      */
     inline qint32 numTiles() const {
-        return m_numTiles + m_swappedStore.numTiles();
+        return m_numTiles + m_swappedStore.numTiles() +
+            m_numSolidTiles + m_numDeduplicatedTiles;
+    }
+
+    /**
+     * Returns the number of tiles compacted into a single pixel
+     *
+     * \see KisTileData::tryCompactSolidData()
+     */
+    inline qint32 numSolidTiles() const {
+        return m_numSolidTiles;
     }
 
     /**
@@ -102,6 +121,33 @@ public:
         m_swapper.kick();
     }
 
+    /**
+     * Asks the store to load a swapped out or compacted tile
+     * data in the background, because it is going to be
+     * accessed soon. The call never blocks on the swap file.
+     * The caller should own a reference to \a td.
+     */
+    inline void prefetchTileData(KisTileData *td) {
+        m_prefetcher.prefetch(td);
+    }
+
+    /**
+     * Starts a new pass of the swap priority hints
+     *
+     * \see KisTileData::mergeSwapPriority()
+     */
+    inline quint32 beginSwapPriorityHints() {
+        return quint32(m_swapPriorityHintsPass.fetchAndAddOrdered(1)) + 1;
+    }
+
+    /**
+     * Called by The Memento Manager for the revisions
+     * of the tiles that have just been superseded
+     */
+    inline void compressMementoItemLater(KisMementoItem *item) {
+        m_mementoCompressor.compressLater(item);
+    }
+
     /**
      * Try swap out the tile data.
      * It may fail in case the tile is being accessed
@@ -109,6 +155,48 @@ public:
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Try to compact the tile data into a single pixel if all its
+     * pixels are equal. It may fail in case the tile is being
+     * accessed at the same moment of time.
+     */
+    bool tryCompactSolidTileData(KisTileData *td);
+
+    /**
+     * Takes a reference to the tile data, unless its last reference
+     * has already been released. Should be called with m_listLock
+     * acquired, i.e. while iterating the store. The reference lets
+     * the caller access the tile data after the lock is released.
+     * It should be dropped with deref() without any store locks held.
+     *
+     * \return true if the reference has been taken
+     */
+    bool tryRefTileData(KisTileData *td);
+
+    /**
+     * Computes the hash of the contents of the tile data, if it
+     * has been accessed since the last call. It may fail in case
+     * the tile is being accessed at the same moment of time.
+     * Should be called without m_listLock, the caller should
+     * own a reference to \a td.
+     *
+     * \return true if the hash has been recalculated
+     */
+    bool tryHashTileData(KisTileData *td);
+
+    /**
+     * Try to make all the tile data objects in \a candidates, that
+     * have identical contents, share a single copy of the data. Every
+     * candidate should have its content hash calculated with
+     * tryHashTileData(). The tile data objects that are being
+     * accessed at the moment are skipped. Should be called without
+     * m_listLock, the caller should own a reference to every
+     * candidate.
+     *
+     * \return the memory metric freed by the operation
+     */
+    qint64 tryDeduplicateTileData(const QVector<KisTileData*> &candidates);
+
 
     /**
      * WARN: The following three method are only for usage
@@ -150,10 +238,13 @@ private:
     void testingResumePooler();
 
     friend class KisLowMemoryBenchmark;
+    friend class KisUndoHistoryBenchmark;
     void testingRereadConfig();
 private:
     KisTileDataPooler m_pooler;
     KisTileDataSwapper m_swapper;
+    KisTileDataPrefetcher m_prefetcher;
+    KisMementoDeltaCompressor m_mementoCompressor;
 
     friend class KisTileDataStoreTest;
     friend class KisTileDataPoolerTest;
@@ -164,6 +255,8 @@ private:
     QMutex m_listLock;
     KisTileDataList m_tileDataList;
     qint32 m_numTiles;
+    qint32 m_numSolidTiles;
+    qint32 m_numDeduplicatedTiles;
 
     /**
      * This metric is used for computing the volume
@@ -171,6 +264,17 @@ private:
      * metric = num_bytes / (KisTileData::WIDTH * KisTileData::HEIGHT)
      */
     qint64 m_memoryMetric;
+
+    /**
+     * The metric of the memory saved by the tile data
+     * objects sharing their data with identical ones
+     */
+    qint64 m_deduplicatedMemoryMetric;
+
+    /**
+     * The last pass of the swap priority hints
+     */
+    QAtomicInt m_swapPriorityHintsPass;
 };
 
 template<typename T>
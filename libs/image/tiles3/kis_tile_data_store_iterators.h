@@ -62,6 +62,13 @@ public:
         return m_store->trySwapTileData(td);
     }
 
+    inline bool tryCompactSolid(KisTileData *td) {
+        if(td->m_listIterator == m_iterator)
+            m_iterator++;
+
+        return m_store->tryCompactSolidTileData(td);
+    }
+
 private:
     KisTileDataList &m_list;
     KisTileDataListIterator m_iterator;
@@ -20,6 +20,9 @@
 #ifndef KIS_TILEHASHTABLE_H_
 #define KIS_TILEHASHTABLE_H_
 
+#include <QAtomicPointer>
+#include <QVector>
+
 #include "kis_tile.h"
 
 
@@ -27,9 +30,18 @@
 /**
  * This is a  template for a hash table that stores  tiles (or some other
  * objects  resembling tiles).   Actually, this  object should  only have
- * col()/row() methods and be able to answer setNext()/next() requests to
- * be   stored   here.    It   is   used   in   KisTiledDataManager   and
- * KisMementoManager.
+ * col()/row() methods to be stored here. It is used in KisTiledDataManager
+ * and KisMementoManager.
+ *
+ * The lookups (getExistingTile(), getTileLazy() and getReadOnlyTileLazy())
+ * do not take any locks. The chains of the table are built of atomic
+ * pointers, and the removed nodes are not deleted until all the readers,
+ * which could have seen them, have left the table (epoch-based
+ * reclamation). The readers are counted in several cache-line-sized
+ * stripes, so the threads looking up the tiles do not fight for the
+ * same counter.
+ *
+ * The modifications of the table are serialized with m_lock.
  */
 
 template<class T>
@@ -99,16 +111,54 @@ public:
     void debugMaxListLength(qint32 &min, qint32 &max);
 
 private:
+    struct Node {
+        Node(TileTypeSP _tile, Node *_next)
+            : tile(_tile),
+              next(_next)
+        {
+        }
+
+        const TileTypeSP tile;
+        QAtomicPointer<Node> next;
+    };
 
-    TileTypeSP getTileMinefieldWalk(qint32 col, qint32 row, qint32 idx);
-    TileTypeSP getTile(qint32 col, qint32 row, qint32 idx);
+    static const int NUM_EPOCHS = 3;
+    static const int NUM_READER_STRIPES = 32;
+
+    struct ReaderStripe {
+        QAtomicInt readers[NUM_EPOCHS];
+        char padding[64 - NUM_EPOCHS * sizeof(QAtomicInt)];
+    };
+
+    /**
+     * Registers the current thread as a reader of the table. The
+     * nodes, which the reader can see, are not deleted until the
+     * section is left.
+     */
+    class ReadSection
+    {
+    public:
+        ReadSection(const KisTileHashTableTraits<T> *ht);
+        ~ReadSection();
+
+    private:
+        QAtomicInt *m_counter;
+    };
+
+private:
+    TileTypeSP getTile(qint32 col, qint32 row, qint32 idx) const;
     void linkTile(TileTypeSP tile, qint32 idx);
     bool unlinkTile(qint32 col, qint32 row, qint32 idx);
 
+    void retireNode(Node *node);
+    void tryAdvanceEpoch();
+    void freeRetiredObjects(int epoch);
+
     inline void setDefaultTileDataImp(KisTileData *defaultTileData);
     inline KisTileData* defaultTileDataImp() const;
 
     static inline quint32 calculateHash(qint32 col, qint32 row);
+    static inline int currentReaderStripe();
 
     inline qint32 debugChainLen(qint32 idx);
     void debugListLengthDistibution();
@@ -117,13 +167,22 @@ private:
     template<class U, class LockerType> friend class KisTileHashTableIteratorTraits;
 
     static const qint32 TABLE_SIZE = 1024;
-    TileTypeSP *m_hashTable;
+    QAtomicPointer<Node> *m_hashTable;
     qint32 m_numTiles;
 
-    KisTileData *m_defaultTileData;
+    QAtomicPointer<KisTileData> m_defaultTileData;
     KisMementoManager *m_mementoManager;
 
     mutable QReadWriteLock m_lock;
+
+    /**
+     * The reclamation state. The epoch is changed by the writers
+     * only, that is with m_lock held, and is stored modulo NUM_EPOCHS
+     */
+    mutable ReaderStripe *m_readerStripes;
+    QAtomicInt m_epoch;
+    QVector<Node*> m_retiredNodes[NUM_EPOCHS];
+    QVector<KisTileData*> m_retiredTileData[NUM_EPOCHS];
 };
 
 #include "kis_tile_hash_table_p.h"
@@ -145,48 +204,50 @@ class KisTileHashTableIteratorTraits
 public:
     typedef T               TileType;
     typedef KisSharedPtr<T> TileTypeSP;
+    typedef typename KisTileHashTableTraits<T>::Node Node;
 
     KisTileHashTableIteratorTraits(KisTileHashTableTraits<T> *ht)
-        : m_locker(&ht->m_lock)
+        : m_node(0),
+          m_locker(&ht->m_lock)
     {
         m_hashTable = ht;
         m_index = nextNonEmptyList(0);
         if (m_index < KisTileHashTableTraits<T>::TABLE_SIZE)
-            m_tile = m_hashTable->m_hashTable[m_index];
+            m_node = m_hashTable->m_hashTable[m_index].loadAcquire();
     }
 
     ~KisTileHashTableIteratorTraits() {
     }
 
     void next() {
-        if (m_tile) {
-            m_tile = m_tile->next();
-            if (!m_tile) {
+        if (m_node) {
+            m_node = m_node->next.loadAcquire();
+            if (!m_node) {
                 qint32 idx = nextNonEmptyList(m_index + 1);
                 if (idx < KisTileHashTableTraits<T>::TABLE_SIZE) {
                     m_index = idx;
-                    m_tile = m_hashTable->m_hashTable[idx];
+                    m_node = m_hashTable->m_hashTable[idx].loadAcquire();
                 } else {
                     //EOList reached
                     m_index = -1;
-                    // m_tile.clear(); // already null
+                    // m_node = 0; // already null
                 }
             }
         }
     }
 
     TileTypeSP tile() const {
-        return m_tile;
+        return m_node ? m_node->tile : TileTypeSP();
     }
     bool isDone() const {
-        return !m_tile;
+        return !m_node;
     }
 
     // disable the method if we didn't lock for writing
     template <class Helper = LockerType>
     typename std::enable_if<std::is_same<Helper, QWriteLocker>::value, void>::type
     deleteCurrent() {
-        TileTypeSP tile = m_tile;
+        TileTypeSP tile = this->tile();
         next();
 
         const qint32 idx = m_hashTable->calculateHash(tile->col(), tile->row());
@@ -197,7 +258,7 @@ public:
     template <class Helper = LockerType>
     typename std::enable_if<std::is_same<Helper, QWriteLocker>::value, void>::type
     moveCurrentToHashTable(KisTileHashTableTraits<T> *newHashTable) {
-        TileTypeSP tile = m_tile;
+        TileTypeSP tile = this->tile();
         next();
 
         const qint32 idx = m_hashTable->calculateHash(tile->col(), tile->row());
@@ -207,7 +268,7 @@ public:
     }
 
 protected:
-    TileTypeSP m_tile;
+    Node *m_node;
     qint32 m_index;
     KisTileHashTableTraits<T> *m_hashTable;
     LockerType m_locker;
@@ -217,7 +278,7 @@ protected:
         qint32 idx = startIdx;
 
         while (idx < KisTileHashTableTraits<T>::TABLE_SIZE &&
-                !m_hashTable->m_hashTable[idx]) {
+                !m_hashTable->m_hashTable[idx].loadAcquire()) {
             idx++;
         }
 
@@ -18,19 +18,21 @@
  */
 
 #include <QtGlobal>
+#include <QThread>
+#include <atomic>
 #include "kis_debug.h"
 #include "kis_global.h"
 
-//#define SHARED_TILES_SANITY_CHECK
-
 
 template<class T>
 KisTileHashTableTraits<T>::KisTileHashTableTraits(KisMementoManager *mm)
         : m_lock(QReadWriteLock::NonRecursive)
 {
-    m_hashTable = new TileTypeSP [TABLE_SIZE];
+    m_hashTable = new QAtomicPointer<Node> [TABLE_SIZE];
     Q_CHECK_PTR(m_hashTable);
 
+    m_readerStripes = new ReaderStripe [NUM_READER_STRIPES];
+
     m_numTiles = 0;
     m_defaultTileData = 0;
     m_mementoManager = mm;
@@ -43,30 +45,27 @@ KisTileHashTableTraits<T>::KisTileHashTableTraits(const KisTileHashTableTraits<T
 {
     QReadLocker locker(&ht.m_lock);
 
+    m_readerStripes = new ReaderStripe [NUM_READER_STRIPES];
+
     m_mementoManager = mm;
     m_defaultTileData = 0;
-    setDefaultTileDataImp(ht.m_defaultTileData);
+    setDefaultTileDataImp(ht.defaultTileDataImp());
 
-    m_hashTable = new TileTypeSP [TABLE_SIZE];
+    m_hashTable = new QAtomicPointer<Node> [TABLE_SIZE];
     Q_CHECK_PTR(m_hashTable);
 
-
-    TileTypeSP foreignTile;
-    TileTypeSP nativeTile;
-    TileTypeSP nativeTileHead;
     for (qint32 i = 0; i < TABLE_SIZE; i++) {
-        nativeTileHead = 0;
+        Node *nativeHead = 0;
 
-        foreignTile = ht.m_hashTable[i];
-        while (foreignTile) {
-            nativeTile = TileTypeSP(new TileType(*foreignTile, m_mementoManager));
-            nativeTile->setNext(nativeTileHead);
-            nativeTileHead = nativeTile;
+        Node *foreignNode = ht.m_hashTable[i].loadAcquire();
+        while (foreignNode) {
+            TileTypeSP nativeTile = TileTypeSP(new TileType(*foreignNode->tile, m_mementoManager));
+            nativeHead = new Node(nativeTile, nativeHead);
 
-            foreignTile = foreignTile->next();
+            foreignNode = foreignNode->next.loadAcquire();
         }
 
-        m_hashTable[i] = nativeTileHead;
+        m_hashTable[i].storeRelease(nativeHead);
     }
     m_numTiles = ht.m_numTiles;
 }
@@ -75,8 +74,18 @@ template<class T>
 KisTileHashTableTraits<T>::~KisTileHashTableTraits()
 {
     clear();
-    delete[] m_hashTable;
     setDefaultTileDataImp(0);
+
+    /**
+     * Nobody can read the table while it is being destroyed,
+     * so everything retired can be freed right now
+     */
+    for (int i = 0; i < NUM_EPOCHS; i++) {
+        freeRetiredObjects(i);
+    }
+
+    delete[] m_hashTable;
+    delete[] m_readerStripes;
 }
 
 template<class T>
@@ -86,51 +95,55 @@ quint32 KisTileHashTableTraits<T>::calculateHash(qint32 col, qint32 row)
 }
 
 template<class T>
-typename KisTileHashTableTraits<T>::TileTypeSP
-KisTileHashTableTraits<T>::getTileMinefieldWalk(qint32 col, qint32 row, qint32 idx)
+int KisTileHashTableTraits<T>::currentReaderStripe()
 {
-    // WARNING: this function is here only for educational purposes! Don't
-    //          use it! It causes race condition in a shared pointer copy-ctor
-    //          when accessing m_hashTable!
+    const quintptr threadId = quintptr(QThread::currentThreadId());
+    return qHash(threadId) % NUM_READER_STRIPES;
+}
+
+template<class T>
+KisTileHashTableTraits<T>::ReadSection::ReadSection(const KisTileHashTableTraits<T> *ht)
+{
+    ReaderStripe &stripe = ht->m_readerStripes[currentReaderStripe()];
 
     /**
-     * This is a special method for dangerous and unsafe access to
-     * the tiles table. Thanks to the fact that our shared pointers
-     * are thread safe, we can iterate through the linked list without
-     * having any locks help. In the worst case, we will miss the needed
-     * tile. In that case, the higher level code will do the proper
-     * locking and do the second try with all the needed locks held.
+     * The reader must be counted in the epoch that is current at
+     * the moment it starts reading the table. If the epoch has
+     * changed while we were registering, just try again.
      */
+    while (1) {
+        const int epoch = ht->m_epoch.loadAcquire();
+        m_counter = &stripe.readers[epoch];
+        m_counter->ref();
 
-    TileTypeSP headTile = m_hashTable[idx];
-    TileTypeSP tile = headTile;
-
-    for (; tile; tile = tile->next()) {
-        if (tile->col() == col &&
-            tile->row() == row) {
-
-            if (m_hashTable[idx] != headTile) {
-                tile.clear();
-            }
+        if (ht->m_epoch.loadAcquire() == epoch) break;
 
-            break;
-        }
+        m_counter->deref();
     }
+}
 
-    return tile;
+template<class T>
+KisTileHashTableTraits<T>::ReadSection::~ReadSection()
+{
+    m_counter->deref();
 }
 
 template<class T>
 typename KisTileHashTableTraits<T>::TileTypeSP
-KisTileHashTableTraits<T>::getTile(qint32 col, qint32 row, qint32 idx)
+KisTileHashTableTraits<T>::getTile(qint32 col, qint32 row, qint32 idx) const
 {
-    TileTypeSP tile = m_hashTable[idx];
+    /**
+     * The caller should either be inside a read section or hold
+     * m_lock. The node cannot be freed while we are here, so it is
+     * safe to take a reference to its tile.
+     */
+    Node *node = m_hashTable[idx].loadAcquire();
 
-    for (; tile; tile = tile->next()) {
-        if (tile->col() == col &&
-                tile->row() == row) {
+    for (; node; node = node->next.loadAcquire()) {
+        if (node->tile->col() == col &&
+                node->tile->row() == row) {
 
-            return tile;
+            return node->tile;
         }
     }
 
@@ -140,77 +153,137 @@ KisTileHashTableTraits<T>::getTile(qint32 col, qint32 row, qint32 idx)
 template<class T>
 void KisTileHashTableTraits<T>::linkTile(TileTypeSP tile, qint32 idx)
 {
-    TileTypeSP firstTile = m_hashTable[idx];
-
-#ifdef SHARED_TILES_SANITY_CHECK
-    Q_ASSERT_X(!tile->next(), "KisTileHashTableTraits<T>::linkTile",
-               "A tile can't be shared by several hash tables, sorry.");
-#endif
-
-    tile->setNext(firstTile);
-    m_hashTable[idx] = tile;
+    Node *node = new Node(tile, m_hashTable[idx].loadAcquire());
+    m_hashTable[idx].storeRelease(node);
     m_numTiles++;
 }
 
 template<class T>
 bool KisTileHashTableTraits<T>::unlinkTile(qint32 col, qint32 row, qint32 idx)
 {
-    TileTypeSP tile = m_hashTable[idx];
-    TileTypeSP prevTile;
+    QAtomicPointer<Node> *link = &m_hashTable[idx];
+    Node *node = link->loadAcquire();
 
-    for (; tile; tile = tile->next()) {
-        if (tile->col() == col &&
-                tile->row() == row) {
+    for (; node; node = node->next.loadAcquire()) {
+        if (node->tile->col() == col &&
+                node->tile->row() == row) {
 
-            if (prevTile)
-                prevTile->setNext(tile->next());
-            else
-                /* optimize here*/
-                m_hashTable[idx] = tile->next();
+            /**
+             * The readers standing on the node will still be able
+             * to continue their walk, because we don't touch its
+             * link to the next node
+             */
+            link->storeRelease(node->next.loadAcquire());
 
             /**
              * The shared pointer may still be accessed by someone, so
              * we need to disconnects the tile from memento manager
              * explicitly
              */
-            tile->setNext(TileTypeSP());
-            tile->notifyDead();
-            tile.clear();
+            node->tile->notifyDead();
+            retireNode(node);
 
             m_numTiles--;
+
+            tryAdvanceEpoch();
             return true;
         }
-        prevTile = tile;
+        link = &node->next;
     }
 
     return false;
 }
 
 template<class T>
-inline void KisTileHashTableTraits<T>::setDefaultTileDataImp(KisTileData *defaultTileData)
+void KisTileHashTableTraits<T>::retireNode(Node *node)
+{
+    m_retiredNodes[m_epoch.loadAcquire()].append(node);
+}
+
+template<class T>
+void KisTileHashTableTraits<T>::tryAdvanceEpoch()
+{
+    /**
+     * An object retired in epoch N may still be seen only by the
+     * readers of epochs N and N - 1, so it can be freed when the
+     * epoch N + 2 starts. We can advance from epoch N to N + 1 only
+     * when all the readers of epoch N - 1 have left.
+     *
+     * The fence orders unlinking of the retired objects before
+     * checking the counters, it pairs with the (ordered) increment
+     * of the counter in ReadSection.
+     *
+     * When nobody reads the table, two steps are enough to free
+     * everything that has been retired.
+     */
+    for (int step = 0; step < NUM_EPOCHS - 1; step++) {
+        bool hasRetiredObjects = false;
+        for (int i = 0; i < NUM_EPOCHS; i++) {
+            hasRetiredObjects |= !m_retiredNodes[i].isEmpty() || !m_retiredTileData[i].isEmpty();
+        }
+        if (!hasRetiredObjects) return;
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const int epoch = m_epoch.loadAcquire();
+        const int previousEpoch = (epoch + NUM_EPOCHS - 1) % NUM_EPOCHS;
+
+        for (int i = 0; i < NUM_READER_STRIPES; i++) {
+            if (m_readerStripes[i].readers[previousEpoch].loadAcquire()) return;
+        }
+
+        const int newEpoch = (epoch + 1) % NUM_EPOCHS;
+        m_epoch.fetchAndStoreOrdered(newEpoch);
+
+        // the objects retired two epochs ago
+        freeRetiredObjects((newEpoch + 1) % NUM_EPOCHS);
+    }
+}
+
+template<class T>
+void KisTileHashTableTraits<T>::freeRetiredObjects(int epoch)
 {
-    if (m_defaultTileData) {
-        m_defaultTileData->release();
-        m_defaultTileData = 0;
+    Q_FOREACH (Node *node, m_retiredNodes[epoch]) {
+        delete node;
     }
+    m_retiredNodes[epoch].clear();
 
+    Q_FOREACH (KisTileData *td, m_retiredTileData[epoch]) {
+        td->release();
+    }
+    m_retiredTileData[epoch].clear();
+}
+
+template<class T>
+inline void KisTileHashTableTraits<T>::setDefaultTileDataImp(KisTileData *defaultTileData)
+{
     if (defaultTileData) {
         defaultTileData->acquire();
-        m_defaultTileData = defaultTileData;
+    }
+
+    KisTileData *oldTileData = m_defaultTileData.fetchAndStoreOrdered(defaultTileData);
+
+    /**
+     * The lock-free readers may be creating a default tile with the
+     * old tile data right now, so release it only after they leave
+     */
+    if (oldTileData) {
+        m_retiredTileData[m_epoch.loadAcquire()].append(oldTileData);
+        tryAdvanceEpoch();
     }
 }
 
 template<class T>
 inline KisTileData* KisTileHashTableTraits<T>::defaultTileDataImp() const
 {
-    return m_defaultTileData;
+    return m_defaultTileData.loadAcquire();
 }
 
 
 template<class T>
 bool KisTileHashTableTraits<T>::tileExists(qint32 col, qint32 row)
 {
-    return this->getExisitngTile(col, row);
+    return this->getExistingTile(col, row);
 }
 
 template<class T>
@@ -219,10 +292,7 @@ KisTileHashTableTraits<T>::getExistingTile(qint32 col, qint32 row)
 {
     const qint32 idx = calculateHash(col, row);
 
-    // NOTE: minefield walk is disabled due to supposed unsafety,
-    //       see bug 391270
-
-    QReadLocker locker(&m_lock);
+    ReadSection section(this);
     return getTile(col, row, idx);
 }
 
@@ -233,22 +303,28 @@ KisTileHashTableTraits<T>::getTileLazy(qint32 col, qint32 row,
 {
     const qint32 idx = calculateHash(col, row);
 
-    // NOTE: minefield walk is disabled due to supposed unsafety,
-    //       see bug 391270
-
     newTile = false;
     TileTypeSP tile;
 
     {
-        QReadLocker locker(&m_lock);
+        ReadSection section(this);
         tile = getTile(col, row, idx);
     }
 
     if (!tile) {
         QWriteLocker locker(&m_lock);
-        tile = new TileType(col, row, m_defaultTileData, m_mementoManager);
-        linkTile(tile, idx);
-        newTile = true;
+
+        /**
+         * Someone could have added the tile while we
+         * were waiting for the lock, so check again
+         */
+        tile = getTile(col, row, idx);
+
+        if (!tile) {
+            tile = new TileType(col, row, defaultTileDataImp(), m_mementoManager);
+            linkTile(tile, idx);
+            newTile = true;
+        }
     }
 
     return tile;
@@ -260,16 +336,13 @@ KisTileHashTableTraits<T>::getReadOnlyTileLazy(qint32 col, qint32 row, bool &exi
 {
     const qint32 idx = calculateHash(col, row);
 
-    // NOTE: minefield walk is disabled due to supposed unsafety,
-    //       see bug 391270
-
-    QReadLocker locker(&m_lock);
+    ReadSection section(this);
 
     TileTypeSP tile = getTile(col, row, idx);
     existingTile = tile;
 
     if (!existingTile) {
-        tile = new TileType(col, row, m_defaultTileData, 0);
+        tile = new TileType(col, row, defaultTileDataImp(), 0);
     }
 
     return tile;
@@ -303,30 +376,28 @@ template<class T>
 void KisTileHashTableTraits<T>::clear()
 {
     QWriteLocker locker(&m_lock);
-    TileTypeSP tile = TileTypeSP();
     qint32 i;
 
     for (i = 0; i < TABLE_SIZE; i++) {
-        tile = m_hashTable[i];
+        Node *node = m_hashTable[i].fetchAndStoreOrdered(0);
 
-        while (tile) {
-            TileTypeSP tmp = tile;
-            tile = tile->next();
+        while (node) {
+            Node *tmp = node;
+            node = node->next.loadAcquire();
 
             /**
              * About disconnection of tiles see a comment in unlinkTile()
              */
 
-            tmp->setNext(TileTypeSP());
-            tmp->notifyDead();
-            tmp = 0;
+            tmp->tile->notifyDead();
+            retireNode(tmp);
 
             m_numTiles--;
         }
-
-        m_hashTable[i] = 0;
     }
 
+    tryAdvanceEpoch();
+
     Q_ASSERT(!m_numTiles);
 }
 
@@ -340,7 +411,6 @@ void KisTileHashTableTraits<T>::setDefaultTileData(KisTileData *defaultTileData)
 template<class T>
 KisTileData* KisTileHashTableTraits<T>::defaultTileData() const
 {
-    QWriteLocker locker(&m_lock);
     return defaultTileDataImp();
 }
 
@@ -354,7 +424,7 @@ void KisTileHashTableTraits<T>::debugPrintInfo()
 
     qDebug() << "==========================\n"
              << "TileHashTable:"
-             << "\n   def. data:\t\t" << m_defaultTileData
+             << "\n   def. data:\t\t" << defaultTileDataImp()
              << "\n   numTiles:\t\t" << m_numTiles;
     debugListLengthDistibution();
     qDebug() << "==========================\n";
@@ -364,14 +434,13 @@ template<class T>
 qint32 KisTileHashTableTraits<T>::debugChainLen(qint32 idx)
 {
     qint32 len = 0;
-    for (TileTypeSP it = m_hashTable[idx]; it; it = it->next(), len++) ;
+    for (Node *it = m_hashTable[idx].loadAcquire(); it; it = it->next.loadAcquire(), len++) ;
     return len;
 }
 
 template<class T>
 void KisTileHashTableTraits<T>::debugMaxListLength(qint32 &min, qint32 &max)
 {
-    TileTypeSP tile;
     qint32 maxLen = 0;
     qint32 minLen = m_numTiles;
     qint32 tmp = 0;
@@ -425,15 +494,10 @@ void KisTileHashTableTraits<T>::sanityChecksumCheck()
      */
     Q_ASSERT(!m_lock.tryLockForWrite());
 
-    TileTypeSP tile = 0;
     qint32 exactNumTiles = 0;
 
     for (qint32 i = 0; i < TABLE_SIZE; i++) {
-        tile = m_hashTable[i];
-        while (tile) {
-            exactNumTiles++;
-            tile = tile->next();
-        }
+        exactNumTiles += debugChainLen(i);
     }
 
     if (exactNumTiles != m_numTiles) {
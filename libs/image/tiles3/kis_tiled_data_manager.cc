@@ -19,6 +19,7 @@
  */
 
 #include <QRect>
+#include <algorithm>
 #include <QVector>
 
 #include "kis_tile.h"
@@ -74,6 +75,67 @@ KisTiledDataManager::KisTiledDataManager(const KisTiledDataManager &dm)
     recalculateExtent();
 }
 
+KisTiledDataManager::KisTiledDataManager(const KisTiledDataManager &dm, SnapshotPolicy policy)
+    : KisShared()
+{
+    Q_UNUSED(policy);
+    QReadLocker locker(&dm.m_lock);
+
+    m_mementoManager = new KisMementoManager();
+    m_hashTable = new KisTileHashTable(m_mementoManager);
+
+    m_pixelSize = dm.m_pixelSize;
+    m_defaultPixel = new quint8[m_pixelSize];
+
+    KisMementoManager *srcMM = dm.m_mementoManager;
+    KisMementoSP memento = srcMM->currentMemento();
+    setDefaultPixelImpl(memento && memento->oldDefaultPixel() ?
+                        memento->oldDefaultPixel() : dm.m_defaultPixel);
+
+    KisTileHashTableConstIterator iter(dm.m_hashTable);
+    KisTileSP tile;
+
+    while ((tile = iter.tile())) {
+        /**
+         * The tile data should be fetched *before* checking the
+         * index of the transaction. KisTile::lockForWrite() replaces
+         * the data and registers the tile in the index inside the
+         * same COW mutex critical section that refTileData() takes.
+         * So if the tile is not in the index after we took the data,
+         * no writer has touched this data since the last commit, and
+         * any later writer will do copy-on-write and leave it intact.
+         *
+         * Without a named transaction the index is ignored and the
+         * data may be written in place, see the header.
+         */
+        KisTileData *td = tile->refTileData();
+
+        if (!srcMM->tileChangedInTransaction(tile->col(), tile->row())) {
+            m_hashTable->addTile(KisTileSP(new KisTile(tile->col(), tile->row(), td, m_mementoManager)));
+        }
+
+        td->deref();
+        iter.next();
+    }
+
+    /**
+     * Now fetch the committed versions of the tiles changed by
+     * the stroke, including the ones it has deleted
+     */
+    Q_FOREACH (const QPoint &pt, srcMM->changedTilesInTransaction()) {
+        if (m_hashTable->getExistingTile(pt.x(), pt.y())) continue;
+
+        bool existingTile = false;
+        KisTileSP commitedTile = srcMM->getCommitedTile(pt.x(), pt.y(), existingTile);
+
+        if (commitedTile && existingTile) {
+            m_hashTable->addTile(KisTileSP(new KisTile(*commitedTile, m_mementoManager)));
+        }
+    }
+
+    recalculateExtent();
+}
+
 KisTiledDataManager::~KisTiledDataManager()
 {
     /**
@@ -300,6 +362,27 @@ void KisTiledDataManager::purge(const QRect& area)
     }
 }
 
+quint32 KisTiledDataManager::beginSwapPriorityHints()
+{
+    return KisTileDataStore::instance()->beginSwapPriorityHints();
+}
+
+void KisTiledDataManager::setSwapPriorityHint(const QRect &visibleRect, quint32 hintsPass)
+{
+    QReadLocker locker(&m_lock);
+
+    KisTileHashTableConstIterator iter(m_hashTable);
+    KisTileSP tile;
+
+    while ((tile = iter.tile())) {
+        tile->setSwapPriority(tile->extent().intersects(visibleRect) ?
+                              KisTileData::HighPriority :
+                              KisTileData::LowPriority,
+                              hintsPass);
+        iter.next();
+    }
+}
+
 quint8* KisTiledDataManager::duplicatePixel(qint32 num, const quint8 *pixel)
 {
     const qint32 pixelSize = this->pixelSize();
@@ -669,18 +752,52 @@ QRect KisTiledDataManager::extent() const
 
 QRegion KisTiledDataManager::region() const
 {
+    QVector<QPoint> indexes = m_extentManager.tiles();
+
+    std::sort(indexes.begin(), indexes.end(),
+              [] (const QPoint &lhs, const QPoint &rhs) {
+                  return lhs.y() < rhs.y() || (lhs.y() == rhs.y() && lhs.x() < rhs.x());
+              });
+
+    /**
+     * Uniting the regions is expensive, so merge the horizontal
+     * runs of tiles into a single rect first
+     */
     QRegion region;
 
-    KisTileHashTableConstIterator iter(m_hashTable);
-    KisTileSP tile;
+    for (int i = 0; i < indexes.size();) {
+        const QPoint &first = indexes[i];
+        int j = i + 1;
 
-    while ((tile = iter.tile())) {
-        region += tile->extent();
-        iter.next();
+        while (j < indexes.size() &&
+               indexes[j].y() == first.y() &&
+               indexes[j].x() == first.x() + (j - i)) {
+            j++;
+        }
+
+        region += QRect(first.x() * KisTileData::WIDTH, first.y() * KisTileData::HEIGHT,
+                        (j - i) * KisTileData::WIDTH, KisTileData::HEIGHT);
+        i = j;
     }
+
     return region;
 }
 
+bool KisTiledDataManager::tileExistsAt(qint32 x, qint32 y) const
+{
+    return m_extentManager.hasTile(xToCol(x), yToRow(y));
+}
+
+bool KisTiledDataManager::tileRowExistsAt(qint32 y) const
+{
+    return m_extentManager.rowHasTiles(yToRow(y));
+}
+
+bool KisTiledDataManager::tileColumnExistsAt(qint32 x) const
+{
+    return m_extentManager.colHasTiles(xToCol(x));
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
@@ -70,6 +70,30 @@ public:
     KisTiledDataManager(quint32 pixelSize, const quint8 *defPixel);
     virtual ~KisTiledDataManager();
     KisTiledDataManager(const KisTiledDataManager &dm);
+
+    enum SnapshotPolicy {
+        FrozenRevision
+    };
+
+    /**
+     * Creates a read-only snapshot of \p dm that can be read in a
+     * background thread.
+     *
+     * When a named transaction (a stroke) is in progress on \p dm,
+     * the snapshot contains the last committed revision, that is the
+     * state of the device before the stroke. The tiles are shared
+     * with the undo history, so no pixel data is copied, and the
+     * snapshot stays consistent however the stroke paints on \p dm.
+     *
+     * Without a named transaction the snapshot is a copy-on-write copy
+     * of the current tiles, just like the ordinary copy constructor
+     * does. It gives no guarantees against concurrent writers: a tile
+     * that is being written at the moment of the copy may show a part
+     * of the write. That is the case of the projections, which are
+     * never painted in a transaction.
+     */
+    KisTiledDataManager(const KisTiledDataManager &dm, SnapshotPolicy policy);
+
     KisTiledDataManager & operator=(const KisTiledDataManager &dm);
 
 
@@ -137,6 +161,40 @@ public:
         return getOldTile(col, row, unused);
     }
 
+    /**
+     * Starts loading the tile in the background if it exists and
+     * has been swapped out. The iterators call it for the tiles
+     * lying ahead of them to avoid waiting for the swap file.
+     */
+    inline void prefetchTile(qint32 col, qint32 row) {
+        KisTileSP tile = m_hashTable->getExistingTile(col, row);
+        if (tile) {
+            tile->prefetch();
+        }
+    }
+
+    /**
+     * Tells the swapper which tiles the user is looking at. The tiles
+     * intersecting \p visibleRect get high swap priority, all the other
+     * tiles get low priority and will be swapped out first. Pass an
+     * empty rect for the devices that are not visible at all.
+     *
+     * \p visibleRect is in the coordinates of the data manager, that
+     * is, without the offset of the paint device.
+     *
+     * The tiles may be shared with other data managers via COW. All
+     * the hints of a single pass, started with
+     * beginSwapPriorityHints(), are merged and the highest priority
+     * wins, so a hidden clone cannot demote the visible tiles.
+     */
+    void setSwapPriorityHint(const QRect &visibleRect, quint32 hintsPass);
+
+    /**
+     * Starts a new pass of swap priority hints and returns its
+     * number, that should be passed to setSwapPriorityHint()
+     */
+    static quint32 beginSwapPriorityHints();
+
     KisMementoSP getMemento() {
         QWriteLocker locker(&m_lock);
         KisMementoSP memento = m_mementoManager->getMemento();
@@ -222,6 +280,17 @@ public:
 
     QRegion region() const;
 
+    /**
+     * Fast checks whether the tile containing the pixel, the row of
+     * tiles containing \p y or the column of tiles containing \p x
+     * exist. They don't access the tiles themselves. The pixels
+     * outside the existing tiles are guaranteed to be default, so
+     * the pixel scanning algorithms may skip them.
+     */
+    bool tileExistsAt(qint32 x, qint32 y) const;
+    bool tileRowExistsAt(qint32 y) const;
+    bool tileColumnExistsAt(qint32 x) const;
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -66,6 +66,8 @@ KisVLineIterator2::KisVLineIterator2(KisDataManager *dataManager, qint32 x, qint
     for (int i = 0; i < m_tilesCacheSize; i++){
         fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i);
     }
+    prefetchNextColumn();
+
     m_index = 0;
     switchToTile(m_topInTopmostTile);
 }
@@ -221,6 +223,14 @@ void KisVLineIterator2::preallocateTiles()
         unlockTile(m_tilesCache[i].oldtile);
         fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i );
     }
+    prefetchNextColumn();
+}
+
+void KisVLineIterator2::prefetchNextColumn()
+{
+    for (int i = 0; i < m_tilesCacheSize; ++i) {
+        m_dataManager->prefetchTile(m_column + 1, m_topRow + i);
+    }
 }
 
 qint32 KisVLineIterator2::x() const
@@ -86,5 +86,11 @@ private:
     void switchToTile(qint32 xInTile);
     void fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row);
     void preallocateTiles();
+
+    /**
+     * Asks the data manager to read ahead the tiles the
+     * iterator is going to step on next
+     */
+    void prefetchNextColumn();
 };
 #endif
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_compression_registry.h"
+
+#include <config-tile-compression.h>
+
+#include "kis_image_config.h"
+#include "kis_lzf_compression.h"
+
+#ifdef HAVE_LZ4
+#include "kis_lz4_compression.h"
+#endif
+
+#ifdef HAVE_ZSTD
+#include "kis_zstd_compression.h"
+#endif
+
+
+namespace {
+
+typedef KisAbstractCompression* (*CompressionCreator)();
+
+template <class Compression>
+KisAbstractCompression* createCompression() {
+    return new Compression();
+}
+
+struct CompressionInfo {
+    quint8 id;
+    const char *name;
+    CompressionCreator creator;
+};
+
+/**
+ * WARNING: the ids and names are persistent! They are saved
+ *          into tile headers, so never change them.
+ */
+const CompressionInfo compressions[] = {
+    {1, "LZF", &createCompression<KisLzfCompression>},
+#ifdef HAVE_LZ4
+    {2, "LZ4", &createCompression<KisLz4Compression>},
+#endif
+#ifdef HAVE_ZSTD
+    {3, "ZSTD", &createCompression<KisZstdCompression>},
+#endif
+};
+
+const CompressionInfo* findCompression(const QString &name) {
+    for (const CompressionInfo &info : compressions) {
+        if (name == QLatin1String(info.name)) {
+            return &info;
+        }
+    }
+    return 0;
+}
+
+}
+
+const quint8 KisCompressionRegistry::RAW_DATA_ID;
+
+QStringList KisCompressionRegistry::availableCompressions()
+{
+    QStringList result;
+
+    for (const CompressionInfo &info : compressions) {
+        result << QLatin1String(info.name);
+    }
+
+    return result;
+}
+
+bool KisCompressionRegistry::isAvailable(const QString &name)
+{
+    return findCompression(name);
+}
+
+KisAbstractCompression* KisCompressionRegistry::create(const QString &name)
+{
+    const CompressionInfo *info = findCompression(name);
+    return info ? info->creator() : 0;
+}
+
+quint8 KisCompressionRegistry::idForName(const QString &name)
+{
+    const CompressionInfo *info = findCompression(name);
+    return info ? info->id : RAW_DATA_ID;
+}
+
+QString KisCompressionRegistry::nameForId(quint8 id)
+{
+    for (const CompressionInfo &info : compressions) {
+        if (info.id == id) {
+            return QLatin1String(info.name);
+        }
+    }
+    return QString();
+}
+
+QString KisCompressionRegistry::compressionForUsage(Usage usage)
+{
+    KisImageConfig config(true);
+
+    QString name;
+
+    switch (usage) {
+    case SwapUsage:
+        name = config.swapCompression();
+        break;
+    case SavingUsage:
+        name = config.tilesSaveCompression();
+        break;
+    case UndoUsage:
+        name = config.undoCompression();
+        break;
+    }
+
+    return isAvailable(name) ? name : defaultCompression();
+}
+
+QString KisCompressionRegistry::defaultCompression()
+{
+    return QLatin1String("LZF");
+}
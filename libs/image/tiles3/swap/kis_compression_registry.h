@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_COMPRESSION_REGISTRY_H
+#define __KIS_COMPRESSION_REGISTRY_H
+
+#include "kritaimage_export.h"
+#include <QString>
+#include <QStringList>
+
+class KisAbstractCompression;
+
+/**
+ * A registry of all the compression backends available in the
+ * current build of Krita. LZF is always available, LZ4 and Zstandard
+ * backends are available only when Krita is linked against the
+ * corresponding libraries.
+ *
+ * Every backend has a persistent name, which is written into the
+ * headers of the tiles saved into .kra files, and a one-byte id,
+ * which is written into the headers of the tiles stored in the swap
+ * file. Both the name and the id must never change, otherwise old
+ * files will fail to load.
+ */
+class KRITAIMAGE_EXPORT KisCompressionRegistry
+{
+public:
+    enum Usage {
+        SwapUsage,
+        SavingUsage,
+        UndoUsage
+    };
+
+    /**
+     * Id 0 is reserved for uncompressed data
+     */
+    static const quint8 RAW_DATA_ID = 0;
+
+public:
+    /**
+     * \return the names of all the compression backends compiled in
+     */
+    static QStringList availableCompressions();
+
+    static bool isAvailable(const QString &name);
+
+    /**
+     * Creates a new compression backend object. The caller
+     * takes the ownership of the object.
+     *
+     * \return the backend or null if \a name is not available
+     */
+    static KisAbstractCompression* create(const QString &name);
+
+    /**
+     * \return a persistent id of the backend or RAW_DATA_ID
+     *         if \a name is not available
+     */
+    static quint8 idForName(const QString &name);
+
+    /**
+     * \return a name of the backend with the persistent id \a id
+     *         or an empty string if no such backend is available
+     */
+    static QString nameForId(quint8 id);
+
+    /**
+     * Returns the name of the backend the user selected for the
+     * \a usage. If the selected backend is not available in the
+     * current build, falls back to defaultCompression().
+     */
+    static QString compressionForUsage(Usage usage);
+
+    /**
+     * The compression that is guaranteed to be available in
+     * every build of Krita (LZF)
+     */
+    static QString defaultCompression();
+
+private:
+    KisCompressionRegistry();
+};
+
+#endif /* __KIS_COMPRESSION_REGISTRY_H */
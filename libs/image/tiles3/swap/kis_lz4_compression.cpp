@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_lz4_compression.h"
+
+#include <lz4.h>
+
+
+KisLz4Compression::KisLz4Compression()
+{
+}
+
+KisLz4Compression::~KisLz4Compression()
+{
+}
+
+qint32 KisLz4Compression::compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    const int result = LZ4_compress_default(reinterpret_cast<const char*>(input),
+                                            reinterpret_cast<char*>(output),
+                                            inputLength, outputLength);
+    return qMax(0, result);
+}
+
+qint32 KisLz4Compression::decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    const int result = LZ4_decompress_safe(reinterpret_cast<const char*>(input),
+                                           reinterpret_cast<char*>(output),
+                                           inputLength, outputLength);
+    return qMax(0, result);
+}
+
+qint32 KisLz4Compression::outputBufferSize(qint32 dataSize)
+{
+    return LZ4_compressBound(dataSize);
+}
@@ -21,6 +21,11 @@
 
 #include <QDir>
 
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #define SWP_PREFIX "KRITA_SWAP_FILE_XXXXXX"
 
 KisMemoryWindow::KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize)
@@ -61,7 +66,7 @@ KisMemoryWindow::~KisMemoryWindow()
 
 quint8* KisMemoryWindow::getReadChunkPtr(const KisChunkData &readChunk)
 {
-    if (!adjustWindow(readChunk, &m_readWindowEx, &m_writeWindowEx)) {
+    if (!adjustWindow(readChunk, &m_readWindowEx, &m_writeWindowEx, true)) {
         return nullptr;
     }
 
@@ -70,7 +75,7 @@ quint8* KisMemoryWindow::getReadChunkPtr(const KisChunkData &readChunk)
 
 quint8* KisMemoryWindow::getWriteChunkPtr(const KisChunkData &writeChunk)
 {
-    if (!adjustWindow(writeChunk, &m_writeWindowEx, &m_readWindowEx)) {
+    if (!adjustWindow(writeChunk, &m_writeWindowEx, &m_readWindowEx, false)) {
         return nullptr;
     }
 
@@ -79,7 +84,8 @@ quint8* KisMemoryWindow::getWriteChunkPtr(const KisChunkData &writeChunk)
 
 bool KisMemoryWindow::adjustWindow(const KisChunkData &requestedChunk,
                                    MappingWindow *adjustingWindow,
-                                   MappingWindow *otherWindow)
+                                   MappingWindow *otherWindow,
+                                   bool readAhead)
 {
     if(!(adjustingWindow->window) ||
        !(requestedChunk.m_begin >= adjustingWindow->chunk.m_begin &&
@@ -144,7 +150,32 @@ bool KisMemoryWindow::adjustWindow(const KisChunkData &requestedChunk,
         if (!adjustingWindow->window) {
             return false;
         }
+
+        adviseWindow(adjustingWindow, readAhead);
     }
 
 	return true;
 }
+
+void KisMemoryWindow::adviseWindow(MappingWindow *window, bool readAhead)
+{
+#ifdef Q_OS_UNIX
+    /**
+     * The tiles are swapped out in the order of the clock iterator,
+     * so the neighbouring tiles usually lie nearby in the file. Ask
+     * the kernel to read the whole read window in the background,
+     * instead of faulting the pages in one by one while painting.
+     * The write window is filled sequentially.
+     */
+    const quintptr pageSize = sysconf(_SC_PAGESIZE);
+    const quintptr begin = reinterpret_cast<quintptr>(window->window);
+    const quintptr alignedBegin = begin & ~(pageSize - 1);
+    const size_t length = window->chunk.size() + (begin - alignedBegin);
+
+    posix_madvise(reinterpret_cast<void*>(alignedBegin), length,
+                  readAhead ? POSIX_MADV_WILLNEED : POSIX_MADV_SEQUENTIAL);
+#else
+    Q_UNUSED(window);
+    Q_UNUSED(readAhead);
+#endif
+}
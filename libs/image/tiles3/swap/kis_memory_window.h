@@ -68,7 +68,10 @@ private:
 private:
     bool adjustWindow(const KisChunkData &requestedChunk,
                       MappingWindow *adjustingWindow,
-                      MappingWindow *otherWindow);
+                      MappingWindow *otherWindow,
+                      bool readAhead);
+
+    void adviseWindow(MappingWindow *window, bool readAhead);
 
 private:
     QTemporaryFile m_file;
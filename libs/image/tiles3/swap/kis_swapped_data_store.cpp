@@ -22,6 +22,7 @@
 #include "kis_image_config.h"
 
 #include "kis_tile_compressor_2.h"
+#include "kis_compression_registry.h"
 
 //#define COMPRESSOR_VERSION 2
 
@@ -36,8 +37,8 @@ KisSwappedDataStore::KisSwappedDataStore()
     m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize);
     m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
 
-    // FIXME: use a factory after the patch is committed
-    m_compressor = new KisTileCompressor2();
+    m_compressor = new KisTileCompressor2(
+        KisCompressionRegistry::compressionForUsage(KisCompressionRegistry::SwapUsage));
 }
 
 KisSwappedDataStore::~KisSwappedDataStore()
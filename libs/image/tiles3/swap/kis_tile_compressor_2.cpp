@@ -17,22 +17,52 @@
  */
 
 #include "kis_tile_compressor_2.h"
-#include "kis_lzf_compression.h"
+#include "kis_abstract_compression.h"
+#include "kis_compression_registry.h"
 #include <QIODevice>
 #include "kis_paint_device_writer.h"
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
-const QString KisTileCompressor2::m_compressionName = "LZF";
-
 
 KisTileCompressor2::KisTileCompressor2()
+    : KisTileCompressor2(KisCompressionRegistry::defaultCompression())
 {
-    m_compression = new KisLzfCompression();
+}
+
+KisTileCompressor2::KisTileCompressor2(const QString &compressionName)
+    : m_compressionName(compressionName),
+      m_compressionId(KisCompressionRegistry::idForName(compressionName))
+{
+    if (m_compressionId == KisCompressionRegistry::RAW_DATA_ID) {
+        warnKrita << "Tile compression" << compressionName
+                  << "is not available, falling back to"
+                  << KisCompressionRegistry::defaultCompression();
+
+        m_compressionName = KisCompressionRegistry::defaultCompression();
+        m_compressionId = KisCompressionRegistry::idForName(m_compressionName);
+    }
+
+    m_compression = compressionForId(m_compressionId);
+    Q_ASSERT(m_compression);
 }
 
 KisTileCompressor2::~KisTileCompressor2()
 {
-    delete m_compression;
+    qDeleteAll(m_decompressors);
+}
+
+KisAbstractCompression* KisTileCompressor2::compressionForId(quint8 id)
+{
+    KisAbstractCompression *compression = m_decompressors.value(id, 0);
+
+    if (!compression) {
+        compression = KisCompressionRegistry::create(KisCompressionRegistry::nameForId(id));
+        if (compression) {
+            m_decompressors.insert(id, compression);
+        }
+    }
+
+    return compression;
 }
 
 bool KisTileCompressor2::writeTile(KisTileSP tile, KisPaintDeviceWriter &store)
@@ -75,15 +105,19 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         qint32 dataSize = headerItems.takeFirst().toInt();
 
         Q_ASSERT(headerItems.isEmpty());
-        Q_ASSERT(compressionName == m_compressionName);
+
+        stream->read(m_streamingBuffer.data(), dataSize);
+
+        if (!KisCompressionRegistry::isAvailable(compressionName)) {
+            warnFile << "Failed to read a tile: unsupported compression" << compressionName;
+            return false;
+        }
 
         qint32 row = yToRow(dm, y);
         qint32 col = xToCol(dm, x);
 
         KisTileSP tile = dm->getTile(col, row, true);
 
-        stream->read(m_streamingBuffer.data(), dataSize);
-
         tile->lockForWrite();
         bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
         tile->unlock();
@@ -129,13 +163,13 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
     compressedBytes = m_compression->compress((quint8*)m_linearizationBuffer.data(), tileDataSize,
                                               (quint8*)m_compressionBuffer.data(), m_compressionBuffer.size());
 
-    if(compressedBytes < tileDataSize) {
-        buffer[0] = COMPRESSED_DATA_FLAG;
+    if(compressedBytes > 0 && compressedBytes < tileDataSize) {
+        buffer[0] = m_compressionId;
         memcpy(buffer + 1, m_compressionBuffer.data(), compressedBytes);
         bytesWritten = compressedBytes + 1;
     }
     else {
-        buffer[0] = RAW_DATA_FLAG;
+        buffer[0] = KisCompressionRegistry::RAW_DATA_ID;
         memcpy(buffer + 1, tileData->data(), tileDataSize);
         bytesWritten = tileDataSize + 1;
     }
@@ -148,12 +182,18 @@ bool KisTileCompressor2::decompressTileData(quint8 *buffer,
     const qint32 pixelSize = tileData->pixelSize();
     const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize);
 
-    if(buffer[0] == COMPRESSED_DATA_FLAG) {
+    if(buffer[0] != KisCompressionRegistry::RAW_DATA_ID) {
+        KisAbstractCompression *compression = compressionForId(buffer[0]);
+        if (!compression) {
+            warnKrita << "Failed to decompress a tile: unknown compression id" << buffer[0];
+            return false;
+        }
+
         prepareWorkBuffers(tileDataSize);
 
         qint32 bytesWritten;
-        bytesWritten = m_compression->decompress(buffer + 1, bufferSize - 1,
-                                                 (quint8*)m_linearizationBuffer.data(), tileDataSize);
+        bytesWritten = compression->decompress(buffer + 1, bufferSize - 1,
+                                               (quint8*)m_linearizationBuffer.data(), tileDataSize);
         if (bytesWritten == tileDataSize) {
             KisAbstractCompression::delinearizeColors((quint8*)m_linearizationBuffer.data(),
                                                       tileData->data(),
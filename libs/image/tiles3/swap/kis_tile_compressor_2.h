@@ -21,12 +21,27 @@
 
 #include "kis_abstract_tile_compressor.h"
 
+#include <QHash>
+
 class KisAbstractCompression;
 
 class KRITAIMAGE_EXPORT KisTileCompressor2 : public KisAbstractTileCompressor
 {
 public:
+    /**
+     * Creates a compressor that writes tiles using the default
+     * compression backend (LZF)
+     */
     KisTileCompressor2();
+
+    /**
+     * Creates a compressor that writes tiles using the compression
+     * backend \a compressionName. Reading is always possible for any
+     * backend available in KisCompressionRegistry, since the name
+     * of the backend is stored in the header of every tile.
+     */
+    explicit KisTileCompressor2(const QString &compressionName);
+
     ~KisTileCompressor2() override;
 
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
@@ -49,16 +64,22 @@ private:
     void prepareWorkBuffers(qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
-private:
-    static const qint8 RAW_DATA_FLAG = 0;
-    static const qint8 COMPRESSED_DATA_FLAG = 1;
+    /**
+     * Returns a (cached) backend for the persistent \a id
+     * or null if the backend is not available
+     */
+    KisAbstractCompression* compressionForId(quint8 id);
 
 private:
     QByteArray m_linearizationBuffer;
     QByteArray m_compressionBuffer;
     QByteArray m_streamingBuffer;
+
+    QString m_compressionName;
+    quint8 m_compressionId;
     KisAbstractCompression *m_compression;
-    static const QString m_compressionName;
+
+    QHash<quint8, KisAbstractCompression*> m_decompressors;
 };
 
 #endif /* __KIS_TILE_COMPRESSOR_2_H */
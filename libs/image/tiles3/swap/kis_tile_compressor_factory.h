@@ -21,6 +21,7 @@
 
 #include "tiles3/swap/kis_legacy_tile_compressor.h"
 #include "tiles3/swap/kis_tile_compressor_2.h"
+#include "tiles3/swap/kis_compression_registry.h"
 
 class KRITAIMAGE_EXPORT KisTileCompressorFactory
 {
@@ -31,7 +32,10 @@ public:
             return KisAbstractTileCompressorSP(new KisLegacyTileCompressor());
             break;
         case 2:
-            return KisAbstractTileCompressorSP(new KisTileCompressor2());
+            return KisAbstractTileCompressorSP(
+                new KisTileCompressor2(
+                    KisCompressionRegistry::compressionForUsage(
+                        KisCompressionRegistry::SavingUsage)));
             break;
         default:
             qFatal("Unknown version of the tiles");
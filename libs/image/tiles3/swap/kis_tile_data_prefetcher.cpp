@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "tiles3/swap/kis_tile_data_prefetcher.h"
+#include "tiles3/swap/kis_tile_data_swapper_p.h"
+#include "tiles3/kis_tile_data.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "kis_image_config.h"
+#include "kis_debug.h"
+
+/**
+ * The iterators request at most one row (or column) of tiles
+ * ahead, so a rather small queue is enough
+ */
+const int KisTileDataPrefetcher::MAX_QUEUE_SIZE = 256;
+
+
+struct Q_DECL_HIDDEN KisTileDataPrefetcher::Private
+{
+    KisTileDataStore *store;
+    KisStoreLimits limits;
+
+    QMutex lock;
+    QWaitCondition workCondition;
+    QWaitCondition idleCondition;
+    QQueue<KisTileData*> queue;
+
+    bool isBusy = false;
+    bool shouldExit = false;
+    bool enabled = true;
+};
+
+KisTileDataPrefetcher::KisTileDataPrefetcher(KisTileDataStore *store)
+    : QThread(),
+      m_d(new Private())
+{
+    m_d->store = store;
+
+    KisImageConfig config(true);
+    m_d->enabled = config.enableSwapPrefetching();
+}
+
+KisTileDataPrefetcher::~KisTileDataPrefetcher()
+{
+    clearQueue();
+    delete m_d;
+}
+
+void KisTileDataPrefetcher::prefetch(KisTileData *td)
+{
+    QMutexLocker locker(&m_d->lock);
+
+    if (!m_d->enabled || m_d->shouldExit ||
+        m_d->queue.size() >= MAX_QUEUE_SIZE) {
+
+        return;
+    }
+
+    td->ref();
+    m_d->queue.enqueue(td);
+    m_d->workCondition.wakeOne();
+}
+
+void KisTileDataPrefetcher::terminatePrefetcher()
+{
+    {
+        QMutexLocker locker(&m_d->lock);
+        m_d->shouldExit = true;
+        m_d->workCondition.wakeAll();
+    }
+
+    wait();
+    clearQueue();
+
+    QMutexLocker locker(&m_d->lock);
+    m_d->shouldExit = false;
+}
+
+void KisTileDataPrefetcher::testingRereadConfig()
+{
+    KisImageConfig config(true);
+
+    QMutexLocker locker(&m_d->lock);
+    m_d->limits = KisStoreLimits();
+    m_d->enabled = config.enableSwapPrefetching();
+}
+
+void KisTileDataPrefetcher::testingWaitForIdle()
+{
+    QMutexLocker locker(&m_d->lock);
+
+    while (!m_d->queue.isEmpty() || m_d->isBusy) {
+        m_d->idleCondition.wait(&m_d->lock);
+    }
+}
+
+bool KisTileDataPrefetcher::canLoadMoreTiles()
+{
+    /**
+     * Loading a tile above the hard limit would make the
+     * swapper push out the tiles that are really in use
+     */
+    return m_d->store->memoryMetric() < m_d->limits.hardLimit();
+}
+
+void KisTileDataPrefetcher::clearQueue()
+{
+    QQueue<KisTileData*> queue;
+
+    {
+        QMutexLocker locker(&m_d->lock);
+        queue.swap(m_d->queue);
+    }
+
+    /**
+     * Dereferencing may free the tile data,
+     * so do it without any locks held
+     */
+    Q_FOREACH (KisTileData *td, queue) {
+        td->deref();
+    }
+}
+
+void KisTileDataPrefetcher::run()
+{
+    QMutexLocker locker(&m_d->lock);
+
+    while (1) {
+        while (m_d->queue.isEmpty() && !m_d->shouldExit) {
+            m_d->workCondition.wait(&m_d->lock);
+        }
+
+        if (m_d->shouldExit) break;
+
+        KisTileData *td = m_d->queue.dequeue();
+        m_d->isBusy = true;
+
+        locker.unlock();
+
+        /**
+         * The check is racy, but it is only a hint. The
+         * locking is done properly by blockSwapping().
+         */
+        if (!td->data() && canLoadMoreTiles()) {
+            td->blockSwapping();
+            td->unblockSwapping();
+        }
+        td->deref();
+
+        locker.relock();
+
+        m_d->isBusy = false;
+        if (m_d->queue.isEmpty()) {
+            m_d->idleCondition.wakeAll();
+        }
+    }
+
+    m_d->isBusy = false;
+    m_d->idleCondition.wakeAll();
+}
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KIS_TILE_DATA_PREFETCHER_H_
+#define KIS_TILE_DATA_PREFETCHER_H_
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+
+#include "kritaimage_export.h"
+
+class KisTileDataStore;
+class KisTileData;
+
+/**
+ * A thread that loads the tile data objects, which are likely to be
+ * accessed soon, back to the memory. The iterators request the tiles
+ * lying ahead in the direction of their walk, so the painting thread
+ * doesn't have to wait for the swap file when it gets there.
+ *
+ * Prefetching is only a hint: the requests are dropped when the queue
+ * is full or when the store is close to its hard memory limit.
+ */
+class KRITAIMAGE_EXPORT KisTileDataPrefetcher : public QThread
+{
+    Q_OBJECT
+
+public:
+    KisTileDataPrefetcher(KisTileDataStore *store);
+    ~KisTileDataPrefetcher() override;
+
+    /**
+     * Queues the tile data for loading. The caller should
+     * own a reference to \a td during the call.
+     */
+    void prefetch(KisTileData *td);
+
+    void terminatePrefetcher();
+
+    void testingRereadConfig();
+
+    /**
+     * Blocks until all the queued tile data objects are processed
+     */
+    void testingWaitForIdle();
+
+private:
+    void run() override;
+
+    bool canLoadMoreTiles();
+    void clearQueue();
+
+private:
+    static const int MAX_QUEUE_SIZE;
+
+private:
+    struct Private;
+    Private * const m_d;
+};
+
+#endif /* KIS_TILE_DATA_PREFETCHER_H_ */
@@ -17,6 +17,8 @@
  */
 
 #include <QSemaphore>
+#include <QHash>
+#include <QSet>
 
 #include "tiles3/swap/kis_tile_data_swapper.h"
 #include "tiles3/swap/kis_tile_data_swapper_p.h"
@@ -29,6 +31,7 @@
 
 const qint32 KisTileDataSwapper::TIMEOUT = -1;
 const qint32 KisTileDataSwapper::DELAY = 0.7 * SEC;
+const qint32 KisTileDataSwapper::MAX_SOLID_CHECKS = 1024;
 
 //#define DEBUG_SWAPPER
 
@@ -52,6 +55,8 @@ public:
     KisTileDataStore *store;
     KisStoreLimits limits;
     QMutex cycleLock;
+    bool deduplicationEnabled;
+    qint32 solidScanPosition;
 };
 
 KisTileDataSwapper::KisTileDataSwapper(KisTileDataStore *store)
@@ -60,6 +65,10 @@ KisTileDataSwapper::KisTileDataSwapper(KisTileDataStore *store)
 {
     m_d->shouldExitFlag = 0;
     m_d->store = store;
+    m_d->solidScanPosition = 0;
+
+    KisImageConfig config(true);
+    m_d->deduplicationEnabled = config.enableTilesDeduplication();
 }
 
 KisTileDataSwapper::~KisTileDataSwapper()
@@ -125,6 +134,19 @@ void KisTileDataSwapper::doJob()
     DEBUG_VALUE(m_d->limits.softLimitThreshold());
     DEBUG_VALUE(m_d->limits.hardLimitThreshold());
 
+    /**
+     * Compacting of the uniform tiles is cheap and doesn't touch
+     * the disk, so do it before any swapping
+     */
+    DEBUG_ACTION("\t solid tiles");
+    memoryMetric -= compactSolidTiles();
+    DEBUG_VALUE(memoryMetric);
+
+    if(m_d->deduplicationEnabled) {
+        DEBUG_ACTION("\t deduplication");
+        memoryMetric -= deduplicateTiles();
+        DEBUG_VALUE(memoryMetric);
+    }
 
     if(memoryMetric > m_d->limits.softLimitThreshold()) {
         qint32 softFree =  memoryMetric - m_d->limits.softLimit();
@@ -197,6 +219,7 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
 {
     qint64 freedMetric = 0;
     QList<KisTileData*> additionalCandidates;
+    QList<KisTileData*> protectedCandidates;
 
     typename strategy::iterator *iter =
         strategy::beginIteration(m_d->store);
@@ -211,7 +234,19 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
 
         if(!strategy::isInteresting(item)) continue;
 
-        if(strategy::swapOutFirst(item)) {
+        /**
+         * The tiles the user is looking at are swapped out only
+         * when nothing else is left, the tiles marked as hidden
+         * or off-screen go first regardless of their age
+         */
+        const KisTileData::SwapPriority priority = item->swapPriority();
+
+        if(priority == KisTileData::HighPriority) {
+            item->markOld();
+            protectedCandidates.append(item);
+        }
+        else if(priority == KisTileData::LowPriority ||
+                strategy::swapOutFirst(item)) {
             if(iter->trySwapOut(item)) {
                 freedMetric += item->pixelSize();
             }
@@ -231,12 +266,148 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
         }
     }
 
+    Q_FOREACH (item, protectedCandidates) {
+        if(freedMetric >= needToFreeMetric) break;
+
+        if(iter->trySwapOut(item)) {
+            freedMetric += item->pixelSize();
+        }
+    }
+
     strategy::endIteration(m_d->store, iter);
 
     return freedMetric;
 }
 
+qint64 KisTileDataSwapper::compactSolidTiles()
+{
+    qint64 freedMetric = 0;
+    qint32 numChecks = 0;
+    qint32 position = 0;
+
+    KisTileDataStoreIterator *iter = m_d->store->beginIteration();
+    KisTileData *item;
+
+    /**
+     * Every check compares the whole tile while m_listLock is held,
+     * which blocks all the tile allocations. So the number of checks
+     * per pass is limited, and the next pass continues from the
+     * place where the previous one has stopped. The list may change
+     * in between, so the position is only approximate.
+     */
+    if(m_d->solidScanPosition >= m_d->store->numTilesInMemory()) {
+        m_d->solidScanPosition = 0;
+    }
+
+    while(iter->hasNext() && position < m_d->solidScanPosition) {
+        iter->next();
+        position++;
+    }
+
+    while(iter->hasNext() && numChecks < MAX_SOLID_CHECKS) {
+        item = iter->next();
+        position++;
+
+        if(item->m_solidityChecked.load(std::memory_order_relaxed)) continue;
+        numChecks++;
+
+        if(iter->tryCompactSolid(item)) {
+            freedMetric += item->pixelSize();
+            position--;
+        }
+    }
+
+    m_d->solidScanPosition = iter->hasNext() ? position : 0;
+
+    m_d->store->endIteration(iter);
+
+    return freedMetric;
+}
+
+qint64 KisTileDataSwapper::deduplicateTiles()
+{
+    /**
+     * Hashing and comparing the tiles is expensive, so it is done
+     * without m_listLock, which would block all the tile allocations
+     * otherwise. The tile data objects are referenced while the
+     * lock is still held, so they cannot be freed in the meantime.
+     */
+
+    QVector<KisTileData*> changedItems;
+
+    KisTileDataStoreIterator *iter = m_d->store->beginIteration();
+    KisTileData *item;
+
+    while(iter->hasNext()) {
+        item = iter->next();
+
+        if(!item->m_contentHashValid.load(std::memory_order_relaxed) &&
+           m_d->store->tryRefTileData(item)) {
+
+            changedItems.append(item);
+        }
+    }
+
+    m_d->store->endIteration(iter);
+
+    QSet<uint> changedHashes;
+
+    Q_FOREACH (item, changedItems) {
+        if(m_d->store->tryHashTileData(item)) {
+            changedHashes.insert(item->m_contentHash);
+        }
+        item->deref();
+    }
+
+    if(changedHashes.isEmpty()) return 0;
+
+    /**
+     * Only the tile data objects accessed since the previous pass
+     * are rehashed, but all of them take part in the grouping, so
+     * that the new tiles could find their old twins
+     */
+    QHash<uint, QVector<KisTileData*>> candidates;
+
+    iter = m_d->store->beginIteration();
+
+    while(iter->hasNext()) {
+        item = iter->next();
+
+        if(item->m_contentHashValid.load(std::memory_order_relaxed) &&
+           changedHashes.contains(item->m_contentHash) &&
+           m_d->store->tryRefTileData(item)) {
+
+            candidates[item->m_contentHash].append(item);
+        }
+    }
+
+    m_d->store->endIteration(iter);
+
+    qint64 freedMetric = 0;
+
+    Q_FOREACH (const QVector<KisTileData*> &group, candidates) {
+        if(group.size() > 1) {
+            freedMetric += m_d->store->tryDeduplicateTileData(group);
+        }
+
+        Q_FOREACH (item, group) {
+            item->deref();
+        }
+    }
+
+    return freedMetric;
+}
+
 void KisTileDataSwapper::testingRereadConfig()
 {
     m_d->limits = KisStoreLimits();
+
+    KisImageConfig config(true);
+    m_d->deduplicationEnabled = config.enableTilesDeduplication();
+}
+
+qint64 KisTileDataSwapper::testingSwapOut(qint64 needToFreeMetric)
+{
+    QMutexLocker locker(&m_d->cycleLock);
+    return pass<AggressiveSwapStrategy>(needToFreeMetric);
 }
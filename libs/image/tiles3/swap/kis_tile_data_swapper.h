@@ -42,16 +42,25 @@ public:
 
     void testingRereadConfig();
 
+    /**
+     * Runs a single aggressive swapping pass regardless
+     * of the store limits. Used in unittests only.
+     */
+    qint64 testingSwapOut(qint64 needToFreeMetric);
+
 private:
     void waitForWork();
     void run() override;
 
     void doJob();
     template<class strategy> qint64 pass(qint64 needToFreeMetric);
+    qint64 compactSolidTiles();
+    qint64 deduplicateTiles();
 
 private:
     static const qint32 TIMEOUT;
     static const qint32 DELAY;
+    static const qint32 MAX_SOLID_CHECKS;
 
 private:
     struct Private;
@@ -23,6 +23,7 @@
 
 #include "../../../sdk/tests/testutil.h"
 #include "tiles3/swap/kis_lzf_compression.h"
+#include "tiles3/swap/kis_compression_registry.h"
 #include <kis_debug.h>
 
 #define TEST_FILE "tile.png"
@@ -221,6 +222,26 @@ void KisCompressionTests::testLzfOverflow()
     delete compression;
 }
 
+void KisCompressionTests::testRegisteredCompressionsRoundTrip()
+{
+    Q_FOREACH (const QString &name, KisCompressionRegistry::availableCompressions()) {
+        dbgKrita << "Testing" << name;
+
+        KisAbstractCompression *compression = KisCompressionRegistry::create(name);
+        QVERIFY(compression);
+
+        roundTrip(compression);
+        roundTripTwoPass(compression);
+        testOverflow(compression);
+
+        delete compression;
+
+        const quint8 id = KisCompressionRegistry::idForName(name);
+        QVERIFY(id != KisCompressionRegistry::RAW_DATA_ID);
+        QCOMPARE(KisCompressionRegistry::nameForId(id), name);
+    }
+}
+
 void KisCompressionTests::benchmarkMemCpy()
 {
     QImage image(QString(FILES_DATA_DIR) + QDir::separator() + TEST_FILE);
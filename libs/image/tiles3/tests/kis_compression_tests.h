@@ -42,6 +42,8 @@ private Q_SLOTS:
     void testLzfRoundTrip();
     void testLzfOverflow();
 
+    void testRegisteredCompressionsRoundTrip();
+
     void benchmarkMemCpy();
 
     void benchmarkCompressionLzf();
@@ -22,11 +22,17 @@
 #include "tiles3/kis_tiled_data_manager.h"
 #include "tiles3/swap/kis_legacy_tile_compressor.h"
 #include "tiles3/swap/kis_tile_compressor_2.h"
+#include "tiles3/swap/kis_compression_registry.h"
 
 #include "tiles_test_utils.h"
 
-void KisTileCompressorsTest::doRoundTrip(KisAbstractTileCompressor *compressor)
+void KisTileCompressorsTest::doRoundTrip(KisAbstractTileCompressor *compressor,
+                                         KisAbstractTileCompressor *readingCompressor)
 {
+    if (!readingCompressor) {
+        readingCompressor = compressor;
+    }
+
     quint8 defaultPixel = 0;
     KisTiledDataManager dm(1, &defaultPixel);
 
@@ -53,7 +59,7 @@ void KisTileCompressorsTest::doRoundTrip(KisAbstractTileCompressor *compressor)
     QVERIFY(memoryIsFilled(defaultPixel, tile11->data(), TILESIZE));
     tile11 = 0;
 
-    bool res = compressor->readTile(fakeStore.device(), &dm);
+    bool res = readingCompressor->readTile(fakeStore.device(), &dm);
     Q_ASSERT(res);
     Q_UNUSED(res);
     tile11 = dm.getTile(1, 1, false);
@@ -179,6 +185,33 @@ void KisTileCompressorsTest::testLowLevelRoundTripIncompressible2()
     delete compressor;
 }
 
+void KisTileCompressorsTest::testRoundTrip2AllCompressions()
+{
+    Q_FOREACH (const QString &name, KisCompressionRegistry::availableCompressions()) {
+        dbgKrita << "Testing" << name;
+
+        KisAbstractTileCompressor *compressor = new KisTileCompressor2(name);
+        doRoundTrip(compressor);
+        doLowLevelRoundTrip(compressor);
+        doLowLevelRoundTripIncompressible(compressor);
+        delete compressor;
+    }
+}
+
+void KisTileCompressorsTest::testReadTileWrittenWithAnotherCompression()
+{
+    KisAbstractTileCompressor *reader = new KisTileCompressor2();
+
+    Q_FOREACH (const QString &name, KisCompressionRegistry::availableCompressions()) {
+        dbgKrita << "Testing" << name;
+
+        KisAbstractTileCompressor *writer = new KisTileCompressor2(name);
+        doRoundTrip(writer, reader);
+        delete writer;
+    }
+
+    delete reader;
+}
 
 QTEST_MAIN(KisTileCompressorsTest)
 
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_data_slab_allocator_test.h"
+#include <QTest>
+#include <QtConcurrent>
+
+#include "kis_debug.h"
+
+#include "tiles3/kis_tile_data_slab_allocator.h"
+
+const int CHUNK_SIZE = 4 * 64 * 64;
+
+
+void KisTileDataSlabAllocatorTest::testAllocation()
+{
+    KisTileDataSlabAllocator allocator(CHUNK_SIZE);
+    QCOMPARE(allocator.allocatedMemory(), 0ULL);
+
+    const int numChunks = 3 * KisTileDataSlabAllocator::SLAB_SIZE / CHUNK_SIZE;
+    QVector<quint8*> chunks;
+    QSet<quint8*> uniqueChunks;
+
+    for (int i = 0; i < numChunks; i++) {
+        quint8 *chunk = allocator.allocate();
+        QVERIFY(chunk);
+        memset(chunk, i & 0xff, CHUNK_SIZE);
+
+        chunks << chunk;
+        uniqueChunks << chunk;
+    }
+
+    QCOMPARE(uniqueChunks.size(), numChunks);
+    QCOMPARE(allocator.allocatedMemory(), 3 * KisTileDataSlabAllocator::SLAB_SIZE);
+
+    for (int i = 0; i < numChunks; i++) {
+        QCOMPARE(int(chunks[i][0]), i & 0xff);
+        QCOMPARE(int(chunks[i][CHUNK_SIZE - 1]), i & 0xff);
+    }
+
+    Q_FOREACH (quint8 *chunk, chunks) {
+        allocator.free(chunk);
+    }
+
+    // the free'd chunks should be reused
+    for (int i = 0; i < numChunks; i++) {
+        QVERIFY(uniqueChunks.contains(allocator.allocate()));
+    }
+    QCOMPARE(allocator.allocatedMemory(), 3 * KisTileDataSlabAllocator::SLAB_SIZE);
+}
+
+void KisTileDataSlabAllocatorTest::testReleaseFreeSlabs()
+{
+    KisTileDataSlabAllocator allocator(CHUNK_SIZE);
+
+    const int chunksPerSlab = KisTileDataSlabAllocator::SLAB_SIZE / CHUNK_SIZE;
+    QVector<quint8*> chunks;
+
+    for (int i = 0; i < 4 * chunksPerSlab; i++) {
+        chunks << allocator.allocate();
+    }
+
+    QCOMPARE(allocator.releaseFreeSlabs(), 0ULL);
+
+    // free everything except a single chunk
+    quint8 *survivor = chunks.takeAt(chunksPerSlab / 2);
+    memset(survivor, 0x5a, CHUNK_SIZE);
+
+    Q_FOREACH (quint8 *chunk, chunks) {
+        allocator.free(chunk);
+    }
+
+    QCOMPARE(allocator.releaseFreeSlabs(), 3 * KisTileDataSlabAllocator::SLAB_SIZE);
+    QCOMPARE(allocator.allocatedMemory(), KisTileDataSlabAllocator::SLAB_SIZE);
+
+    // the chunk in use should not be affected
+    for (int i = 0; i < CHUNK_SIZE; i++) {
+        QCOMPARE(survivor[i], quint8(0x5a));
+    }
+
+    allocator.free(survivor);
+    QCOMPARE(allocator.releaseFreeSlabs(), KisTileDataSlabAllocator::SLAB_SIZE);
+    QCOMPARE(allocator.allocatedMemory(), 0ULL);
+
+    // the allocator is still usable
+    QVERIFY(allocator.allocate());
+}
+
+void KisTileDataSlabAllocatorTest::testThreadedAllocation()
+{
+    KisTileDataSlabAllocator allocator(CHUNK_SIZE);
+
+    const int numThreads = 8;
+    const int numChunks = 2000;
+
+    auto worker = [&allocator] (int seed) {
+        QVector<quint8*> chunks;
+        bool result = true;
+
+        for (int cycle = 0; cycle < 4; cycle++) {
+            for (int i = 0; i < numChunks; i++) {
+                quint8 *chunk = allocator.allocate();
+                *reinterpret_cast<int*>(chunk) = seed + i;
+                chunks << chunk;
+            }
+
+            for (int i = 0; i < numChunks; i++) {
+                result &= *reinterpret_cast<int*>(chunks[i]) == seed + i;
+                allocator.free(chunks[i]);
+            }
+            chunks.clear();
+        }
+
+        return result;
+    };
+
+    QVector<int> seeds;
+    for (int i = 0; i < numThreads; i++) {
+        seeds << i * numChunks;
+    }
+
+    QList<bool> results = QtConcurrent::blockingMapped<QList<bool>>(seeds, std::function<bool(int)>(worker));
+
+    Q_FOREACH (bool result, results) {
+        QVERIFY(result);
+    }
+
+    allocator.releaseFreeSlabs();
+    QCOMPARE(allocator.allocatedMemory(), 0ULL);
+}
+
+QTEST_MAIN(KisTileDataSlabAllocatorTest)
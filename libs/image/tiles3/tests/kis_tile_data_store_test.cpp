@@ -28,6 +28,7 @@
 
 #include "tiles3/kis_tile_data_store.h"
 #include "tiles3/kis_tile_data_store_iterators.h"
+#include "tiles3/kis_hline_iterator.h"
 
 
 void KisTileDataStoreTest::testClockIterator()
@@ -180,6 +181,273 @@ void KisTileDataStoreTest::testSwapping()
         tile->unlock();
     }
 }
+void KisTileDataStoreTest::testSolidTiles()
+{
+    KisTileDataStore::instance()->debugClear();
+
+    const qint32 pixelSize = 1;
+    quint8 defaultPixel = 128;
+    const qint32 numColumns = 10;
+
+    {
+        KisTiledDataManager dm(pixelSize, &defaultPixel);
+
+        for(qint32 col = 0; col < numColumns; col++) {
+            KisTileSP tile = dm.getTile(col, 0, true);
+            tile->lockForWrite();
+
+            KisTileData *td = tile->tileData();
+            memset(td->data(), COLUMN2COLOR(col), TILESIZE);
+
+            // make odd tiles non-uniform
+            if (col & 0x1) {
+                td->data()[TILESIZE - 1] = COLUMN2COLOR(col) + 1;
+            }
+
+            tile->unlock();
+        }
+
+        const qint32 numTiles = KisTileDataStore::instance()->numTiles();
+
+        KisTileDataStoreIterator *iter = KisTileDataStore::instance()->beginIteration();
+        while(iter->hasNext()) {
+            KisTileData *item = iter->next();
+            iter->tryCompactSolid(item);
+        }
+        KisTileDataStore::instance()->endIteration(iter);
+
+        // even tiles plus the default tile data
+        QCOMPARE(KisTileDataStore::instance()->numSolidTiles(), numColumns / 2 + 1);
+        QCOMPARE(KisTileDataStore::instance()->numTiles(), numTiles);
+
+        // the second pass should not recheck the tiles
+        iter = KisTileDataStore::instance()->beginIteration();
+        while(iter->hasNext()) {
+            KisTileData *item = iter->next();
+            QVERIFY(!iter->tryCompactSolid(item));
+        }
+        KisTileDataStore::instance()->endIteration(iter);
+
+        for(qint32 col = 0; col < numColumns; col++) {
+            KisTileSP tile = dm.getTile(col, 0, false);
+            tile->lockForRead();
+
+            KisTileData *td = tile->tileData();
+            QVERIFY(!td->isSolid());
+
+            if (col & 0x1) {
+                QVERIFY(memoryIsFilled(COLUMN2COLOR(col), td->data(), TILESIZE - 1));
+                QCOMPARE(td->data()[TILESIZE - 1], quint8(COLUMN2COLOR(col) + 1));
+            } else {
+                QVERIFY(memoryIsFilled(COLUMN2COLOR(col), td->data(), TILESIZE));
+            }
+
+            tile->unlock();
+        }
+
+        // only the default tile data is still solid
+        QCOMPARE(KisTileDataStore::instance()->numSolidTiles(), 1);
+    }
+
+    QCOMPARE(KisTileDataStore::instance()->numSolidTiles(), 0);
+    QCOMPARE(KisTileDataStore::instance()->numTiles(), 0);
+}
+void fillTestPattern(quint8 *data, int seed)
+{
+    for (int i = 0; i < TILESIZE; i++) {
+        data[i] = (i + seed) % 256;
+    }
+}
+
+bool checkTestPattern(quint8 *data, int seed)
+{
+    for (int i = 0; i < TILESIZE; i++) {
+        if (data[i] != (i + seed) % 256) return false;
+    }
+    return true;
+}
+
+void KisTileDataStoreTest::testDeduplication()
+{
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+
+    const qint32 pixelSize = 1;
+    quint8 defaultPixel = 128;
+
+    {
+        KisTiledDataManager dm(pixelSize, &defaultPixel);
+        QVector<KisTileData*> candidates;
+
+        // the first three tiles are identical
+        for(qint32 col = 0; col < 4; col++) {
+            KisTileSP tile = dm.getTile(col, 0, true);
+            tile->lockForWrite();
+            fillTestPattern(tile->data(), col < 3 ? 0 : 1);
+            candidates << tile->tileData();
+            tile->unlock();
+        }
+
+        const qint32 numTiles = store->numTiles();
+
+        Q_FOREACH (KisTileData *td, candidates) {
+            QVERIFY(store->tryHashTileData(td));
+        }
+        const qint64 freedMetric = store->tryDeduplicateTileData(candidates);
+
+        // three tiles are released, one shared copy is created
+        QCOMPARE(freedMetric, qint64(2 * pixelSize));
+        QCOMPARE(store->numTiles(), numTiles + 1);
+        QCOMPARE(store->memoryStatistics().deduplicatedSize,
+                 qint64(3 * pixelSize * KisTileData::WIDTH * KisTileData::HEIGHT));
+
+        // write into one of the duplicates
+        {
+            KisTileSP tile = dm.getTile(1, 0, true);
+            tile->lockForWrite();
+            QVERIFY(checkTestPattern(tile->data(), 0));
+            fillTestPattern(tile->data(), 2);
+            tile->unlock();
+        }
+
+        const int expectedSeeds[] = {0, 2, 0, 1};
+
+        for(qint32 col = 0; col < 4; col++) {
+            KisTileSP tile = dm.getTile(col, 0, false);
+            tile->lockForRead();
+            QVERIFY(checkTestPattern(tile->data(), expectedSeeds[col]));
+            tile->unlock();
+        }
+
+        // all the duplicates are expanded, the shared copy is freed
+        QCOMPARE(store->numTiles(), numTiles);
+        QCOMPARE(store->memoryStatistics().deduplicatedSize, qint64(0));
+    }
+
+    QCOMPARE(store->numTiles(), 0);
+}
+
+void KisTileDataStoreTest::testPrefetching()
+{
+    KisImageConfig config;
+    config.setMemoryHardLimitPercent(config.memoryHardLimitPercent(true));
+    config.setMemorySoftLimitPercent(config.memorySoftLimitPercent(true));
+    config.setEnableSwapPrefetching(true);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+    store->testingRereadConfig();
+
+    const qint32 pixelSize = 1;
+    quint8 defaultPixel = 128;
+    const qint32 numColumns = 4;
+
+    {
+        KisTiledDataManager dm(pixelSize, &defaultPixel);
+
+        for(qint32 row = 0; row < 3; row++) {
+            for(qint32 col = 0; col < numColumns; col++) {
+                KisTileSP tile = dm.getTile(col, row, true);
+                tile->lockForWrite();
+                memset(tile->data(), COLUMN2COLOR(col + row), TILESIZE);
+                tile->unlock();
+            }
+        }
+
+        store->debugSwapAll();
+
+        for(qint32 row = 0; row < 3; row++) {
+            for(qint32 col = 0; col < numColumns; col++) {
+                QVERIFY(!dm.getTile(col, row, false)->tileData()->data());
+            }
+        }
+
+        {
+            KisHLineIterator2 it(&dm, 0, 0, numColumns * KisTileData::WIDTH,
+                                 0, 0, false, 0);
+            store->m_prefetcher.testingWaitForIdle();
+        }
+
+        // the row following the iterated one should have been read ahead
+        for(qint32 col = 0; col < numColumns; col++) {
+            QVERIFY(dm.getTile(col, 1, false)->tileData()->data());
+            QVERIFY(!dm.getTile(col, 2, false)->tileData()->data());
+        }
+
+        for(qint32 row = 0; row < 3; row++) {
+            for(qint32 col = 0; col < numColumns; col++) {
+                KisTileSP tile = dm.getTile(col, row, false);
+                tile->lockForRead();
+                QVERIFY(memoryIsFilled(COLUMN2COLOR(col + row), tile->data(), TILESIZE));
+                tile->unlock();
+            }
+        }
+    }
+
+    QCOMPARE(store->numTiles(), 0);
+}
+
+void KisTileDataStoreTest::testSwapPriorities()
+{
+    KisImageConfig config;
+    config.setMemoryHardLimitPercent(config.memoryHardLimitPercent(true));
+    config.setMemorySoftLimitPercent(config.memorySoftLimitPercent(true));
+    config.setEnableSwapPrefetching(false);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+    store->testingRereadConfig();
+
+    const qint32 pixelSize = 1;
+    quint8 defaultPixel = 128;
+    const qint32 numColumns = 8;
+    const qint32 numVisibleColumns = 3;
+
+    {
+        KisTiledDataManager dm(pixelSize, &defaultPixel);
+
+        for(qint32 col = 0; col < numColumns; col++) {
+            KisTileSP tile = dm.getTile(col, 0, true);
+            tile->lockForWrite();
+            // not uniform, otherwise the tile would be compacted
+            memset(tile->data(), COLUMN2COLOR(col), TILESIZE);
+            tile->data()[0] = ~COLUMN2COLOR(col);
+            tile->unlock();
+        }
+
+        const quint32 hintsPass = KisTiledDataManager::beginSwapPriorityHints();
+        dm.setSwapPriorityHint(QRect(0, 0, numVisibleColumns * KisTileData::WIDTH, 1), hintsPass);
+
+        // a hidden clone sharing the tiles doesn't demote them
+        KisTiledDataManager clone(dm);
+        clone.setSwapPriorityHint(QRect(), hintsPass);
+
+        // only the off-screen tiles are evicted
+        store->m_swapper.testingSwapOut(numColumns - numVisibleColumns);
+
+        for(qint32 col = 0; col < numColumns; col++) {
+            const bool isVisible = col < numVisibleColumns;
+            QCOMPARE(bool(dm.getTile(col, 0, false)->tileData()->data()), isVisible);
+        }
+
+        // the visible tiles are evicted when nothing else is left
+        store->m_swapper.testingSwapOut(numColumns);
+
+        for(qint32 col = 0; col < numColumns; col++) {
+            QVERIFY(!dm.getTile(col, 0, false)->tileData()->data());
+        }
+
+        for(qint32 col = 0; col < numColumns; col++) {
+            KisTileSP tile = dm.getTile(col, 0, false);
+            tile->lockForRead();
+            QCOMPARE(tile->data()[0], quint8(~COLUMN2COLOR(col)));
+            QVERIFY(memoryIsFilled(COLUMN2COLOR(col), tile->data() + 1, TILESIZE - 1));
+            tile->unlock();
+        }
+    }
+
+    QCOMPARE(store->numTiles(), 0);
+}
 
 QTEST_MAIN(KisTileDataStoreTest)
 
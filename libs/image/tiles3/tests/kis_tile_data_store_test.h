@@ -30,6 +30,10 @@ private Q_SLOTS:
     void testClockIterator();
     void testLeaks();
     void testSwapping();
+    void testSolidTiles();
+    void testDeduplication();
+    void testPrefetching();
+    void testSwapPriorities();
 };
 
 #endif /* KIS_TILE_DATA_STORE_TEST_H */
@@ -0,0 +1,240 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_hash_table_test.h"
+#include <QTest>
+#include <QtConcurrent>
+#include <QAtomicInt>
+
+#include "kis_debug.h"
+
+#include "tiles3/kis_tile.h"
+#include "tiles3/kis_tile_hash_table.h"
+#include "tiles3/kis_tile_data_store.h"
+
+const qint32 PIXEL_SIZE = 1;
+const qint32 NUM_COLUMNS = 64;
+const qint32 NUM_ROWS = 64;
+
+
+KisTileData* createDefaultTileData(quint8 defaultPixel)
+{
+    return KisTileDataStore::instance()->createDefaultTileData(PIXEL_SIZE, &defaultPixel);
+}
+
+int countTiles(KisTileHashTable &ht)
+{
+    int numTiles = 0;
+
+    KisTileHashTableConstIterator iter(&ht);
+    for (; !iter.isDone(); iter.next()) {
+        numTiles++;
+    }
+
+    return numTiles;
+}
+
+void KisTileHashTableTest::testOperations()
+{
+    KisTileHashTable ht(0);
+    ht.setDefaultTileData(createDefaultTileData(0));
+
+    QVERIFY(ht.isEmpty());
+    QVERIFY(!ht.getExistingTile(1, 2));
+
+    bool newTile = false;
+    KisTileSP tile = ht.getTileLazy(1, 2, newTile);
+    QVERIFY(newTile);
+    QCOMPARE(tile->col(), 1);
+    QCOMPARE(tile->row(), 2);
+
+    // a tile with the same hash
+    KisTileSP tile2 = ht.getTileLazy(1 + 32, 2, newTile);
+    QVERIFY(newTile);
+
+    QCOMPARE(ht.getTileLazy(1, 2, newTile), tile);
+    QVERIFY(!newTile);
+
+    QCOMPARE(ht.getExistingTile(1, 2), tile);
+    QCOMPARE(ht.getExistingTile(1 + 32, 2), tile2);
+    QCOMPARE(ht.numTiles(), 2);
+    QCOMPARE(countTiles(ht), 2);
+
+    bool existingTile = false;
+    QCOMPARE(ht.getReadOnlyTileLazy(1, 2, existingTile), tile);
+    QVERIFY(existingTile);
+
+    KisTileSP defaultTile = ht.getReadOnlyTileLazy(3, 3, existingTile);
+    QVERIFY(!existingTile);
+    QCOMPARE(defaultTile->tileData(), ht.defaultTileData());
+    QCOMPARE(ht.numTiles(), 2);
+
+    QVERIFY(ht.deleteTile(1, 2));
+    QVERIFY(!ht.deleteTile(1, 2));
+    QVERIFY(!ht.getExistingTile(1, 2));
+    QCOMPARE(ht.getExistingTile(1 + 32, 2), tile2);
+    QCOMPARE(ht.numTiles(), 1);
+
+    // the deleted tile is still usable by its owners
+    QCOMPARE(tile->col(), 1);
+
+    ht.clear();
+    QVERIFY(ht.isEmpty());
+    QCOMPARE(countTiles(ht), 0);
+}
+
+void KisTileHashTableTest::testDefaultTileData()
+{
+    KisTileHashTable ht(0);
+    ht.setDefaultTileData(createDefaultTileData(0));
+
+    bool existingTile = false;
+    KisTileSP oldTile = ht.getReadOnlyTileLazy(0, 0, existingTile);
+
+    KisTileData *newTileData = createDefaultTileData(255);
+    ht.setDefaultTileData(newTileData);
+
+    KisTileSP newTile = ht.getReadOnlyTileLazy(0, 0, existingTile);
+    QCOMPARE(newTile->tileData(), newTileData);
+
+    // the old default tile data is kept alive by the tile
+    oldTile->lockForRead();
+    QCOMPARE(oldTile->data()[0], quint8(0));
+    oldTile->unlock();
+}
+
+void KisTileHashTableTest::testConcurrentLazyCreation()
+{
+    KisTileHashTable ht(0);
+    ht.setDefaultTileData(createDefaultTileData(0));
+
+    const int numThreads = 8;
+    QAtomicInt numNewTiles;
+
+    QVector<int> seeds;
+    for (int i = 0; i < numThreads; i++) {
+        seeds << i;
+    }
+
+    QtConcurrent::blockingMap(seeds, [&ht, &numNewTiles] (int seed) {
+        for (int i = 0; i < NUM_COLUMNS * NUM_ROWS; i++) {
+            const int index = (i + seed * 97) % (NUM_COLUMNS * NUM_ROWS);
+            bool newTile = false;
+            ht.getTileLazy(index % NUM_COLUMNS, index / NUM_COLUMNS, newTile);
+            if (newTile) {
+                numNewTiles.ref();
+            }
+        }
+    });
+
+    // every tile should have been created exactly once
+    QCOMPARE(int(numNewTiles), NUM_COLUMNS * NUM_ROWS);
+    QCOMPARE(ht.numTiles(), NUM_COLUMNS * NUM_ROWS);
+    QCOMPARE(countTiles(ht), NUM_COLUMNS * NUM_ROWS);
+}
+
+void KisTileHashTableTest::testConcurrentReadWrite()
+{
+    KisTileHashTable ht(0);
+    ht.setDefaultTileData(createDefaultTileData(0));
+
+    /**
+     * The even columns are never removed, so the readers must
+     * always find them. The odd columns are constantly removed
+     * and added back by the writers.
+     */
+    bool newTile = false;
+    for (int row = 0; row < NUM_ROWS; row++) {
+        for (int col = 0; col < NUM_COLUMNS; col++) {
+            ht.getTileLazy(col, row, newTile);
+        }
+    }
+
+    const int numReaders = 8;
+    const int numWriters = 2;
+    const int numCycles = 20;
+
+    QAtomicInt numWritersRunning(numWriters);
+    QAtomicInt numFailures;
+
+    auto reader = [&] () {
+        while (numWritersRunning) {
+            for (int row = 0; row < NUM_ROWS; row++) {
+                for (int col = 0; col < NUM_COLUMNS; col++) {
+                    KisTileSP tile = ht.getExistingTile(col, row);
+
+                    if (tile && (tile->col() != col || tile->row() != row)) {
+                        numFailures.ref();
+                    }
+
+                    if (!tile && !(col & 0x1)) {
+                        numFailures.ref();
+                    }
+
+                    bool existingTile = false;
+                    tile = ht.getReadOnlyTileLazy(col, row, existingTile);
+                    if (!tile) {
+                        numFailures.ref();
+                    }
+                }
+            }
+        }
+    };
+
+    auto writer = [&] (int seed) {
+        for (int cycle = 0; cycle < numCycles; cycle++) {
+            for (int row = seed; row < NUM_ROWS; row += numWriters) {
+                for (int col = 1; col < NUM_COLUMNS; col += 2) {
+                    ht.deleteTile(col, row);
+                }
+            }
+
+            for (int row = seed; row < NUM_ROWS; row += numWriters) {
+                for (int col = 1; col < NUM_COLUMNS; col += 2) {
+                    bool newTile = false;
+                    ht.getTileLazy(col, row, newTile);
+                }
+            }
+        }
+        numWritersRunning.deref();
+    };
+
+    // the readers spin until the writers finish, so they need own threads
+    QThreadPool pool;
+    pool.setMaxThreadCount(numReaders + numWriters);
+
+    QList<QFuture<void>> futures;
+
+    for (int i = 0; i < numWriters; i++) {
+        futures << QtConcurrent::run(&pool, writer, i);
+    }
+
+    for (int i = 0; i < numReaders; i++) {
+        futures << QtConcurrent::run(&pool, reader);
+    }
+
+    Q_FOREACH (QFuture<void> future, futures) {
+        future.waitForFinished();
+    }
+
+    QCOMPARE(int(numFailures), 0);
+    QCOMPARE(ht.numTiles(), NUM_COLUMNS * NUM_ROWS);
+    QCOMPARE(countTiles(ht), NUM_COLUMNS * NUM_ROWS);
+}
+
+QTEST_MAIN(KisTileHashTableTest)
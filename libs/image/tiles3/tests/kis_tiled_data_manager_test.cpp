@@ -18,8 +18,12 @@
 
 #include "kis_tiled_data_manager_test.h"
 #include <QTest>
+#include <algorithm>
+#include <atomic>
 
 #include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/KisTiledExtentManager.h"
+#include "kis_image_config.h"
 
 #include "tiles_test_utils.h"
 
@@ -400,6 +404,170 @@ void KisTiledDataManagerTest::testTransactions()
 
 }
 
+void KisTiledDataManagerTest::testFrozenRevisionSnapshot()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+    quint8 oddPixel3 = 130;
+
+    dm.clear(0, 0, 64, 64, &oddPixel1);
+
+    // Start a stroke: change one tile and create another one
+    KisMementoSP memento1 = dm.getMemento();
+    dm.clear(0, 0, 64, 64, &oddPixel2);
+    dm.clear(64, 0, 64, 64, &oddPixel3);
+
+    KisTiledDataManager snapshot1(dm, KisTiledDataManager::FrozenRevision);
+
+    // The snapshot shows the state before the stroke...
+    QCOMPARE(snapshot1.extent(), QRect(0, 0, 64, 64));
+    QVERIFY(memoryIsFilled(oddPixel1, snapshot1.getTile(0, 0, false)->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(defaultPixel, snapshot1.getTile(1, 0, false)->data(), TILESIZE));
+
+    // ... and shares the pixels with the undo history
+    QVERIFY(checkTilesShared(&dm, &snapshot1, true, false, QRect(0, 0, 1, 1)));
+
+    dm.commit();
+
+    // Finishing the stroke doesn't change the existing snapshot
+    QVERIFY(memoryIsFilled(oddPixel1, snapshot1.getTile(0, 0, false)->data(), TILESIZE));
+
+    // Without a stroke the snapshot is just a copy of the device
+    KisTiledDataManager snapshot2(dm, KisTiledDataManager::FrozenRevision);
+    QCOMPARE(snapshot2.extent(), QRect(0, 0, 128, 64));
+    QVERIFY(memoryIsFilled(oddPixel2, snapshot2.getTile(0, 0, false)->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(oddPixel3, snapshot2.getTile(1, 0, false)->data(), TILESIZE));
+    QVERIFY(checkTilesShared(&dm, &snapshot2, false, false, QRect(0, 0, 2, 1)));
+
+    // Further painting doesn't change the snapshot
+    dm.clear(0, 0, 64, 64, &oddPixel3);
+    QVERIFY(memoryIsFilled(oddPixel2, snapshot2.getTile(0, 0, false)->data(), TILESIZE));
+}
+
+class SnapshotWriterJob : public QRunnable
+{
+public:
+    SnapshotWriterJob(KisTiledDataManager &dm, std::atomic<bool> &stop)
+        : m_dm(dm), m_stop(stop)
+    {
+    }
+
+    void run() override {
+        quint8 pixels[] = {129, 130};
+        int i = 0;
+
+        while (!m_stop) {
+            // non-aligned rects are painted in place, not by replacing tiles
+            m_dm.clear(1, 1, 254, 254, &pixels[i++ % 2]);
+        }
+    }
+
+private:
+    KisTiledDataManager &m_dm;
+    std::atomic<bool> &m_stop;
+};
+
+void KisTiledDataManagerTest::testFrozenRevisionSnapshotConcurrentWriter()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    dm.clear(0, 0, 256, 256, &oddPixel1);
+
+    KisMementoSP memento = dm.getMemento();
+
+    std::atomic<bool> stop(false);
+    QThreadPool pool;
+    pool.start(new SnapshotWriterJob(dm, stop));
+
+    bool snapshotsAreFrozen = true;
+
+    for (int i = 0; i < 200 && snapshotsAreFrozen; i++) {
+        KisTiledDataManager snapshot(dm, KisTiledDataManager::FrozenRevision);
+
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++) {
+                snapshotsAreFrozen &=
+                    memoryIsFilled(oddPixel1, snapshot.getTile(col, row, false)->data(), TILESIZE);
+            }
+        }
+    }
+
+    stop = true;
+    pool.waitForDone();
+
+    dm.commit();
+
+    QVERIFY(snapshotsAreFrozen);
+}
+
+void KisTiledDataManagerTest::testOccupancyIndex()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+
+    // two tiles far away from each other, and a run of three tiles
+    dm.clear(-640, -640, 64, 64, &oddPixel1);
+    dm.clear(64000, 32000, 64, 64, &oddPixel1);
+    dm.clear(0, 128, 192, 64, &oddPixel1);
+
+    QVERIFY(dm.tileExistsAt(-600, -600));
+    QVERIFY(dm.tileExistsAt(64010, 32010));
+    QVERIFY(dm.tileExistsAt(130, 150));
+    QVERIFY(!dm.tileExistsAt(200, 150));
+    QVERIFY(!dm.tileExistsAt(0, 0));
+
+    QVERIFY(dm.tileRowExistsAt(32063));
+    QVERIFY(!dm.tileRowExistsAt(32064));
+    QVERIFY(dm.tileColumnExistsAt(-577));
+    QVERIFY(!dm.tileColumnExistsAt(-576));
+
+    QRegion expectedRegion;
+    expectedRegion += QRect(-640, -640, 64, 64);
+    expectedRegion += QRect(64000, 32000, 64, 64);
+    expectedRegion += QRect(0, 128, 192, 64);
+    QCOMPARE(dm.region(), expectedRegion);
+
+    KisTiledExtentManager extentManager;
+    extentManager.notifyTileAdded(-10, -10);
+    extentManager.notifyTileAdded(1000, 500);
+    extentManager.notifyTileAdded(0, 2);
+    extentManager.notifyTileAdded(1, 2);
+    extentManager.notifyTileAdded(2, 2);
+    extentManager.notifyTileRemoved(1, 2);
+
+    QVector<QPoint> tiles = extentManager.tilesInRect(QRect(-100, -100, 200, 200));
+    std::sort(tiles.begin(), tiles.end(),
+              [] (const QPoint &lhs, const QPoint &rhs) { return lhs.x() < rhs.x(); });
+    QCOMPARE(tiles, QVector<QPoint>() << QPoint(-10, -10) << QPoint(0, 2) << QPoint(2, 2));
+    QCOMPARE(extentManager.tiles().size(), 4);
+
+    // removing the tiles should update the index
+    dm.clear(-640, -640, 64, 64, &defaultPixel);
+    dm.clear(64000, 32000, 64, 64, &defaultPixel);
+
+    QVERIFY(!dm.tileExistsAt(-600, -600));
+    QVERIFY(!dm.tileExistsAt(64010, 32010));
+    QCOMPARE(dm.region(), QRegion(QRect(0, 128, 192, 64)));
+    QCOMPARE(dm.extent(), QRect(0, 128, 192, 64));
+
+    // the index is rebuilt on undo
+    KisMementoSP memento1 = dm.getMemento();
+    dm.clear(640, 640, 64, 64, &oddPixel1);
+    dm.commit();
+    QVERIFY(dm.tileExistsAt(640, 640));
+
+    dm.rollback(memento1);
+    QVERIFY(!dm.tileExistsAt(640, 640));
+    QVERIFY(dm.tileExistsAt(0, 128));
+}
+
 void KisTiledDataManagerTest::testPurgeHistory()
 {
     quint8 defaultPixel = 0;
@@ -539,6 +707,87 @@ void KisTiledDataManagerTest::testUndoSetDefaultPixel()
     QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
 }
 
+bool checkDeltaRevision(KisTiledDataManager &dm, int revision)
+{
+    quint8 buffer[TILESIZE];
+    dm.readBytes(buffer, 0, 0, 64, 64);
+
+    for (int y = 0; y < 64; y++) {
+        for (int x = 0; x < 64; x++) {
+            const int strokeIndex = x / 4;
+            const quint8 expectedValue =
+                y < 4 && strokeIndex <= revision ? strokeIndex + 1 : 0;
+
+            if (buffer[y * 64 + x] != expectedValue) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void KisTiledDataManagerTest::testUndoDeltaCompression()
+{
+    KisImageConfig config;
+    config.setEnableUndoDeltaCompression(true);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->testingSuspendPooler();
+    store->testingRereadConfig();
+
+    const int numRevisions = 6;
+    const qint32 numTilesBefore = store->numTiles();
+
+    {
+        quint8 defaultPixel = 0;
+        KisTiledDataManager dm(1, &defaultPixel);
+
+        QVector<KisMementoSP> mementos;
+
+        for (int i = 0; i < numRevisions; i++) {
+            quint8 strokePixel = i + 1;
+
+            mementos << dm.getMemento();
+            dm.clear(QRect(i * 4, 0, 4, 4), &strokePixel);
+            dm.commit();
+        }
+
+        store->m_mementoCompressor.testingWaitForIdle();
+
+        /**
+         * All the revisions, except the current one, should be
+         * compressed: only the default tile data and the current
+         * tile data should be left in memory
+         */
+        QCOMPARE(store->numTiles(), numTilesBefore + 2);
+        QVERIFY(checkDeltaRevision(dm, numRevisions - 1));
+
+        for (int i = numRevisions - 1; i > 0; i--) {
+            dm.rollback(mementos[i]);
+            QVERIFY(checkDeltaRevision(dm, i - 1));
+        }
+
+        for (int i = 1; i < numRevisions; i++) {
+            dm.rollforward(mementos[i]);
+            QVERIFY(checkDeltaRevision(dm, i));
+        }
+
+        store->m_mementoCompressor.testingWaitForIdle();
+        QCOMPARE(store->numTiles(), numTilesBefore + 2);
+
+        dm.purgeHistory(mementos[numRevisions / 2]);
+        QVERIFY(checkDeltaRevision(dm, numRevisions - 1));
+
+        dm.rollback(mementos[numRevisions - 1]);
+        QVERIFY(checkDeltaRevision(dm, numRevisions - 2));
+    }
+
+    store->m_mementoCompressor.testingWaitForIdle();
+    QCOMPARE(store->numTiles(), numTilesBefore);
+
+    store->testingResumePooler();
+}
+
 //#include <valgrind/callgrind.h>
 
 void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
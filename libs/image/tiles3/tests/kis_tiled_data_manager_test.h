@@ -50,8 +50,12 @@ private Q_SLOTS:
     void testBitBltOldData();
     void testBitBltRough();
     void testTransactions();
+    void testFrozenRevisionSnapshot();
+    void testFrozenRevisionSnapshotConcurrentWriter();
+    void testOccupancyIndex();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testUndoDeltaCompression();
 
     void benchmarkReadOnlyTileLazy();
     void benchmarkSharedPointers();
@@ -23,6 +23,9 @@
 #include <QList>
 #include <QMutex>
 #include <QThreadStorage>
+#include <QAtomicInt>
+
+#include <atomic>
 
 #include <KoColorSpace.h>
 
@@ -67,20 +70,93 @@ struct KoColorConversionCache::CachedTransformation {
     }
 
     bool available() {
-        return use == 0;
+        return use.load() == 0;
     }
 
     KoColorConversionTransformation* transfo;
-    int use;
+    QAtomicInt use;
 };
 
 typedef QPair<KoColorConversionCacheKey, KoCachedColorConversionTransformation> FastPathCacheItem;
 
+/**
+ * The transformations recently used by a thread. Holding a handle keeps
+ * the transformation busy, so no other thread can get the same instance
+ * while it stays here.
+ */
+struct KoColorConversionCache::ThreadLocalCache {
+    /**
+     * Most of the threads use just a couple of conversions at a time
+     * (e.g. image -> display and layer -> image), but the size of the
+     * set also limits the number of instances pinned by every thread.
+     */
+    static const int maxItems = 8;
+
+    /**
+     * Hits are not counted in the shared counters immediately to avoid
+     * bouncing a cache line between the threads on every lookup
+     */
+    static const int hitsFlushThreshold = 256;
+
+    ThreadLocalCache(int _generation)
+        : generation(_generation), pendingHits(0)
+    {}
+
+    ~ThreadLocalCache() {
+        qDeleteAll(items);
+    }
+
+    int generation;
+    int pendingHits;
+
+    /// the most recently used item comes first
+    QList<FastPathCacheItem*> items;
+};
+
 struct KoColorConversionCache::Private {
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*> cache;
     QMutex cacheMutex;
 
-    QThreadStorage<FastPathCacheItem*> fastStorage;
+    /**
+     * Transformations whose color space has been destroyed while some
+     * thread still kept them in its local set. They are deleted as soon as
+     * that thread drops them.
+     */
+    QList<CachedTransformation*> orphans;
+
+    /**
+     * Incremented when a color space is destroyed, so that all the threads
+     * drop their local sets on the next lookup.
+     */
+    QAtomicInt generation;
+
+    QThreadStorage<ThreadLocalCache*> threadLocalCache;
+
+    std::atomic<qint64> threadLocalHits {0};
+    std::atomic<qint64> poolHits {0};
+    std::atomic<qint64> misses {0};
+
+    CachedTransformation* takeAvailable(const KoColorConversionCacheKey &key) {
+        QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = cache.find(key);
+        for (; it != cache.end() && it.key() == key; ++it) {
+            if (it.value()->available()) {
+                return it.value();
+            }
+        }
+        return 0;
+    }
+
+    void purgeOrphans() {
+        QList<CachedTransformation*>::iterator it = orphans.begin();
+        while (it != orphans.end()) {
+            if ((*it)->available()) {
+                delete *it;
+                it = orphans.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
 };
 
 
@@ -90,9 +166,12 @@ KoColorConversionCache::KoColorConversionCache() : d(new Private)
 
 KoColorConversionCache::~KoColorConversionCache()
 {
+    d->threadLocalCache.setLocalData(0);
+
     Q_FOREACH (CachedTransformation* transfo, d->cache) {
         delete transfo;
     }
+    qDeleteAll(d->orphans);
     delete d;
 }
 
@@ -103,56 +182,132 @@ KoCachedColorConversionTransformation KoColorConversionCache::cachedConverter(co
 {
     KoColorConversionCacheKey key(src, dst, _renderingIntent, _conversionFlags);
 
-    FastPathCacheItem *cacheItem =
-        d->fastStorage.localData();
+    const int generation = d->generation.load();
+    ThreadLocalCache *localCache = d->threadLocalCache.localData();
 
-    if (cacheItem) {
-        if (cacheItem->first == key) {
-            return cacheItem->second;
-        }
+    if (!localCache || localCache->generation != generation) {
+        localCache = new ThreadLocalCache(generation);
+        d->threadLocalCache.setLocalData(localCache);
     }
 
-    cacheItem = 0;
+    for (int i = 0; i < localCache->items.size(); i++) {
+        FastPathCacheItem *item = localCache->items[i];
 
-    QMutexLocker lock(&d->cacheMutex);
-    QList< CachedTransformation* > cachedTransfos = d->cache.values(key);
-    if (cachedTransfos.size() != 0) {
-        Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
-            if (ct->available()) {
-                ct->transfo->setSrcColorSpace(src);
-                ct->transfo->setDstColorSpace(dst);
-
-                cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
-                break;
+        if (item->first == key) {
+            if (i > 0) {
+                localCache->items.move(i, 0);
             }
+
+            if (++localCache->pendingHits >= ThreadLocalCache::hitsFlushThreshold) {
+                flushThreadLocalHits(localCache);
+            }
+
+            return item->second;
         }
     }
-    if (!cacheItem) {
+
+    flushThreadLocalHits(localCache);
+
+    CachedTransformation *ct = 0;
+
+    {
+        QMutexLocker lock(&d->cacheMutex);
+        d->purgeOrphans();
+        ct = d->takeAvailable(key);
+
+        if (ct) {
+            /**
+             * Mark the instance as busy before releasing the lock,
+             * otherwise another thread could grab it as well
+             */
+            ct->use.ref();
+            d->poolHits++;
+        }
+    }
+
+    if (ct) {
+        ct->transfo->setSrcColorSpace(src);
+        ct->transfo->setDstColorSpace(dst);
+    } else {
+        /**
+         * Creating a transformation may take a lot of time, so do it
+         * without holding the lock. If another thread creates the same
+         * transformation concurrently, the pool just gets one more instance.
+         */
         KoColorConversionTransformation* transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
-        CachedTransformation* ct = new CachedTransformation(transfo);
+        ct = new CachedTransformation(transfo);
+        ct->use.ref();
+
+        QMutexLocker lock(&d->cacheMutex);
         d->cache.insert(key, ct);
-        cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
+        d->misses++;
+    }
+
+    FastPathCacheItem *cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
+    ct->use.deref();
+
+    localCache->items.prepend(cacheItem);
+    while (localCache->items.size() > ThreadLocalCache::maxItems) {
+        delete localCache->items.takeLast();
     }
 
-    d->fastStorage.setLocalData(cacheItem);
     return cacheItem->second;
 }
 
 void KoColorConversionCache::colorSpaceIsDestroyed(const KoColorSpace* cs)
 {
-    d->fastStorage.setLocalData(0);
+    d->generation.ref();
+    d->threadLocalCache.setLocalData(0);
 
     QMutexLocker lock(&d->cacheMutex);
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator endIt = d->cache.end();
     for (QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = d->cache.begin(); it != endIt;) {
         if (it.key().src == cs || it.key().dst == cs) {
-            Q_ASSERT(it.value()->available()); // That's terribely evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
-            delete it.value();
+            /**
+             * The transformation may still sit in the local set of some
+             * other thread, which will drop it on its next lookup. Nobody
+             * is supposed to actually *use* it anymore though.
+             */
+            if (it.value()->available()) {
+                delete it.value();
+            } else {
+                d->orphans.append(it.value());
+            }
             it = d->cache.erase(it);
         } else {
             ++it;
         }
     }
+
+    d->purgeOrphans();
+}
+
+void KoColorConversionCache::flushThreadLocalHits(ThreadLocalCache *localCache)
+{
+    if (localCache->pendingHits) {
+        d->threadLocalHits += localCache->pendingHits;
+        localCache->pendingHits = 0;
+    }
+}
+
+KoColorConversionCache::Statistics KoColorConversionCache::statistics() const
+{
+    Statistics stats;
+    stats.threadLocalHits = d->threadLocalHits;
+    stats.poolHits = d->poolHits;
+    stats.misses = d->misses;
+
+    QMutexLocker lock(&d->cacheMutex);
+    stats.instances = d->cache.size() + d->orphans.size();
+
+    return stats;
+}
+
+void KoColorConversionCache::resetStatistics()
+{
+    d->threadLocalHits = 0;
+    d->poolHits = 0;
+    d->misses = 0;
 }
 
 //--------- KoCachedColorConversionTransformation ----------//
@@ -165,21 +320,20 @@ struct KoCachedColorConversionTransformation::Private {
 
 KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(KoColorConversionCache* cache, KoColorConversionCache::CachedTransformation* transfo) : d(new Private)
 {
-    Q_ASSERT(transfo->available());
     d->cache = cache;
     d->transfo = transfo;
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(const KoCachedColorConversionTransformation& rhs) : d(new Private(*rhs.d))
 {
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::~KoCachedColorConversionTransformation()
 {
-    d->transfo->use--;
-    Q_ASSERT(d->transfo->use >= 0);
+    d->transfo->use.deref();
+    Q_ASSERT(d->transfo->use.load() >= 0);
     delete d;
 }
 
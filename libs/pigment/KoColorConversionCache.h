@@ -24,16 +24,42 @@ class KoCachedColorConversionTransformation;
 class KoColorSpace;
 
 #include "KoColorConversionTransformation.h"
+#include "kritapigment_export.h"
 
 /**
  * This class holds a cache of KoColorConversionTransformations.
  *
+ * Every thread keeps a small set of the transformations it used most
+ * recently, so that a lookup that hits it takes no locks at all. Only
+ * when a thread needs a transformation it doesn't have, it goes to the
+ * shared pool, which is guarded by a mutex and holds all the instances
+ * created so far. A transformation instance is used by one thread at a
+ * time, so there may be several instances for the same key.
+ *
  * This class is not part of public API, and can be changed without notice.
  */
-class KoColorConversionCache
+class KRITAPIGMENT_EXPORT KoColorConversionCache
 {
 public:
     struct CachedTransformation;
+
+    /**
+     * Lookup counters, useful for profiling. Thread-local hits are
+     * accounted in batches, so the numbers may lag behind a bit.
+     */
+    struct Statistics {
+        Statistics() : threadLocalHits(0), poolHits(0), misses(0), instances(0) {}
+
+        /// lookups served by the calling thread's own set without locking
+        qint64 threadLocalHits;
+        /// lookups that reused an idle instance from the shared pool
+        qint64 poolHits;
+        /// lookups that had to create a new transformation
+        qint64 misses;
+        /// number of transformation instances currently owned by the cache
+        qint64 instances;
+    };
+
 public:
     KoColorConversionCache();
     ~KoColorConversionCache();
@@ -56,6 +82,20 @@ public:
      * @param src source color space
      */
     void colorSpaceIsDestroyed(const KoColorSpace* src);
+
+    /**
+     * @return the lookup counters accumulated since the creation of the
+     * cache or the last call to resetStatistics()
+     */
+    Statistics statistics() const;
+
+    void resetStatistics();
+
+private:
+    struct ThreadLocalCache;
+
+    void flushThreadLocalHits(ThreadLocalCache *localCache);
+
 private:
     struct Private;
     Private* const d;
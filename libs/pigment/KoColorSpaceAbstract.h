@@ -31,6 +31,7 @@
 #include "KoFallBackColorTransformation.h"
 #include "KoLabDarkenColorTransformation.h"
 #include "KoMixColorsOpImpl.h"
+#include "compositeops/KoOptimizedMixColorsOpFactory.h"
 
 #include "KoConvolutionOpImpl.h"
 #include "KoInvertColorTransformation.h"
@@ -51,7 +52,7 @@ class KoColorSpaceAbstract : public KoColorSpace
 {
 public:
     KoColorSpaceAbstract(const QString &id, const QString &name) :
-        KoColorSpace(id, name, new KoMixColorsOpImpl< _CSTrait>(), new KoConvolutionOpImpl< _CSTrait>()) {
+        KoColorSpace(id, name, OptimizedMixColorsOpSelector<_CSTrait>::createMixColorsOp(), new KoConvolutionOpImpl< _CSTrait>()) {
     }
 
     quint32 colorChannelCount() const override {
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KO_PER_CHANNEL_LUT_TRANSFORMATION_H
+#define KO_PER_CHANNEL_LUT_TRANSFORMATION_H
+
+#include <QVector>
+
+#include "KoColorTransformation.h"
+#include "KoTransferLut.h"
+
+/**
+ * Applies an independent transfer curve to every channel of a
+ * pixel using look-up tables. Unlike a linearization device link
+ * of lcms it needs no conversion of the pixels, so it should be
+ * used whenever the curves apply to the encoded channel values
+ * directly.
+ */
+template<class _CSTraits>
+class KoPerChannelLutTransformation : public KoColorTransformation
+{
+    typedef typename _CSTraits::channels_type channels_type;
+
+public:
+    /**
+     * @param transfers the tabulated curves of \p transferSize nodes
+     *        for every channel of the pixel, in the order of the
+     *        channels in memory. The channels with null curves are
+     *        left unchanged.
+     */
+    KoPerChannelLutTransformation(const QVector<const quint16*> &transfers, int transferSize)
+        : m_luts(_CSTraits::channels_nb, 0)
+    {
+        Q_ASSERT(transfers.size() == int(_CSTraits::channels_nb));
+
+        for (int i = 0; i < transfers.size(); i++) {
+            if (transfers[i]) {
+                m_luts[i] = new KoTransferLut<channels_type>(KoTransferCurve(transfers[i], transferSize));
+            }
+        }
+    }
+
+    ~KoPerChannelLutTransformation() override {
+        qDeleteAll(m_luts);
+    }
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override {
+        if (src != dst) {
+            memcpy(dst, src, nPixels * _CSTraits::pixelSize);
+        }
+
+        const channels_type *srcPixels = _CSTraits::nativeArray(src);
+        channels_type *dstPixels = _CSTraits::nativeArray(dst);
+
+        for (int i = 0; i < m_luts.size(); i++) {
+            if (!m_luts[i]) continue;
+
+            m_luts[i]->map(srcPixels + i, dstPixels + i, nPixels, _CSTraits::channels_nb);
+        }
+    }
+
+private:
+    QVector<KoTransferLut<channels_type>*> m_luts;
+};
+
+#endif /* KO_PER_CHANNEL_LUT_TRANSFORMATION_H */
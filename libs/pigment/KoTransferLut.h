@@ -0,0 +1,247 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KO_TRANSFER_LUT_H
+#define KO_TRANSFER_LUT_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#include <cstring>
+
+#include "KoColorSpaceMaths.h"
+
+/**
+ * A tabulated transfer curve, the same kind of curve as the ones
+ * produced by KisCubicCurve::uint16Transfer() and
+ * KisCubicCurve::floatTransfer(). The nodes are spread evenly over
+ * [0, 1], the values between them are interpolated linearly, like
+ * lcms does for its tabulated tone curves.
+ */
+class KoTransferCurve
+{
+public:
+    /**
+     * Creates a curve from \p size 16-bit nodes
+     */
+    KoTransferCurve(const quint16 *values, int size)
+        : m_nodes(size)
+    {
+        for (int i = 0; i < size; i++) {
+            m_nodes[i] = values[i] / 65535.0;
+        }
+    }
+
+    /**
+     * Creates a curve from normalized nodes
+     */
+    KoTransferCurve(const QVector<qreal> &values)
+        : m_nodes(values)
+    {
+    }
+
+    /**
+     * @return the value of the curve at the normalized position \p x
+     */
+    inline qreal value(qreal x) const {
+        const int size = m_nodes.size();
+        if (size < 2) {
+            return size ? m_nodes.first() : x;
+        }
+
+        const qreal pos = qBound(0.0, x, 1.0) * (size - 1);
+        const int index = qMin(int(pos), size - 2);
+        const qreal t = pos - index;
+
+        return m_nodes[index] + t * (m_nodes[index + 1] - m_nodes[index]);
+    }
+
+private:
+    QVector<qreal> m_nodes;
+};
+
+/**
+ * A cache-line aligned table of a look-up table
+ */
+template<typename T>
+class KoTransferLutTable
+{
+public:
+    KoTransferLutTable(int size)
+        : m_data(static_cast<T*>(qMallocAligned(size * sizeof(T), 64))),
+          m_size(size)
+    {
+    }
+
+    ~KoTransferLutTable() {
+        qFreeAligned(m_data);
+    }
+
+    inline T* data() {
+        return m_data;
+    }
+
+    inline const T* data() const {
+        return m_data;
+    }
+
+    inline int size() const {
+        return m_size;
+    }
+
+private:
+    Q_DISABLE_COPY(KoTransferLutTable)
+
+    T *m_data;
+    int m_size;
+};
+
+/**
+ * The base class of the exact look-up tables of the integer channel
+ * types: every possible value of the channel has its own entry.
+ */
+template<typename channels_type>
+class KoExactTransferLut
+{
+public:
+    inline channels_type operator()(channels_type value) const {
+        return m_table.data()[value];
+    }
+
+    /**
+     * Maps \p count values of \p src, placed every \p stride elements,
+     * into \p dst. Used to apply the table to one channel of an
+     * array of pixels. \p src and \p dst may be the same.
+     */
+    inline void map(const channels_type *src, channels_type *dst, int count, int stride) const {
+        const channels_type *table = m_table.data();
+
+        /**
+         * The table is small enough to stay in L1/L2 cache, so
+         * independent scalar loads are faster than the hardware
+         * gathers, which work on 32-bit lanes only. Unrolling lets
+         * the CPU issue several lookups at once.
+         */
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const channels_type v0 = table[src[0]];
+            const channels_type v1 = table[src[stride]];
+            const channels_type v2 = table[src[2 * stride]];
+            const channels_type v3 = table[src[3 * stride]];
+
+            dst[0] = v0;
+            dst[stride] = v1;
+            dst[2 * stride] = v2;
+            dst[3 * stride] = v3;
+
+            src += 4 * stride;
+            dst += 4 * stride;
+        }
+
+        for (; i < count; i++) {
+            *dst = table[*src];
+            src += stride;
+            dst += stride;
+        }
+    }
+
+protected:
+    KoExactTransferLut()
+        : m_table(int(KoColorSpaceMathsTraits<channels_type>::max) + 1)
+    {
+    }
+
+    KoTransferLutTable<channels_type> m_table;
+};
+
+/**
+ * A look-up table of a transfer curve for the channels of type
+ * \p channels_type. The integer channels get an exact table with
+ * an entry for every value, the floating point ones get a table of
+ * interpolated samples.
+ */
+template<typename channels_type>
+class KoTransferLut
+{
+public:
+    static const int defaultSize = 4096;
+
+    KoTransferLut(const KoTransferCurve &curve, int size = defaultSize)
+        : m_table(size + 1),
+          m_scale(size)
+    {
+        float *table = m_table.data();
+        for (int i = 0; i <= size; i++) {
+            table[i] = curve.value(qreal(i) / size);
+        }
+    }
+
+    inline channels_type operator()(channels_type value) const {
+        const float x = float(value) / float(KoColorSpaceMathsTraits<channels_type>::unitValue);
+        const float pos = qBound(0.0f, x, 1.0f) * m_scale;
+        const int index = qMin(int(pos), m_table.size() - 2);
+        const float t = pos - index;
+
+        const float *table = m_table.data();
+        const float result = table[index] + t * (table[index + 1] - table[index]);
+        return channels_type(result * float(KoColorSpaceMathsTraits<channels_type>::unitValue));
+    }
+
+    /**
+     * Maps \p count values of \p src, placed every \p stride elements,
+     * into \p dst. \p src and \p dst may be the same.
+     */
+    inline void map(const channels_type *src, channels_type *dst, int count, int stride) const {
+        for (int i = 0; i < count; i++) {
+            *dst = (*this)(*src);
+            src += stride;
+            dst += stride;
+        }
+    }
+
+private:
+    KoTransferLutTable<float> m_table;
+    float m_scale;
+};
+
+template<>
+class KoTransferLut<quint8> : public KoExactTransferLut<quint8>
+{
+public:
+    KoTransferLut(const KoTransferCurve &curve) {
+        quint8 *table = m_table.data();
+        for (int i = 0; i < m_table.size(); i++) {
+            table[i] = KoColorSpaceMaths<qreal, quint8>::scaleToA(curve.value(i / 255.0));
+        }
+    }
+};
+
+template<>
+class KoTransferLut<quint16> : public KoExactTransferLut<quint16>
+{
+public:
+    KoTransferLut(const KoTransferCurve &curve) {
+        quint16 *table = m_table.data();
+        for (int i = 0; i < m_table.size(); i++) {
+            table[i] = KoColorSpaceMaths<qreal, quint16>::scaleToA(curve.value(i / 65535.0));
+        }
+    }
+};
+
+#endif /* KO_TRANSFER_LUT_H */
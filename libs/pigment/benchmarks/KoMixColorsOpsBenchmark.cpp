@@ -0,0 +1,168 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoMixColorsOpsBenchmark.h"
+
+#include <QTest>
+#include <QVector>
+#include <QScopedPointer>
+
+#include <KoColorSpaceTraits.h>
+#include <KoMixColorsOpImpl.h>
+#include "compositeops/KoOptimizedMixColorsOpFactory.h"
+
+/**
+ * The size of the area mixed by the color smudge brush with a
+ * radius of about 250 pixels
+ */
+#define NB_PIXELS (500 * 500)
+
+enum MixColorsOpType {
+    Scalar8,
+    Optimized8,
+    Scalar16,
+    Optimized16,
+    Scalar32f,
+    Optimized32f
+};
+
+Q_DECLARE_METATYPE(MixColorsOpType)
+
+static KoMixColorsOp* createMixColorsOp(MixColorsOpType type, int *pixelSize)
+{
+    KoMixColorsOp *op = 0;
+
+    switch (type) {
+    case Scalar8:
+        op = new KoMixColorsOpImpl<KoBgrU8Traits>();
+        *pixelSize = KoBgrU8Traits::pixelSize;
+        break;
+    case Optimized8:
+        op = KoOptimizedMixColorsOpFactory::createMixColorsOp32();
+        *pixelSize = KoBgrU8Traits::pixelSize;
+        break;
+    case Scalar16:
+        op = new KoMixColorsOpImpl<KoBgrU16Traits>();
+        *pixelSize = KoBgrU16Traits::pixelSize;
+        break;
+    case Optimized16:
+        op = KoOptimizedMixColorsOpFactory::createMixColorsOpU64();
+        *pixelSize = KoBgrU16Traits::pixelSize;
+        break;
+    case Scalar32f:
+        op = new KoMixColorsOpImpl<KoRgbF32Traits>();
+        *pixelSize = KoRgbF32Traits::pixelSize;
+        break;
+    case Optimized32f:
+        op = KoOptimizedMixColorsOpFactory::createMixColorsOp128();
+        *pixelSize = KoRgbF32Traits::pixelSize;
+        break;
+    }
+
+    return op;
+}
+
+static void createRows()
+{
+    QTest::addColumn<MixColorsOpType>("type");
+
+    QTest::newRow("scalar-8") << Scalar8;
+    QTest::newRow("optimized-8") << Optimized8;
+    QTest::newRow("scalar-16") << Scalar16;
+    QTest::newRow("optimized-16") << Optimized16;
+    QTest::newRow("scalar-32f") << Scalar32f;
+    QTest::newRow("optimized-32f") << Optimized32f;
+}
+
+static void fillRandomBytes(QVector<quint8> &data)
+{
+    qsrand(1);
+
+    for (int i = 0; i < data.size(); i++) {
+        data[i] = qrand() & 0xff;
+    }
+}
+
+static void fixFloatPixels(QVector<quint8> &data, MixColorsOpType type)
+{
+    if (type != Scalar32f && type != Optimized32f) return;
+
+    float *ptr = reinterpret_cast<float*>(data.data());
+    const int numValues = data.size() / sizeof(float);
+
+    for (int i = 0; i < numValues; i++) {
+        ptr[i] = qreal(qrand()) / RAND_MAX;
+    }
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColors_data()
+{
+    createRows();
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColors()
+{
+    QFETCH(MixColorsOpType, type);
+
+    int pixelSize = 0;
+    QScopedPointer<KoMixColorsOp> op(createMixColorsOp(type, &pixelSize));
+
+    QVector<quint8> data(NB_PIXELS * pixelSize);
+    fillRandomBytes(data);
+    fixFloatPixels(data, type);
+
+    QVector<quint8> result(pixelSize);
+
+    QBENCHMARK {
+        op->mixColors(data.constData(), NB_PIXELS, result.data());
+    }
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColorsWeighted_data()
+{
+    createRows();
+}
+
+void KoMixColorsOpsBenchmark::benchmarkMixColorsWeighted()
+{
+    QFETCH(MixColorsOpType, type);
+
+    int pixelSize = 0;
+    QScopedPointer<KoMixColorsOp> op(createMixColorsOp(type, &pixelSize));
+
+    QVector<quint8> data(NB_PIXELS * pixelSize);
+    fillRandomBytes(data);
+    fixFloatPixels(data, type);
+
+    QVector<const quint8*> pixelPtrs(NB_PIXELS);
+    QVector<qint16> weights(NB_PIXELS);
+
+    for (int i = 0; i < NB_PIXELS; i++) {
+        pixelPtrs[i] = data.constData() + i * pixelSize;
+        weights[i] = i % 2;
+    }
+
+    QVector<quint8> result(pixelSize);
+
+    QBENCHMARK {
+        op->mixColors(pixelPtrs.constData(), weights.constData(), NB_PIXELS, result.data());
+    }
+}
+
+QTEST_GUILESS_MAIN(KoMixColorsOpsBenchmark)
@@ -58,6 +58,16 @@ struct OptimizedOpsSelector
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return new KoCompositeOpOver<Traits>(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<Traits>(cs);
+    }
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category) {
+        Q_UNUSED(cs);
+        Q_UNUSED(id);
+        Q_UNUSED(description);
+        Q_UNUSED(category);
+        return 0;
+    }
 };
 
 template<>
@@ -69,6 +79,12 @@ struct OptimizedOpsSelector<KoBgrU8Traits>
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp32(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<KoBgrU8Traits>(cs);
+    }
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category) {
+        return KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, id, description, category);
+    }
 };
 
 template<>
@@ -80,6 +96,12 @@ struct OptimizedOpsSelector<KoLabU8Traits>
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp32(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<KoLabU8Traits>(cs);
+    }
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category) {
+        return KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, id, description, category);
+    }
 };
 
 template<>
@@ -91,8 +113,83 @@ struct OptimizedOpsSelector<KoRgbF32Traits>
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp128(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<KoRgbF32Traits>(cs);
+    }
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category) {
+        Q_UNUSED(cs);
+        Q_UNUSED(id);
+        Q_UNUSED(description);
+        Q_UNUSED(category);
+        return 0;
+    }
 };
 
+template<>
+struct OptimizedOpsSelector<KoBgrU16Traits>
+{
+    static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createAlphaDarkenOpU64(cs);
+    }
+    static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverOpU64(cs);
+    }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createCopyOpU64(cs);
+    }
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category) {
+        Q_UNUSED(cs);
+        Q_UNUSED(id);
+        Q_UNUSED(description);
+        Q_UNUSED(category);
+        return 0;
+    }
+};
+
+template<>
+struct OptimizedOpsSelector<KoLabU16Traits>
+{
+    static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createAlphaDarkenOpU64(cs);
+    }
+    static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverOpU64(cs);
+    }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createCopyOpU64(cs);
+    }
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category) {
+        Q_UNUSED(cs);
+        Q_UNUSED(id);
+        Q_UNUSED(description);
+        Q_UNUSED(category);
+        return 0;
+    }
+};
+
+#ifdef HAVE_OPENEXR
+template<>
+struct OptimizedOpsSelector<KoRgbF16Traits>
+{
+    static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createAlphaDarkenOpF64(cs);
+    }
+    static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverOpF64(cs);
+    }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createCopyOpF64(cs);
+    }
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category) {
+        Q_UNUSED(cs);
+        Q_UNUSED(id);
+        Q_UNUSED(description);
+        Q_UNUSED(category);
+        return 0;
+    }
+};
+#endif
+
 template<class Traits>
 struct AddGeneralOps<Traits, true>
 {
@@ -102,13 +199,19 @@ struct AddGeneralOps<Traits, true>
 
      template<CompositeFunc func>
      static void add(KoColorSpace* cs, const QString& id, const QString& description, const QString& category) {
-         cs->addCompositeOp(new KoCompositeOpGenericSC<Traits, func>(cs, id, description, category));
+         KoCompositeOp *op = OptimizedOpsSelector<Traits>::createGenericSCOp(cs, id, description, category);
+
+         if (!op) {
+             op = new KoCompositeOpGenericSC<Traits, func>(cs, id, description, category);
+         }
+
+         cs->addCompositeOp(op);
      }
 
      static void add(KoColorSpace* cs) {
          cs->addCompositeOp(OptimizedOpsSelector<Traits>::createOverOp(cs));
          cs->addCompositeOp(OptimizedOpsSelector<Traits>::createAlphaDarkenOp(cs));
-         cs->addCompositeOp(new KoCompositeOpCopy2<Traits>(cs));
+         cs->addCompositeOp(OptimizedOpsSelector<Traits>::createCopyOp(cs));
          cs->addCompositeOp(new KoCompositeOpErase<Traits>(cs));
          cs->addCompositeOp(new KoCompositeOpBehind<Traits>(cs));
          cs->addCompositeOp(new KoCompositeOpDestinationIn<Traits>(cs));
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPALPHADARKEN64_H_
+#define KOOPTIMIZEDCOMPOSITEOPALPHADARKEN64_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+#include "KoOptimizedCompositeOpAlphaDarken128.h"
+#include "KoOptimizedCompositor64.h"
+
+/**
+ * An optimized version of a composite op for the use in 8 byte
+ * colorspaces with alpha channel placed at the last channel of
+ * the pixel: C1_C2_C3_A. The channels are either quint16 or half.
+ */
+template<Vc::Implementation _impl, typename channels_type>
+class KoOptimizedCompositeOpAlphaDarken64 : public KoCompositeOp
+{
+    typedef Compositor64<channels_type, AlphaDarkenCompositor128<float, KoFloatPixel128> > Compositor;
+
+public:
+    KoOptimizedCompositeOpAlphaDarken64(const KoColorSpace* cs)
+        : KoCompositeOp(cs, COMPOSITE_ALPHA_DARKEN, i18n("Alpha darken"), KoCompositeOp::categoryMix()) {}
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        if(params.maskRowStart) {
+            KoStreamedMath<_impl>::template genericComposite64<true, true, Compositor>(params);
+        } else {
+            KoStreamedMath<_impl>::template genericComposite64<false, true, Compositor>(params);
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPALPHADARKEN64_H_
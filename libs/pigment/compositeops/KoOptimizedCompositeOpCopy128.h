@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPCOPY128_H_
+#define KOOPTIMIZEDCOMPOSITEOPCOPY128_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+
+/**
+ * A vectorized version of KoCompositeOpCopy2 for 16 byte pixels
+ * consisting of four floating point channels: C1_C2_C3_A.
+ */
+template<typename channels_type, bool alphaLocked, bool allChannelsFlag>
+struct CopyCompositor128 {
+    struct OptionalParams {
+        OptionalParams(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags)
+        {
+        }
+        const QBitArray &channelFlags;
+    };
+
+    struct Pixel {
+        channels_type red;
+        channels_type green;
+        channels_type blue;
+        channels_type alpha;
+    };
+
+    // \see docs in AlphaDarkenCompositor32
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(oparams);
+
+        const Pixel *sp = reinterpret_cast<const Pixel*>(src);
+        Pixel *dp = reinterpret_cast<Pixel*>(dst);
+
+        Vc::float_v opacity_vec(opacity);
+
+        if (haveMask) {
+            const Vc::float_v uint8MaxRec1((float)1.0 / 255);
+            Vc::float_v mask_vec = KoStreamedMath<_impl>::fetch_mask_8(mask);
+            opacity_vec *= mask_vec * uint8MaxRec1;
+        }
+
+        const Vc::float_v zeroValue(KoColorSpaceMathsTraits<channels_type>::zeroValue);
+        const Vc::float_v oneValue(KoColorSpaceMathsTraits<channels_type>::unitValue);
+
+        // zero opacity keeps both, colors and alpha of the destination
+        if ((opacity_vec == zeroValue).isFull()) {
+            return;
+        }
+
+        Vc::float_v src_c1;
+        Vc::float_v src_c2;
+        Vc::float_v src_c3;
+        Vc::float_v src_alpha;
+
+        const Vc::float_v::IndexType indexes(Vc::IndexesFromZero);
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> data(const_cast<Pixel*>(sp));
+        tie(src_c1, src_c2, src_c3, src_alpha) = data[indexes];
+
+        Vc::float_v dst_c1;
+        Vc::float_v dst_c2;
+        Vc::float_v dst_c3;
+        Vc::float_v dst_alpha;
+
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> dataDest(dp);
+        tie(dst_c1, dst_c2, dst_c3, dst_alpha) = dataDest[indexes];
+
+        Vc::float_v new_alpha = (src_alpha - dst_alpha) * opacity_vec + dst_alpha;
+
+        // undefined destination colors are not blended, they are just replaced
+        const Vc::float_m copy_mask = (dst_alpha == zeroValue) || (opacity_vec == oneValue);
+
+        if (copy_mask.isFull()) {
+            dst_c1 = src_c1;
+            dst_c2 = src_c2;
+            dst_c3 = src_c3;
+        } else {
+            /**
+             * The value of new_alpha can have *some* zero values,
+             * which will result in NaN values while division. These
+             * pixels keep their colors.
+             */
+            const Vc::float_m keep_mask = new_alpha == zeroValue;
+
+            const Vc::float_v src_mult = src_alpha * opacity_vec;
+            const Vc::float_v dst_mult = dst_alpha * (oneValue - opacity_vec);
+
+            Vc::float_v new_c1 = (src_c1 * src_mult + dst_c1 * dst_mult) / new_alpha;
+            Vc::float_v new_c2 = (src_c2 * src_mult + dst_c2 * dst_mult) / new_alpha;
+            Vc::float_v new_c3 = (src_c3 * src_mult + dst_c3 * dst_mult) / new_alpha;
+
+            new_c1(keep_mask) = dst_c1;
+            new_c2(keep_mask) = dst_c2;
+            new_c3(keep_mask) = dst_c3;
+
+            dst_c1 = Vc::iif(copy_mask, src_c1, new_c1);
+            dst_c2 = Vc::iif(copy_mask, src_c2, new_c2);
+            dst_c3 = Vc::iif(copy_mask, src_c3, new_c3);
+        }
+
+        if (alphaLocked) {
+            new_alpha = dst_alpha;
+        }
+
+        dataDest[indexes] = tie(dst_c1, dst_c2, dst_c3, new_alpha);
+    }
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        using namespace Arithmetic;
+        const qint32 alpha_pos = 3;
+
+        const channels_type *s = reinterpret_cast<const channels_type*>(src);
+        channels_type *d = reinterpret_cast<channels_type*>(dst);
+
+        if (haveMask) {
+            const float uint8Rec1 = 1.0 / 255;
+            opacity *= float(*mask) * uint8Rec1;
+        }
+
+        const float srcAlpha = s[alpha_pos];
+        const float dstAlpha = d[alpha_pos];
+
+        if (!allChannelsFlag && dstAlpha == zeroValue<channels_type>()) {
+            KoStreamedMathFunctions::clearPixel<16>(dst);
+        }
+
+        float newAlpha = dstAlpha;
+
+        if (dstAlpha == zeroValue<channels_type>() ||
+            opacity == unitValue<channels_type>()) {
+
+            newAlpha = lerp(dstAlpha, srcAlpha, opacity);
+
+            for (int i = 0; i < alpha_pos; i++) {
+                if (allChannelsFlag || oparams.channelFlags.at(i)) {
+                    d[i] = s[i];
+                }
+            }
+        } else if (opacity != zeroValue<channels_type>()) {
+            newAlpha = lerp(dstAlpha, srcAlpha, opacity);
+
+            if (newAlpha != zeroValue<channels_type>()) {
+                const float srcMult = srcAlpha * opacity;
+                const float dstMult = dstAlpha * (1.0f - opacity);
+
+                for (int i = 0; i < alpha_pos; i++) {
+                    if (allChannelsFlag || oparams.channelFlags.at(i)) {
+                        d[i] = (s[i] * srcMult + d[i] * dstMult) / newAlpha;
+                    }
+                }
+            }
+        }
+
+        if (!alphaLocked) {
+            d[alpha_pos] = newAlpha;
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPCOPY128_H_
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPCOPY64_H_
+#define KOOPTIMIZEDCOMPOSITEOPCOPY64_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+#include "KoOptimizedCompositeOpCopy128.h"
+#include "KoOptimizedCompositor64.h"
+
+/**
+ * An optimized version of KoCompositeOpCopy2 for the use in 8 byte
+ * colorspaces with alpha channel placed at the last channel of
+ * the pixel: C1_C2_C3_A. The channels are either quint16 or half.
+ */
+template<Vc::Implementation _impl, typename channels_type>
+class KoOptimizedCompositeOpCopy64 : public KoCompositeOp
+{
+    template<bool alphaLocked, bool allChannelsFlag>
+    struct Compositor {
+        typedef Compositor64<channels_type, CopyCompositor128<float, alphaLocked, allChannelsFlag> > type;
+    };
+
+public:
+    KoOptimizedCompositeOpCopy64(const KoColorSpace* cs)
+        : KoCompositeOp(cs, COMPOSITE_COPY, i18n("Copy"), KoCompositeOp::categoryMisc()) {}
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        if(params.maskRowStart) {
+            composite<true>(params);
+        } else {
+            composite<false>(params);
+        }
+    }
+
+    template <bool haveMask>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite64<haveMask, false, typename Compositor<false, true>::type>(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite64<haveMask, false, typename Compositor<true, true>::type>(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite64_novector<haveMask, false, typename Compositor<false, false>::type>(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite64_novector<haveMask, false, typename Compositor<true, false>::type>(params);
+            }
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPCOPY64_H_
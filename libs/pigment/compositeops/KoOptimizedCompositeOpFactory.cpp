@@ -20,6 +20,10 @@
 #include "KoOptimizedCompositeOpFactoryPerArch.h" // vc.h must come first
 #include "KoOptimizedCompositeOpFactory.h"
 
+#ifdef HAVE_OPENEXR
+#include <half.h>
+#endif
+
 #if defined(__clang__)
 #pragma GCC diagnostic ignored "-Wundef"
 #endif
@@ -44,3 +48,43 @@ KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOp128(const KoColorSpace
 {
     return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128> >(cs);
 }
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createAlphaDarkenOpU64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpAlphaDarken64, quint16> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOpU64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpOver64, quint16> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createCopyOpU64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpCopy64, quint16> >(cs);
+}
+
+#ifdef HAVE_OPENEXR
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createAlphaDarkenOpF64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpAlphaDarken64, half> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOpF64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpOver64, half> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createCopyOpF64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpCopy64, half> >(cs);
+}
+
+#endif /* HAVE_OPENEXR */
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericSCOp32(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category)
+{
+    return createOptimizedClass<KoOptimizedGenericSCCompositeOpFactoryPerArch>(
+        KoOptimizedGenericSCCompositeOpFactoryPerArch::Params(cs, id, description, category));
+}
@@ -21,9 +21,11 @@
 #define KOOPTIMIZEDCOMPOSITEOPFACTORY_H
 
 #include "kritapigment_export.h"
+#include <KoConfig.h>
 
 class KoCompositeOp;
 class KoColorSpace;
+class QString;
 
 /**
  * The creation of the optimized composite ops is moved into a separate
@@ -44,6 +46,23 @@ public:
     static KoCompositeOp* createOverOp32(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOp128(const KoColorSpace *cs);
     static KoCompositeOp* createOverOp128(const KoColorSpace *cs);
+
+    static KoCompositeOp* createAlphaDarkenOpU64(const KoColorSpace *cs);
+    static KoCompositeOp* createOverOpU64(const KoColorSpace *cs);
+    static KoCompositeOp* createCopyOpU64(const KoColorSpace *cs);
+
+#ifdef HAVE_OPENEXR
+    static KoCompositeOp* createAlphaDarkenOpF64(const KoColorSpace *cs);
+    static KoCompositeOp* createOverOpF64(const KoColorSpace *cs);
+    static KoCompositeOp* createCopyOpF64(const KoColorSpace *cs);
+#endif
+
+    /**
+     * Returns an optimized version of a separable composite op with
+     * id \p id for a 4 byte colorspace, or null if there is no
+     * optimized version for it.
+     */
+    static KoCompositeOp* createGenericSCOp32(const KoColorSpace *cs, const QString &id, const QString &description, const QString &category);
 };
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORY_H */
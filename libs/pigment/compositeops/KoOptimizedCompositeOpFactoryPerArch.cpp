@@ -26,6 +26,10 @@
 #include "KoOptimizedCompositeOpAlphaDarken128.h"
 #include "KoOptimizedCompositeOpOver32.h"
 #include "KoOptimizedCompositeOpOver128.h"
+#include "KoOptimizedCompositeOpGeneric32.h"
+#include "KoOptimizedCompositeOpAlphaDarken64.h"
+#include "KoOptimizedCompositeOpOver64.h"
+#include "KoOptimizedCompositeOpCopy64.h"
 
 #include <QString>
 #include "DebugPigment.h"
@@ -67,3 +71,62 @@ KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128>::create<Vc::
 {
     return new KoOptimizedCompositeOpOver128<Vc::CurrentImplementation::current()>(param);
 }
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpAlphaDarken64, quint16>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpAlphaDarken64, quint16>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpAlphaDarken64<Vc::CurrentImplementation::current(), quint16>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpOver64, quint16>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpOver64, quint16>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpOver64<Vc::CurrentImplementation::current(), quint16>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpCopy64, quint16>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpCopy64, quint16>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpCopy64<Vc::CurrentImplementation::current(), quint16>(param);
+}
+
+#ifdef HAVE_OPENEXR
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpAlphaDarken64, half>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpAlphaDarken64, half>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpAlphaDarken64<Vc::CurrentImplementation::current(), half>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpOver64, half>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpOver64, half>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpOver64<Vc::CurrentImplementation::current(), half>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpCopy64, half>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch64<KoOptimizedCompositeOpCopy64, half>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpCopy64<Vc::CurrentImplementation::current(), half>(param);
+}
+
+#endif /* HAVE_OPENEXR */
+
+template<>
+KoOptimizedGenericSCCompositeOpFactoryPerArch::ReturnType
+KoOptimizedGenericSCCompositeOpFactoryPerArch::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return createOptimizedGenericSCOp32<Vc::CurrentImplementation::current()>(param.cs, param.id, param.description, param.category);
+}
@@ -23,6 +23,8 @@
 
 #include <compositeops/KoVcMultiArchBuildSupport.h>
 
+#include <QString>
+
 
 class KoCompositeOp;
 class KoColorSpace;
@@ -40,6 +42,15 @@ class KoOptimizedCompositeOpAlphaDarken128;
 template<Vc::Implementation _impl>
 class KoOptimizedCompositeOpOver128;
 
+template<Vc::Implementation _impl, typename channels_type>
+class KoOptimizedCompositeOpAlphaDarken64;
+
+template<Vc::Implementation _impl, typename channels_type>
+class KoOptimizedCompositeOpOver64;
+
+template<Vc::Implementation _impl, typename channels_type>
+class KoOptimizedCompositeOpCopy64;
+
 template<template<Vc::Implementation I> class CompositeOp>
 struct KoOptimizedCompositeOpFactoryPerArch
 {
@@ -50,5 +61,46 @@ struct KoOptimizedCompositeOpFactoryPerArch
     static ReturnType create(ParamType param);
 };
 
+/**
+ * The same as KoOptimizedCompositeOpFactoryPerArch, but for the ops
+ * that are shared by several 64-bit colorspaces and, therefore, are
+ * parametrized by the channel type as well.
+ */
+template<template<Vc::Implementation I, typename T> class CompositeOp, typename channels_type>
+struct KoOptimizedCompositeOpFactoryPerArch64
+{
+    typedef const KoColorSpace* ParamType;
+    typedef KoCompositeOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
+
+/**
+ * Creates optimized versions of the separable composite ops
+ * (\see KoCompositeOpGenericSC) for 4 byte colorspaces. Since all
+ * of them share the same constructor, the op is selected by its id.
+ * The factory returns null if the op has no optimized version.
+ */
+struct KoOptimizedGenericSCCompositeOpFactoryPerArch
+{
+    struct Params {
+        Params(const KoColorSpace *_cs, const QString &_id, const QString &_description, const QString &_category)
+            : cs(_cs), id(_id), description(_description), category(_category)
+        {
+        }
+
+        const KoColorSpace *cs;
+        const QString &id;
+        const QString &description;
+        const QString &category;
+    };
+
+    typedef const Params& ParamType;
+    typedef KoCompositeOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORYPERARCH_H */
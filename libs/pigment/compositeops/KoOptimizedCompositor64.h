@@ -0,0 +1,191 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITOR64_H_
+#define KOOPTIMIZEDCOMPOSITOR64_H_
+
+#include <KoConfig.h>
+
+#include "KoCompositeOpBase.h"
+#include "KoStreamedMath.h"
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define KO_HAVE_F16C
+#define KO_F16C_TARGET
+#elif defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+/**
+ * The AVX2 build of the ops is not compiled with -mf16c, but every
+ * CPU that supports AVX2 also supports F16C, so we can safely enable
+ * it for the conversion functions only.
+ */
+#define KO_HAVE_F16C
+#define KO_F16C_TARGET __attribute__((target("f16c")))
+#endif
+
+#ifdef KO_HAVE_F16C
+#include <immintrin.h>
+#endif
+
+
+/**
+ * Converts the pixels of 64-bit colorspaces (4 channels, 16 bit per
+ * channel) into the 128-bit floating point pixels the 128-bit
+ * compositors work with, and back.
+ *
+ * Integer channels are normalized into [0.0, 1.0] range, half-float
+ * channels are kept as they are.
+ *
+ * The converters work on contiguous arrays and the loops are kept
+ * trivial, so that the compiler could vectorize them for the
+ * instruction set of \p _impl.
+ */
+template<typename channels_type, Vc::Implementation _impl>
+struct KoStreamedMath64Converter;
+
+template<Vc::Implementation _impl>
+struct KoStreamedMath64Converter<quint16, _impl>
+{
+    static inline void toFloat(const quint8 *src, float *dst, int numPixels) {
+        const quint16 *s = reinterpret_cast<const quint16*>(src);
+        const float uint16Rec1 = 1.0f / 65535.0f;
+
+        for (int i = 0; i < 4 * numPixels; i++) {
+            dst[i] = s[i] * uint16Rec1;
+        }
+    }
+
+    static inline void fromFloat(const float *src, quint8 *dst, int numPixels) {
+        quint16 *d = reinterpret_cast<quint16*>(dst);
+        const float uint16Max = 65535.0f;
+
+        for (int i = 0; i < 4 * numPixels; i++) {
+            d[i] = quint16(qBound(0.0f, src[i] * uint16Max, uint16Max) + 0.5f);
+        }
+    }
+};
+
+#ifdef HAVE_OPENEXR
+
+template<Vc::Implementation _impl>
+struct KoStreamedMath64Converter<half, _impl>
+{
+#ifdef KO_HAVE_F16C
+
+    static KO_F16C_TARGET void toFloat(const quint8 *src, float *dst, int numPixels) {
+        // one pixel of four halves gets into one SSE register
+        for (int i = 0; i < numPixels; i++) {
+            const __m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 8 * i));
+            _mm_storeu_ps(dst + 4 * i, _mm_cvtph_ps(value));
+        }
+    }
+
+    static KO_F16C_TARGET void fromFloat(const float *src, quint8 *dst, int numPixels) {
+        for (int i = 0; i < numPixels; i++) {
+            const __m128i value = _mm_cvtps_ph(_mm_loadu_ps(src + 4 * i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 8 * i), value);
+        }
+    }
+
+#else /* KO_HAVE_F16C */
+
+    static inline void toFloat(const quint8 *src, float *dst, int numPixels) {
+        const half *s = reinterpret_cast<const half*>(src);
+
+        for (int i = 0; i < 4 * numPixels; i++) {
+            dst[i] = s[i];
+        }
+    }
+
+    static inline void fromFloat(const float *src, quint8 *dst, int numPixels) {
+        half *d = reinterpret_cast<half*>(dst);
+
+        for (int i = 0; i < 4 * numPixels; i++) {
+            d[i] = src[i];
+        }
+    }
+
+#endif /* KO_HAVE_F16C */
+};
+
+#endif /* HAVE_OPENEXR */
+
+
+/**
+ * Adapts a 128-bit compositor (\see OverCompositor128) to 64-bit
+ * pixels. The pixels are widened into an on-stack float buffer,
+ * composited with the vector code of \p Compositor128 and narrowed
+ * back.
+ *
+ * The widening costs much less than the scalar integer math of
+ * KoCompositeOpBase, and lets all the 16-bit colorspaces share a
+ * single well-tested implementation of the composition math.
+ */
+template<typename channels_type, class Compositor128>
+struct Compositor64 {
+    typedef typename Compositor128::OptionalParams OptionalParams;
+
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        typedef KoStreamedMath64Converter<channels_type, _impl> Converter;
+        const int vectorSize = Vc::float_v::size();
+
+        alignas(64) float srcBuf[4 * Vc::float_v::Size];
+        alignas(64) float dstBuf[4 * Vc::float_v::Size];
+
+        Converter::toFloat(src, srcBuf, vectorSize);
+        Converter::toFloat(dst, dstBuf, vectorSize);
+
+        Compositor128::template compositeVector<haveMask, true, _impl>(
+            reinterpret_cast<const quint8*>(srcBuf),
+            reinterpret_cast<quint8*>(dstBuf),
+            mask, opacity, oparams);
+
+        Converter::fromFloat(dstBuf, dst, vectorSize);
+    }
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        typedef KoStreamedMath64Converter<channels_type, _impl> Converter;
+
+        alignas(16) float srcBuf[4];
+        alignas(16) float dstBuf[4];
+
+        Converter::toFloat(src, srcBuf, 1);
+        Converter::toFloat(dst, dstBuf, 1);
+
+        Compositor128::template compositeOnePixelScalar<haveMask, _impl>(
+            reinterpret_cast<const quint8*>(srcBuf),
+            reinterpret_cast<quint8*>(dstBuf),
+            mask, opacity, oparams);
+
+        Converter::fromFloat(dstBuf, dst, 1);
+    }
+};
+
+/**
+ * A pixel type for the compositors that copy the whole 128-bit pixel
+ * with a single assignment (\see AlphaDarkenCompositor128)
+ */
+struct KoFloatPixel128 {
+    float channels[4];
+};
+
+#endif // KOOPTIMIZEDCOMPOSITOR64_H_
@@ -0,0 +1,358 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOP_H_
+#define KOOPTIMIZEDMIXCOLORSOP_H_
+
+#include <cstring>
+
+#include <KoColorSpaceMaths.h>
+#include <KoMixColorsOp.h>
+
+#include "KoStreamedMath.h"
+
+/**
+ * The vector type the sums are accumulated in. The sums of the 8-bit
+ * channels premultiplied by the alpha and the weight fit into the
+ * mantissa of float, so they are exact. The 16-bit ones do not, so
+ * they are accumulated in double to truncate the results exactly the
+ * same way KoMixColorsOpImpl does.
+ */
+template<typename channels_type>
+struct KoMixColorsOpVector
+{
+    typedef Vc::float_v type;
+};
+
+template<>
+struct KoMixColorsOpVector<quint16>
+{
+    typedef Vc::double_v type;
+};
+
+/**
+ * Loads KoMixColorsOpVector::type::size() pixels of 4 channels with
+ * the alpha channel in the last position and splits them into the
+ * vectors of separate channels. The channel values are kept in their
+ * native range.
+ *
+ * \p pixelAt is called for every pixel, so the pixels do not have
+ * to be contiguous in memory.
+ */
+template<typename channels_type, Vc::Implementation _impl>
+struct KoMixColorsOpLoader
+{
+    typedef typename KoMixColorsOpVector<channels_type>::type vector_type;
+    typedef typename vector_type::EntryType entry_type;
+
+    template<class Source>
+    static ALWAYS_INLINE void load(const Source &source, int numPixels,
+                                   vector_type &c1, vector_type &c2, vector_type &c3, vector_type &alpha)
+    {
+        const int vectorSize = vector_type::size();
+        alignas(64) entry_type planes[4 * vector_type::Size];
+
+        int i = 0;
+        for (; i < numPixels; i++) {
+            const channels_type *pixel = reinterpret_cast<const channels_type*>(source.pixelAt(i));
+
+            planes[i] = pixel[0];
+            planes[vectorSize + i] = pixel[1];
+            planes[2 * vectorSize + i] = pixel[2];
+            planes[3 * vectorSize + i] = pixel[3];
+        }
+
+        // the missing pixels are transparent, so they are not counted
+        for (; i < vectorSize; i++) {
+            planes[3 * vectorSize + i] = 0;
+        }
+
+        c1.load(planes, Vc::Aligned);
+        c2.load(planes + vectorSize, Vc::Aligned);
+        c3.load(planes + 2 * vectorSize, Vc::Aligned);
+        alpha.load(planes + 3 * vectorSize, Vc::Aligned);
+    }
+};
+
+/**
+ * 8-bit pixels fit into 32-bit integer lanes, so the channels are
+ * split with the vector shifts of KoStreamedMath.
+ */
+template<Vc::Implementation _impl>
+struct KoMixColorsOpLoader<quint8, _impl>
+{
+    typedef Vc::float_v vector_type;
+
+    template<class Source>
+    static ALWAYS_INLINE void load(const Source &source, int numPixels,
+                                   Vc::float_v &c1, Vc::float_v &c2, Vc::float_v &c3, Vc::float_v &alpha)
+    {
+        const int vectorSize = Vc::float_v::size();
+
+        if (Source::isContiguous && numPixels == vectorSize) {
+            const quint8 *data = source.pixelAt(0);
+            KoStreamedMath<_impl>::template fetch_colors_32<false>(data, c1, c2, c3);
+            alpha = KoStreamedMath<_impl>::template fetch_alpha_32<false>(data);
+            return;
+        }
+
+        alignas(64) quint32 words[Vc::float_v::Size];
+
+        int i = 0;
+        for (; i < numPixels; i++) {
+            memcpy(&words[i], source.pixelAt(i), sizeof(quint32));
+        }
+
+        // the missing pixels are transparent, so they are not counted
+        for (; i < vectorSize; i++) {
+            words[i] = 0;
+        }
+
+        const quint8 *data = reinterpret_cast<const quint8*>(words);
+        KoStreamedMath<_impl>::template fetch_colors_32<true>(data, c1, c2, c3);
+        alpha = KoStreamedMath<_impl>::template fetch_alpha_32<true>(data);
+    }
+};
+
+/**
+ * A vectorized version of KoMixColorsOpImpl for the colorspaces
+ * with 4 channels of type \p channels_type and the alpha channel in
+ * the last position, that is 8-bit and 16-bit integer and 32-bit
+ * floating point RGBA.
+ *
+ * Every lane of the vectors handles its own pixel. The colors are
+ * premultiplied by the alpha and the weight, and the sums are
+ * accumulated in the vectors of KoMixColorsOpVector. To keep the
+ * precision, the vector sums are moved into the double totals every
+ * few iterations.
+ *
+ * The integer results are truncated like in KoMixColorsOpImpl, so
+ * both the ops give exactly the same result for the integer channels.
+ */
+template<Vc::Implementation _impl, typename channels_type>
+class KoOptimizedMixColorsOp : public KoMixColorsOp
+{
+    typedef typename KoMixColorsOpVector<channels_type>::type vector_type;
+    typedef typename vector_type::EntryType entry_type;
+
+    static const int pixelSize = 4 * sizeof(channels_type);
+    static const int alphaPos = 3;
+
+    /**
+     * The number of vector iterations after which the vector sums are
+     * moved into the double totals. For the 8-bit channels it keeps
+     * the float sums below 2^24, so that they stay exact: the weights
+     * sum up to 255, and without the weights every lane gets at most
+     * 16 products of 255 * 255.
+     */
+    static const int flushInterval = 16;
+
+public:
+    void mixColors(const quint8 * const* colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(ArrayOfPointers(colors), WeightsWrapper(weights), nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(PointerToArray(colors), WeightsWrapper(weights), nColors, dst);
+    }
+
+    void mixColors(const quint8 * const* colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(ArrayOfPointers(colors), NoWeightsSurrogate(nColors), nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl(PointerToArray(colors), NoWeightsSurrogate(nColors), nColors, dst);
+    }
+
+private:
+    struct ArrayOfPointers {
+        static const bool isContiguous = false;
+
+        ArrayOfPointers(const quint8 * const* colors)
+            : m_colors(colors)
+        {
+        }
+
+        inline const quint8* pixelAt(int index) const {
+            return m_colors[index];
+        }
+
+        inline void advance(int numPixels) {
+            m_colors += numPixels;
+        }
+
+    private:
+        const quint8 * const * m_colors;
+    };
+
+    struct PointerToArray {
+        static const bool isContiguous = true;
+
+        PointerToArray(const quint8 *colors)
+            : m_colors(colors)
+        {
+        }
+
+        inline const quint8* pixelAt(int index) const {
+            return m_colors + index * pixelSize;
+        }
+
+        inline void advance(int numPixels) {
+            m_colors += numPixels * pixelSize;
+        }
+
+    private:
+        const quint8 *m_colors;
+    };
+
+    struct WeightsWrapper {
+        WeightsWrapper(const qint16 *weights)
+            : m_weights(weights)
+        {
+        }
+
+        inline vector_type weights(int numPixels) const {
+            alignas(64) entry_type buffer[vector_type::Size];
+
+            for (int i = 0; i < numPixels; i++) {
+                buffer[i] = m_weights[i];
+            }
+            for (int i = numPixels; i < int(vector_type::size()); i++) {
+                buffer[i] = 0;
+            }
+
+            return vector_type(buffer, Vc::Aligned);
+        }
+
+        inline void advance(int numPixels) {
+            m_weights += numPixels;
+        }
+
+        inline int normalizeFactor() const {
+            return 255;
+        }
+
+    private:
+        const qint16 *m_weights;
+    };
+
+    struct NoWeightsSurrogate {
+        NoWeightsSurrogate(int numPixels)
+            : m_numPixels(numPixels)
+        {
+        }
+
+        inline vector_type weights(int) const {
+            // the missing pixels are already transparent
+            return vector_type(Vc::One);
+        }
+
+        inline void advance(int) {
+        }
+
+        inline int normalizeFactor() const {
+            return m_numPixels;
+        }
+
+    private:
+        const int m_numPixels;
+    };
+
+    static inline void flush(vector_type *sums, double *totals) {
+        for (int ch = 0; ch < 4; ch++) {
+            totals[ch] += sums[ch].sum();
+            sums[ch] = vector_type(Vc::Zero);
+        }
+    }
+
+    static inline channels_type clampResult(double value) {
+        const double minValue = KoColorSpaceMathsTraits<channels_type>::min;
+        const double maxValue = KoColorSpaceMathsTraits<channels_type>::max;
+
+        return channels_type(qBound(minValue, value, maxValue));
+    }
+
+    template<class Source, class Weights>
+    void mixColorsImpl(Source source, Weights weights, quint32 nColors, quint8 *dst) const {
+        const int vectorSize = vector_type::size();
+
+        // sums of the three colors and the alpha
+        vector_type sums[4] = {vector_type(Vc::Zero), vector_type(Vc::Zero),
+                               vector_type(Vc::Zero), vector_type(Vc::Zero)};
+        double totals[4] = {0.0, 0.0, 0.0, 0.0};
+
+        int iterations = 0;
+
+        while (nColors > 0) {
+            const int numPixels = qMin(nColors, quint32(vectorSize));
+
+            vector_type c1, c2, c3, alpha;
+            KoMixColorsOpLoader<channels_type, _impl>::load(source, numPixels, c1, c2, c3, alpha);
+
+            const vector_type alphaTimesWeight = alpha * weights.weights(numPixels);
+
+            sums[0] += c1 * alphaTimesWeight;
+            sums[1] += c2 * alphaTimesWeight;
+            sums[2] += c3 * alphaTimesWeight;
+            sums[3] += alphaTimesWeight;
+
+            if (++iterations == flushInterval) {
+                flush(sums, totals);
+                iterations = 0;
+            }
+
+            source.advance(numPixels);
+            weights.advance(numPixels);
+            nColors -= numPixels;
+        }
+
+        flush(sums, totals);
+
+        const int sumOfWeights = weights.normalizeFactor();
+        const double unitValue = KoColorSpaceMathsTraits<channels_type>::unitValue;
+
+        double totalAlpha = qMin(totals[3], unitValue * sumOfWeights);
+
+        channels_type *dstColor = reinterpret_cast<channels_type*>(dst);
+
+        if (totalAlpha > 0) {
+            /**
+             * For 8-bit pixels KoStreamedMath returns the colors in
+             * the reverse order, see fetch_colors_32()
+             */
+            const bool reversed = sizeof(channels_type) == 1;
+
+            /**
+             * The results are truncated, so they should be divided
+             * exactly like in KoMixColorsOpImpl. Multiplying by the
+             * reciprocal is not exact, e.g. 49.0 * (1.0 / 49.0) gives
+             * 0.9999999999999999, which is truncated to zero.
+             */
+
+            dstColor[reversed ? 2 : 0] = clampResult(totals[0] / totalAlpha);
+            dstColor[1] = clampResult(totals[1] / totalAlpha);
+            dstColor[reversed ? 0 : 2] = clampResult(totals[2] / totalAlpha);
+            dstColor[alphaPos] = clampResult(totalAlpha / sumOfWeights);
+        } else {
+            memset(dst, 0, pixelSize);
+        }
+    }
+};
+
+#endif /* KOOPTIMIZEDMIXCOLORSOP_H_ */
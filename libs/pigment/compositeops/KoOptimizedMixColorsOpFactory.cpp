@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoOptimizedMixColorsOpFactoryPerArch.h" // vc.h must come first
+#include "KoOptimizedMixColorsOpFactory.h"
+
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wundef"
+#endif
+
+
+KoMixColorsOp* KoOptimizedMixColorsOpFactory::createMixColorsOp32()
+{
+    return createOptimizedClass<KoOptimizedMixColorsOpFactoryPerArch<quint8> >(0);
+}
+
+KoMixColorsOp* KoOptimizedMixColorsOpFactory::createMixColorsOpU64()
+{
+    return createOptimizedClass<KoOptimizedMixColorsOpFactoryPerArch<quint16> >(0);
+}
+
+KoMixColorsOp* KoOptimizedMixColorsOpFactory::createMixColorsOp128()
+{
+    return createOptimizedClass<KoOptimizedMixColorsOpFactoryPerArch<float> >(0);
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOPFACTORY_H
+#define KOOPTIMIZEDMIXCOLORSOPFACTORY_H
+
+#include "kritapigment_export.h"
+
+#include <KoColorSpaceTraits.h>
+#include <KoMixColorsOpImpl.h>
+
+class KoMixColorsOp;
+
+/**
+ * Creates the vectorized mix colors ops. Like the optimized composite
+ * ops they are moved into a separate object module, so that they are
+ * built once per instruction set.
+ *
+ * All the ops are suitable for any colorspace with 4 channels and the
+ * alpha channel in the last position.
+ */
+class KRITAPIGMENT_EXPORT KoOptimizedMixColorsOpFactory
+{
+public:
+    static KoMixColorsOp* createMixColorsOp32();
+    static KoMixColorsOp* createMixColorsOpU64();
+    static KoMixColorsOp* createMixColorsOp128();
+};
+
+template<class Traits>
+struct OptimizedMixColorsOpSelector
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return new KoMixColorsOpImpl<Traits>();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoBgrU8Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOp32();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoLabU8Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOp32();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoBgrU16Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOpU64();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoLabU16Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOpU64();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoRgbF32Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedMixColorsOpFactory::createMixColorsOp128();
+    }
+};
+
+#endif /* KOOPTIMIZEDMIXCOLORSOPFACTORY_H */
@@ -186,6 +186,82 @@ void TestColorConversionSystem::testAlphaU16Conversions()
     }
 }
 
+void TestColorConversionSystem::testMatrixShaperConversions_data()
+{
+    QTest::addColumn<QString>("srcDepth");
+    QTest::addColumn<QString>("srcProfile");
+    QTest::addColumn<QString>("dstDepth");
+    QTest::addColumn<QString>("dstProfile");
+    QTest::addColumn<float>("tolerance");
+
+    const QString U8 = Integer8BitsColorDepthID.id();
+    const QString U16 = Integer16BitsColorDepthID.id();
+    const QString F32 = Float32BitsColorDepthID.id();
+
+    QTest::newRow("u8-srgb-u16-rec2020-linear") << U8 << "sRGB-elle-V2-srgbtrc.icc" << U16 << "Rec2020-elle-V2-g10.icc" << 64.0f / 65535;
+    QTest::newRow("u16-srgb-linear-u8-srgb") << U16 << "sRGB-elle-V2-g10.icc" << U8 << "sRGB-elle-V2-srgbtrc.icc" << 1.5f / 255;
+    QTest::newRow("u16-srgb-u16-clay") << U16 << "sRGB-elle-V2-srgbtrc.icc" << U16 << "ClayRGB-elle-V2-srgbtrc.icc" << 64.0f / 65535;
+    QTest::newRow("f32-srgb-linear-u8-srgb") << F32 << "sRGB-elle-V2-g10.icc" << U8 << "sRGB-elle-V2-srgbtrc.icc" << 1.5f / 255;
+    QTest::newRow("u8-srgb-f32-srgb-linear") << U8 << "sRGB-elle-V2-srgbtrc.icc" << F32 << "sRGB-elle-V2-g10.icc" << 1e-3f;
+    QTest::newRow("f32-rec2020-linear-f32-srgb-linear") << F32 << "Rec2020-elle-V2-g10.icc" << F32 << "sRGB-elle-V2-g10.icc" << 1e-3f;
+}
+
+void TestColorConversionSystem::testMatrixShaperConversions()
+{
+    QFETCH(QString, srcDepth);
+    QFETCH(QString, srcProfile);
+    QFETCH(QString, dstDepth);
+    QFETCH(QString, dstProfile);
+    QFETCH(float, tolerance);
+
+    const KoColorSpace *srcCs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), srcDepth, srcProfile);
+    const KoColorSpace *dstCs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), dstDepth, dstProfile);
+
+    if (!srcCs || !dstCs) {
+        QSKIP("The profiles are not installed");
+    }
+
+    const int numPixels = 4096;
+    QVector<float> channels(4);
+    QByteArray srcBuf(numPixels * srcCs->pixelSize(), '\0');
+
+    qsrand(1);
+    for (int i = 0; i < numPixels; i++) {
+        for (int j = 0; j < 4; j++) {
+            channels[j] = float(qrand()) / RAND_MAX;
+        }
+        srcCs->fromNormalisedChannelsValue((quint8*)srcBuf.data() + i * srcCs->pixelSize(), channels);
+    }
+
+    QByteArray fastBuf(numPixels * dstCs->pixelSize(), '\0');
+    QByteArray lcmsBuf(numPixels * dstCs->pixelSize(), '\0');
+
+    // the default flags let the engine pick the matrix-shaper fast path...
+    srcCs->convertPixelsTo((quint8*)srcBuf.data(), (quint8*)fastBuf.data(), dstCs, numPixels,
+                           KoColorConversionTransformation::IntentPerceptual,
+                           KoColorConversionTransformation::Empty);
+
+    // ...and NoOptimization forces the plain lcms pipeline
+    srcCs->convertPixelsTo((quint8*)srcBuf.data(), (quint8*)lcmsBuf.data(), dstCs, numPixels,
+                           KoColorConversionTransformation::IntentPerceptual,
+                           KoColorConversionTransformation::NoOptimization);
+
+    QVector<float> fastChannels(4);
+    QVector<float> lcmsChannels(4);
+
+    for (int i = 0; i < numPixels; i++) {
+        dstCs->normalisedChannelsValue((quint8*)fastBuf.data() + i * dstCs->pixelSize(), fastChannels);
+        dstCs->normalisedChannelsValue((quint8*)lcmsBuf.data() + i * dstCs->pixelSize(), lcmsChannels);
+
+        for (int j = 0; j < 4; j++) {
+            if (qAbs(fastChannels[j] - lcmsChannels[j]) > tolerance) {
+                QFAIL(QString("Pixel %1 channel %2 differs: fast path %3, lcms %4")
+                      .arg(i).arg(j).arg(fastChannels[j]).arg(lcmsChannels[j]).toLatin1());
+            }
+        }
+    }
+}
+
 void TestColorConversionSystem::benchmarkAlphaToRgbConversion()
 {
     const KoColorSpace *alpha8 = KoColorSpaceRegistry::instance()->alpha8();
@@ -234,4 +310,49 @@ void TestColorConversionSystem::benchmarkRgbToAlphaConversion()
     }
 }
 
+void TestColorConversionSystem::benchmarkMatrixShaperConversion_data()
+{
+    QTest::addColumn<bool>("useFastPath");
+
+    QTest::newRow("lcms") << false;
+    QTest::newRow("fast-path") << true;
+}
+
+void TestColorConversionSystem::benchmarkMatrixShaperConversion()
+{
+    QFETCH(bool, useFastPath);
+
+    const KoColorSpace *srcCs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), "sRGB-elle-V2-g10.icc");
+    const KoColorSpace *dstCs = KoColorSpaceRegistry::instance()->rgb8();
+
+    if (!srcCs) {
+        QSKIP("The profiles are not installed");
+    }
+
+    const int numPixels = 1024 * 1024;
+    QByteArray srcBuf(numPixels * srcCs->pixelSize(), '\0');
+    QByteArray dstBuf(numPixels * dstCs->pixelSize(), '\0');
+
+    float *srcPtr = reinterpret_cast<float*>(srcBuf.data());
+
+    qsrand(1);
+    for (int i = 0; i < 4 * numPixels; i++) {
+        srcPtr[i] = float(qrand()) / RAND_MAX;
+    }
+
+    const KoColorConversionTransformation::ConversionFlags flags =
+        useFastPath ?
+        KoColorConversionTransformation::Empty :
+        KoColorConversionTransformation::NoOptimization;
+
+    QBENCHMARK {
+        srcCs->convertPixelsTo((quint8*)srcBuf.data(),
+                               (quint8*)dstBuf.data(),
+                               dstCs,
+                               numPixels,
+                               KoColorConversionTransformation::IntentPerceptual,
+                               flags);
+    }
+}
+
 QTEST_GUILESS_MAIN(TestColorConversionSystem)
@@ -43,8 +43,12 @@ private Q_SLOTS:
     void testGoodConnections();
     void testAlphaConversions();
     void testAlphaU16Conversions();
+    void testMatrixShaperConversions_data();
+    void testMatrixShaperConversions();
     void benchmarkAlphaToRgbConversion();
     void benchmarkRgbToAlphaConversion();
+    void benchmarkMatrixShaperConversion_data();
+    void benchmarkMatrixShaperConversion();
 private:
     QList< ModelDepthProfile > listModels;
 };
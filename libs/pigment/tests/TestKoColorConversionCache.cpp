@@ -0,0 +1,205 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoColorConversionCache.h"
+
+#include <QTest>
+#include <QThread>
+#include <QSemaphore>
+
+#include <functional>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorConversionCache.h>
+#include <KoColorSpace.h>
+#include "KoAlphaColorSpace.h"
+
+namespace {
+
+class FunctionThread : public QThread
+{
+public:
+    FunctionThread(std::function<void()> func)
+        : m_func(func)
+    {
+    }
+
+protected:
+    void run() override {
+        m_func();
+    }
+
+private:
+    std::function<void()> m_func;
+};
+
+const KoColorConversionTransformation* lookup(const KoColorSpace *src, const KoColorSpace *dst)
+{
+    KoColorConversionCache *cache = KoColorSpaceRegistry::instance()->colorConversionCache();
+
+    /**
+     * The returned pointer stays valid after the handle is gone,
+     * because the instance is pinned by the thread-local set
+     */
+    return cache->cachedConverter(src, dst,
+                                  KoColorConversionTransformation::internalRenderingIntent(),
+                                  KoColorConversionTransformation::internalConversionFlags()).transformation();
+}
+
+}
+
+void TestKoColorConversionCache::testThreadLocalHits()
+{
+    KoColorConversionCache *cache = KoColorSpaceRegistry::instance()->colorConversionCache();
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16();
+
+    const KoColorConversionTransformation *transfo = lookup(rgb8, rgb16);
+
+    cache->resetStatistics();
+
+    for (int i = 0; i < 1000; i++) {
+        QCOMPARE(lookup(rgb8, rgb16), transfo);
+    }
+
+    // a lookup of another key flushes the pending thread-local hits
+    QVERIFY(lookup(rgb16, rgb8) != transfo);
+
+    KoColorConversionCache::Statistics stats = cache->statistics();
+    QCOMPARE(stats.threadLocalHits, qint64(1000));
+    QCOMPARE(stats.poolHits + stats.misses, qint64(1));
+}
+
+void TestKoColorConversionCache::testSeparateInstancesPerThread()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16();
+
+    const KoColorConversionTransformation *mainTransfo = lookup(rgb8, rgb16);
+    const KoColorConversionTransformation *threadTransfo = 0;
+    bool threadHitItsOwnInstance = false;
+
+    FunctionThread thread([&]() {
+        threadTransfo = lookup(rgb8, rgb16);
+        threadHitItsOwnInstance = lookup(rgb8, rgb16) == threadTransfo;
+    });
+    thread.start();
+    thread.wait();
+
+    QVERIFY(threadTransfo);
+    QVERIFY(threadHitItsOwnInstance);
+    QVERIFY(threadTransfo != mainTransfo);
+    QCOMPARE(lookup(rgb8, rgb16), mainTransfo);
+}
+
+void TestKoColorConversionCache::testColorSpaceDestroyedWhileCachedByOtherThread()
+{
+    KoColorConversionCache *cache = KoColorSpaceRegistry::instance()->colorConversionCache();
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+
+    KoAlphaColorSpace *alpha = new KoAlphaColorSpace();
+    const qint64 instancesBefore = cache->statistics().instances;
+
+    QSemaphore lookedUp;
+    QSemaphore released;
+
+    FunctionThread thread([&]() {
+        lookup(alpha, rgb8);
+        lookedUp.release();
+        released.acquire();
+    });
+    thread.start();
+
+    lookedUp.acquire();
+    QCOMPARE(cache->statistics().instances, instancesBefore + 1);
+
+    // the other thread still holds the transformation in its local set
+    delete alpha;
+    QCOMPARE(cache->statistics().instances, instancesBefore + 1);
+
+    released.release();
+    thread.wait();
+
+    // destruction of any color space purges the dropped instances
+    delete new KoAlphaColorSpace();
+    QCOMPARE(cache->statistics().instances, instancesBefore);
+}
+
+void TestKoColorConversionCache::benchmarkConcurrentConversion_data()
+{
+    QTest::addColumn<int>("numThreads");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("4") << 4;
+    QTest::newRow("8") << 8;
+}
+
+void TestKoColorConversionCache::benchmarkConcurrentConversion()
+{
+    QFETCH(int, numThreads);
+
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16();
+
+    /**
+     * The total amount of work is fixed, so with a perfectly scalable
+     * cache the time should go down linearly with the number of threads.
+     * The conversions are done in small chunks, like the tile-based code
+     * does, to make the cost of the lookup visible.
+     */
+    const int totalChunks = 64 * 1024;
+    const int chunkPixels = 64;
+
+    QVector<FunctionThread*> threads;
+
+    QBENCHMARK {
+        for (int i = 0; i < numThreads; i++) {
+            threads << new FunctionThread([=]() {
+                QByteArray src(chunkPixels * rgb8->pixelSize(), '\x80');
+                QByteArray dst(chunkPixels * rgb16->pixelSize(), '\0');
+
+                for (int j = 0; j < totalChunks / numThreads; j++) {
+                    rgb8->convertPixelsTo((const quint8*)src.constData(), (quint8*)dst.data(),
+                                          rgb16, chunkPixels,
+                                          KoColorConversionTransformation::internalRenderingIntent(),
+                                          KoColorConversionTransformation::internalConversionFlags());
+                }
+            });
+            threads.last()->start();
+        }
+
+        Q_FOREACH (FunctionThread *thread, threads) {
+            thread->wait();
+        }
+
+        qDeleteAll(threads);
+        threads.clear();
+    }
+
+    KoColorConversionCache::Statistics stats =
+        KoColorSpaceRegistry::instance()->colorConversionCache()->statistics();
+
+    qDebug() << "thread-local hits:" << stats.threadLocalHits
+             << "pool hits:" << stats.poolHits
+             << "misses:" << stats.misses
+             << "instances:" << stats.instances;
+}
+
+QTEST_GUILESS_MAIN(TestKoColorConversionCache)
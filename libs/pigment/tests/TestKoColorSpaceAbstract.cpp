@@ -2,10 +2,14 @@
 
 #include "KoColorSpaceAbstract.h"
 #include "KoColorSpaceTraits.h"
+#include "compositeops/KoOptimizedMixColorsOpFactory.h"
 
 #include <cfloat>
+#include <limits>
 
 #include <QTest>
+#include <QScopedPointer>
+#include <QVector>
 
 template <class T>
 T mixOpExpectedAlpha(T alpha1, T alpha2, const qint16 *weights)
@@ -385,5 +389,161 @@ void TestKoColorSpaceAbstract::testMixColorsOpU8NoAlphaLinear()
     QCOMPARE(outputPixel[COLOR_CHANNEL_2], mixOpNoAlphaExpectedColor(pixel1[COLOR_CHANNEL_2], pixel2[COLOR_CHANNEL_2], weights));
 }
 
+template <class Traits>
+typename Traits::channels_type randomChannelValue()
+{
+    typedef typename Traits::channels_type channels_type;
+    const qreal value = qreal(qrand()) / RAND_MAX;
+    return KoColorSpaceMaths<qreal, channels_type>::scaleToA(value);
+}
+
+template <class Traits>
+bool compareMixedPixels(const quint8 *pixel1, const quint8 *pixel2, qreal tolerance)
+{
+    typedef typename Traits::channels_type channels_type;
+    const channels_type *p1 = Traits::nativeArray(pixel1);
+    const channels_type *p2 = Traits::nativeArray(pixel2);
+
+    for (int i = 0; i < (int)Traits::channels_nb; i++) {
+        if (qAbs(qreal(p1[i]) - qreal(p2[i])) > tolerance) {
+            qDebug() << "Channel" << i << "differs:" << p1[i] << p2[i];
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Compares the optimized version of the mix colors op against
+ * KoMixColorsOpImpl on the same pixels. Both the ops truncate the
+ * integer channels, so their results should be exactly the same.
+ */
+template <class Traits>
+void testOptimizedMixColorsOpImpl(KoMixColorsOp *optimizedOp, qreal tolerance)
+{
+    typedef typename Traits::channels_type channels_type;
+    QScopedPointer<KoMixColorsOp> op(optimizedOp);
+    KoMixColorsOpImpl<Traits> referenceOp;
+
+    qsrand(1);
+
+    const int pixelSize = Traits::pixelSize;
+    const int counts[] = {1, 3, 7, 8, 17, 100, 1000};
+
+    for (int count : counts) {
+        QVector<quint8> pixels(count * pixelSize);
+        QVector<const quint8*> pixelPtrs(count);
+        QVector<qint16> weights(count);
+
+        for (int i = 0; i < count; i++) {
+            channels_type *pixel = Traits::nativeArray(pixels.data() + i * pixelSize);
+            for (int ch = 0; ch < (int)Traits::channels_nb; ch++) {
+                pixel[ch] = randomChannelValue<Traits>();
+            }
+            pixelPtrs[count - i - 1] = pixels.data() + i * pixelSize;
+            weights[i] = 255 / count;
+        }
+        weights[0] += 255 - (255 / count) * count;
+
+        QVector<quint8> expected(pixelSize);
+        QVector<quint8> result(pixelSize);
+
+        referenceOp.mixColors(pixelPtrs.constData(), weights.constData(), count, expected.data());
+        op->mixColors(pixelPtrs.constData(), weights.constData(), count, result.data());
+        QVERIFY(compareMixedPixels<Traits>(expected.constData(), result.constData(), tolerance));
+
+        referenceOp.mixColors(pixels.constData(), weights.constData(), count, expected.data());
+        op->mixColors(pixels.constData(), weights.constData(), count, result.data());
+        QVERIFY(compareMixedPixels<Traits>(expected.constData(), result.constData(), tolerance));
+
+        referenceOp.mixColors(pixelPtrs.constData(), count, expected.data());
+        op->mixColors(pixelPtrs.constData(), count, result.data());
+        QVERIFY(compareMixedPixels<Traits>(expected.constData(), result.constData(), tolerance));
+
+        referenceOp.mixColors(pixels.constData(), count, expected.data());
+        op->mixColors(pixels.constData(), count, result.data());
+        QVERIFY(compareMixedPixels<Traits>(expected.constData(), result.constData(), tolerance));
+
+        // mixing the same color with itself should not change it
+        for (int i = 1; i < count; i++) {
+            memcpy(pixels.data() + i * pixelSize, pixels.constData(), pixelSize);
+        }
+
+        op->mixColors(pixels.constData(), weights.constData(), count, result.data());
+        QVERIFY(compareMixedPixels<Traits>(pixels.constData(), result.constData(), std::numeric_limits<channels_type>::is_integer ? 0.0 : 1e-5));
+
+        // fully transparent pixels give a transparent result
+        for (int i = 0; i < count; i++) {
+            Traits::setOpacity(pixels.data() + i * pixelSize, quint8(OPACITY_TRANSPARENT_U8), 1);
+        }
+
+        op->mixColors(pixels.constData(), count, result.data());
+        QCOMPARE(Traits::nativeArray(result.constData())[Traits::alpha_pos], KoColorSpaceMathsTraits<channels_type>::zeroValue);
+    }
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOpU8()
+{
+    testOptimizedMixColorsOpImpl<KoBgrU8Traits>(KoOptimizedMixColorsOpFactory::createMixColorsOp32(), 0.0);
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOpU16()
+{
+    testOptimizedMixColorsOpImpl<KoBgrU16Traits>(KoOptimizedMixColorsOpFactory::createMixColorsOpU64(), 0.0);
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOpF32()
+{
+    testOptimizedMixColorsOpImpl<KoRgbF32Traits>(KoOptimizedMixColorsOpFactory::createMixColorsOp128(), 1e-5);
+}
+
+/**
+ * The weighted mix of the green channels of these pixels is 149.8,
+ * so rounding and truncation give different results for it
+ */
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOpTruncation()
+{
+    QScopedPointer<KoMixColorsOp> op(KoOptimizedMixColorsOpFactory::createMixColorsOp32());
+    KoMixColorsOpImpl<KoBgrU8Traits> referenceOp;
+
+    const quint8 pixels[8] = {50, 100, 200, 255,
+                              20, 200, 100, 255};
+    const qint16 weights[2] = {128, 127};
+
+    quint8 expected[4];
+    quint8 result[4];
+
+    referenceOp.mixColors(pixels, weights, 2, expected);
+    op->mixColors(pixels, weights, 2, result);
+
+    QCOMPARE(int(result[1]), 149);
+
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(int(result[i]), int(expected[i]));
+    }
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOpExactDivision()
+{
+    QScopedPointer<KoMixColorsOp> op(KoOptimizedMixColorsOpFactory::createMixColorsOp32());
+    KoMixColorsOpImpl<KoBgrU8Traits> referenceOp;
+
+    // 49.0 * (1.0 / 49.0) is slightly less than 1.0
+    const quint8 pixels[4] = {1, 1, 1, 49};
+    const qint16 weights[1] = {255};
+
+    quint8 expected[4];
+    quint8 result[4];
+
+    referenceOp.mixColors(pixels, weights, 1, expected);
+    op->mixColors(pixels, weights, 1, result);
+
+    QCOMPARE(int(result[0]), 1);
+
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(int(result[i]), int(expected[i]));
+    }
+}
+
 
 QTEST_GUILESS_MAIN(TestKoColorSpaceAbstract)
@@ -11,6 +11,11 @@ private Q_SLOTS:
     void testMixColorsOpF32();
     void testMixColorsOpU8NoAlpha();
     void testMixColorsOpU8NoAlphaLinear();
+    void testOptimizedMixColorsOpU8();
+    void testOptimizedMixColorsOpU16();
+    void testOptimizedMixColorsOpF32();
+    void testOptimizedMixColorsOpTruncation();
+    void testOptimizedMixColorsOpExactDivision();
 };
 
 #endif
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoTransferLut.h"
+
+#include <QTest>
+
+#include <cmath>
+
+#include <KoTransferLut.h>
+#include <KoPerChannelLutTransformation.h>
+#include <KoBgrColorSpaceTraits.h>
+
+namespace {
+
+QVector<quint16> identityTransfer()
+{
+    QVector<quint16> transfer(256);
+    for (int i = 0; i < transfer.size(); i++) {
+        transfer[i] = i * 257;
+    }
+    return transfer;
+}
+
+QVector<quint16> gammaTransfer(qreal gamma)
+{
+    QVector<quint16> transfer(256);
+    for (int i = 0; i < transfer.size(); i++) {
+        transfer[i] = qRound(std::pow(i / 255.0, gamma) * 65535.0);
+    }
+    return transfer;
+}
+
+}
+
+void TestKoTransferLut::testIdentity()
+{
+    const QVector<quint16> transfer = identityTransfer();
+    const KoTransferCurve curve(transfer.constData(), transfer.size());
+
+    KoTransferLut<quint8> lut8(curve);
+    for (int i = 0; i < 256; i++) {
+        QCOMPARE(int(lut8(i)), i);
+    }
+
+    KoTransferLut<quint16> lut16(curve);
+    for (int i = 0; i < 65536; i++) {
+        QCOMPARE(int(lut16(i)), i);
+    }
+
+    KoTransferLut<float> lutF(curve);
+    for (int i = 0; i <= 1000; i++) {
+        const float value = i / 1000.0f;
+        QVERIFY(qAbs(lutF(value) - value) < 1e-5);
+    }
+}
+
+/**
+ * The 8-bit values fall exactly on the nodes of a 256-node curve,
+ * so the result should be just the node value.
+ */
+void TestKoTransferLut::testNodesAreExact()
+{
+    const QVector<quint16> transfer = gammaTransfer(2.2);
+    const KoTransferCurve curve(transfer.constData(), transfer.size());
+
+    KoTransferLut<quint8> lut8(curve);
+    KoTransferLut<quint16> lut16(curve);
+
+    for (int i = 0; i < 256; i++) {
+        QCOMPARE(int(lut8(i)), qRound(transfer[i] / 257.0));
+        QCOMPARE(lut16(i * 257), transfer[i]);
+    }
+}
+
+void TestKoTransferLut::testFloatInterpolation()
+{
+    QVector<qreal> nodes(17);
+    for (int i = 0; i < nodes.size(); i++) {
+        nodes[i] = std::pow(i / 16.0, 0.5);
+    }
+    const KoTransferCurve curve(nodes);
+
+    KoTransferLut<float> lut(curve);
+    for (int i = 0; i <= 1000; i++) {
+        const float value = i / 1000.0f;
+        QVERIFY(qAbs(lut(value) - curve.value(value)) < 1e-4);
+    }
+
+    // the values out of range are clamped
+    QCOMPARE(lut(-1.0f), 0.0f);
+    QVERIFY(qAbs(lut(2.0f) - 1.0f) < 1e-6);
+}
+
+void TestKoTransferLut::testPerChannelTransformation()
+{
+    typedef KoBgrU16Traits Traits;
+
+    const QVector<quint16> identity = identityTransfer();
+    const QVector<quint16> gamma = gammaTransfer(0.5);
+
+    QVector<quint16> inverted(256);
+    for (int i = 0; i < inverted.size(); i++) {
+        inverted[i] = 65535 - i * 257;
+    }
+
+    QVector<const quint16*> transfers(Traits::channels_nb, 0);
+    transfers[Traits::green_pos] = inverted.constData();
+    transfers[Traits::red_pos] = gamma.constData();
+    transfers[Traits::alpha_pos] = identity.constData();
+
+    KoPerChannelLutTransformation<Traits> transformation(transfers, 256);
+
+    // the number of pixels is not a multiple of the unrolling factor
+    const int numPixels = 1023;
+
+    QVector<quint16> src(numPixels * Traits::channels_nb);
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = (i * 7919) % 65536;
+    }
+
+    QVector<quint16> dst(src.size());
+    transformation.transform(reinterpret_cast<const quint8*>(src.constData()),
+                             reinterpret_cast<quint8*>(dst.data()), numPixels);
+
+    const KoTransferCurve gammaCurve(gamma.constData(), gamma.size());
+
+    for (int i = 0; i < numPixels; i++) {
+        const quint16 *srcPixel = src.constData() + i * Traits::channels_nb;
+        const quint16 *dstPixel = dst.constData() + i * Traits::channels_nb;
+
+        QCOMPARE(dstPixel[Traits::blue_pos], srcPixel[Traits::blue_pos]);
+        QVERIFY(qAbs(int(dstPixel[Traits::green_pos]) - (65535 - int(srcPixel[Traits::green_pos]))) <= 1);
+        QCOMPARE(dstPixel[Traits::red_pos],
+                 KoColorSpaceMaths<qreal, quint16>::scaleToA(
+                     gammaCurve.value(srcPixel[Traits::red_pos] / 65535.0)));
+        QCOMPARE(dstPixel[Traits::alpha_pos], srcPixel[Traits::alpha_pos]);
+    }
+
+    // in-place transformation gives the same result
+    QVector<quint16> inPlace = src;
+    transformation.transform(reinterpret_cast<const quint8*>(inPlace.constData()),
+                             reinterpret_cast<quint8*>(inPlace.data()), numPixels);
+    QCOMPARE(inPlace, dst);
+}
+
+void TestKoTransferLut::benchmarkU16Lut()
+{
+    typedef KoBgrU16Traits Traits;
+
+    const QVector<quint16> gamma = gammaTransfer(2.2);
+    QVector<const quint16*> transfers(Traits::channels_nb, gamma.constData());
+    transfers[Traits::alpha_pos] = 0;
+
+    KoPerChannelLutTransformation<Traits> transformation(transfers, 256);
+
+    const int numPixels = 4096 * 256;
+    QVector<quint16> pixels(numPixels * Traits::channels_nb);
+    for (int i = 0; i < pixels.size(); i++) {
+        pixels[i] = (i * 7919) % 65536;
+    }
+
+    QBENCHMARK {
+        transformation.transform(reinterpret_cast<const quint8*>(pixels.constData()),
+                                 reinterpret_cast<quint8*>(pixels.data()), numPixels);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestKoTransferLut)
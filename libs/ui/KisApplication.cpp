@@ -90,6 +90,7 @@
 #include "opengl/kis_opengl.h"
 #include "kis_spin_box_unit_manager.h"
 #include "kis_document_aware_spin_box_unit_manager.h"
+#include "KisTraceRecorder.h"
 #include "KisViewManager.h"
 #include "kis_workspace_resource.h"
 
@@ -527,6 +528,13 @@ bool KisApplication::start(const KisApplicationArguments &args)
     connect(this, &KisApplication::aboutToQuit, &KisSpinBoxUnitManagerFactory::clearUnitManagerBuilder); //ensure the builder is destroyed when the application leave.
     //the new syntax slot syntax allow to connect to a non q_object static method.
 
+    // save the update trace if the user quits without switching the tracing off
+    connect(this, &KisApplication::aboutToQuit, [] () {
+        if (KisTraceRecorder::isEnabled() && KisTraceRecorder::instance()) {
+            KisTraceRecorder::instance()->dumpToLogFolder();
+        }
+    });
+
 
     // Create a new image, if needed
     if (doNewImage) {
@@ -839,6 +839,7 @@ void KisView::setCurrentNode(KisNodeSP node)
 {
     d->currentNode = node;
     d->canvas.slotTrySwitchShapeManager();
+    d->canvas.notifyCurrentNodeChanged();
 
     syncLastActiveNodeToDocument();
 }
@@ -28,6 +28,8 @@
 #include <QLabel>
 #include <QMouseEvent>
 #include <QDesktopWidget>
+#include <QSet>
+#include <QtConcurrent>
 
 #include <kis_debug.h>
 
@@ -46,6 +48,8 @@
 #include "kis_prescaled_projection.h"
 #include "kis_image.h"
 #include "kis_image_barrier_locker.h"
+#include "kis_layer_utils.h"
+#include "kis_paint_device.h"
 #include "kis_undo_adapter.h"
 #include "KisDocument.h"
 #include "flake/kis_shape_layer.h"
@@ -103,6 +107,7 @@ public:
         , selectedShapesProxy(&shapeManager)
         , toolProxy(parent)
         , displayColorConverter(resourceManager, view)
+        , swapPrioritiesCompressor(1000, KisSignalCompressor::POSTPONE)
     {
     }
 
@@ -136,6 +141,7 @@ public:
     bool bootstrapLodBlocked;
     QPointer<KoShapeManager> currentlyActiveShapeManager;
     KisInputActionGroupsMask inputActionGroupsMask = AllActionGroup;
+    KisSignalCompressor swapPrioritiesCompressor;
 
     bool effectiveLodAllowedInCanvas() {
         return lodAllowedInCanvas && !bootstrapLodBlocked;
@@ -227,6 +233,7 @@ void KisCanvas2::setup()
             globalShapeManager()->selection(), SIGNAL(currentLayerChanged(const KoShapeLayer*)));
 
     connect(&m_d->updateSignalCompressor, SIGNAL(timeout()), SLOT(slotDoCanvasUpdate()));
+    connect(&m_d->swapPrioritiesCompressor, SIGNAL(timeout()), SLOT(slotUpdateSwapPriorities()));
 
     initializeFpsDecoration();
 }
@@ -804,6 +811,12 @@ void KisCanvas2::notifyZoomChanged()
 
     notifyLevelOfDetailChange();
     updateCanvas(); // update the canvas, because that isn't done when zooming using KoZoomAction
+    m_d->swapPrioritiesCompressor.start();
+}
+
+void KisCanvas2::notifyCurrentNodeChanged()
+{
+    m_d->swapPrioritiesCompressor.start();
 }
 
 void KisCanvas2::slotTrySwitchShapeManager()
@@ -828,6 +841,14 @@ void KisCanvas2::notifyLevelOfDetailChange()
     const int maxLod = cfg.numMipmapLevels();
 
     int lod = KisLodTransform::scaleToLod(effectiveZoom, maxLod);
+
+    /**
+     * The canvas textures have no mipmaps above maxLod, so the
+     * adaptive level cannot go any higher
+     */
+    KisImageConfig imageConfig;
+    image->setAdaptiveLevelOfDetailLimit(imageConfig.enableAdaptiveLevelOfDetail() ? maxLod : 0);
+
     image->setDesiredLevelOfDetail(lod);
 }
 
@@ -874,6 +895,76 @@ void KisCanvas2::documentOffsetMoved(const QPoint &documentOffset)
     emit documentOffsetUpdateFinished();
 
     updateCanvas();
+    m_d->swapPrioritiesCompressor.start();
+}
+
+void KisCanvas2::slotUpdateSwapPriorities()
+{
+    KisImageSP image = this->image();
+    if (!image || !m_d->canvasWidget) return;
+
+    const QRect visibleRect =
+        m_d->coordinatesConverter->widgetToImage(
+            QRectF(m_d->canvasWidget->widget()->rect())).toAlignedRect() &
+        image->bounds();
+
+    /**
+     * The tiles the user is looking at are kept in memory as long as
+     * possible, the tiles of the hidden layers and the ones lying
+     * outside the viewport are the first to be swapped out. The active
+     * node is the one the user paints on, so its tiles in the viewport
+     * are kept even when the node is hidden. The nodes are walked in
+     * the GUI thread, but the tiles themselves are marked in the
+     * background, the data managers are shared pointers, so they stay
+     * alive until the job is finished.
+     */
+    typedef QPair<KisDataManagerSP, QRect> DataManagerHint;
+    QVector<DataManagerHint> hints;
+    QSet<KisDataManager*> visitedManagers;
+
+    auto addDevice = [&] (KisPaintDeviceSP device, const QRect &rect) {
+        if (!device) return;
+
+        KisDataManagerSP dataManager = device->dataManager();
+        if (visitedManagers.contains(dataManager.data())) return;
+
+        visitedManagers.insert(dataManager.data());
+
+        // the data manager knows nothing about the offset of the device
+        hints.append(DataManagerHint(dataManager, rect.translated(-device->x(), -device->y())));
+    };
+
+    auto addNode = [&] (KisNodeSP node, const QRect &rect) {
+        addDevice(node->paintDevice(), rect);
+        addDevice(node->original(), rect);
+        addDevice(node->projection(), rect);
+    };
+
+    /**
+     * The data managers may be shared between the nodes, so the
+     * active node goes first to not get its tiles marked as low
+     * priority by a hidden neighbour. The tiles shared via COW
+     * are protected by merging the hints of the whole pass.
+     */
+    KisNodeSP activeNode = m_d->view->currentNode();
+    if (activeNode) {
+        addNode(activeNode, visibleRect);
+    }
+
+    addDevice(image->projection(), visibleRect);
+
+    KisLayerUtils::recursiveApplyNodes(image->root(),
+        [&] (KisNodeSP node) {
+            addNode(node, node->visible(true) ? visibleRect : QRect());
+        });
+
+    QtConcurrent::run([hints] () {
+        const quint32 hintsPass = KisDataManager::beginSwapPriorityHints();
+
+        Q_FOREACH (const DataManagerHint &hint, hints) {
+            hint.first->setSwapPriorityHint(hint.second, hintsPass);
+        }
+    });
 }
 
 void KisCanvas2::slotConfigChanged()
@@ -885,6 +976,7 @@ void KisCanvas2::slotConfigChanged()
     slotSetDisplayProfile(cfg.displayProfile(QApplication::desktop()->screenNumber(this->canvasWidget())));
 
     initializeFpsDecoration();
+    notifyLevelOfDetailChange();
 }
 
 void KisCanvas2::refetchDataFromImage()
@@ -82,6 +82,12 @@ public:
 
     void notifyZoomChanged();
 
+    /**
+     * Called by the view when its current node changes, the tiles of
+     * the active node are kept in memory along with the visible ones
+     */
+    void notifyCurrentNodeChanged();
+
     void disconnectCanvasObserver(QObject *object) override;
 
 public: // KoCanvasBase implementation
@@ -272,6 +278,8 @@ private Q_SLOTS:
 
     void slotDoCanvasUpdate();
 
+    void slotUpdateSwapPriorities();
+
     void bootstrapFinished();
 
 public:
@@ -35,6 +35,7 @@
 
 #include <kis_debug.h>
 #include <kis_config.h>
+#include <KisTraceRecorder.h>
 
 #include <KoColorProfile.h>
 #include "kis_coordinates_converter.h"
@@ -101,6 +102,8 @@ void KisQPainterCanvas::setPrescaledProjection(KisPrescaledProjectionSP prescale
 
 void KisQPainterCanvas::paintEvent(QPaintEvent * ev)
 {
+    KIS_TRACE_SCOPE("paint canvas", "canvas");
+
     KisImageWSP image = canvas()->image();
     if (image == 0) return;
 
@@ -74,6 +74,7 @@
 #include "kis_color_manager.h"
 #include "KisProofingConfiguration.h"
 #include "kis_image_config.h"
+#include "KisTraceRecorder.h"
 
 #include "slider_and_spin_box_sync.h"
 
@@ -774,6 +775,7 @@ void PerformanceTab::load(bool requestDefault)
     sliderUndoLimit->setValue(cfg.memorySoftLimitPercent(requestDefault));
 
     chkPerformanceLogging->setChecked(cfg.enablePerfLog(requestDefault));
+    chkUpdateTracing->setChecked(cfg.enableUpdateTracing(requestDefault));
     chkProgressReporting->setChecked(cfg.enableProgressReporting(requestDefault));
 
     sliderSwapSize->setValue(cfg.maxSwapSize(requestDefault) / 1024);
@@ -786,6 +788,7 @@ void PerformanceTab::load(bool requestDefault)
     sliderFrameClonesLimit->setValue(m_lastUsedClonesLimit);
 
     sliderFpsLimit->setValue(cfg.fpsLimit(requestDefault));
+    chkAdaptiveLevelOfDetail->setChecked(cfg.enableAdaptiveLevelOfDetail(requestDefault));
 
     {
         KisConfig cfg2;
@@ -804,6 +807,11 @@ void PerformanceTab::save()
     cfg.setMemoryPoolLimitPercent(sliderPoolLimit->value());
 
     cfg.setEnablePerfLog(chkPerformanceLogging->isChecked());
+
+    if (cfg.enableUpdateTracing() && !chkUpdateTracing->isChecked()) {
+        KisTraceRecorder::instance()->dumpToLogFolder();
+    }
+    cfg.setEnableUpdateTracing(chkUpdateTracing->isChecked());
     cfg.setEnableProgressReporting(chkProgressReporting->isChecked());
 
     cfg.setMaxSwapSize(sliderSwapSize->value() * 1024);
@@ -813,6 +821,7 @@ void PerformanceTab::save()
     cfg.setMaxNumberOfThreads(sliderThreadsLimit->value());
     cfg.setFrameRenderingClones(sliderFrameClonesLimit->value());
     cfg.setFpsLimit(sliderFpsLimit->value());
+    cfg.setEnableAdaptiveLevelOfDetail(chkAdaptiveLevelOfDetail->isChecked());
 
     {
         KisConfig cfg2;
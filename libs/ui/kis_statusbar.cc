@@ -283,11 +283,13 @@ void KisStatusBar::updateMemoryStatus()
                   "Image size:\t %1\n"
                   "  - layers:\t\t %2\n"
                   "  - projections:\t %3\n"
-                  "  - instant preview:\t %4\n",
+                  "  - instant preview:\t %4\n"
+                  "  - composition cache:\t %5\n",
                   formatSize(stats.imageSize),
                   formatSize(stats.layersSize),
                   formatSize(stats.projectionsSize),
-                  formatSize(stats.lodSize));
+                  formatSize(stats.lodSize),
+                  formatSize(stats.belowStackCacheSize));
 
     const QString memoryStatsMsg =
             i18nc("tooltip on statusbar memory reporting button (total stats)",
@@ -295,6 +297,7 @@ void KisStatusBar::updateMemoryStatus()
                   "  image data:\t %3 / %4\n"
                   "  pool:\t\t %5 / %6\n"
                   "  undo data:\t %7\n"
+                  "  shared duplicates:\t %9\n"
                   "\n"
                   "Swap used:\t %8",
                   formatSize(stats.totalMemorySize),
@@ -307,7 +310,8 @@ void KisStatusBar::updateMemoryStatus()
                   formatSize(stats.tilesPoolLimit),
 
                   formatSize(stats.historicalMemorySize),
-                  formatSize(stats.swapSize));
+                  formatSize(stats.swapSize),
+                  formatSize(stats.deduplicatedSize));
 
     QString longStats = imageStatsMsg + "\n" + memoryStatsMsg;
 
@@ -31,6 +31,7 @@
 #include "kis_config.h"
 #include "kis_config_notifier.h"
 #include "kis_debug.h"
+#include "KisTraceRecorder.h"
 
 #include <QPainter>
 #include <QPainterPath>
@@ -355,6 +356,8 @@ void KisOpenGLCanvas2::resizeGL(int width, int height)
 
 void KisOpenGLCanvas2::paintGL()
 {
+    KIS_TRACE_SCOPE("paint canvas", "canvas");
+
     if (!OPENGL_SUCCESS) {
         KisConfig cfg;
         cfg.writeEntry("canvasState", "OPENGL_PAINT_STARTED");
@@ -32,6 +32,7 @@
 #include "kis_image.h"
 #include "kis_config.h"
 #include "KisPart.h"
+#include "KisTraceRecorder.h"
 
 #ifdef HAVE_OPENEXR
 #include <half.h>
@@ -266,6 +267,8 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheNoConversion(const QRec
 // TODO: add sanity checks about the conformance of the passed srcImage!
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect, KisImageSP srcImage, bool convertColorSpace)
 {
+    KIS_TRACE_SCOPE("prepare textures", "canvas");
+
     const KoColorSpace *dstCS = m_tilesDestinationColorSpace;
 
     ConversionOptions options;
@@ -380,6 +383,8 @@ void KisOpenGLImageTextures::recalculateCache(KisUpdateInfoSP info)
     KisOpenGLUpdateInfoSP glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
     if(!glInfo) return;
 
+    KIS_TRACE_SCOPE("upload textures", "canvas");
+
     KisTextureTileUpdateInfoSP tileInfo;
     Q_FOREACH (tileInfo, glInfo->tileList) {
         KisTextureTile *tile = getTextureTileCR(tileInfo->tileCol(), tileInfo->tileRow());
@@ -116,6 +116,7 @@ void FreehandStrokeStrategy::init()
     setSupportsWrapAroundMode(true);
     setSupportsMaskingBrush(true);
     setSupportsIndirectPainting(true);
+    setAdaptsLevelOfDetail(true);
     enableJob(KisSimpleStrokeStrategy::JOB_DOSTROKE);
 
     if (m_d->needsAsynchronousUpdates) {
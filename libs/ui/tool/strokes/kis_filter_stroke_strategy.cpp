@@ -21,15 +21,30 @@
 #include <filter/kis_filter.h>
 #include <filter/kis_filter_configuration.h>
 #include <kis_transaction.h>
+#include <kis_image_config.h>
 #include <KoCompositeOpRegistry.h>
 
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisRunnableStrokeJobsInterface.h>
+
+namespace {
+/**
+ * The height of the tiles of the paint devices. The bands never share
+ * a row of tiles, so the concurrent bands don't write into the same
+ * tile.
+ */
+const int tileHeight = 64;
+}
+
 
 struct KisFilterStrokeStrategy::Private {
     Private()
         : updatesFacade(0),
           cancelSilently(false),
           secondaryTransaction(0),
-          levelOfDetail(0)
+          levelOfDetail(0),
+          maxNumBands(1)
     {
     }
 
@@ -43,7 +58,8 @@ struct KisFilterStrokeStrategy::Private {
           filterDeviceBounds(),
           secondaryTransaction(0),
           progressHelper(),
-          levelOfDetail(0)
+          levelOfDetail(0),
+          maxNumBands(rhs.maxNumBands)
     {
         KIS_ASSERT_RECOVER_RETURN(!rhs.filterDevice);
         KIS_ASSERT_RECOVER_RETURN(rhs.filterDeviceBounds.isEmpty());
@@ -64,6 +80,7 @@ struct KisFilterStrokeStrategy::Private {
     QScopedPointer<KisProcessingVisitor::ProgressHelper> progressHelper;
 
     int levelOfDetail;
+    int maxNumBands;
 };
 
 
@@ -83,6 +100,7 @@ KisFilterStrokeStrategy::KisFilterStrokeStrategy(KisFilterSP filter,
     m_d->cancelSilently = false;
     m_d->secondaryTransaction = 0;
     m_d->levelOfDetail = 0;
+    m_d->maxNumBands = qMax(1, KisImageConfig(true).maxNumberOfThreads());
 
     setSupportsWrapAroundMode(true);
     enableJob(KisSimpleStrokeStrategy::JOB_DOSTROKE);
@@ -142,25 +160,103 @@ void KisFilterStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
             return;
         }
 
-        m_d->filter->processImpl(m_d->filterDevice, rc,
-                                 m_d->filterConfig.data(),
-                                 m_d->progressHelper->updater());
+        const QVector<QRect> bands = splitIntoBands(rc);
 
-        if (m_d->secondaryTransaction) {
-            KisPainter::copyAreaOptimized(rc.topLeft(), m_d->filterDevice, targetDevice(), rc, activeSelection());
+        if (bands.size() == 1) {
+            m_d->filter->processImpl(m_d->filterDevice, rc,
+                                     m_d->filterConfig.data(),
+                                     m_d->progressHelper->updater());
+            finishProcessedRect(rc);
+            return;
+        }
 
-            // Free memory
-            m_d->filterDevice->clear(rc);
+        /**
+         * The bands are processed as separate stroke jobs, so they
+         * are executed by the scheduler's own threads, respecting its
+         * limit of threads and the cancellation of the stroke. The
+         * last finished band writes the whole rect into the target.
+         */
+        QSharedPointer<QAtomicInt> numPendingBands(new QAtomicInt(bands.size()));
+        QVector<KisRunnableStrokeJobData*> jobs;
+
+        Q_FOREACH (const QRect &band, bands) {
+            KritaUtils::addJobConcurrent(jobs, [this, band, rc, numPendingBands] () {
+                m_d->filter->processImpl(m_d->filterDevice, band,
+                                         m_d->filterConfig.data(),
+                                         m_d->progressHelper->updater());
+
+                if (!numPendingBands->deref()) {
+                    finishProcessedRect(rc);
+                }
+            });
         }
 
-        m_d->node->setDirty(rc);
+        runnableJobsInterface()->addRunnableJobs(jobs);
     } else if (cancelJob) {
         m_d->cancelSilently = true;
+    } else if (dynamic_cast<KisRunnableStrokeJobData*>(data)) {
+        KisPainterBasedStrokeStrategy::doStrokeCallback(data);
     } else {
         qFatal("KisFilterStrokeStrategy: job type is not known");
     }
 }
 
+QVector<QRect> KisFilterStrokeStrategy::splitIntoBands(const QRect &rc) const
+{
+    QVector<QRect> bands;
+
+    if (!m_d->filter->supportsThreading() || m_d->maxNumBands <= 1) {
+        bands << rc;
+        return bands;
+    }
+
+    /**
+     * Every band reads its own border, so the bands should be
+     * much higher than the border to keep the overhead small.
+     */
+    const QRect needRect =
+        m_d->filter->neededRect(rc, m_d->filterConfig.data(), m_d->levelOfDetail);
+    const int borderHeight = qMax(0, needRect.height() - rc.height());
+    const int minBandHeight = qMax(tileHeight, 4 * borderHeight);
+
+    if (rc.height() < 2 * minBandHeight) {
+        bands << rc;
+        return bands;
+    }
+
+    int bandHeight = qMax(minBandHeight, rc.height() / m_d->maxNumBands);
+    bandHeight = (bandHeight + tileHeight - 1) / tileHeight * tileHeight;
+
+    const int tileOffsetY = -m_d->filterDevice->y();
+
+    int y = rc.top();
+    while (y <= rc.bottom()) {
+        const int tileY = y + tileOffsetY;
+        const int bandStart = tileY >= 0 ?
+            tileY / bandHeight * bandHeight :
+            -((-tileY + bandHeight - 1) / bandHeight * bandHeight);
+
+        const int nextY = qMin(bandStart + bandHeight - tileOffsetY, rc.bottom() + 1);
+
+        bands << QRect(rc.x(), y, rc.width(), nextY - y);
+        y = nextY;
+    }
+
+    return bands;
+}
+
+void KisFilterStrokeStrategy::finishProcessedRect(const QRect &rc)
+{
+    if (m_d->secondaryTransaction) {
+        KisPainter::copyAreaOptimized(rc.topLeft(), m_d->filterDevice, targetDevice(), rc, activeSelection());
+
+        // Free memory
+        m_d->filterDevice->clear(rc);
+    }
+
+    m_d->node->setDirty(rc);
+}
+
 void KisFilterStrokeStrategy::cancelStrokeCallback()
 {
     delete m_d->secondaryTransaction;
@@ -76,6 +76,21 @@ public:
 
     KisStrokeStrategy* createLodClone(int levelOfDetail) override;
 
+private:
+    /**
+     * Splits \p rc into horizontal bands that can be filtered as
+     * separate concurrent jobs. The bands are aligned to the tile
+     * rows of the filtered device. The filters that don't support
+     * threading get the whole rect.
+     */
+    QVector<QRect> splitIntoBands(const QRect &rc) const;
+
+    /**
+     * Writes the filtered \p rc into the target device and
+     * requests its update.
+     */
+    void finishProcessedRect(const QRect &rc);
+
 private:
     struct Private;
     Private* const m_d;
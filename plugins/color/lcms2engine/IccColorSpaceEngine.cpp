@@ -25,6 +25,7 @@
 #include <klocalizedstring.h>
 
 #include "LcmsColorSpace.h"
+#include "LcmsMatrixShaperTransformation.h"
 
 // -- KoLcmsColorConversionTransformation --
 
@@ -254,11 +255,28 @@ KoColorConversionTransformation *IccColorSpaceEngine::createColorTransformation(
     Q_ASSERT(srcColorSpace);
     Q_ASSERT(dstColorSpace);
 
-    return new KoLcmsColorConversionTransformation(
-                srcColorSpace, computeColorSpaceType(srcColorSpace),
-                dynamic_cast<const IccColorProfile *>(srcColorSpace->profile())->asLcms(), dstColorSpace, computeColorSpaceType(dstColorSpace),
-                dynamic_cast<const IccColorProfile *>(dstColorSpace->profile())->asLcms(), renderingIntent, conversionFlags);
+    const quint32 srcColorSpaceType = computeColorSpaceType(srcColorSpace);
+    const quint32 dstColorSpaceType = computeColorSpaceType(dstColorSpace);
+    LcmsColorProfileContainer *srcProfile = dynamic_cast<const IccColorProfile *>(srcColorSpace->profile())->asLcms();
+    LcmsColorProfileContainer *dstProfile = dynamic_cast<const IccColorProfile *>(dstColorSpace->profile())->asLcms();
+
+    /**
+     * Conversions between two RGB matrix-shaper profiles (sRGB, Rec.2020,
+     * their linear versions and so on) are done without lcms
+     */
+    KoColorConversionTransformation *transformation =
+        LcmsMatrixShaperTransformation::create(srcColorSpace, srcColorSpaceType, srcProfile,
+                                               dstColorSpace, dstColorSpaceType, dstProfile,
+                                               renderingIntent, conversionFlags);
+
+    if (!transformation) {
+        transformation = new KoLcmsColorConversionTransformation(
+                    srcColorSpace, srcColorSpaceType, srcProfile,
+                    dstColorSpace, dstColorSpaceType, dstProfile,
+                    renderingIntent, conversionFlags);
+    }
 
+    return transformation;
 }
 KoColorProofingConversionTransformation *IccColorSpaceEngine::createColorProofingTransformation(const KoColorSpace *srcColorSpace,
                                                                                                 const KoColorSpace *dstColorSpace,
@@ -24,6 +24,7 @@
 
 #include <colorprofiles/LcmsColorProfileContainer.h>
 #include <KoColorSpaceAbstract.h>
+#include <KoPerChannelLutTransformation.h>
 #include <QMutex>
 #include <QMutexLocker>
 
@@ -328,6 +329,36 @@ public:
             return 0;
         }
 
+        /**
+         * The tone curves of the integer RGB, Gray and CMYK spaces
+         * work on the encoded channel values, so they can be applied
+         * with plain look-up tables, which is much faster than an
+         * lcms transform.
+         */
+        if (std::numeric_limits<typename _CSTraits::channels_type>::is_integer &&
+            (this->colorSpaceSignature() == cmsSigRgbData ||
+             this->colorSpaceSignature() == cmsSigGrayData ||
+             this->colorSpaceSignature() == cmsSigCmykData)) {
+
+            /**
+             * The curves of lcms follow the order of the channels
+             * in the color model, which is their display order.
+             */
+            QVector<const quint16*> transfers(_CSTraits::channels_nb, 0);
+            const QList<KoChannelInfo*> channels = KoChannelInfo::displayOrderSorted(this->channels());
+
+            int colorIndex = 0;
+            Q_FOREACH (KoChannelInfo *channel, channels) {
+                const int index = channel->pos() / sizeof(typename _CSTraits::channels_type);
+                transfers[index] =
+                    channel->channelType() == KoChannelInfo::ALPHA ?
+                    transferValues[this->colorChannelCount()] :
+                    transferValues[colorIndex++];
+            }
+
+            return new KoPerChannelLutTransformation<_CSTraits>(transfers, 256);
+        }
+
         cmsToneCurve **transferFunctions = new cmsToneCurve*[ this->colorChannelCount()];
 
         for (uint ch = 0; ch < this->colorChannelCount(); ch++) {
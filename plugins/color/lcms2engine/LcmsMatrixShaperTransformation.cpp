@@ -0,0 +1,466 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "LcmsMatrixShaperTransformation.h"
+
+#include <cmath>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceMaths.h>
+
+#include "LcmsColorProfileContainer.h"
+
+namespace {
+
+/**
+ * Size of the tables that map linear light back to the destination
+ * encoding. Linear values are quantized to 16 bits, which is what lcms
+ * itself does for integer transforms.
+ */
+const int delinearizeTableSize = 65536;
+
+/**
+ * Number of pixels converted in one go. The pixels of a batch are kept
+ * in planar float buffers on the stack, so that the matrix pass is a plain
+ * loop over arrays.
+ */
+const int batchSize = 256;
+
+bool parseLayout(quint32 colorSpaceType, LcmsMatrixShaperTransformation::PixelLayout *layout)
+{
+    if (T_COLORSPACE(colorSpaceType) != PT_RGB ||
+        T_CHANNELS(colorSpaceType) != 3 ||
+        T_EXTRA(colorSpaceType) != 1 ||
+        T_PLANAR(colorSpaceType) ||
+        T_ENDIAN16(colorSpaceType) ||
+        T_FLAVOR(colorSpaceType)) {
+
+        return false;
+    }
+
+    layout->channelSize = T_BYTES(colorSpaceType);
+    layout->isFloat = T_FLOAT(colorSpaceType);
+
+    if (layout->isFloat && layout->channelSize != 4) return false;
+    if (!layout->isFloat && layout->channelSize != 1 && layout->channelSize != 2) return false;
+
+    const bool doSwap = T_DOSWAP(colorSpaceType);
+    const bool swapFirst = T_SWAPFIRST(colorSpaceType);
+
+    if (!doSwap && !swapFirst) {
+        layout->redPos = 0;
+        layout->greenPos = 1;
+        layout->bluePos = 2;
+        layout->alphaPos = 3;
+    } else if (doSwap && swapFirst) {
+        layout->bluePos = 0;
+        layout->greenPos = 1;
+        layout->redPos = 2;
+        layout->alphaPos = 3;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Fetches the colorants and the tone curves of an RGB matrix-shaper
+ * profile. The matrix maps linear RGB to PCS XYZ, row-major.
+ */
+bool readMatrixShaper(cmsHPROFILE profile, int usedDirection, cmsUInt32Number intent,
+                      double *matrix, cmsToneCurve **curves)
+{
+    if (!profile ||
+        cmsGetColorSpace(profile) != cmsSigRgbData ||
+        cmsGetPCS(profile) != cmsSigXYZData ||
+        !cmsIsMatrixShaper(profile) ||
+        cmsIsCLUT(profile, intent, usedDirection)) {
+
+        return false;
+    }
+
+    const cmsCIEXYZ *red = static_cast<cmsCIEXYZ*>(cmsReadTag(profile, cmsSigRedColorantTag));
+    const cmsCIEXYZ *green = static_cast<cmsCIEXYZ*>(cmsReadTag(profile, cmsSigGreenColorantTag));
+    const cmsCIEXYZ *blue = static_cast<cmsCIEXYZ*>(cmsReadTag(profile, cmsSigBlueColorantTag));
+
+    curves[0] = static_cast<cmsToneCurve*>(cmsReadTag(profile, cmsSigRedTRCTag));
+    curves[1] = static_cast<cmsToneCurve*>(cmsReadTag(profile, cmsSigGreenTRCTag));
+    curves[2] = static_cast<cmsToneCurve*>(cmsReadTag(profile, cmsSigBlueTRCTag));
+
+    if (!red || !green || !blue || !curves[0] || !curves[1] || !curves[2]) {
+        return false;
+    }
+
+    matrix[0] = red->X; matrix[1] = green->X; matrix[2] = blue->X;
+    matrix[3] = red->Y; matrix[4] = green->Y; matrix[5] = blue->Y;
+    matrix[6] = red->Z; matrix[7] = green->Z; matrix[8] = blue->Z;
+
+    return true;
+}
+
+bool invertMatrix(const double *m, double *inv)
+{
+    const double c0 = m[4] * m[8] - m[5] * m[7];
+    const double c1 = m[5] * m[6] - m[3] * m[8];
+    const double c2 = m[3] * m[7] - m[4] * m[6];
+
+    const double det = m[0] * c0 + m[1] * c1 + m[2] * c2;
+    if (std::fabs(det) < 1e-12) return false;
+
+    const double invDet = 1.0 / det;
+
+    inv[0] = c0 * invDet;
+    inv[1] = (m[2] * m[7] - m[1] * m[8]) * invDet;
+    inv[2] = (m[1] * m[5] - m[2] * m[4]) * invDet;
+    inv[3] = c1 * invDet;
+    inv[4] = (m[0] * m[8] - m[2] * m[6]) * invDet;
+    inv[5] = (m[2] * m[3] - m[0] * m[5]) * invDet;
+    inv[6] = c2 * invDet;
+    inv[7] = (m[1] * m[6] - m[0] * m[7]) * invDet;
+    inv[8] = (m[0] * m[4] - m[1] * m[3]) * invDet;
+
+    return true;
+}
+
+bool allCurvesLinear(cmsToneCurve **curves)
+{
+    return cmsIsToneCurveLinear(curves[0]) &&
+        cmsIsToneCurveLinear(curves[1]) &&
+        cmsIsToneCurveLinear(curves[2]);
+}
+
+bool blackIsZero(cmsToneCurve **curves)
+{
+    for (int i = 0; i < 3; i++) {
+        if (std::fabs(cmsEvalToneCurveFloat(curves[i], 0.0f)) > 1e-6f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool blackPointCompensationMayApply(cmsHPROFILE profile,
+                                    KoColorConversionTransformation::Intent intent,
+                                    KoColorConversionTransformation::ConversionFlags flags)
+{
+    /**
+     * lcms enables BPC implicitly for v4 profiles in perceptual
+     * and saturation intents
+     */
+    return flags.testFlag(KoColorConversionTransformation::BlackpointCompensation) ||
+        ((intent == KoColorConversionTransformation::IntentPerceptual ||
+          intent == KoColorConversionTransformation::IntentSaturation) &&
+         cmsGetEncodedICCversion(profile) >= 0x4000000);
+}
+
+template <typename T>
+void fillDelinearizeTable(cmsToneCurve *curve, QVector<T> *table)
+{
+    table->resize(delinearizeTableSize);
+    T *ptr = table->data();
+
+    const float unit = KoColorSpaceMathsTraits<T>::unitValue;
+
+    for (int i = 0; i < delinearizeTableSize; i++) {
+        const float value = cmsEvalToneCurveFloat(curve, float(i) / (delinearizeTableSize - 1));
+        ptr[i] = T(qBound(0.0f, value * unit + 0.5f, unit));
+    }
+}
+
+template <typename T>
+void loadInteger(const quint8 *src, int numPixels,
+                 const LcmsMatrixShaperTransformation::PixelLayout &layout,
+                 const QVector<float> *linearize,
+                 float *r, float *g, float *b, float *a)
+{
+    const T *pixel = reinterpret_cast<const T*>(src);
+
+    const float *redTable = linearize[0].constData();
+    const float *greenTable = linearize[1].constData();
+    const float *blueTable = linearize[2].constData();
+
+    const float alphaScale = 1.0f / KoColorSpaceMathsTraits<T>::unitValue;
+
+    for (int i = 0; i < numPixels; i++) {
+        r[i] = redTable[pixel[layout.redPos]];
+        g[i] = greenTable[pixel[layout.greenPos]];
+        b[i] = blueTable[pixel[layout.bluePos]];
+        a[i] = pixel[layout.alphaPos] * alphaScale;
+        pixel += 4;
+    }
+}
+
+void loadFloat(const quint8 *src, int numPixels,
+               const LcmsMatrixShaperTransformation::PixelLayout &layout,
+               float *r, float *g, float *b, float *a)
+{
+    const float *pixel = reinterpret_cast<const float*>(src);
+
+    for (int i = 0; i < numPixels; i++) {
+        r[i] = pixel[layout.redPos];
+        g[i] = pixel[layout.greenPos];
+        b[i] = pixel[layout.bluePos];
+        a[i] = pixel[layout.alphaPos];
+        pixel += 4;
+    }
+}
+
+inline int linearToIndex(float value)
+{
+    return int(qBound(0.0f, value, 1.0f) * (delinearizeTableSize - 1) + 0.5f);
+}
+
+template <typename T>
+void storeInteger(const float *r, const float *g, const float *b, const float *a,
+                  int numPixels,
+                  const LcmsMatrixShaperTransformation::PixelLayout &layout,
+                  const QVector<T> *delinearize,
+                  quint8 *dst)
+{
+    T *pixel = reinterpret_cast<T*>(dst);
+
+    const T *redTable = delinearize[0].constData();
+    const T *greenTable = delinearize[1].constData();
+    const T *blueTable = delinearize[2].constData();
+
+    const float unit = KoColorSpaceMathsTraits<T>::unitValue;
+
+    for (int i = 0; i < numPixels; i++) {
+        pixel[layout.redPos] = redTable[linearToIndex(r[i])];
+        pixel[layout.greenPos] = greenTable[linearToIndex(g[i])];
+        pixel[layout.bluePos] = blueTable[linearToIndex(b[i])];
+        pixel[layout.alphaPos] = T(qBound(0.0f, a[i] * unit + 0.5f, unit));
+        pixel += 4;
+    }
+}
+
+void storeFloat(const float *r, const float *g, const float *b, const float *a,
+                int numPixels,
+                const LcmsMatrixShaperTransformation::PixelLayout &layout,
+                quint8 *dst)
+{
+    float *pixel = reinterpret_cast<float*>(dst);
+
+    for (int i = 0; i < numPixels; i++) {
+        pixel[layout.redPos] = r[i];
+        pixel[layout.greenPos] = g[i];
+        pixel[layout.bluePos] = b[i];
+        pixel[layout.alphaPos] = a[i];
+        pixel += 4;
+    }
+}
+
+}
+
+LcmsMatrixShaperTransformation::LcmsMatrixShaperTransformation(const KoColorSpace *srcCs, const KoColorSpace *dstCs,
+                                                               Intent renderingIntent, ConversionFlags conversionFlags)
+    : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags)
+{
+}
+
+LcmsMatrixShaperTransformation *LcmsMatrixShaperTransformation::create(const KoColorSpace *srcCs, quint32 srcColorSpaceType, LcmsColorProfileContainer *srcProfile,
+                                                                       const KoColorSpace *dstCs, quint32 dstColorSpaceType, LcmsColorProfileContainer *dstProfile,
+                                                                       Intent renderingIntent,
+                                                                       ConversionFlags conversionFlags)
+{
+    /**
+     * NoOptimization is the way to ask for the exact lcms pipeline, and
+     * the rest of the flags need a real lcms transform anyway
+     */
+    if (conversionFlags.testFlag(NoOptimization) ||
+        conversionFlags.testFlag(GamutCheck) ||
+        conversionFlags.testFlag(SoftProofing) ||
+        renderingIntent == IntentAbsoluteColorimetric ||
+        !srcProfile || !dstProfile) {
+
+        return 0;
+    }
+
+    PixelLayout srcLayout;
+    PixelLayout dstLayout;
+
+    if (!parseLayout(srcColorSpaceType, &srcLayout) ||
+        !parseLayout(dstColorSpaceType, &dstLayout)) {
+
+        return 0;
+    }
+
+    double srcMatrix[9];
+    double dstMatrix[9];
+    cmsToneCurve *srcCurves[3];
+    cmsToneCurve *dstCurves[3];
+
+    if (!readMatrixShaper(srcProfile->lcmsProfile(), LCMS_USED_AS_INPUT, renderingIntent, srcMatrix, srcCurves) ||
+        !readMatrixShaper(dstProfile->lcmsProfile(), LCMS_USED_AS_OUTPUT, renderingIntent, dstMatrix, dstCurves)) {
+
+        return 0;
+    }
+
+    /**
+     * Float pixels are not limited to [0, 1], so we cannot tabulate
+     * their curves. Only linear float profiles take the fast path.
+     */
+    if ((srcLayout.isFloat && !allCurvesLinear(srcCurves)) ||
+        (dstLayout.isFloat && !allCurvesLinear(dstCurves))) {
+
+        return 0;
+    }
+
+    /**
+     * Black point compensation is a no-op only when both profiles
+     * map zero to zero
+     */
+    if ((blackPointCompensationMayApply(srcProfile->lcmsProfile(), renderingIntent, conversionFlags) ||
+         blackPointCompensationMayApply(dstProfile->lcmsProfile(), renderingIntent, conversionFlags)) &&
+        (!blackIsZero(srcCurves) || !blackIsZero(dstCurves))) {
+
+        return 0;
+    }
+
+    double dstInverse[9];
+    if (!invertMatrix(dstMatrix, dstInverse)) {
+        return 0;
+    }
+
+    cmsToneCurve *reversedCurves[3] = {0, 0, 0};
+    if (!dstLayout.isFloat) {
+        for (int i = 0; i < 3; i++) {
+            reversedCurves[i] = cmsReverseToneCurve(dstCurves[i]);
+
+            if (!reversedCurves[i]) {
+                for (int j = 0; j < i; j++) {
+                    cmsFreeToneCurve(reversedCurves[j]);
+                }
+                return 0;
+            }
+        }
+    }
+
+    LcmsMatrixShaperTransformation *t =
+        new LcmsMatrixShaperTransformation(srcCs, dstCs, renderingIntent, conversionFlags);
+
+    t->m_srcLayout = srcLayout;
+    t->m_dstLayout = dstLayout;
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            double value = 0.0;
+            for (int k = 0; k < 3; k++) {
+                value += dstInverse[row * 3 + k] * srcMatrix[k * 3 + col];
+            }
+            t->m_matrix[row * 3 + col] = value;
+        }
+    }
+
+    if (!srcLayout.isFloat) {
+        const int tableSize = 1 << (8 * srcLayout.channelSize);
+
+        for (int i = 0; i < 3; i++) {
+            // profiles usually link all three TRC tags to a single curve
+            if (i > 0 && srcCurves[i] == srcCurves[i - 1]) {
+                t->m_linearize[i] = t->m_linearize[i - 1];
+                continue;
+            }
+
+            QVector<float> &table = t->m_linearize[i];
+            table.resize(tableSize);
+
+            for (int j = 0; j < tableSize; j++) {
+                table[j] = cmsEvalToneCurveFloat(srcCurves[i], float(j) / (tableSize - 1));
+            }
+        }
+    }
+
+    if (!dstLayout.isFloat) {
+        for (int i = 0; i < 3; i++) {
+            if (i > 0 && dstCurves[i] == dstCurves[i - 1]) {
+                t->m_delinearize16[i] = t->m_delinearize16[i - 1];
+                t->m_delinearize8[i] = t->m_delinearize8[i - 1];
+            } else if (dstLayout.channelSize == 1) {
+                fillDelinearizeTable(reversedCurves[i], &t->m_delinearize8[i]);
+            } else {
+                fillDelinearizeTable(reversedCurves[i], &t->m_delinearize16[i]);
+            }
+
+            cmsFreeToneCurve(reversedCurves[i]);
+        }
+    }
+
+    return t;
+}
+
+void LcmsMatrixShaperTransformation::loadPixels(const quint8 *src, int numPixels, float *r, float *g, float *b, float *a) const
+{
+    if (m_srcLayout.isFloat) {
+        loadFloat(src, numPixels, m_srcLayout, r, g, b, a);
+    } else if (m_srcLayout.channelSize == 1) {
+        loadInteger<quint8>(src, numPixels, m_srcLayout, m_linearize, r, g, b, a);
+    } else {
+        loadInteger<quint16>(src, numPixels, m_srcLayout, m_linearize, r, g, b, a);
+    }
+}
+
+void LcmsMatrixShaperTransformation::storePixels(const float *r, const float *g, const float *b, const float *a, int numPixels, quint8 *dst) const
+{
+    if (m_dstLayout.isFloat) {
+        storeFloat(r, g, b, a, numPixels, m_dstLayout, dst);
+    } else if (m_dstLayout.channelSize == 1) {
+        storeInteger<quint8>(r, g, b, a, numPixels, m_dstLayout, m_delinearize8, dst);
+    } else {
+        storeInteger<quint16>(r, g, b, a, numPixels, m_dstLayout, m_delinearize16, dst);
+    }
+}
+
+void LcmsMatrixShaperTransformation::transform(const quint8 *src, quint8 *dst, qint32 numPixels) const
+{
+    float r[batchSize];
+    float g[batchSize];
+    float b[batchSize];
+    float a[batchSize];
+
+    const int srcStride = 4 * m_srcLayout.channelSize;
+    const int dstStride = 4 * m_dstLayout.channelSize;
+
+    const float m0 = m_matrix[0], m1 = m_matrix[1], m2 = m_matrix[2];
+    const float m3 = m_matrix[3], m4 = m_matrix[4], m5 = m_matrix[5];
+    const float m6 = m_matrix[6], m7 = m_matrix[7], m8 = m_matrix[8];
+
+    while (numPixels > 0) {
+        const int batch = qMin(numPixels, batchSize);
+
+        loadPixels(src, batch, r, g, b, a);
+
+        for (int i = 0; i < batch; i++) {
+            const float sr = r[i];
+            const float sg = g[i];
+            const float sb = b[i];
+
+            r[i] = m0 * sr + m1 * sg + m2 * sb;
+            g[i] = m3 * sr + m4 * sg + m5 * sb;
+            b[i] = m6 * sr + m7 * sg + m8 * sb;
+        }
+
+        storePixels(r, g, b, a, batch, dst);
+
+        src += batch * srcStride;
+        dst += batch * dstStride;
+        numPixels -= batch;
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2018 The Krita developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _LCMS_MATRIX_SHAPER_TRANSFORMATION_H_
+#define _LCMS_MATRIX_SHAPER_TRANSFORMATION_H_
+
+#include <KoColorConversionTransformation.h>
+
+#include <QVector>
+
+class LcmsColorProfileContainer;
+
+/**
+ * A color conversion between two RGB matrix-shaper profiles that does not
+ * go through cmsDoTransform(). Such a conversion is nothing more than
+ * a per-channel tone curve, a 3x3 matrix and another per-channel tone curve,
+ * so the curves are baked into lookup tables and the matrix is applied to
+ * batches of pixels in a loop the compiler can vectorize.
+ *
+ * Use create() to get an instance; it returns 0 for any pair of profiles,
+ * pixel layouts, intents or flags that the fast path cannot reproduce
+ * exactly, and the caller is expected to fall back to a full LCMS transform.
+ */
+class LcmsMatrixShaperTransformation : public KoColorConversionTransformation
+{
+public:
+    static LcmsMatrixShaperTransformation *create(const KoColorSpace *srcCs, quint32 srcColorSpaceType, LcmsColorProfileContainer *srcProfile,
+                                                  const KoColorSpace *dstCs, quint32 dstColorSpaceType, LcmsColorProfileContainer *dstProfile,
+                                                  Intent renderingIntent,
+                                                  ConversionFlags conversionFlags);
+
+    void transform(const quint8 *src, quint8 *dst, qint32 numPixels) const override;
+
+public:
+    /**
+     * Position and type of the channels of an RGBA pixel as described
+     * by an lcms pixel type
+     */
+    struct PixelLayout {
+        int channelSize;
+        bool isFloat;
+        int redPos;
+        int greenPos;
+        int bluePos;
+        int alphaPos;
+    };
+
+private:
+    LcmsMatrixShaperTransformation(const KoColorSpace *srcCs, const KoColorSpace *dstCs,
+                                   Intent renderingIntent, ConversionFlags conversionFlags);
+
+    void loadPixels(const quint8 *src, int numPixels, float *r, float *g, float *b, float *a) const;
+    void storePixels(const float *r, const float *g, const float *b, const float *a, int numPixels, quint8 *dst) const;
+
+private:
+    PixelLayout m_srcLayout;
+    PixelLayout m_dstLayout;
+
+    float m_matrix[9];
+
+    /// source value -> linear light, empty for linear float sources
+    QVector<float> m_linearize[3];
+
+    /// linear light quantized to 16 bits -> destination value, for integer destinations
+    QVector<quint16> m_delinearize16[3];
+    QVector<quint8> m_delinearize8[3];
+};
+
+#endif
@@ -57,9 +57,12 @@ void HistogramDockerWidget::setPaintDevice(KisCanvas2* canvas)
 void HistogramDockerWidget::updateHistogram()
 {
     if (!m_paintDevice.isNull()) {
-        KisPaintDeviceSP m_devClone = new KisPaintDevice(m_paintDevice->colorSpace());
-
-        m_devClone->makeCloneFrom(m_paintDevice, m_bounds);
+        /**
+         * The projection is updated outside transactions, so the
+         * snapshot may catch a partially merged tile. That is
+         * acceptable for a histogram, which is recalculated anyway.
+         */
+        KisPaintDeviceSP m_devClone = m_paintDevice->createSnapshot();
 
         HistogramComputationThread *workerThread = new HistogramComputationThread(m_devClone, m_bounds);
         connect(workerThread, &HistogramComputationThread::resultReady, this, &HistogramDockerWidget::receiveNewHistogram);